@@ -72,12 +72,21 @@ typedef uint32_t ret_code_t;
 
 #else // HOST_TARGET defined
 
+#include <stdint.h>
+
 #ifndef __ALIGN
 #define __ALIGN(n) __attribute__((aligned(n)))
 #endif
 
 #define BLE_GAP_PASSKEY_LEN 6
 
+#define BLE_GAP_AD_TYPE_FLAGS                           0x01
+#define BLE_GAP_AD_TYPE_16BIT_SERVICE_UUID_COMPLETE     0x03
+#define BLE_GAP_AD_TYPE_128BIT_SERVICE_UUID_COMPLETE    0x07
+#define BLE_GAP_AD_TYPE_COMPLETE_LOCAL_NAME             0x09
+#define BLE_GAP_AD_TYPE_SERVICE_DATA                    0x16
+#define BLE_GAP_AD_TYPE_MANUFACTURER_SPECIFIC_DATA      0xFF
+
 #if __clang__
 #define STRINGIFY(str) #str
 #else
@@ -86,6 +95,11 @@ typedef uint32_t ret_code_t;
 
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 
+// The host always runs in thread mode.
+static inline uint32_t __get_IPSR(void) {
+	return 0;
+}
+
 #endif
 
 #ifdef __cplusplus
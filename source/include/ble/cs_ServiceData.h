@@ -10,13 +10,14 @@
 #pragma once
 
 #include "processing/cs_ExternalStates.h"
+#include "processing/cs_MeshStatePublisher.h"
 #include "events/cs_EventListener.h"
 #include "events/cs_EventDispatcher.h"
 #include "storage/cs_State.h"
 #include "drivers/cs_Timer.h"
 #include "cfg/cs_Config.h"
 
-class ServiceData : EventListener {
+class ServiceData : EventListener, StateSubscriber {
 
 public:
 	ServiceData();
@@ -31,30 +32,6 @@ public:
 	 */
 	void setDeviceType(uint8_t deviceType);
 
-	/** Set the power usage field of the service data.
-	 *
-	 * @param[in] powerUsage      The power usage in milliWatt.
-	 */
-	void updatePowerUsage(int32_t powerUsage);
-
-	/** Set the energy used field of the service data.
-	 *
-	 * @param[in] energy          The energy used in units of 64 Joule.
-	 */
-	void updateAccumulatedEnergy(int32_t energy);
-
-	/** Set the ID field of the service data.
-	 *
-	 * @param[in] crownstoneId    The Crownstone ID.
-	 */
-	void updateCrownstoneId(stone_id_t crownstoneId);
-
-	/** Set the switch state field of the service data.
-	 *
-	 * @param[in] switchState     The switch state.
-	 */
-	void updateSwitchState(uint8_t switchState);
-
 	/** Set the event bitmask field of the service data.
 	 *
 	 * @param[in] bitmask         The bitmask.
@@ -75,12 +52,6 @@ public:
 	 */
 	void updateExtraFlagsBitmask(uint8_t bit, bool set);
 
-	/** Set the temperature field of the service data.
-	 *
-	 * @param[in] temperature     The temperature.
-	 */
-	void updateTemperature(int8_t temperature);
-
 	/** Set the cached state errors
 	 *
 	 * @param[in] type            Type of error
@@ -119,34 +90,20 @@ private:
 	//! Stores the last (current) advertised service data
 	service_data_t _serviceData;
 
-	//! Store own ID
-	stone_id_t _crownstoneId = 0; // TODO: use State for this?
-
-	//! Store switch state
-	uint8_t _switchState = 0; // TODO: use State for this?
-
 	//! Store flags
-	uint8_t _flags = 0; // TODO: use State for this?
+	uint8_t _flags = 0;
 
 	//! Store extra flags
 	uint8_t _extraFlags = 0;
 
-	//! Store the temperature
-	int8_t  _temperature = 0; // TODO: use State for this?
-
-	//! Store the power factor
-	int8_t  _powerFactor = 0; // TODO: use State for this?
-
-	//! Store the power usage in mW
-	int32_t _powerUsageReal = 0; // TODO: use State for this?
-
-	//! Store the energy used, in units of 64 J
-	int32_t _energyUsed = 0; // TODO: use State for this?
+	//! The power factor is not measured yet.
+	int8_t  _powerFactor = 127;
 
 	//! Store timestamp of first error
 	uint32_t _firstErrorTimestamp = 0; // TODO: use State for this?
 
-	uint32_t _sendStateCountdown = MESH_SEND_STATE_INTERVAL_MS / TICK_INTERVAL_MS;
+	//! Decides when to send the state via the mesh.
+	MeshStatePublisher _statePublisher;
 
 //	//! Store the error state, so that they don't have to be retrieved every time.
 //	state_errors_t _stateErrors;
@@ -183,6 +140,33 @@ private:
 	 */
 	void handleEvent(event_t & event);
 
+	/** Called when a subscribed state value changed.
+	 */
+	void handleStateChange(const state_change_t & change);
+
+	/** Get own ID from State.
+	 */
+	stone_id_t getCrownstoneId();
+
+	/** Get switch state from State.
+	 */
+	uint8_t getSwitchState();
+
+	/** Get chip temperature from State.
+	 */
+	int8_t getTemperature();
+
+	/** Get power usage in mW from State.
+	 */
+	int32_t getPowerUsage();
+
+	/** Get the energy used from State, in units of 64 J.
+	 */
+	int32_t getEnergyUsed();
+
+	/** Get the parts of the state that are checked for significant changes, before sending them via the mesh.
+	 */
+	cs_mesh_state_sample_t getMeshStateSample();
 
 
 	/** Compress power usage, according to service data protocol v3.
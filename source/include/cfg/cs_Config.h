@@ -185,6 +185,22 @@
 // Buffer size for storage requests. Storage requests get buffered when the device is scanning or meshing.
 #define STORAGE_REQUEST_BUFFER_SIZE              5 // Should be at least 3, because setup pushes 3 storage requests (configs + operation mode + switch state).
 
+// Background garbage collection of storage, see StorageGcPolicy.
+#define STORAGE_GC_CHECK_INTERVAL_MS             1000 // Interval at which flash usage is checked.
+#define STORAGE_GC_DIRTY_RATIO_PERCENT           25 // Percentage of used flash that should be freeable before idle garbage collection.
+#define STORAGE_GC_MIN_FREEABLE_WORDS            256 // Don't collect garbage when less words can be freed.
+#define STORAGE_GC_RESERVE_WORDS                 1024 // Collect garbage without waiting for idle when less contiguous words are free.
+#define STORAGE_GC_IDLE_TIME_MS                  10000 // Time without writes, connections, or mesh activity to be considered idle.
+#define STORAGE_GC_MAX_SCHEDULER_QUEUE_USE       4 // Max number of queued scheduler events to be considered idle.
+#define STORAGE_GC_MAX_DEFER_MS                  (10 * 60 * 1000) // Max time to wait for idle once the dirty ratio is reached.
+
+#define STATE_SNAPSHOT_MAX_CONFIG_SIZE           1024 // Max size of the entries of a state snapshot, other than behaviours. See STATE_SNAPSHOT_MAX_SIZE.
+#define STATE_SNAPSHOT_COMMIT_DELAY_SECONDS      1 // Imported values are written to flash together, after this delay.
+
+#define STATE_MAX_SUBSCRIPTIONS                  16 // Max number of state change subscriptions, see StateSubscriptions.
+#define STATE_CACHE_MAX_SIZE                     512 // Max total size of values with default location FLASH_CACHED kept in RAM, unless they still have to be written.
+#define STATE_CACHE_LOG_INTERVAL_MS              (60 * 60 * 1000) // Interval at which cache statistics are logged.
+
 #define FACTORY_RESET_CODE                       0xdeadbeef
 #define FACTORY_RESET_TIMEOUT                    60000 // Timeout before recovery becomes unavailable after reset (ms)
 #define FACTORY_PROCESS_TIMEOUT                  200 // Timeout before recovery process step is executed (ms)
@@ -225,8 +241,18 @@
 #define STATE_RETRY_STORE_DELAY_MS               200 // Time before retrying to store a varable to flash.
 #define MESH_SEND_TIME_INTERVAL_MS               (60 * 1000) // Interval at which the time is sent via the mesh.
 #define MESH_SEND_TIME_INTERVAL_MS_VARIATION     (10 * 1000) // Max amount that gets added to interval.
-#define MESH_SEND_STATE_INTERVAL_MS              (60 * 1000) // Interval at which the stone state is sent via the mesh.
+#define MESH_SEND_STATE_INTERVAL_MS              (60 * 1000) // Interval at which the stone state is sent via the mesh, after it changed.
 #define MESH_SEND_STATE_INTERVAL_MS_VARIATION    (10 * 1000) // Max amount that gets added to interval.
+// The interval doubles while the state doesn't change, up to this value.
+// Firmware without this backoff times out the states of other stones after 60 s, so by default there is no backoff.
+// Only raise this when all stones in the mesh time out states after EXTERNAL_STATE_TIMEOUT_MS.
+#ifndef MESH_SEND_STATE_INTERVAL_MAX_MS
+#define MESH_SEND_STATE_INTERVAL_MAX_MS          MESH_SEND_STATE_INTERVAL_MS
+#endif
+#define MESH_SEND_STATE_CHANGE_DELAY_MS          300 // Delay before sending the state via the mesh after a significant change.
+#define MESH_SEND_STATE_MIN_INTERVAL_MS          (5 * 1000) // Min time between sending the state via the mesh because of changes.
+#define MESH_SEND_STATE_POWER_THRESHOLD_MW       5000 // Min change in power usage to send the state via the mesh.
+#define MESH_SEND_STATE_POWER_THRESHOLD_PERCENTAGE 20 // Min change in power usage, relative to last sent power usage, to send the state via the mesh.
 #define MESH_SYNC_RETRY_INTERVAL_MS              (2500)
 #define MESH_SYNC_GIVE_UP_MS                     (60 * 1000) // After some time, give up syncing.
 
@@ -276,7 +302,7 @@
 #define ADVERTISING_REFRESH_PERIOD_SETUP         500  // Push the changes in the advertisement packet to the stack every x milliseconds
 
 #define EXTERNAL_STATE_LIST_COUNT                10 // Number of stones to cache the state of, for advertising external state.
-#define EXTERNAL_STATE_TIMEOUT_MS                60000 // Time after which a state of another stone is considered to be timed out.
+#define EXTERNAL_STATE_TIMEOUT_MS                (MESH_SEND_STATE_INTERVAL_MAX_MS + MESH_SEND_STATE_INTERVAL_MS_VARIATION) // Time after which a state of another stone is considered to be timed out.
 
 #define SWITCH_ON_AT_SETUP_BOOT_DELAY            3600  // Seconds until the switch turns on when in setup mode (Crownstone built-in only)
 
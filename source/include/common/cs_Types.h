@@ -191,6 +191,7 @@ enum class CS_TYPE: uint16_t {
 	EVT_BLE_CONNECT,                                       // Device connected.
 	EVT_BLE_DISCONNECT,                                    // Device disconnected.
 	CMD_ENABLE_ADVERTISEMENT,                              // Enable/disable advertising.
+	EVT_DEVICE_SCANNED_BATCH,                              // Batch of scanned devices.
 
 	// Switch (aggregator)
 	CMD_SWITCH_OFF = InternalBaseSwitch,              // Turn switch off.
@@ -270,6 +271,9 @@ enum class CS_TYPE: uint16_t {
 	EVT_MESH_EXT_STATE_0,                             // Mesh received part 0 of the state of a Crownstone.
 	EVT_MESH_EXT_STATE_1,                             // Mesh received part 1 of the state of a Crownstone.
 	EVT_MESH_PAGES_ERASED,                            // All mesh storage pages are completely erased.
+	CMD_SEND_MESH_BULK_TRANSFER,                      // Send data to a stone via the mesh, in chunks. The data is copied.
+	EVT_MESH_BULK_TRANSFER_RECEIVED,                  // Mesh received all data of a bulk transfer.
+	EVT_MESH_BULK_TRANSFER_RESULT,                    // A bulk transfer that was sent is done.
 
 	// Behaviour
 	CMD_ADD_BEHAVIOUR = InternalBaseBehaviour,        // Add a behaviour.
@@ -305,6 +309,13 @@ enum class CS_TYPE: uint16_t {
 	CMD_GET_ADC_RESTARTS,                             // Get number of ADC restarts.
 	CMD_GET_SWITCH_HISTORY,                           // Get the switch command history.
 	CMD_GET_POWER_SAMPLES,                            // Get power samples of interesting events.
+	CMD_GET_MESH_LINK_QUALITY,                        // Get the link quality table of the mesh.
+	CMD_GET_MESH_TELEMETRY,                           // Get the mesh traffic telemetry.
+	CMD_RESET_MESH_TELEMETRY,                         // Reset the mesh traffic telemetry.
+	CMD_GET_SCAN_PREFILTER_STATS,                     // Get the statistics of the scan prefilter.
+	CMD_GET_SCAN_DUTY_STATS,                          // Get the scan duty and the rate of relevant scanned devices.
+	CMD_GET_EXTERNAL_STATE_STATS,                     // Get the average staleness of the broadcasted states of other stones.
+	CMD_GET_STORAGE_GC_STATS,                         // Get the statistics of the storage garbage collections.
 
 	CMD_MICROAPP_UPLOAD,                              // MicroApp upload (e.g. Arduino code).
 	EVT_MICROAPP,                                     // MicroApp event (e.g. write done)
@@ -439,6 +450,7 @@ typedef  void TYPIFY(EVT_CURRENT_USAGE_ABOVE_THRESHOLD);
 typedef  void TYPIFY(CMD_DEC_CURRENT_RANGE);
 typedef  void TYPIFY(CMD_DEC_VOLTAGE_RANGE);
 typedef  scanned_device_t TYPIFY(EVT_DEVICE_SCANNED);
+typedef  scanned_device_batch_t TYPIFY(EVT_DEVICE_SCANNED_BATCH);
 typedef  void TYPIFY(EVT_DIMMER_ON_FAILURE_DETECTED);
 typedef  void TYPIFY(EVT_DIMMER_OFF_FAILURE_DETECTED);
 typedef  BOOL TYPIFY(CMD_ENABLE_ADC_DIFFERENTIAL_CURRENT);
@@ -515,6 +527,9 @@ typedef cs_mesh_model_msg_sync_request_t TYPIFY(EVT_MESH_SYNC_REQUEST_OUTGOING);
 typedef cs_mesh_model_msg_sync_request_t TYPIFY(EVT_MESH_SYNC_REQUEST_INCOMING);
 typedef void TYPIFY(EVT_MESH_SYNC_FAILED);
 typedef void TYPIFY(EVT_MESH_PAGES_ERASED);
+typedef cs_mesh_bulk_transfer_t TYPIFY(CMD_SEND_MESH_BULK_TRANSFER);
+typedef cs_mesh_bulk_transfer_t TYPIFY(EVT_MESH_BULK_TRANSFER_RECEIVED);
+typedef cs_mesh_bulk_transfer_result_t TYPIFY(EVT_MESH_BULK_TRANSFER_RESULT);
 typedef cs_mesh_model_msg_state_0_t TYPIFY(EVT_MESH_EXT_STATE_0);
 typedef cs_mesh_model_msg_state_1_t TYPIFY(EVT_MESH_EXT_STATE_1);
 typedef uint32_t TYPIFY(CMD_SEND_MESH_MSG_SET_TIME);
@@ -523,6 +538,13 @@ typedef void TYPIFY(CMD_SEND_MESH_MSG_NOOP);
 typedef void TYPIFY(CMD_GET_ADC_RESTARTS);
 typedef void TYPIFY(CMD_GET_SWITCH_HISTORY);
 typedef cs_power_samples_request_t TYPIFY(CMD_GET_POWER_SAMPLES);
+typedef void TYPIFY(CMD_GET_MESH_LINK_QUALITY);
+typedef void TYPIFY(CMD_GET_MESH_TELEMETRY);
+typedef void TYPIFY(CMD_RESET_MESH_TELEMETRY);
+typedef void TYPIFY(CMD_GET_SCAN_PREFILTER_STATS);
+typedef void TYPIFY(CMD_GET_SCAN_DUTY_STATS);
+typedef void TYPIFY(CMD_GET_EXTERNAL_STATE_STATS);
+typedef void TYPIFY(CMD_GET_STORAGE_GC_STATS);
 typedef microapp_upload_packet_t TYPIFY(CMD_MICROAPP_UPLOAD);
 typedef microapp_notification_packet_t TYPIFY(EVT_MICROAPP);
 
@@ -11,6 +11,8 @@
 #include <events/cs_EventListener.h>
 #include <components/libraries/fds/fds.h>
 #include <storage/cs_StateData.h>
+#include <storage/cs_StorageGcPolicy.h>
+#include <storage/cs_StorageRecordIndex.h>
 #include <util/cs_Utils.h>
 
 #include <string>
@@ -39,7 +41,8 @@ typedef void (*cs_storage_error_callback_t) (cs_storage_operation_t operation, C
  *
  * CS_TYPE is used as record key.
  *
- * Garbage collection will be automatically started by this class when needed.
+ * Garbage collection will be automatically started by this class when needed: in the background when the device is
+ * idle, see StorageGcPolicy, or when a write fails due to lack of space.
  *
  * When a record is corrupted, most likely in case of power loss while writing, the CRC check will fail when opening a
  * file. In this case the record will be deleted (TODO).
@@ -48,6 +51,9 @@ typedef void (*cs_storage_error_callback_t) (cs_storage_operation_t operation, C
  * (TODO). Since FDS always appends records, it is assumed that the last valid record should be kept. Checking for
  * duplicates is done for each write and each read.
  *
+ * After init, all records are indexed in a single pass over flash, so that a read is a direct fetch of the record,
+ * instead of a search through all pages. The index is kept up to date with the write and remove events.
+ *
  * Some operations will block other operations. For example, you can't write a record while performing garbage
  * collection. You can't write a record while it's already being written. This is what the "busy" functions are for.
  * Each type can be set busy multiple times, for example in case multiple records of the same type are being deleted.
@@ -275,7 +281,7 @@ public:
 	/**
 	 * Handle Crownstone events.
 	 */
-	void handleEvent(event_t &) {};
+	void handleEvent(event_t & event);
 
 	/**
 	 * Handle FDS events.
@@ -309,6 +315,23 @@ private:
 	bool _performingFactoryReset = false;
 	std::vector<uint16_t> _busyRecordKeys;
 
+	StorageGcPolicy _gcPolicy;
+
+	/**
+	 * Time since boot in ms, based on tick events.
+	 */
+	uint32_t _uptimeMs = 0;
+
+	/**
+	 * Index of the latest record of each record key and file id.
+	 */
+	StorageRecordIndex<fds_record_desc_t> _recordIndex;
+
+	/**
+	 * Whether the record index holds all records, so that a miss in the index means the record does not exist.
+	 */
+	bool _recordIndexValid = false;
+
 	/**
 	 * Next page to erase. Used by eraseAllPages().
 	 */
@@ -336,13 +359,23 @@ private:
 	 *
 	 * Only returns success when data has been copied to buffer.
 	 */
-	cs_ret_code_t readRecord(fds_record_desc_t recordDesc, uint8_t* buf, uint16_t size, uint16_t & fileId);
+	cs_ret_code_t readRecord(fds_record_desc_t & recordDesc, uint8_t* buf, uint16_t size, uint16_t & fileId);
 
 	/** Write to persistent storage.
 	*/
 	ret_code_t writeInternal(const cs_state_data_t & data);
 
-	ret_code_t garbageCollectInternal();
+	ret_code_t garbageCollectInternal(StorageGcReason reason);
+
+	/**
+	 * Get the current flash usage from FDS.
+	 */
+	void getFlashStats(storage_gc_flash_stats_t & stats);
+
+	/**
+	 * Check if garbage collection should be started in the background, and if so, start it.
+	 */
+	void checkGarbageCollection();
 
 	bool isErasingPages();
 
@@ -402,6 +435,11 @@ private:
 	 */
 	ret_code_t exists(cs_file_id_t file_id, uint16_t recordKey, fds_record_desc_t & record_desc, bool & result);
 
+	/**
+	 * Build the record index, by iterating over all records once.
+	 */
+	void buildRecordIndex();
+
 	void setBusy(uint16_t recordKey);
 	void clearBusy(uint16_t recordKey);
 	bool isBusy(uint16_t recordKey);
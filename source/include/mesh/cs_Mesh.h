@@ -11,7 +11,9 @@
 #include <common/cs_Types.h>
 #include <events/cs_EventListener.h>
 #include <mesh/cs_MeshAdvertiser.h>
+#include <mesh/cs_MeshBulkTransfer.h>
 #include <mesh/cs_MeshCore.h>
+#include <mesh/cs_MeshLinkQuality.h>
 #include <mesh/cs_MeshModelMulticast.h>
 #include <mesh/cs_MeshModelMulticastAcked.h>
 #include <mesh/cs_MeshModelUnicast.h>
@@ -19,6 +21,7 @@
 #include <mesh/cs_MeshMsgHandler.h>
 #include <mesh/cs_MeshMsgSender.h>
 #include <mesh/cs_MeshScanner.h>
+#include <mesh/cs_MeshTelemetry.h>
 
 /**
  * Class that manages all mesh classes:
@@ -104,6 +107,9 @@ private:
 	MeshModelMulticastAcked  _modelMulticastAcked;
 	MeshModelUnicast         _modelUnicast;
 	MeshModelSelector        _modelSelector;
+	MeshLinkQuality          _linkQuality;
+	MeshBulkTransfer         _bulkTransfer;
+	MeshTelemetry            _telemetry;
 	MeshMsgHandler           _msgHandler;
 	MeshMsgSender            _msgSender;
 	MeshAdvertiser           _advertiser;
@@ -0,0 +1,166 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <common/cs_Types.h>
+#include <mesh/cs_MeshDefines.h>
+#include <mesh/cs_MeshModelSelector.h>
+#include <protocol/mesh/cs_MeshModelPackets.h>
+
+/**
+ * Class that sends data to a single stone, and receives data from other stones, in chunks.
+ *
+ * Protocol:
+ * - The sender requests an ack, with the unicast model (reliable). This also tells the receiver the size of the data.
+ * - The receiver allocates a buffer, and replies with a cs_mesh_model_msg_bulk_ack_t: which chunks have been received.
+ * - The sender sends the missing chunks of the window, unacked, then requests an ack again.
+ * - When the request times out, or the receiver is busy, the sender waits and requests again.
+ *   Since the ack tells which chunks have been received, the transfer resumes where it was.
+ * - When all chunks are received, the receiver sends out EVT_MESH_BULK_TRANSFER_RECEIVED,
+ *   and the sender sends out EVT_MESH_BULK_TRANSFER_RESULT once it received the ack.
+ *
+ * Only one transfer is sent, and one is received, at a time.
+ */
+class MeshBulkTransfer {
+public:
+	struct cs_mesh_bulk_transfer_stats_t {
+		//! Number of chunks sent, including chunks sent again.
+		uint32_t chunksSent = 0;
+		//! Number of chunks sent again.
+		uint32_t chunksResent = 0;
+		//! Number of acks requested.
+		uint32_t ackRequests = 0;
+		//! Number of ack requests that timed out.
+		uint32_t ackTimeouts = 0;
+	};
+
+	/**
+	 * Init the class.
+	 *
+	 * @param[in] selector         Model selector to send the messages with.
+	 * @param[in] firstTransferId  Transfer ID to start counting from, should be random,
+	 *                             so that a rebooted sender doesn't reuse the IDs of before the reboot.
+	 */
+	void init(MeshModelSelector* selector, uint8_t firstTransferId);
+
+	/**
+	 * Start sending data to a stone.
+	 *
+	 * @param[in] targetId        Stone to send the data to.
+	 * @param[in] type            Type of data, passed on to the receiver.
+	 * @param[in] data            The data, will be copied.
+	 *
+	 * @retval ERR_SUCCESS                 When the transfer started. The result is sent out as EVT_MESH_BULK_TRANSFER_RESULT.
+	 * @retval ERR_BUSY                    When another transfer is being sent.
+	 * @retval ERR_WRONG_PAYLOAD_LENGTH    When the data is empty, or larger than MESH_BULK_TRANSFER_MAX_SIZE.
+	 * @retval ERR_NO_SPACE                When the data could not be copied.
+	 */
+	cs_ret_code_t send(stone_id_t targetId, uint8_t type, cs_data_t data);
+
+	/**
+	 * Whether a transfer is being sent.
+	 */
+	bool isSending();
+
+	/**
+	 * Handle an ack request, and set the ack as result data.
+	 */
+	void handleAckRequest(stone_id_t srcId, uint8_t* payload, size16_t payloadSize, cs_result_t& result);
+
+	/**
+	 * Handle a received chunk.
+	 */
+	cs_ret_code_t handleChunk(stone_id_t srcId, uint8_t* payload, size16_t payloadSize);
+
+	/**
+	 * Handle the reply to an ack request.
+	 */
+	void handleAck(stone_id_t srcId, cs_ret_code_t retCode, cs_data_t resultData);
+
+	/**
+	 * To be called every tick.
+	 */
+	void tick(uint32_t tickCount);
+
+	cs_mesh_bulk_transfer_stats_t& getStats();
+
+private:
+	enum SendState {
+		SEND_STATE_IDLE,
+		//! Ack request has to be queued.
+		SEND_STATE_REQUEST,
+		//! Ack request is queued, waiting for the reply.
+		SEND_STATE_WAIT_FOR_ACK,
+		//! Sending chunks of the window.
+		SEND_STATE_SEND_CHUNKS,
+		//! Waiting before requesting an ack again.
+		SEND_STATE_WAIT_FOR_RETRY,
+	};
+
+	MeshModelSelector* _selector = nullptr;
+
+	/*
+	 * Sender state.
+	 */
+	SendState _sendState = SEND_STATE_IDLE;
+	uint8_t* _sendBuf = nullptr;
+	cs_mesh_bulk_transfer_result_t _sendInfo;
+	size16_t _sendSize = 0;
+	uint8_t _sendNumChunks = 0;
+	uint8_t _sendTransferId = 0;
+	uint16_t _sendChecksum = 0;
+	uint8_t _sendSeq = 0;
+	//! All chunks before this index have been acked.
+	uint8_t _sendAckedIndex = 0;
+	//! Bit i is set when chunk _sendAckedIndex + i has been acked.
+	uint32_t _sendAckedBitmask = 0;
+	//! Next chunk index to send, within the window.
+	uint8_t _sendIndex = 0;
+	//! All chunks before this index have been sent at least once.
+	uint8_t _sendHighestIndex = 0;
+	uint8_t _sendRetries = 0;
+	//! Ticks left in the current wait state.
+	uint32_t _sendWaitTicks = 0;
+
+	/*
+	 * Receiver state.
+	 */
+	uint8_t* _recvBuf = nullptr;
+	cs_mesh_model_msg_bulk_ack_request_t _recvInfo;
+	stone_id_t _recvSrcId = 0;
+	uint8_t _recvNumChunks = 0;
+	uint8_t _recvNumReceived = 0;
+	uint8_t _recvReceivedBitmask[(MESH_BULK_TRANSFER_MAX_SIZE / MESH_BULK_TRANSFER_CHUNK_SIZE + 1 + 7) / 8];
+	uint32_t _recvTimeoutTicks = 0;
+	//! The last completed transfer, so that repeated ack requests for it can still be answered.
+	stone_id_t _recvDoneSrcId = 0;
+	cs_mesh_model_msg_bulk_ack_request_t _recvDoneInfo;
+	uint8_t _recvDoneNumChunks = 0;
+	//! Ticks left before the last completed transfer is forgotten.
+	uint32_t _recvDoneTimeoutTicks = 0;
+
+	cs_mesh_bulk_transfer_stats_t _stats;
+
+	static uint8_t getNumChunks(size16_t size);
+	static uint16_t getChecksum(const uint8_t* data, size16_t size);
+
+	/**
+	 * Whether two ack requests are of the same transfer: same ID, type, size, and checksum.
+	 */
+	static bool isSameTransfer(const cs_mesh_model_msg_bulk_ack_request_t& request1, const cs_mesh_model_msg_bulk_ack_request_t& request2);
+
+	void sendTick();
+	bool sendAckRequest();
+	void sendChunks();
+	void retry();
+	void finishSend(cs_ret_code_t retCode);
+
+	bool isReceived(uint8_t index);
+	void finishReceive();
+	void clearReceive();
+};
@@ -31,10 +31,13 @@ struct __attribute__((__packed__)) cs_mesh_queue_item_meta_data_t {
 //	stone_id_t targetId = 0;   // 0 for broadcast
 	uint8_t transmissionsOrTimeout : 6; // Timeout in seconds when reliable, else number of transmissions.
 	bool priority : 1;
+	bool sent : 1; // Whether the item has been sent at least once, set by the model.
+	uint16_t queuedTick = 0; // Tick at which the item was queued, set by the model.
 
 	cs_mesh_queue_item_meta_data_t():
 		transmissionsOrTimeout(0),
-		priority(false)
+		priority(false),
+		sent(false)
 	{}
 };
 
@@ -41,6 +41,9 @@ public:
 	/** Callback function definition. */
 	typedef function<void(const nrf_mesh_adv_packet_rx_data_t *scanData)> callback_scan_t;
 
+	/** Callback function definition. */
+	typedef function<bool(uint16_t srcAddress, uint16_t dstAddress, uint8_t ttl)> callback_relay_t;
+
 	/**
 	 * Register a callback function that's called when the models should be initialized.
 	 */
@@ -56,6 +59,14 @@ public:
 	 */
 	void registerScanCallback(const callback_scan_t& closure);
 
+	/**
+	 * Register a callback function that's called when a packet could be relayed, optional.
+	 *
+	 * The callback returns whether the packet should be relayed.
+	 * Without callback, all packets are relayed.
+	 */
+	void registerRelayCallback(const callback_relay_t& closure);
+
 	/**
 	 * Whether flash pages have valid data.
 	 *
@@ -110,6 +121,9 @@ public:
 	/** Internal usage */
 	void scanCallback(const nrf_mesh_adv_packet_rx_data_t *scanData);
 
+	/** Internal usage */
+	bool relayCallback(uint16_t srcAddress, uint16_t dstAddress, uint8_t ttl);
+
 private:
 	//! Constructor, singleton, thus made private
 	MeshCore();
@@ -124,6 +138,7 @@ private:
 	callback_scan_t _scanCallback = nullptr;
 	callback_model_init_t _modelInitCallback = nullptr;
 	callback_model_configure_t _modelConfigureCallback = nullptr;
+	callback_relay_t _relayCallback = nullptr;
 
 	// Keys
 	uint8_t _netkey[NRF_MESH_KEY_SIZE];
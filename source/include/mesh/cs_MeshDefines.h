@@ -42,6 +42,204 @@
  */
 #define MESH_MODEL_ACK_TRANSMISSIONS 1
 
+/**
+ * Number of messages that can be queued by the multicast acked model.
+ */
+#ifndef MESH_MODEL_MULTICAST_ACKED_QUEUE_SIZE
+#define MESH_MODEL_MULTICAST_ACKED_QUEUE_SIZE 5
+#endif
+
+/**
+ * Number of messages of the multicast acked model that can wait for acks at the same time.
+ */
+#ifndef MESH_MODEL_MULTICAST_ACKED_MAX_IN_FLIGHT
+#define MESH_MODEL_MULTICAST_ACKED_MAX_IN_FLIGHT 3
+#endif
+
+/**
+ * Number of messages that can be queued by the multicast model.
+ * Can be raised for stones that relay a lot, like gateways.
+ */
+#ifndef MESH_MODEL_MULTICAST_QUEUE_SIZE
+#define MESH_MODEL_MULTICAST_QUEUE_SIZE 20
+#endif
+
+/**
+ * Whether small multicast messages are packed together in aggregate messages.
+ * Firmware without support for aggregate messages drops them, so this is disabled by default:
+ * only enable it when all stones in the mesh run firmware that handles aggregate messages.
+ * Aggregate messages are always handled when received.
+ */
+#ifndef MESH_MODEL_AGGREGATION
+#define MESH_MODEL_AGGREGATION 0
+#endif
+
+/**
+ * Number of small messages that can wait to be aggregated.
+ */
+#define MESH_MODEL_AGGREGATION_MAX_PENDING 8
+
+/**
+ * Max time a small message without priority waits to be aggregated.
+ * Messages with priority wait at most 1 tick.
+ * Should be a multiple of TICK_INTERVAL_MS.
+ */
+#define MESH_MODEL_AGGREGATION_DELAY_MS 500
+
+/**
+ * Number of received messages kept up to recognize retransmissions.
+ * Should be a multiple of MESH_MSG_DEDUP_CACHE_WAYS.
+ *
+ * Sized for a mesh of 150 stones that each have a message in flight, at 13 bytes per entry.
+ * Smaller meshes can save RAM by overriding this at build time.
+ */
+#ifndef MESH_MSG_DEDUP_CACHE_SIZE
+#define MESH_MSG_DEDUP_CACHE_SIZE 256
+#endif
+
+/**
+ * Number of entries a received message can be stored at in the dedup cache.
+ */
+#ifndef MESH_MSG_DEDUP_CACHE_WAYS
+#define MESH_MSG_DEDUP_CACHE_WAYS 16
+#endif
+
+/**
+ * Time after which a received message is no longer considered a retransmission.
+ * An identical message received after this time is handled again.
+ * Should be a multiple of TICK_INTERVAL_MS.
+ */
+#define MESH_MSG_DEDUP_TIMEOUT_MS 5000
+
+/**
+ * Interval at which the dedup cache statistics are logged.
+ */
+#define MESH_MSG_DEDUP_LOG_INTERVAL_MS (60 * 60 * 1000)
+
+/**
+ * Number of neighbours kept up in the link quality table.
+ */
+#ifndef MESH_LINK_QUALITY_TABLE_SIZE
+#define MESH_LINK_QUALITY_TABLE_SIZE 16
+#endif
+
+/**
+ * Weight of a new sample in the moving averages of the link quality table, as a power of 2.
+ * A value of 3 means a new sample has a weight of 1/8.
+ */
+#define MESH_LINK_QUALITY_EWMA_SHIFT 3
+
+/**
+ * Time after which a neighbour that has not been heard directly is removed from the link quality table.
+ * Should be a multiple of 1000.
+ */
+#define MESH_LINK_QUALITY_TIMEOUT_MS (10 * 60 * 1000)
+
+/**
+ * A neighbour is considered a good link when both its average RSSI and reception rate are at least this value.
+ */
+#define MESH_LINK_QUALITY_GOOD_RSSI -80
+#define MESH_LINK_QUALITY_GOOD_RECEPTION_RATE_PERCENTAGE 70
+
+/**
+ * With at least this many good links, the stone is in a dense part of the mesh,
+ * and the default number of transmissions is halved.
+ */
+#define MESH_LINK_QUALITY_DENSE_NEIGHBOURS 6
+
+/**
+ * With less than this many good links, the stone is at the edge of the mesh,
+ * and the default number of transmissions is raised.
+ */
+#define MESH_LINK_QUALITY_SPARSE_NEIGHBOURS 3
+
+/**
+ * Whether the default number of transmissions of multicast messages adapts to the link quality.
+ */
+#ifndef MESH_LINK_QUALITY_ADAPTIVE_TRANSMISSIONS
+#define MESH_LINK_QUALITY_ADAPTIVE_TRANSMISSIONS 1
+#endif
+
+/**
+ * Whether this stone skips relaying some of the mesh packets when it has many good links.
+ * Without it, every stone relays every packet, as the mesh SDK does by default.
+ */
+#ifndef MESH_RELAY_SUPPRESSION
+#define MESH_RELAY_SUPPRESSION 0
+#endif
+
+/**
+ * With relay suppression, relays are only skipped with at least this many good links.
+ */
+#define MESH_RELAY_SUPPRESSION_MIN_NEIGHBOURS 4
+
+/**
+ * With relay suppression, the expected number of good neighbours that relay a packet.
+ * Each stone relays a packet with a probability of this value divided by its number of good links.
+ */
+#define MESH_RELAY_SUPPRESSION_RELAYERS 3
+
+/**
+ * With relay suppression, the minimum probability to relay a packet.
+ */
+#define MESH_RELAY_SUPPRESSION_MIN_PERCENTAGE 25
+
+/**
+ * Max size of the data of a bulk transfer.
+ * This is also the max size of the reassembly buffer of the receiver.
+ */
+#ifndef MESH_BULK_TRANSFER_MAX_SIZE
+#define MESH_BULK_TRANSFER_MAX_SIZE 1024
+#endif
+
+/**
+ * Size of the data in each chunk of a bulk transfer.
+ * Chunks are sent as segmented messages.
+ */
+#define MESH_BULK_TRANSFER_CHUNK_SIZE (MAX_MESH_MSG_SIZE - MESH_HEADER_SIZE - sizeof(cs_mesh_model_msg_bulk_chunk_header_t))
+
+/**
+ * Max number of chunks that are sent before an ack is requested.
+ * Can be at most 8 * MESH_BULK_ACK_BITMASK_SIZE.
+ */
+#ifndef MESH_BULK_TRANSFER_WINDOW_SIZE
+#define MESH_BULK_TRANSFER_WINDOW_SIZE 8
+#endif
+
+/**
+ * Max number of chunks sent per tick.
+ */
+#define MESH_BULK_TRANSFER_CHUNKS_PER_TICK 1
+
+/**
+ * Timeout in seconds of the reliable msg that requests an ack.
+ */
+#define MESH_BULK_TRANSFER_ACK_TIMEOUT_S 4
+
+/**
+ * Time to wait before requesting an ack again, after a timeout or when the receiver is busy.
+ * Doubles after each retry.
+ */
+#define MESH_BULK_TRANSFER_RETRY_DELAY_MS 1000
+
+/**
+ * Number of times an ack is requested again, before the transfer fails.
+ */
+#define MESH_BULK_TRANSFER_MAX_RETRIES 4
+
+/**
+ * Time after which the receiver drops an incomplete transfer that made no progress.
+ */
+#define MESH_BULK_TRANSFER_RECEIVE_TIMEOUT_MS (60 * 1000)
+
+/**
+ * Interval at which the mesh telemetry is written to UART, 0 to disable.
+ * Should be a multiple of TICK_INTERVAL_MS.
+ */
+#ifndef MESH_TELEMETRY_UART_INTERVAL_MS
+#define MESH_TELEMETRY_UART_INTERVAL_MS (60 * 1000)
+#endif
+
 /**
  * Number of messages sent each time processQueue() gets called.
  */
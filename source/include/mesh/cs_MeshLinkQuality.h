@@ -0,0 +1,134 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <mesh/cs_MeshDefines.h>
+#include <protocol/cs_Packets.h>
+#include <structs/cs_PacketsInternal.h>
+
+/**
+ * Table with the quality of the links to neighbouring stones, and the policy
+ * that picks the number of transmissions of multicast messages based on it.
+ *
+ * For each neighbour, keeps up a moving average of:
+ * - The RSSI of messages received directly from it.
+ * - The reception rate: the fraction of its messages that were received directly.
+ *   The mesh only passes on the first copy of a message, so a message of a neighbour
+ *   that arrives via hops means that the direct transmission was missed.
+ *
+ * A stone with many good links is in a dense part of the mesh, where each message is
+ * relayed by many stones, so fewer transmissions suffice. A stone with few good links
+ * is at the edge of the mesh, where each message depends on a single link.
+ *
+ * The same goes for relaying: the mesh SDK only relays the first copy of a packet, and can't
+ * wait to count how many neighbours relayed it already. Instead, a stone with many good links
+ * assumes most of its neighbours received the packet as well, and relays it with a probability
+ * such that on average MESH_RELAY_SUPPRESSION_RELAYERS of its neighbours relay it.
+ */
+class MeshLinkQuality {
+public:
+	MeshLinkQuality();
+
+	/**
+	 * Update the table with a received message.
+	 *
+	 * @param[in] srcId           Stone ID of the source of the message.
+	 * @param[in] rssi            RSSI of the message.
+	 * @param[in] hops            Number of hops the message made, 0 when received directly.
+	 */
+	void onReceived(stone_id_t srcId, int8_t rssi, uint8_t hops);
+
+	/**
+	 * To be called every tick.
+	 */
+	void tick(uint32_t tickCount);
+
+	/**
+	 * Get the number of neighbours with a good link.
+	 */
+	uint8_t getNumGoodLinks();
+
+	/**
+	 * Get the number of transmissions to use for a message, instead of the default of its type.
+	 *
+	 * - With MESH_LINK_QUALITY_DENSE_NEIGHBOURS or more good links, the default is halved, rounded up.
+	 * - With less than MESH_LINK_QUALITY_SPARSE_NEIGHBOURS good links, the default is raised by 1, or by 2 without any good link.
+	 * - As long as no neighbour has been heard, the default is used.
+	 */
+	uint8_t getTransmissions(uint8_t defaultTransmissions);
+
+	/**
+	 * Enable or disable the adaptive number of transmissions.
+	 * When disabled, getTransmissions() returns the default.
+	 */
+	void setAdaptive(bool enable);
+
+	/**
+	 * Get the probability, in percentage, that a packet is relayed.
+	 *
+	 * - Without relay suppression, or with less than MESH_RELAY_SUPPRESSION_MIN_NEIGHBOURS good links, it's 100.
+	 * - Else it's MESH_RELAY_SUPPRESSION_RELAYERS divided by the number of good links,
+	 *   but at least MESH_RELAY_SUPPRESSION_MIN_PERCENTAGE.
+	 */
+	uint8_t getRelayPercentage();
+
+	/**
+	 * Whether a received packet should be relayed.
+	 *
+	 * Packets that were received directly from a source without a good link are always relayed,
+	 * as other neighbours are unlikely to have received them.
+	 *
+	 * @param[in] srcId           Stone ID of the source of the packet.
+	 * @param[in] hops            Number of hops the packet made, 0 when received directly.
+	 * @param[in] random          Random number, used to decide on the relay probability.
+	 */
+	bool shouldRelay(stone_id_t srcId, uint8_t hops, uint8_t random);
+
+	/**
+	 * Enable or disable relay suppression.
+	 * When disabled, shouldRelay() always returns true.
+	 */
+	void setRelaySuppression(bool enable);
+
+	/**
+	 * Write the table to the result buffer: a cs_mesh_link_quality_header_t, followed by a cs_mesh_link_quality_item_t per neighbour.
+	 */
+	void getTable(cs_result_t& result);
+
+	/**
+	 * Forget all neighbours.
+	 */
+	void clear();
+
+private:
+	struct cs_mesh_link_quality_entry_t {
+		//! Moving average of the RSSI, multiplied by 16.
+		int16_t rssi;
+		//! Moving average of the reception rate, where 0xFFFF is 100%.
+		uint16_t receptionRate;
+		//! Seconds since last direct reception.
+		uint16_t lastSeenSeconds;
+		//! 0 when the entry is not in use.
+		stone_id_t stoneId;
+	};
+
+	cs_mesh_link_quality_entry_t _entries[MESH_LINK_QUALITY_TABLE_SIZE];
+
+	bool _adaptive = (MESH_LINK_QUALITY_ADAPTIVE_TRANSMISSIONS == 1);
+
+	bool _relaySuppression = (MESH_RELAY_SUPPRESSION == 1);
+
+	cs_mesh_link_quality_entry_t* find(stone_id_t stoneId);
+
+	/**
+	 * Get an entry for a new neighbour: a free one, or else the one not heard of for the longest time.
+	 */
+	cs_mesh_link_quality_entry_t* getFreeEntry();
+
+	bool isGoodLink(const cs_mesh_link_quality_entry_t& entry);
+};
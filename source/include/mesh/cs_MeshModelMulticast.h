@@ -8,7 +8,9 @@
 #pragma once
 
 #include <mesh/cs_MeshCommon.h>
+#include <mesh/cs_MeshTelemetry.h>
 #include <third/std/function.h>
+#include <util/cs_ReadySet.h>
 
 extern "C" {
 #include <access.h>
@@ -35,6 +37,11 @@ public:
 	 */
 	void init(uint16_t modelId);
 
+	/**
+	 * Set the telemetry that counts the traffic of this model, optional.
+	 */
+	void setTelemetry(MeshTelemetry* telemetry);
+
 	/**
 	 * Configure the model.
 	 *
@@ -43,7 +50,7 @@ public:
 	void configureSelf(dsm_handle_t appkeyHandle);
 
 	/**
-	 * Add a msg to an empty spot in the queue (transmissions == 0).
+	 * Add a msg to an empty spot in the queue.
 	 * Start looking at SendIndex, then reverse iterate over the queue.
 	 * Then set the new SendIndex at the newly added item, so that it will be send first.
 	 * We do the reverse iterate, so that the old SendIndex should be handled early (for a large enough queue).
@@ -55,6 +62,11 @@ public:
 	 */
 	cs_ret_code_t remFromQueue(cs_mesh_model_msg_type_t type, uint16_t id);
 
+	/**
+	 * Get the number of messages in the queue.
+	 */
+	uint8_t getNumQueued();
+
 	/**
 	 * To be called at a regular interval.
 	 */
@@ -64,7 +76,7 @@ public:
 	void handleMsg(const access_message_rx_t * accessMsg);
 
 private:
-	const static uint8_t _queueSize = 20;
+	const static uint16_t _queueSize = MESH_MODEL_MULTICAST_QUEUE_SIZE;
 
 	struct __attribute__((__packed__)) cs_multicast_queue_item_t {
 		MeshUtil::cs_mesh_queue_item_meta_data_t metaData;
@@ -78,25 +90,24 @@ private:
 
 	callback_msg_t _msgCallback = nullptr;
 
+	MeshTelemetry* _telemetry = nullptr;
+
 	cs_multicast_queue_item_t _queue[_queueSize];
 
 	/**
-	 * Next index in queue to send.
+	 * Keeps up which items in the queue have transmissions left, and which of them have priority.
 	 */
-	uint8_t _queueIndexNext = 0;
+	ReadySet<_queueSize> _readySet;
 
 	/**
-	 * Send messages from queue.
+	 * Next index in queue to send.
 	 */
-	void processQueue();
+	uint16_t _queueIndexNext = 0;
 
 	/**
-	 * Check if there is a msg in queue with more than 0 transmissions.
-	 * If so, return that index.
-	 * Start looking at index SendIndex as that item should be sent first.
-	 * Returns -1 if none found.
+	 * Send messages from queue.
 	 */
-	int getNextItemInQueue(bool priority);
+	void processQueue();
 
 	/**
 	 * Get a msg from the queue, and send it.
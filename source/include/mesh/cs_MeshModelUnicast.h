@@ -8,6 +8,7 @@
 #pragma once
 
 #include <mesh/cs_MeshCommon.h>
+#include <mesh/cs_MeshTelemetry.h>
 #include <protocol/mesh/cs_MeshModelPackets.h>
 #include <third/std/function.h>
 
@@ -21,6 +22,7 @@ extern "C" {
  * - Uses reliable segmented messages for this.
  * - Queues messages to be sent.
  * - Handles queue 1 by 1.
+ * - Sends targeted unacked messages, without queue.
  */
 class MeshModelUnicast {
 public:
@@ -37,6 +39,11 @@ public:
 	 */
 	void init(uint16_t modelId);
 
+	/**
+	 * Set the telemetry that counts the traffic of this model, optional.
+	 */
+	void setTelemetry(MeshTelemetry* telemetry);
+
 	/**
 	 * Configure the model.
 	 *
@@ -49,11 +56,23 @@ public:
 	 */
 	cs_ret_code_t addToQueue(MeshUtil::cs_mesh_queue_item_t& item);
 
+	/**
+	 * Send an unacked msg to a single stone right away.
+	 *
+	 * @retval ERR_BUSY           When an acked msg to another stone is in progress, or the mesh has no space.
+	 */
+	cs_ret_code_t sendUnacked(MeshUtil::cs_mesh_queue_item_t& item);
+
 	/**
 	 * Remove a msg from the queue.
 	 */
 	cs_ret_code_t remFromQueue(cs_mesh_model_msg_type_t type, uint16_t id);
 
+	/**
+	 * Get the number of messages in the queue.
+	 */
+	uint8_t getNumQueued();
+
 	/**
 	 * To be called at a regular interval.
 	 */
@@ -83,6 +102,8 @@ private:
 
 	callback_msg_t _msgCallback = nullptr;
 
+	MeshTelemetry* _telemetry = nullptr;
+
 	access_reliable_t _accessReliableMsg;
 
 #if MESH_MODEL_TEST_MSG == 2
@@ -0,0 +1,122 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <mesh/cs_MeshCommon.h>
+#include <protocol/mesh/cs_MeshModelPackets.h>
+
+/**
+ * Max payload size of an aggregate message: a non segmented message.
+ */
+#define MESH_MODEL_AGGREGATE_PAYLOAD_SIZE (MAX_MESH_MSG_NON_SEGMENTED_SIZE - MESH_HEADER_SIZE)
+
+/**
+ * Max payload size of a message that can be aggregated.
+ */
+#define MESH_MODEL_AGGREGATE_MAX_ENTRY_SIZE (MESH_MODEL_AGGREGATE_PAYLOAD_SIZE - sizeof(cs_mesh_model_msg_aggregate_entry_header_t))
+
+/**
+ * Class that packs small multicast messages together.
+ *
+ * Messages are kept pending until they are ready to be sent, see isReady(). Pending messages
+ * with the same number of transmissions and priority are packed into one aggregate message,
+ * so that they share the transmissions.
+ * A message that can't be combined with another is given back as is, so when
+ * there is little traffic, nothing changes for receivers.
+ */
+class MeshMsgAggregator {
+public:
+	/**
+	 * Whether an item can be aggregated: a small unreliable broadcast.
+	 */
+	static bool isAggregatable(const MeshUtil::cs_mesh_queue_item_t& item);
+
+	/**
+	 * Add an item, replaces a pending item with the same type and id.
+	 *
+	 * Item is copied.
+	 *
+	 * @retval ERR_SUCCESS                  When added.
+	 * @retval ERR_WRONG_PARAMETER          When the item can't be aggregated.
+	 * @retval ERR_BUSY                     When there is no space left.
+	 */
+	cs_ret_code_t add(const MeshUtil::cs_mesh_queue_item_t& item);
+
+	/**
+	 * Remove pending items with the same type and id.
+	 *
+	 * @return                              True when an item was removed.
+	 */
+	bool remove(const MeshUtil::cs_mesh_queue_item_meta_data_t& metaData);
+
+	/**
+	 * To be called every tick.
+	 */
+	void tick();
+
+	/**
+	 * Whether the pending items should be sent now.
+	 *
+	 * That's the case when an item has priority, an item waited long enough, or when
+	 * there are enough items to fill an aggregate message.
+	 */
+	bool isReady();
+
+	/**
+	 * Pack pending items into the next message to send.
+	 *
+	 * The packed items stay pending until removeNext() is called, so that they can be retried
+	 * when the message could not be queued.
+	 *
+	 * @param[out] item                     Item to send. The payload is only valid until the next call.
+	 * @return                              True when an item was set, false when nothing is pending.
+	 */
+	bool getNext(MeshUtil::cs_mesh_queue_item_t& item);
+
+	/**
+	 * Remove the items that were packed by the last call to getNext().
+	 *
+	 * Does nothing when items were added or removed since that call.
+	 */
+	void removeNext();
+
+	uint8_t getNumPending() {
+		return _numPending;
+	}
+
+private:
+	struct __attribute__((__packed__)) cs_mesh_aggregator_item_t {
+		MeshUtil::cs_mesh_queue_item_meta_data_t metaData;
+		uint8_t size;
+		uint8_t payload[MESH_MODEL_AGGREGATE_MAX_ENTRY_SIZE];
+	};
+
+	cs_mesh_aggregator_item_t _pending[MESH_MODEL_AGGREGATION_MAX_PENDING];
+
+	uint8_t _numPending = 0;
+
+	/**
+	 * Number of ticks the oldest pending item has been waiting.
+	 */
+	uint8_t _waitedTicks = 0;
+
+	/**
+	 * Buffer for the payload of the item returned by getNext().
+	 */
+	uint8_t _payload[MESH_MODEL_AGGREGATE_PAYLOAD_SIZE];
+
+	/**
+	 * Which pending items were packed by the last call to getNext(), and how many.
+	 */
+	bool _nextSelected[MESH_MODEL_AGGREGATION_MAX_PENDING] = {false};
+	uint8_t _numNext = 0;
+
+	void removeIndex(uint8_t index);
+
+	void clearNext();
+};
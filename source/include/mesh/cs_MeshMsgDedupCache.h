@@ -0,0 +1,80 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <mesh/cs_MeshDefines.h>
+#include <protocol/cs_Typedefs.h>
+
+#include <cstdint>
+
+/**
+ * Cache of recently received mesh messages, to recognize retransmissions.
+ *
+ * Messages are keyed by source address, type, and a hash of the payload.
+ * A message that is identical to one received less than MESH_MSG_DEDUP_TIMEOUT_MS ago,
+ * is considered a retransmission. The time of the first reception counts, so
+ * a message that is sent over and over is still handled once every timeout.
+ *
+ * The cache is set associative: a message can only be stored at MESH_MSG_DEDUP_CACHE_WAYS entries.
+ * When they are all in use, the oldest is overwritten. So a retransmission may be missed, but a
+ * new message is never considered a retransmission (apart from hash collisions).
+ */
+class MeshMsgDedupCache {
+public:
+	MeshMsgDedupCache();
+
+	/**
+	 * Check if a message was received recently, and if not, remember it.
+	 *
+	 * @param[in] srcAddress      Source address of the message.
+	 * @param[in] type            Mesh msg type.
+	 * @param[in] payload         Payload of the message.
+	 * @param[in] payloadSize     Size of the payload.
+	 * @return                    True when the message is a retransmission.
+	 */
+	bool isDuplicate(uint16_t srcAddress, uint8_t type, const uint8_t* payload, size16_t payloadSize);
+
+	/**
+	 * To be called every tick.
+	 */
+	void tick();
+
+	/**
+	 * Forget all messages.
+	 */
+	void clear();
+
+	uint32_t getHits() {
+		return _hits;
+	}
+
+	uint32_t getMisses() {
+		return _misses;
+	}
+
+private:
+	struct __attribute__((__packed__)) cs_mesh_dedup_entry_t {
+		uint32_t payloadHash;
+		uint32_t receivedTick;
+		uint16_t srcAddress;
+		uint8_t type;
+		uint8_t payloadSize;
+		bool valid;
+	};
+
+	static const uint16_t NUM_SETS = MESH_MSG_DEDUP_CACHE_SIZE / MESH_MSG_DEDUP_CACHE_WAYS;
+
+	cs_mesh_dedup_entry_t _entries[MESH_MSG_DEDUP_CACHE_SIZE];
+
+	uint32_t _tickCount = 0;
+
+	uint32_t _hits = 0;
+	uint32_t _misses = 0;
+
+	bool isExpired(const cs_mesh_dedup_entry_t& entry);
+};
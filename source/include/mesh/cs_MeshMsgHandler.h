@@ -8,18 +8,34 @@
 #pragma once
 
 #include <common/cs_Types.h>
+#include <mesh/cs_MeshBulkTransfer.h>
+#include <mesh/cs_MeshLinkQuality.h>
+#include <mesh/cs_MeshMsgDedupCache.h>
 #include <protocol/cs_UartMsgTypes.h>
 
 /**
  * Class that:
  * - Handles received messages from the mesh.
+ * - Ignores retransmissions, see MeshMsgDedupCache.
+ * - Keeps up the link quality to neighbours, see MeshLinkQuality.
+ * - Passes bulk transfer messages and acks on, see MeshBulkTransfer.
  */
 class MeshMsgHandler {
 public:
-	void init();
+	void init(MeshLinkQuality* linkQuality, MeshBulkTransfer* bulkTransfer = nullptr);
 	void handleMsg(const MeshUtil::cs_mesh_received_msg_t& msg, cs_result_t& result);
 
+	/**
+	 * To be called every tick.
+	 */
+	void tick(uint32_t tickCount);
+
 protected:
+	/**
+	 * Handle a valid message, without checking for retransmissions.
+	 */
+	void dispatchMsg(const MeshUtil::cs_mesh_received_msg_t& msg, cs_result_t& result);
+
 	cs_ret_code_t handleTest(                 uint8_t* payload, size16_t payloadSize);
 	cs_ret_code_t handleAck(                  uint8_t* payload, size16_t payloadSize);
 	cs_ret_code_t handleStateTime(            uint8_t* payload, size16_t payloadSize);
@@ -37,10 +53,17 @@ protected:
 	void handleStateSet(                      uint8_t* payload, size16_t payloadSize, cs_result_t& result);
 	cs_ret_code_t handleResult(               uint8_t* payload, size16_t payloadSize, stone_id_t srcId);
 	cs_ret_code_t handleSetIbeaconConfigId(   uint8_t* payload, size16_t payloadSize);
+	cs_ret_code_t handleAggregate(            const MeshUtil::cs_mesh_received_msg_t& msg, uint8_t* payload, size16_t payloadSize);
 
 private:
 	TYPIFY(CONFIG_CROWNSTONE_ID) _ownId = 0;
 
+	MeshMsgDedupCache _dedupCache;
+
+	MeshLinkQuality* _linkQuality = nullptr;
+
+	MeshBulkTransfer* _bulkTransfer = nullptr;
+
 	struct cs_mesh_model_ext_state_t {
 		stone_id_t srcId = 0;
 		uint8_t partsReceivedBitmask = 0;
@@ -9,12 +9,16 @@
 
 #include <common/cs_Types.h>
 #include <events/cs_EventListener.h>
+#include <mesh/cs_MeshLinkQuality.h>
 #include <mesh/cs_MeshModelSelector.h>
+#include <mesh/cs_MeshMsgAggregator.h>
 #include <protocol/mesh/cs_MeshModelPackets.h>
 
 /**
  * Class that:
  * - Sends messages to the mesh.
+ * - Packs small messages together, see MeshMsgAggregator.
+ * - Adapts the default number of transmissions to the link quality, see MeshLinkQuality.
  */
 class MeshMsgSender: public EventListener {
 public:
@@ -26,7 +30,7 @@ public:
 //
 //	void registerAddCallback(const callback_add_t& closure);
 //	void registerRemCallback(const callback_rem_t& closure);
-	void init(MeshModelSelector* selector);
+	void init(MeshModelSelector* selector, MeshLinkQuality* linkQuality = nullptr);
 
 	cs_ret_code_t sendMsg(cs_mesh_msg_t *meshMsg);
 	cs_ret_code_t sendTestMsg();
@@ -47,13 +51,29 @@ private:
 //	callback_add_t _addCallback;
 //	callback_rem_t _remCallback;
 	MeshModelSelector* _selector;
+	MeshLinkQuality* _linkQuality = nullptr;
+
+#if MESH_MODEL_AGGREGATION == 1
+	MeshMsgAggregator _aggregator;
+#endif
 
 #if MESH_MODEL_TEST_MSG != 0
 	uint32_t _nextSendCounter = 1;
 #endif
 
+	/**
+	 * Get the number of transmissions of a message that has no number of transmissions set.
+	 */
+	uint8_t getDefaultTransmissions(cs_mesh_msg_reliability reliability);
+
 	cs_ret_code_t handleSendMeshCommand(mesh_control_command_packet_t* command, const cmd_source_with_counter_t& source);
 
 	cs_ret_code_t addToQueue(MeshUtil::cs_mesh_queue_item_t & item);
 	cs_ret_code_t remFromQueue(MeshUtil::cs_mesh_queue_item_t & item);
+
+	/**
+	 * Add all messages pending in the aggregator to the queue, when they are ready to be sent.
+	 * Messages that can't be queued stay in the aggregator, and are retried next tick.
+	 */
+	void flushAggregator();
 };
@@ -0,0 +1,153 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <mesh/cs_MeshCommon.h>
+#include <util/cs_BitmaskVarSize.h>
+
+/**
+ * Queue of the multicast acked model, without dependencies on the mesh SDK.
+ *
+ * Several items can be in flight at the same time, each with their own acks and timeout.
+ * Since a reply only contains the message type it's a result of, items of the same type
+ * can only be in flight at the same time when they have no stone IDs in common.
+ * That way, each reply belongs to exactly one item in flight.
+ */
+class MeshMulticastAckedQueue {
+public:
+	const static uint8_t QUEUE_SIZE = MESH_MODEL_MULTICAST_ACKED_QUEUE_SIZE;
+
+	struct cs_multicast_acked_queue_item_t {
+		MeshUtil::cs_mesh_queue_item_meta_data_t metaData;
+		uint8_t numIds = 0;
+		stone_id_t* stoneIdsPtr = nullptr;
+
+		uint8_t msgSize = 0;
+		uint8_t* msgPtr = nullptr;
+
+		//! Whether this item has been sent, and is waiting for acks.
+		bool inProgress = false;
+
+		//! Number of retries left until timeout.
+		uint16_t retriesLeft = 0;
+
+		/**
+		 * Bitmask of acked stones.
+		 * If the Nth bit is set, the ack of Nth stone ID in the list has been received.
+		 */
+		BitmaskVarSize ackedStonesBitmask;
+	};
+
+	~MeshMulticastAckedQueue();
+
+	/**
+	 * Set own stone ID, which is marked as acked right away.
+	 */
+	void setOwnStoneId(stone_id_t stoneId);
+
+	/**
+	 * Set the max number of items in flight.
+	 */
+	void setMaxInFlight(uint8_t maxInFlight);
+
+	/**
+	 * Add an item to the queue.
+	 *
+	 * Message and stone IDs are copied.
+	 *
+	 * @retval ERR_SUCCESS                  When added.
+	 * @retval ERR_BUSY                     When the queue is full.
+	 * @retval ERR_NO_SPACE                 When out of memory.
+	 */
+	cs_ret_code_t add(const MeshUtil::cs_mesh_queue_item_t& item);
+
+	/**
+	 * Remove all items with given type and id.
+	 *
+	 * @retval ERR_SUCCESS                  When removed.
+	 * @retval ERR_NOT_FOUND                When no such item.
+	 */
+	cs_ret_code_t remove(cs_mesh_model_msg_type_t type, uint16_t id);
+
+	/**
+	 * Remove an item.
+	 */
+	void remove(uint8_t index);
+
+	/**
+	 * Start the next item that can be put in flight.
+	 *
+	 * @return                              Index of the started item, or -1 when none.
+	 */
+	int16_t startNext();
+
+	/**
+	 * Find the item in flight that a reply belongs to.
+	 *
+	 * @param[in] srcId                     Stone ID of the reply.
+	 * @param[in] msgType                   Message type the reply is a result of.
+	 * @param[out] stoneIndex               Set to the index of the stone ID in the list of the item.
+	 * @return                              Index of the item, or -1 when none.
+	 */
+	int16_t findInFlight(stone_id_t srcId, uint8_t msgType, uint8_t& stoneIndex);
+
+	/**
+	 * Mark a stone as acked.
+	 */
+	void setAcked(uint8_t index, uint8_t stoneIndex);
+
+	/**
+	 * Whether all stones acked an item.
+	 */
+	bool isAllAcked(uint8_t index);
+
+	/**
+	 * Count down the retries of an item.
+	 *
+	 * @return                              True when timed out.
+	 */
+	bool retry(uint8_t index);
+
+	bool isInProgress(uint8_t index) {
+		return _queue[index].metaData.transmissionsOrTimeout != 0 && _queue[index].inProgress;
+	}
+
+	cs_multicast_acked_queue_item_t& get(uint8_t index) {
+		return _queue[index];
+	}
+
+	uint8_t getNumInFlight() {
+		return _numInFlight;
+	}
+
+	/**
+	 * Get the number of items in the queue, including the ones in flight.
+	 */
+	uint8_t getNumQueued();
+
+private:
+	cs_multicast_acked_queue_item_t _queue[QUEUE_SIZE];
+
+	stone_id_t _ownStoneId = 0;
+
+	uint8_t _maxInFlight = MESH_MODEL_MULTICAST_ACKED_MAX_IN_FLIGHT;
+
+	uint8_t _numInFlight = 0;
+
+	/**
+	 * Next index in queue to start.
+	 */
+	uint8_t _queueIndexNext = 0;
+
+	/**
+	 * Whether an item can be put in flight, next to the items already in flight.
+	 */
+	bool canStart(uint8_t index);
+
+	int16_t getNextItemInQueue(bool priority);
+};
@@ -0,0 +1,113 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <mesh/cs_MeshDefines.h>
+#include <protocol/cs_Packets.h>
+#include <structs/cs_PacketsInternal.h>
+
+enum MeshTelemetryModel {
+	MESH_TELEMETRY_MODEL_MULTICAST        = 0,
+	MESH_TELEMETRY_MODEL_MULTICAST_ACKED  = 1,
+	MESH_TELEMETRY_MODEL_UNICAST          = 2,
+};
+
+/**
+ * Counters and histograms of the mesh traffic, per model and per message type.
+ *
+ * The models call the on..() functions, which only increment a counter or a histogram bucket.
+ * Times are measured in ticks, so the histograms have a resolution of TICK_INTERVAL_MS.
+ * Histogram bucket 0 counts values of less than 1 tick, bucket i counts values of [2^(i-1), 2^i) ticks,
+ * and the last bucket counts all larger values.
+ */
+class MeshTelemetry {
+public:
+	MeshTelemetry();
+
+	/**
+	 * To be called every tick.
+	 */
+	void tick(uint32_t tickCount);
+
+	/**
+	 * Get the current tick, to mark the time a message is queued.
+	 */
+	uint16_t getTick() {
+		return _tick;
+	}
+
+	/**
+	 * A message was added to the queue of a model, or dropped because the queue was full.
+	 */
+	void onQueued(MeshTelemetryModel model, uint8_t type);
+	void onDropped(MeshTelemetryModel model);
+
+	/**
+	 * A message was handed to the mesh stack.
+	 */
+	void onSent(MeshTelemetryModel model);
+
+	/**
+	 * A message was received.
+	 *
+	 * @param[in] hops            Number of hops the message made, 0 when received directly.
+	 */
+	void onReceived(MeshTelemetryModel model, uint8_t type, uint8_t hops);
+
+	/**
+	 * An acked message was sent again, or timed out.
+	 */
+	void onRetry(MeshTelemetryModel model);
+	void onAckTimeout(MeshTelemetryModel model);
+
+	/**
+	 * A queued message is sent for the first time.
+	 *
+	 * @param[in] queuedTick      Tick at which the message was queued.
+	 */
+	void onFirstSent(uint16_t queuedTick);
+
+	/**
+	 * All acks of a queued message have been received.
+	 *
+	 * @param[in] queuedTick      Tick at which the message was queued.
+	 */
+	void onAcked(uint16_t queuedTick);
+
+	cs_mesh_telemetry_t& getStats();
+
+	/**
+	 * Write the stats to the result buffer.
+	 */
+	void getStats(cs_result_t& result);
+
+	/**
+	 * Set all counters and histograms to 0.
+	 */
+	void reset();
+
+	/**
+	 * Get the histogram bucket of a number of ticks.
+	 */
+	static uint8_t getBucket(uint16_t ticks);
+
+private:
+	cs_mesh_telemetry_t _stats;
+
+	uint16_t _tick = 0;
+
+	//! Ticks since the last whole second of durationSeconds.
+	uint16_t _ticksInSecond = 0;
+
+	/**
+	 * Returns the histogram count plus 1, without overflowing.
+	 *
+	 * The histograms are in a packed struct, so they are updated by value instead of via a pointer.
+	 */
+	static uint16_t incrementCount(uint16_t count);
+};
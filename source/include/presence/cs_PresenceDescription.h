@@ -45,12 +45,12 @@ class PresenceStateDescription{
 
     void setRoom(uint8_t index) {
         if(index < 64){
-            val |= 1 << index;
+            val |= 1ULL << index;
         }
     }
     void clearRoom(uint8_t index) {
         if(index < 64){
-            val &= ~(1 << index);
+            val &= ~(1ULL << index);
         }
     }
 
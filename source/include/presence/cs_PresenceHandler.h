@@ -8,9 +8,9 @@
 
 #include <events/cs_EventListener.h>
 #include <presence/cs_PresenceDescription.h>
+#include <presence/cs_PresenceMatrix.h>
 #include <time/cs_SystemTime.h>
 
-#include <list>
 #include <optional>
 
 /**
@@ -42,58 +42,23 @@ private:
      */
     static const constexpr uint32_t presence_uncertain_due_reboot_time_out_s = 30;
 
-    static const constexpr uint8_t max_location_id = 63;
-    static const constexpr uint8_t max_profile_id = 7;
-
-    // using a list because of constant time insertion/deletion of
-    // any item in the container
-    static const constexpr uint8_t max_records = 20;
-    struct PresenceRecord {
-        uint8_t who;    // profile id
-        uint8_t where;  // room id
-        /**
-         * Used to determine when a record is timed out.
-         * Decreases every seconds.
-         * Starts at presence_time_out_s, when 0, it is timed out.
-         */
-    	uint8_t timeoutCountdownSeconds;
-    	/**
-    	 * Used to determine whether to send a mesh message.
-    	 * Decreases every seconds.
-    	 * Starts at presence_mesh_send_throttle_seconds, when 0, a mesh message can be sent.
-    	 */
-    	uint8_t meshSendCountdownSeconds;
-        PresenceRecord(
-        		uint8_t profileId,
-				uint8_t roomId,
-				uint8_t timeoutSeconds = presence_time_out_s,
-				uint8_t meshThrottleSeconds = presence_mesh_send_throttle_seconds):
-        	who(profileId),
-			where(roomId),
-			timeoutCountdownSeconds(timeoutSeconds),
-			meshSendCountdownSeconds(meshThrottleSeconds)
-        {}
-    };
+    static const constexpr uint8_t max_location_id = PresenceMatrix::max_location_id;
+    static const constexpr uint8_t max_profile_id = PresenceMatrix::max_profile_id;
 
     /**
-     * keeps track of a short history of presence events.
-     * will be lazily updated to remove old entries: 
-     *  - when new presence is detected
-     *  - when getCurrentPresenceDescription() is called
+     * Which profile is in which room, timed out after presence_time_out_s.
      */
-    static std::list<PresenceRecord> WhenWhoWhere;
+    static PresenceMatrix WhenWhoWhere;
 
     /**
-     * Clears the WhenWhoWhere list from entries that have a time stamp older than
-     * presence_time_out_s.
+     * Returns the current presence description, given the occupied rooms.
      */
-    void removeOldRecords();
+    static std::optional<PresenceStateDescription> getPresenceDescription(uint64_t occupiedRooms);
 
     /**
      * Processes a new profile-location combination:
-     * - a new entry is placed in the WhenWhoWhere list, 
-     * - previous entries with the same p-l combo are deleted
-     * - the WhenWhoWhere list is purged of old entries
+     * - the timeout of the profile-location combo is restarted,
+     * - it's sent over the mesh, when it's new or when the mesh throttle expired.
      * @param[in] fromMesh   Whether the profile location information comes from the mesh, instead of having it heard ourselves.
      */
     MutationType handleProfileLocationAdministration(uint8_t profile, uint8_t location, bool fromMesh);
@@ -0,0 +1,85 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Keeps up which profile is in which location, as a matrix of countdowns.
+ *
+ * Each profile has a bitmask of the locations it's present in,
+ * and the mask of occupied locations is kept up to date on every change.
+ */
+class PresenceMatrix {
+public:
+	static const constexpr uint8_t max_location_id = 63;
+	static const constexpr uint8_t max_profile_id = 7;
+
+	PresenceMatrix();
+
+	/**
+	 * Mark a profile as present in a location.
+	 *
+	 * @param[in] profile              Profile ID, should be at most max_profile_id.
+	 * @param[in] location             Location ID, should be at most max_location_id.
+	 * @param[in] timeoutSeconds       Seconds after which the profile is no longer present, unless marked again.
+	 * @param[in] meshThrottleSeconds  Seconds to wait before this profile location may be sent over the mesh again.
+	 *
+	 * @return True when this profile location may be sent over the mesh: when it's new,
+	 *         or when meshThrottleSeconds have passed since the last time it was allowed.
+	 */
+	bool update(uint8_t profile, uint8_t location, uint8_t timeoutSeconds, uint8_t meshThrottleSeconds);
+
+	/**
+	 * Whether the profile is present in the location.
+	 */
+	bool isPresent(uint8_t profile, uint8_t location);
+
+	/**
+	 * Returns a bitmask with a bit set for each location where any profile is present.
+	 */
+	uint64_t getOccupiedLocations();
+
+	/**
+	 * Returns the number of profile location combinations that are present.
+	 */
+	uint16_t getNumPresent();
+
+	/**
+	 * Remove all presence.
+	 */
+	void clear();
+
+	/**
+	 * To be called every second.
+	 *
+	 * Decreases the countdowns of all present profile locations, and removes the ones that timed out.
+	 */
+	void tickSecond();
+
+private:
+	//! Bit per location, for each profile.
+	uint64_t _presence[max_profile_id + 1];
+
+	//! Cached bitwise or of all profiles.
+	uint64_t _occupiedLocations;
+
+	uint16_t _numPresent;
+
+	/**
+	 * Seconds until the profile location is no longer present.
+	 */
+	uint8_t _timeoutCountdown[max_profile_id + 1][max_location_id + 1];
+
+	/**
+	 * Seconds until the profile location may be sent over the mesh again.
+	 * Only counts down while the profile is present.
+	 */
+	uint8_t _meshSendCountdown[max_profile_id + 1][max_location_id + 1];
+
+	void remove(uint8_t profile, uint8_t location);
+};
@@ -8,13 +8,15 @@
 
 #include "ble/cs_Nordic.h"
 #include "events/cs_EventListener.h"
+#include "processing/cs_RC5ValidationCache.h"
 #include "util/cs_Utils.h"
 
 /**
  * Class that parses advertisements for background broadcasts.
  *
  * Receives data from either EVT_DEVICE_SCANNED, or EVT_ADV_BACKGROUND.
- * Parses and decrypts.
+ * Parses and decrypts: the payloads of a batch are decrypted in a single call,
+ * and results are cached, so that repeated advertisements of a phone don't have to be decrypted again.
  * Sends event EVT_ADV_BACKGROUND_PARSED.
  */
 class BackgroundAdvertisementHandler : public EventListener {
@@ -35,9 +37,34 @@ private:
 	BackgroundAdvertisementHandler();
 
 	/**
-	 * Parse, decrypt, and validate an advertisement.
+	 * Decrypted and validated payloads.
+	 * Cleared when the localization key changes.
 	 */
-	void parseAdvertisement(scanned_device_t* scannedDevice);
+	RC5ValidationCache _validationCache;
+
+	/**
+	 * Parse an advertisement.
+	 *
+	 * Protocol 1 advertisements are handled right away.
+	 *
+	 * @param[in] scannedDevice              The scanned device.
+	 * @param[out] backgroundAdvertisement   Set when returning true, except for the data.
+	 * @param[out] encryptedPayload          Set when returning true.
+	 *
+	 * @return True for a protocol 0 advertisement of own sphere.
+	 */
+	bool parseAdvertisement(scanned_device_t* scannedDevice, adv_background_t& backgroundAdvertisement, uint16_t encryptedPayload[2]);
+
+	/**
+	 * Decrypt and validate encrypted payloads, and handle the validated advertisements.
+	 *
+	 * Payloads that are not in the cache are decrypted in a single batch.
+	 *
+	 * @param[in] backgroundAdvertisements   Parsed advertisements.
+	 * @param[in] encryptedPayloads          Encrypted payload of each advertisement: 2 words per advertisement.
+	 * @param[in] count                      Number of advertisements, at most SCAN_BATCH_SIZE.
+	 */
+	void handleEncryptedAdvertisements(adv_background_t* backgroundAdvertisements, uint16_t* encryptedPayloads, uint8_t count);
 
 	/**
 	 * Handle a validated background advertisement.
@@ -0,0 +1,234 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#define CMD_ADC_ENCRYPTED_DATA_SIZE 16
+
+/**
+ * Struct used to prevent double handling of similar command advertisements.
+ * And to prevent handling command advertisements of many devices at once.
+ */
+struct __attribute__((__packed__)) command_adv_claim_t {
+	uint8_t deviceToken;
+	uint8_t encryptedData[CMD_ADC_ENCRYPTED_DATA_SIZE];
+	uint16_t encryptedRC5;
+	uint16_t decryptedRC5[2];
+};
+
+/**
+ * Preallocated table of claims of command advertisements.
+ *
+ * - Claims are looked up by device token, via an open addressing hash table with linear probing.
+ * - Claims expire via a timer wheel: a claim is put in the bucket of the tick at which it expires,
+ *   so that a tick only has to look at the claims that expire at that tick.
+ *
+ * @param Capacity        Maximum number of claims, should be smaller than 255.
+ * @param TimeoutTicks    Number of ticks after which a claim expires, unless claimed again.
+ */
+template <uint8_t Capacity, uint8_t TimeoutTicks>
+class CommandAdvClaimTable {
+	static_assert(Capacity > 0 && Capacity < 255, "Invalid capacity");
+	static_assert(TimeoutTicks > 0 && TimeoutTicks < 255, "Invalid timeout");
+public:
+	CommandAdvClaimTable() {
+		clear();
+	}
+
+	void clear() {
+		memset(_index, NONE, sizeof(_index));
+		memset(_wheel, NONE, sizeof(_wheel));
+		for (uint8_t i = 0; i < Capacity; ++i) {
+			_next[i] = (i + 1 < Capacity) ? i + 1 : NONE;
+		}
+		_freeHead = 0;
+		_wheelPos = 0;
+		_size = 0;
+		_droppedCount = 0;
+	}
+
+	uint8_t size() {
+		return _size;
+	}
+
+	/**
+	 * Number of claims that were dropped, because the table was full.
+	 */
+	uint32_t getDroppedCount() {
+		return _droppedCount;
+	}
+
+	/**
+	 * Find the claim of given device token.
+	 *
+	 * Returns null if there is no claim, or if it expired.
+	 */
+	command_adv_claim_t* find(uint8_t deviceToken) {
+		uint16_t pos = findPos(deviceToken);
+		if (pos == NO_POS) {
+			return nullptr;
+		}
+		return &_claims[_index[pos]];
+	}
+
+	/**
+	 * Claim for a device token.
+	 *
+	 * Renews the claim of the device token, or adds a new claim with only the device token set.
+	 * The claim expires after TimeoutTicks ticks.
+	 *
+	 * Returns null when the table is full: the claim is dropped.
+	 */
+	command_adv_claim_t* claim(uint8_t deviceToken) {
+		uint8_t slot;
+		uint16_t pos = findPos(deviceToken);
+		if (pos != NO_POS) {
+			slot = _index[pos];
+			unlinkWheel(slot);
+		}
+		else {
+			if (_freeHead == NONE) {
+				_droppedCount++;
+				return nullptr;
+			}
+			slot = _freeHead;
+			_freeHead = _next[slot];
+			_claims[slot] = command_adv_claim_t();
+			_claims[slot].deviceToken = deviceToken;
+			insertPos(slot);
+			_size++;
+		}
+		linkWheel(slot, (_wheelPos + TimeoutTicks) % WHEEL_SIZE);
+		return &_claims[slot];
+	}
+
+	/**
+	 * To be called every tick.
+	 *
+	 * Removes the claims that expire at this tick.
+	 */
+	void tick() {
+		_wheelPos = (_wheelPos + 1) % WHEEL_SIZE;
+		uint8_t slot = _wheel[_wheelPos];
+		_wheel[_wheelPos] = NONE;
+		while (slot != NONE) {
+			uint8_t next = _next[slot];
+			removePos(findPos(_claims[slot].deviceToken));
+			_next[slot] = _freeHead;
+			_freeHead = slot;
+			_size--;
+			slot = next;
+		}
+	}
+
+private:
+	static const uint8_t NONE = 0xFF;
+	static const uint16_t NO_POS = 0xFFFF;
+
+	/**
+	 * Size of the hash table: a power of 2, at least twice the capacity, so that probe sequences stay short.
+	 */
+	static constexpr uint16_t indexSize(uint16_t size = 1) {
+		return (size >= 2 * Capacity) ? size : indexSize(size * 2);
+	}
+	static const uint16_t INDEX_SIZE = indexSize();
+
+	/**
+	 * Number of buckets of the timer wheel: claims expire at most TimeoutTicks ahead.
+	 */
+	static const uint16_t WHEEL_SIZE = TimeoutTicks + 1;
+
+	command_adv_claim_t _claims[Capacity];
+
+	//! Slot of the claim, or NONE.
+	uint8_t _index[INDEX_SIZE];
+
+	//! First claim in each bucket of the timer wheel.
+	uint8_t _wheel[WHEEL_SIZE];
+
+	//! Bucket of the current tick.
+	uint8_t _wheelPos;
+
+	//! Links of the list of a timer wheel bucket, or of the list of free slots.
+	uint8_t _prev[Capacity];
+	uint8_t _next[Capacity];
+	//! Bucket of the claim.
+	uint8_t _bucket[Capacity];
+	uint8_t _freeHead;
+
+	uint8_t _size;
+	uint32_t _droppedCount;
+
+	static uint16_t getHome(uint8_t deviceToken) {
+		return ((deviceToken * 2654435761U) >> 16) & (INDEX_SIZE - 1);
+	}
+
+	/**
+	 * Returns the position of the device token in the index, or NO_POS.
+	 */
+	uint16_t findPos(uint8_t deviceToken) {
+		for (uint16_t pos = getHome(deviceToken); _index[pos] != NONE; pos = (pos + 1) & (INDEX_SIZE - 1)) {
+			if (_claims[_index[pos]].deviceToken == deviceToken) {
+				return pos;
+			}
+		}
+		return NO_POS;
+	}
+
+	void insertPos(uint8_t slot) {
+		uint16_t pos = getHome(_claims[slot].deviceToken);
+		while (_index[pos] != NONE) {
+			pos = (pos + 1) & (INDEX_SIZE - 1);
+		}
+		_index[pos] = slot;
+	}
+
+	/**
+	 * Remove an entry, and shift back the entries after it, so that no probe sequence is broken.
+	 */
+	void removePos(uint16_t pos) {
+		uint16_t next = pos;
+		while (true) {
+			next = (next + 1) & (INDEX_SIZE - 1);
+			if (_index[next] == NONE) {
+				break;
+			}
+			uint16_t home = getHome(_claims[_index[next]].deviceToken);
+			// Only move the entry when its home is not in (pos, next].
+			bool inRange = (pos <= next) ? (pos < home && home <= next) : (pos < home || home <= next);
+			if (!inRange) {
+				_index[pos] = _index[next];
+				pos = next;
+			}
+		}
+		_index[pos] = NONE;
+	}
+
+	void linkWheel(uint8_t slot, uint8_t bucket) {
+		_bucket[slot] = bucket;
+		_prev[slot] = NONE;
+		_next[slot] = _wheel[bucket];
+		if (_wheel[bucket] != NONE) {
+			_prev[_wheel[bucket]] = slot;
+		}
+		_wheel[bucket] = slot;
+	}
+
+	void unlinkWheel(uint8_t slot) {
+		if (_prev[slot] != NONE) {
+			_next[_prev[slot]] = _next[slot];
+		}
+		else {
+			_wheel[_bucket[slot]] = _next[slot];
+		}
+		if (_next[slot] != NONE) {
+			_prev[_next[slot]] = _prev[slot];
+		}
+	}
+};
@@ -9,6 +9,7 @@
 
 #include "common/cs_Types.h"
 #include "events/cs_EventListener.h"
+#include "processing/cs_CommandAdvClaimTable.h"
 #include "util/cs_Utils.h"
 
 #define CMD_ADV_NUM_SERVICES_16BIT 4 // There are 4 16 bit service UUIDs in a command advertisement.
@@ -21,21 +22,9 @@
 /**
  * Number of devices that can simultaneously advertise commands
  */
-#define CMD_ADV_MAX_CLAIM_COUNT 10
-
-#define CMD_ADC_ENCRYPTED_DATA_SIZE 16
-
-/**
- * Struct used to prevent double handling of similar command advertisements.
- * And to prevent handling command advertisements of many devices at once.
- */
-struct __attribute__((__packed__)) command_adv_claim_t {
-	uint8_t deviceToken;
-	uint8_t timeoutCounter;
-	uint8_t encryptedData[CMD_ADC_ENCRYPTED_DATA_SIZE];
-	uint16_t encryptedRC5;
-	uint16_t decryptedRC5;
-};
+#ifndef CMD_ADV_MAX_CLAIM_COUNT
+#define CMD_ADV_MAX_CLAIM_COUNT 16
+#endif
 
 struct __attribute__((__packed__)) command_adv_header_t {
 //	uint8_t sequence0 : 2;
@@ -67,7 +56,7 @@ public:
 
 private:
 	CommandAdvHandler();
-	command_adv_claim_t _claims[CMD_ADV_MAX_CLAIM_COUNT];
+	CommandAdvClaimTable<CMD_ADV_MAX_CLAIM_COUNT, CMD_ADV_CLAIM_TIME_MS / TICK_INTERVAL_MS> _claims;
 	TYPIFY(CONFIG_SPHERE_ID) _sphereId = 0;
 
 	void parseAdvertisement(scanned_device_t* scannedDevice);
@@ -82,17 +71,14 @@ private:
 	EncryptionAccessLevel getRequiredAccessLevel(const AdvCommandTypes type);
 
 	/**
-	 * Return index of claim with this device token.
+	 * Check if the device token has a claim with similar encrypted data.
 	 *
 	 * @param[out] decryptedRC5   When previous encrypted data is similar: set to previous decrypted RC5 data.
 	 *
-	 * Returns -1 when the device token was not found.
-	 * Returns -2 when the device token was found, but the previous encryptedData is similar.
+	 * Returns true when the previous encrypted data is similar.
 	 */
-	int checkSimilarCommand(uint8_t deviceToken, cs_data_t& encryptedData, uint16_t encryptedRC5, uint16_t& decryptedRC5);
+	bool checkSimilarCommand(uint8_t deviceToken, cs_data_t& encryptedData, uint16_t encryptedRC5, uint16_t decryptedRC5[2]);
 
 	// Return true when device claimed successfully: when there's a claim spot.
-	bool claim(uint8_t deviceToken, cs_data_t& encryptedData, uint16_t encryptedRC5, uint16_t decryptedRC5, int indexOfDevice);
-
-	void tickClaims();
+	bool claim(uint8_t deviceToken, cs_data_t& encryptedData, uint16_t encryptedRC5, uint16_t decryptedRC5[2]);
 };
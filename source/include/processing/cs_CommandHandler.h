@@ -9,6 +9,7 @@
 #include <ble/cs_Nordic.h>
 #include <ble/cs_Stack.h>
 #include <common/cs_Types.h>
+#include <processing/cs_StateSnapshotHandler.h>
 #include <protocol/cs_CommandTypes.h>
 
 
@@ -75,6 +76,8 @@ private:
 
 	const boards_config_t* _boardConfig;
 
+	StateSnapshotHandler _stateSnapshotHandler;
+
 	EncryptionAccessLevel getRequiredAccessLevel(const CommandHandlerTypes type);
 	bool allowedAsMeshCommand(const CommandHandlerTypes type);
 
@@ -101,6 +104,8 @@ private:
 	void handleCmdUartMsg                 (cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t & result);
 	void handleCmdStateGet                (cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t & result);
 	void handleCmdStateSet                (cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t & result);
+	void handleCmdStateSnapshotGet        (cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t & result);
+	void handleCmdStateSnapshotSet        (cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t & result);
 	void handleCmdRegisterTrackedDevice   (cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t & result);
 	void handleCmdGetUptime               (cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t & result);
 	void handleMicroAppUpload             (cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t & result);
@@ -11,6 +11,7 @@
 #include <cstdlib>
 #include <drivers/cs_RNG.h>
 #include <events/cs_EventListener.h>
+#include <processing/cs_RC5.h>
 #include <storage/cs_State.h>
 
 #define PACKET_NONCE_LENGTH  	3
@@ -18,9 +19,8 @@
 #define DEFAULT_SESSION_KEY 	0xCAFEBABE
 #define DEFAULT_SESSION_KEY_LENGTH 4
 
-#define RC5_ROUNDS 12
-#define RC5_NUM_SUBKEYS (2*(RC5_ROUNDS+1)) // t = 2(r+1) - the number of round subkeys required.
-#define RC5_KEYLEN 16
+// Number of access levels with a key in storage: admin, member, basic, service data, and localization.
+#define RC5_NUM_ACCESS_LEVELS 5
 
 enum EncryptionType {
 	CTR,
@@ -44,7 +44,17 @@ private:
 
 	conv8_32 _defaultValidationKey;
 	uint8_t _overhead = PACKET_NONCE_LENGTH + USER_LEVEL_LENGTH;
-	uint16_t _rc5SubKeys[RC5_NUM_SUBKEYS]; // S[] - The round subkey words.
+
+	/**
+	 * Expanded RC5 key for each access level, see _getRC5Index().
+	 * Only expanded again when the key changes.
+	 */
+	RC5<> _rc5[RC5_NUM_ACCESS_LEVELS];
+
+	/**
+	 * Bit per RC5 key: whether it has been initialized.
+	 */
+	uint8_t _rc5Initialized = 0;
 
 public:
 	static EncryptionHandler& getInstance() {
@@ -79,13 +89,25 @@ public:
 
 	/**
 	 * Initialized the key, using the key of given access level.
+	 *
+	 * Once initialized, the key will be initialized again whenever the key of that access level changes.
 	 */
 	bool RC5InitKey(EncryptionAccessLevel accessLevel);
 
 	/**
 	 * Decrypt data with RC5.
 	 */
-	bool RC5Decrypt(uint16_t* encryptedData, uint16_t encryptedDataLength, uint16_t* target, uint16_t targetLength);
+	bool RC5Decrypt(uint16_t* encryptedData, uint16_t encryptedDataLength, uint16_t* target, uint16_t targetLength, EncryptionAccessLevel accessLevel = LOCALIZATION);
+
+	/**
+	 * Decrypt multiple blocks of 32 bits with RC5.
+	 *
+	 * @param[in] encryptedData    Encrypted blocks: 2 words per block.
+	 * @param[out] target          Decrypted blocks: 2 words per block, may be the same as encryptedData.
+	 * @param[in] numBlocks        Number of blocks.
+	 * @param[in] accessLevel      Access level of the key to use, should be initialized.
+	 */
+	bool RC5DecryptBatch(const uint16_t* encryptedData, uint16_t* target, uint8_t numBlocks, EncryptionAccessLevel accessLevel = LOCALIZATION);
 
 	/**
 	 * make sure we create a new nonce for each connection
@@ -138,6 +160,10 @@ private:
 	void _generateNewSetupKey();
 	void _generateNonceInTarget(uint8_t* target);
 	void _createIV(uint8_t* target, uint8_t* nonce, EncryptionType encryptionType);
-	bool _RC5PrepareKey(uint8_t* key, uint8_t keyLength);
+
+	/**
+	 * Returns the index in _rc5 for given access level, or RC5_NUM_ACCESS_LEVELS when it has no stored key.
+	 */
+	uint8_t _getRC5Index(EncryptionAccessLevel accessLevel);
 };
 
@@ -9,17 +9,26 @@
 
 #include "common/cs_Types.h"
 
+/**
+ * Priority that a state gets when it changed, in number of broadcasted states it has waited.
+ */
+#define EXTERNAL_STATE_CHANGED_PRIORITY EXTERNAL_STATE_LIST_COUNT
+
 /**
  * Item with state of external stone.
  *
  * timeoutCount         Count until this state is considered timed out.
  *                      Every item with timeoutCount of 0, is considered empty.
  * id                   Id of the stone.
+ * broadcastWait        Number of states broadcasted since this state was broadcasted.
+ * changed              Whether the state is new or changed, since it was last broadcasted.
  * state                The state of the stone.
  */
 struct __attribute__((__packed__)) cs_external_state_item_t {
 	uint16_t timeoutCount;
 	stone_id_t id;
+	uint8_t broadcastWait;
+	bool changed;
 	state_external_stone_t state;
 };
 
@@ -30,6 +39,11 @@ struct __attribute__((__packed__)) cs_external_state_item_t {
  * - Storing the states of other stones.
  * - Keeping up if states are timed out.
  * - Choosing which state should be broadcasted next.
+ *
+ * States are indexed by stone id.
+ * The next state to broadcast is the one that waited longest, where a new or changed state
+ * counts as having waited EXTERNAL_STATE_CHANGED_PRIORITY more. Changes spread faster that way,
+ * while unchanged states still get their turn.
  */
 class ExternalStates {
 public:
@@ -51,15 +65,37 @@ public:
 	 * To be called every EVT_TICK.
 	 */
 	void tick(TYPIFY(EVT_TICK) tickCount);
+
+	/**
+	 * Write the average time in seconds since the broadcasted states were received to the result.
+	 *
+	 * The average is over the states broadcasted since the previous call.
+	 */
+	void getStats(cs_result_t& result);
+
 private:
-	cs_external_state_item_t* _states;
+	static const uint8_t INDEX_NONE = 0xFF;
+
+	cs_external_state_item_t _states[EXTERNAL_STATE_LIST_COUNT];
 
-	/** Index of states to be broadcasted next */
+	/** Index in _states for each stone id, or INDEX_NONE. */
+	uint8_t _indexOfId[0x100];
+
+	/** Index of states to be broadcasted next, when states have equal priority. */
 	int _broadcastIndex = 0;
 
-	void removeFromList(stone_id_t id);
+	/** Sum of the staleness of the broadcasted states, and the number of broadcasted states, since the stats were read. */
+	uint32_t _stalenessSum = 0;
+	uint32_t _stalenessCount = 0;
+
+	void removeFromList(int index);
 
 	void addToList(int index, stone_id_t id, state_external_stone_t* state);
 
+	/**
+	 * Whether the state differs from the stored state in switch state, flags, or errors.
+	 */
+	bool isChanged(state_external_stone_t* stored, state_external_stone_t* state);
+
 	void fixState(state_external_stone_t* state);
 };
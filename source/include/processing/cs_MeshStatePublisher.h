@@ -0,0 +1,96 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <cfg/cs_Config.h>
+#include <cstdint>
+
+/**
+ * The parts of the state of this stone that are sent via the mesh, and that are checked for significant changes.
+ */
+struct cs_mesh_state_sample_t {
+	uint8_t switchState = 0;
+	uint8_t flags = 0;
+	uint32_t errors = 0;
+	int32_t powerUsageMilliWatt = 0;
+};
+
+enum MeshStatePublishType {
+	MESH_STATE_PUBLISH_NONE = 0,
+	//! The state changed significantly.
+	MESH_STATE_PUBLISH_CHANGE,
+	//! The state did not change significantly, but has not been sent for a while.
+	MESH_STATE_PUBLISH_KEEP_ALIVE,
+};
+
+/**
+ * Decides when to send the state of this stone via the mesh.
+ *
+ * - When the state changes significantly, it is sent after MESH_SEND_STATE_CHANGE_DELAY_MS,
+ *   but no sooner than MESH_SEND_STATE_MIN_INTERVAL_MS after the previous send.
+ * - Otherwise, it is sent as keep alive. The keep alive interval starts at MESH_SEND_STATE_INTERVAL_MS,
+ *   and doubles each time the state is sent without significant change, up to MESH_SEND_STATE_INTERVAL_MAX_MS.
+ *   By default that is the same interval, as older firmware times out the states of other stones after 60 s.
+ *   A random amount of up to MESH_SEND_STATE_INTERVAL_MS_VARIATION is added to each interval.
+ *
+ * A change is significant when the switch state, flags, or errors change, or when the power usage changes
+ * by at least MESH_SEND_STATE_POWER_THRESHOLD_MW and MESH_SEND_STATE_POWER_THRESHOLD_PERCENTAGE of the last sent power usage.
+ */
+class MeshStatePublisher {
+public:
+	/**
+	 * Init with the current state, as if it was just sent.
+	 *
+	 * @param[in] sample          The current state.
+	 * @param[in] seed            Seed for the random variation of the interval.
+	 */
+	void init(const cs_mesh_state_sample_t& sample, uint32_t seed);
+
+	/**
+	 * To be called every tick, with the current state.
+	 *
+	 * @return                    Whether to send the state now, and why.
+	 */
+	MeshStatePublishType tick(const cs_mesh_state_sample_t& sample);
+
+	/**
+	 * Whether the state changed significantly, compared to the state that was sent last.
+	 */
+	bool isSignificantChange(const cs_mesh_state_sample_t& sample);
+
+	/**
+	 * Get the current keep alive interval, without random variation.
+	 */
+	uint32_t getKeepAliveIntervalMs();
+
+	uint32_t getNumChangeSends();
+	uint32_t getNumKeepAliveSends();
+
+private:
+	cs_mesh_state_sample_t _lastSent;
+
+	uint32_t _keepAliveIntervalMs = MESH_SEND_STATE_INTERVAL_MS;
+
+	//! Ticks since the state was last sent.
+	uint32_t _ticksSinceSent = 0;
+
+	//! Send a keep alive when _ticksSinceSent reaches this value.
+	uint32_t _keepAliveTicks = 0;
+
+	//! Send the changed state when _ticksSinceSent reaches this value, 0 when no change is pending.
+	uint32_t _changeTicks = 0;
+
+	uint32_t _random = 1;
+
+	uint32_t _numChangeSends = 0;
+	uint32_t _numKeepAliveSends = 0;
+
+	void onSent(const cs_mesh_state_sample_t& sample);
+
+	uint32_t getRandomVariationMs();
+};
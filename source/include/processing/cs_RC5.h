@@ -0,0 +1,131 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <cstdint>
+
+#define RC5_ROUNDS 12
+#define RC5_NUM_SUBKEYS (2*(RC5_ROUNDS+1)) // t = 2(r+1) - the number of round subkeys required.
+#define RC5_KEYLEN 16
+
+// Magic numbers for RC5 with 16 bit words.
+#define RC5_16BIT_P 0xB7E1
+#define RC5_16BIT_Q 0x9E37
+
+/**
+ * RC5 with 16 bit words, so with blocks of 32 bits.
+ *
+ * Holds the expanded key (the round subkeys), so that it only has to be computed when the key changes.
+ * See https://en.wikipedia.org/wiki/RC5
+ *
+ * @param Rounds    Number of rounds, the firmware uses RC5_ROUNDS.
+ */
+template <uint8_t Rounds = RC5_ROUNDS>
+class RC5 {
+public:
+	static const constexpr uint8_t numSubKeys = 2 * (Rounds + 1);
+
+	/**
+	 * Expand a key into the round subkeys.
+	 *
+	 * @param[in] key         Key bytes.
+	 * @param[in] keyLength   Length of the key, should be a multiple of 2, and at most RC5_KEYLEN.
+	 *
+	 * @return False when the key length is invalid.
+	 */
+	bool prepareKey(const uint8_t* key, uint8_t keyLength) {
+		if (keyLength == 0 || keyLength > RC5_KEYLEN || keyLength % 2) {
+			return false;
+		}
+		uint8_t keyLenWords = keyLength / sizeof(uint16_t); // c - The length of the key in words.
+		uint8_t loops = 3 * (numSubKeys > keyLenWords ? numSubKeys : keyLenWords);
+		uint16_t L[RC5_KEYLEN / sizeof(uint16_t)]; // L[] - A temporary working array used during key scheduling. initialized to the key in words.
+		for (uint8_t i = 0; i < keyLenWords; ++i) {
+			L[i] = (key[2*i+1] << 8) + key[2*i];
+		}
+
+		_subKeys[0] = RC5_16BIT_P;
+		for (uint8_t i = 1; i < numSubKeys; ++i) {
+			_subKeys[i] = _subKeys[i-1] + RC5_16BIT_Q;
+		}
+
+		uint8_t i = 0;
+		uint8_t j = 0;
+		uint16_t a = 0;
+		uint16_t b = 0;
+		for (uint8_t k = 0; k < loops; ++k) {
+			a = rotl(_subKeys[i] + a + b, 3);
+			_subKeys[i] = a;
+			b = rotl(L[j] + a + b, a + b);
+			L[j] = b;
+			i = (i + 1) % numSubKeys;
+			j = (j + 1) % keyLenWords;
+		}
+		return true;
+	}
+
+	/**
+	 * Decrypt a single block.
+	 *
+	 * @param[in] encrypted    Encrypted block: 2 words.
+	 * @param[out] target      Decrypted block: 2 words, may be the same as encrypted.
+	 */
+	void decrypt(const uint16_t* encrypted, uint16_t* target) {
+		uint16_t a = encrypted[0];
+		uint16_t b = encrypted[1];
+#pragma GCC unroll 32
+		for (uint8_t i = Rounds; i > 0; --i) {
+			b = rotr(b - _subKeys[2*i + 1], a) ^ a;
+			a = rotr(a - _subKeys[2*i], b) ^ b;
+		}
+		target[0] = a - _subKeys[0];
+		target[1] = b - _subKeys[1];
+	}
+
+	/**
+	 * Decrypt multiple blocks, with the rounds unrolled.
+	 *
+	 * @param[in] encrypted    Encrypted blocks: 2 words per block.
+	 * @param[out] target      Decrypted blocks: 2 words per block, may be the same as encrypted.
+	 * @param[in] numBlocks    Number of blocks.
+	 */
+	void decrypt(const uint16_t* encrypted, uint16_t* target, uint8_t numBlocks) {
+		for (uint8_t n = 0; n < numBlocks; ++n) {
+			decrypt(encrypted + 2 * n, target + 2 * n);
+		}
+	}
+
+	/**
+	 * Encrypt a single block.
+	 *
+	 * @param[in] plain        Block to encrypt: 2 words.
+	 * @param[out] target      Encrypted block: 2 words, may be the same as plain.
+	 */
+	void encrypt(const uint16_t* plain, uint16_t* target) {
+		uint16_t a = plain[0] + _subKeys[0];
+		uint16_t b = plain[1] + _subKeys[1];
+		for (uint8_t i = 1; i <= Rounds; ++i) {
+			a = rotl(a ^ b, b) + _subKeys[2*i];
+			b = rotl(b ^ a, a) + _subKeys[2*i + 1];
+		}
+		target[0] = a;
+		target[1] = b;
+	}
+
+private:
+	uint16_t _subKeys[numSubKeys]; // S[] - The round subkey words.
+
+	static inline uint16_t rotl(uint16_t x, uint16_t shift) {
+		shift %= 16;
+		return (x << shift) | (x >> (16 - shift));
+	}
+
+	static inline uint16_t rotr(uint16_t x, uint16_t shift) {
+		shift %= 16;
+		return (x >> shift) | (x << (16 - shift));
+	}
+};
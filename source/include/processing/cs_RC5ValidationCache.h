@@ -0,0 +1,88 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Number of cached results.
+ */
+#ifndef RC5_VALIDATION_CACHE_SIZE
+#define RC5_VALIDATION_CACHE_SIZE 16
+#endif
+
+/**
+ * Caches the decrypted and validated results of RC5 payloads.
+ *
+ * Phones repeat the same encrypted payload until the validation time window changes,
+ * so a result is keyed by the encrypted payload and the time window.
+ * Results of other time windows are misses, and will be overwritten.
+ *
+ * A new result replaces the result of the same payload, else the oldest result.
+ * Since there are only a few phones nearby, the cache is small, and simply searched.
+ * It should be cleared when the key changes.
+ */
+class RC5ValidationCache {
+public:
+	RC5ValidationCache();
+
+	/**
+	 * Look up the result of an encrypted payload.
+	 *
+	 * @param[in] encrypted    Encrypted payload: 2 words.
+	 * @param[in] timeWindow   Time window in which the payload was received.
+	 * @param[out] decrypted   Decrypted payload: 2 words, only set on a hit.
+	 * @param[out] valid       Whether the payload was validated, only set on a hit.
+	 *
+	 * @return True on a hit.
+	 */
+	bool get(const uint16_t* encrypted, uint16_t timeWindow, uint16_t* decrypted, bool& valid);
+
+	/**
+	 * Store the result of an encrypted payload.
+	 */
+	void set(const uint16_t* encrypted, uint16_t timeWindow, const uint16_t* decrypted, bool valid);
+
+	/**
+	 * Remove all results.
+	 */
+	void clear();
+
+	uint32_t getHits() {
+		return _hits;
+	}
+
+	uint32_t getMisses() {
+		return _misses;
+	}
+
+private:
+	struct __attribute__((packed)) entry_t {
+		uint32_t encrypted;
+		uint32_t decrypted;
+		uint16_t timeWindow;
+		uint8_t used : 1;
+		uint8_t valid : 1;
+	};
+
+	entry_t _entries[RC5_VALIDATION_CACHE_SIZE];
+
+	//! Index of the entry to overwrite next.
+	uint8_t _next;
+
+	uint32_t _hits;
+	uint32_t _misses;
+
+	static uint32_t toWord(const uint16_t* payload) {
+		return payload[0] | ((uint32_t)payload[1] << 16);
+	}
+
+	/**
+	 * Returns the index of the entry with given encrypted payload, or RC5_VALIDATION_CACHE_SIZE.
+	 */
+	uint8_t find(uint32_t encrypted);
+};
@@ -0,0 +1,102 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <structs/cs_PacketsInternal.h>
+
+/**
+ * Whether scanned devices are dispatched in batches (EVT_DEVICE_SCANNED_BATCH),
+ * instead of one by one (EVT_DEVICE_SCANNED).
+ *
+ * Disabled by default: batching delays the handling of command advertisements by up to SCAN_BATCH_TIMEOUT_MS,
+ * while it only saves little processing time per scanned device.
+ */
+#ifndef SCAN_BATCH_ENABLED
+#define SCAN_BATCH_ENABLED 0
+#endif
+
+/**
+ * Maximum number of scanned devices in a batch.
+ */
+#define SCAN_BATCH_SIZE 8
+
+/**
+ * A batch is delivered at latest this long after its first scanned device.
+ * Rounded up to ticks.
+ */
+#define SCAN_BATCH_TIMEOUT_MS 100
+
+/**
+ * Whether advertisements with the same address and data within a batch are collapsed into a single record.
+ */
+#ifndef SCAN_BATCH_COLLAPSE_DUPLICATES
+#define SCAN_BATCH_COLLAPSE_DUPLICATES 0
+#endif
+
+typedef void (*callback_scan_batch_t)(scanned_device_batch_t& batch);
+
+/**
+ * Collects scanned devices, and delivers them in batches.
+ *
+ * Scanned devices are added from the thread, so the batch is delivered and emptied before the next one is added.
+ */
+class ScanAggregator {
+public:
+	static ScanAggregator& getInstance() {
+		static ScanAggregator instance;
+		return instance;
+	}
+
+	/**
+	 * Set the function that is called with each batch.
+	 */
+	void setCallback(callback_scan_batch_t callback);
+
+	/**
+	 * Set whether duplicates are collapsed, see SCAN_BATCH_COLLAPSE_DUPLICATES.
+	 */
+	void setCollapseDuplicates(bool collapse);
+
+	/**
+	 * Add a scanned device. The device and its data are copied.
+	 *
+	 * Delivers the batch when it's full.
+	 *
+	 * @retval ERR_SUCCESS                 When the device was added.
+	 * @retval ERR_WRONG_PAYLOAD_LENGTH    When the data is larger than a record can hold.
+	 */
+	cs_ret_code_t add(scanned_device_t* scannedDevice);
+
+	/**
+	 * Deliver the batch, if there is any scanned device.
+	 */
+	void flush();
+
+	/**
+	 * To be called every tick: delivers the batch when it timed out.
+	 */
+	void tick();
+
+private:
+	ScanAggregator();
+
+	callback_scan_batch_t _callback = nullptr;
+	bool _collapseDuplicates = (SCAN_BATCH_COLLAPSE_DUPLICATES == 1);
+
+	scanned_device_record_t _records[SCAN_BATCH_SIZE];
+	//! Sum of the RSSI of the collapsed advertisements, per record.
+	int16_t _rssiSum[SCAN_BATCH_SIZE];
+	uint8_t _size = 0;
+
+	//! Ticks left before the batch is delivered.
+	uint8_t _ticksLeft = 0;
+
+	/**
+	 * Returns the index of the record with the same address and data, or -1 when there is none.
+	 */
+	int16_t findDuplicate(scanned_device_t* scannedDevice);
+};
@@ -0,0 +1,155 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <protocol/cs_Packets.h>
+#include <structs/cs_PacketsInternal.h>
+
+/**
+ * Lowest percentage of the scan period that is spent scanning, used when there is nothing of interest around.
+ * Below the default fixed duty (2000 ms of 9000 ms), so that more radio time is left for mesh and advertising.
+ * Must be at least 1.
+ */
+#ifndef SCAN_DUTY_MIN_PERCENT
+#define SCAN_DUTY_MIN_PERCENT 10
+#endif
+
+/**
+ * Highest percentage of the scan period that is spent scanning.
+ * Must be at most 99, so that the scan break never becomes 0.
+ */
+#ifndef SCAN_DUTY_MAX_PERCENT
+#define SCAN_DUTY_MAX_PERCENT 80
+#endif
+
+/**
+ * Percentage by which the duty is raised for every second with hits.
+ */
+#ifndef SCAN_DUTY_RISE_PERCENT
+#define SCAN_DUTY_RISE_PERCENT 20
+#endif
+
+/**
+ * Seconds without hits before the duty starts to decay.
+ */
+#ifndef SCAN_DUTY_HOLD_SECONDS
+#define SCAN_DUTY_HOLD_SECONDS 10
+#endif
+
+/**
+ * Seconds that the duty is at the maximum after a command advertisement has been seen.
+ * A phone repeats a command advertisement for a few seconds, so the repeats are heard at the maximum duty.
+ */
+#ifndef SCAN_DUTY_COMMAND_BOOST_SECONDS
+#define SCAN_DUTY_COMMAND_BOOST_SECONDS 5
+#endif
+
+/**
+ * Every second after the hold time, the duty above the minimum is multiplied by
+ * (SCAN_DUTY_DECAY_FACTOR - 1) / SCAN_DUTY_DECAY_FACTOR.
+ */
+#define SCAN_DUTY_DECAY_FACTOR 8
+
+/**
+ * Weight of the last second in the average hits per second, as 1 / SCAN_DUTY_HIT_RATE_FACTOR.
+ */
+#define SCAN_DUTY_HIT_RATE_FACTOR 8
+
+/**
+ * Shortest scan duration and scan break duration, in ms.
+ * A timer can't be started with a timeout below APP_TIMER_MIN_TIMEOUT_TICKS, which would stop the scanner.
+ */
+#define SCAN_DUTY_MIN_PHASE_MS 10
+
+/**
+ * Decides how much of the scan period is spent scanning.
+ *
+ * The duty is raised while there are relevant hits (tracked devices, command advertisements, tap to toggle),
+ * held for a while after the last hit, and then decays to the minimum.
+ * A command advertisement sets the duty to the maximum right away, for a short while.
+ */
+class ScanDutyController {
+public:
+	ScanDutyController();
+
+	/**
+	 * Set the bounds of the duty.
+	 *
+	 * @param[in] minPercent   Lowest duty, in percent, at least 1.
+	 * @param[in] maxPercent   Highest duty, in percent, at most 99.
+	 *
+	 * @return ERR_WRONG_PARAMETER when the bounds are invalid.
+	 */
+	cs_ret_code_t setBounds(uint8_t minPercent, uint8_t maxPercent);
+
+	/**
+	 * To be called for each relevant scanned device.
+	 */
+	void addHit();
+
+	/**
+	 * To be called for each command advertisement for this sphere.
+	 *
+	 * Counts as a hit, and boosts the duty to the maximum for SCAN_DUTY_COMMAND_BOOST_SECONDS.
+	 */
+	void addCommandHit();
+
+	/**
+	 * To be called every second.
+	 *
+	 * Updates the duty and the average hits per second.
+	 */
+	void tickSecond();
+
+	/**
+	 * Current duty, in percent, including a command boost.
+	 */
+	uint8_t getDutyPercent();
+
+	/**
+	 * Average number of hits per second, in 1/100 hits.
+	 */
+	uint16_t getHitsPerSecondCenti();
+
+	/**
+	 * Time to scan, given the scan period (scan time + break time).
+	 * At least SCAN_DUTY_MIN_PHASE_MS.
+	 */
+	uint16_t getScanDuration(uint32_t periodMs);
+
+	/**
+	 * Time to not scan, given the scan period (scan time + break time).
+	 * At least SCAN_DUTY_MIN_PHASE_MS.
+	 */
+	uint16_t getScanBreakDuration(uint32_t periodMs);
+
+	/**
+	 * Write the telemetry to the result.
+	 */
+	void getStats(cs_result_t& result);
+
+private:
+	uint8_t _minPercent = SCAN_DUTY_MIN_PERCENT;
+	uint8_t _maxPercent = SCAN_DUTY_MAX_PERCENT;
+	uint8_t _dutyPercent = SCAN_DUTY_MIN_PERCENT;
+
+	//! Hits since the last tick.
+	uint16_t _hitsThisSecond = 0;
+
+	//! Seconds left of the command boost.
+	uint8_t _boostSeconds = 0;
+
+	//! Seconds since the last second with hits, saturates at SCAN_DUTY_HOLD_SECONDS.
+	uint8_t _secondsSinceHit = SCAN_DUTY_HOLD_SECONDS;
+
+	//! Moving average of the hits per second, in 1/100 hits.
+	uint32_t _hitRateCenti = 0;
+
+	uint32_t _totalHits = 0;
+
+	static uint16_t clampDuration(uint32_t durationMs);
+};
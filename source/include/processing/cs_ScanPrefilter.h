@@ -0,0 +1,133 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <structs/cs_PacketsInternal.h>
+
+/**
+ * Whether scanned devices are filtered before they are dispatched.
+ */
+#ifndef SCAN_PREFILTER_ENABLED
+#define SCAN_PREFILTER_ENABLED 1
+#endif
+
+#define SCAN_PREFILTER_MAX_RULES 8
+#define SCAN_PREFILTER_PATTERN_SIZE 4
+#define SCAN_PREFILTER_COMPANY_ID_ANY 0xFFFF
+
+/**
+ * Size of each bloom filter of addresses, in bytes.
+ */
+#define SCAN_PREFILTER_BLOOM_SIZE 32
+
+/**
+ * Number of bits set per address in the bloom filter.
+ */
+#define SCAN_PREFILTER_BLOOM_HASHES 3
+
+/**
+ * Rule that accepts scanned devices with a given AD structure.
+ */
+struct __attribute__((packed)) scan_prefilter_rule_t {
+	//! AD type, see BLE_GAP_AD_TYPE_*.
+	uint8_t adType;
+	//! For manufacturer data: the company ID, in the first 2 bytes of the data. SCAN_PREFILTER_COMPANY_ID_ANY for any.
+	uint16_t companyId = SCAN_PREFILTER_COMPANY_ID_ANY;
+	//! Offset of the pattern in the data of the AD structure.
+	uint8_t patternOffset = 0;
+	//! Number of bytes of the pattern, the data of the AD structure should be at least patternOffset + patternLen long.
+	uint8_t patternLen = 0;
+	uint8_t pattern[SCAN_PREFILTER_PATTERN_SIZE] = {0};
+	//! Only bits set in the mask are compared.
+	uint8_t mask[SCAN_PREFILTER_PATTERN_SIZE] = {0};
+};
+
+/**
+ * Sources of the addresses that are always accepted.
+ * Each source has its own bloom filter, so that it can be rebuilt without affecting the others.
+ */
+enum ScanPrefilterAddressSource {
+	SCAN_PREFILTER_SOURCE_TAP_TO_TOGGLE = 0,
+	SCAN_PREFILTER_SOURCE_TRACKED_DEVICES,
+	SCAN_PREFILTER_SOURCE_COUNT
+};
+
+/**
+ * Decides whether a scanned device is of interest, before it is dispatched as EVT_DEVICE_SCANNED.
+ *
+ * Most scanned devices are of no interest: foreign iBeacons, random phones, other vendors.
+ * Handlers of scanned devices add a rule for the advertisements they look for.
+ * A scanned device is accepted when it matches any rule, or when its address is in a bloom filter
+ * of interesting addresses. The bloom filter may give false positives, which are simply dispatched.
+ *
+ * Relies on the AD index of the scanned device, see BLEutil::indexAdvData().
+ */
+class ScanPrefilter {
+public:
+	static ScanPrefilter& getInstance() {
+		static ScanPrefilter instance;
+		return instance;
+	}
+
+	/**
+	 * Add a rule.
+	 *
+	 * @retval ERR_SUCCESS             When the rule was added.
+	 * @retval ERR_WRONG_PARAMETER     When the pattern doesn't fit.
+	 * @retval ERR_NO_SPACE            When the rule table is full.
+	 */
+	cs_ret_code_t addRule(const scan_prefilter_rule_t& rule);
+
+	/**
+	 * Add an address that should always be accepted.
+	 */
+	void addAddress(ScanPrefilterAddressSource source, const uint8_t* address);
+
+	/**
+	 * Remove all addresses of a source.
+	 */
+	void clearAddresses(ScanPrefilterAddressSource source);
+
+	/**
+	 * Enable or disable the filter.
+	 * When disabled, all scanned devices are accepted.
+	 */
+	void setEnabled(bool enable);
+
+	/**
+	 * Whether a scanned device should be dispatched. Updates the statistics.
+	 */
+	bool accept(scanned_device_t* scannedDevice);
+
+	cs_scan_prefilter_stats_t& getStats();
+
+	/**
+	 * Write the statistics to the result buffer.
+	 */
+	void getStats(cs_result_t& result);
+
+private:
+	ScanPrefilter();
+
+	bool _enabled = (SCAN_PREFILTER_ENABLED == 1);
+
+	scan_prefilter_rule_t _rules[SCAN_PREFILTER_MAX_RULES];
+	uint8_t _numRules = 0;
+
+	uint8_t _bloom[SCAN_PREFILTER_SOURCE_COUNT][SCAN_PREFILTER_BLOOM_SIZE];
+
+	cs_scan_prefilter_stats_t _stats;
+
+	bool matches(const scan_prefilter_rule_t& rule, scanned_device_t* scannedDevice);
+
+	bool isAddressAccepted(const uint8_t* address);
+
+	/**
+	 * Get the bit index in the bloom filter of the given hash function.
+	 */
+	static uint16_t getBloomIndex(const uint8_t* address, uint8_t hashIndex);
+};
@@ -8,6 +8,7 @@
 
 #include <ble/cs_Stack.h>
 #include <events/cs_EventListener.h>
+#include <processing/cs_ScanDutyController.h>
 
 /** Scanner scans for BLE devices.
  */
@@ -31,6 +32,9 @@ public:
 
 	static void staticTick(Scanner* ptr);
 
+	//! Dispatches a batch of scanned devices.
+	static void onScanBatch(scanned_device_batch_t& batch);
+
 	void init();
 	//! start immediately
 	void start();
@@ -41,6 +45,11 @@ public:
 	//! stop scan immediately (no results will be sent)
 	void stop();
 
+	/**
+	 * To be called for each command advertisement for this sphere, so that the repeats of the command are heard.
+	 */
+	void addCommandHit();
+
 	void handleEvent(event_t & event);
 
 private:
@@ -54,11 +63,14 @@ private:
 
 	bool _scanning;
 	bool _running;
-	//! scan for ... ms
+	//! scan for ... ms, together with the break duration this is the scan period
 	TYPIFY(CONFIG_SCAN_DURATION) _scanDuration;
 	//! wait ... ms before starting the next scan
 	TYPIFY(CONFIG_SCAN_BREAK_DURATION) _scanBreakDuration;
 
+	//! Decides which part of the scan period is spent scanning.
+	ScanDutyController _dutyController;
+
 	uint16_t _scanCount;
 
 	app_timer_t              _appTimerData;
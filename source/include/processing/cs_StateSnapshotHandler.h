@@ -0,0 +1,94 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <behaviour/cs_BehaviourStore.h>
+#include <common/cs_Types.h>
+#include <protocol/cs_Packets.h>
+#include <storage/cs_StateSnapshot.h>
+
+#include <algorithm>
+
+/**
+ * Size of the largest behaviour type in a state snapshot.
+ */
+constexpr size_t STATE_SNAPSHOT_MAX_BEHAVIOUR_SIZE = std::max({
+		WireFormat::size<SwitchBehaviour>(),
+		WireFormat::size<TwilightBehaviour>(),
+		WireFormat::size<ExtendedSwitchBehaviour>()});
+
+/**
+ * Max size of a state snapshot to export or import: all other values, and the max number of behaviours,
+ * all of the largest type.
+ */
+constexpr size_t STATE_SNAPSHOT_MAX_SIZE = sizeof(state_snapshot_header_t)
+		+ STATE_SNAPSHOT_MAX_CONFIG_SIZE
+		+ BehaviourStore::MaxBehaviours * (sizeof(state_snapshot_entry_header_t) + STATE_SNAPSHOT_MAX_BEHAVIOUR_SIZE)
+		+ sizeof(uint32_t);
+
+static_assert(STATE_SNAPSHOT_MAX_SIZE <= 0xFFFF, "State snapshot size must fit in the total size of a chunk header");
+
+/**
+ * Handles export and import of state snapshots, see StateSnapshotWriter for the format.
+ *
+ * Export: the snapshot is created when the chunk at offset 0 is requested, after which it can be read in chunks.
+ * Import: the snapshot is written in chunks. Once complete, it is validated as a whole, and only then all values
+ * are set. The values are written to flash together, after a short delay.
+ *
+ * Only values that are persisted in flash, and that the user is allowed to both get and set, are part of a snapshot.
+ */
+class StateSnapshotHandler {
+public:
+	/**
+	 * Handle a request for a chunk of the snapshot.
+	 *
+	 * @param[in] commandData     A state_snapshot_get_packet_t.
+	 * @param[in] accessLevel     Access level of the user.
+	 * @param[out] result         Chunk header, followed by the chunk data.
+	 */
+	void handleGet(cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t & result);
+
+	/**
+	 * Handle a chunk of a snapshot to import.
+	 *
+	 * @param[in] commandData     A chunk header, followed by the chunk data.
+	 * @param[in] accessLevel     Access level of the user.
+	 * @param[out] result         Result code: ERR_WAIT_FOR_SUCCESS when more chunks are expected.
+	 */
+	void handleSet(cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t & result);
+
+	/**
+	 * Free any snapshot that is being exported or imported.
+	 */
+	void clear();
+
+private:
+	buffer_ptr_t _exportBuf = nullptr;
+	cs_buffer_size_t _exportSize = 0;
+
+	buffer_ptr_t _importBuf = nullptr;
+	cs_buffer_size_t _importSize = 0;
+	cs_buffer_size_t _importReceived = 0;
+
+	cs_ret_code_t createExport(const EncryptionAccessLevel accessLevel);
+
+	/**
+	 * Add all values of given type to the export.
+	 */
+	cs_ret_code_t addToExport(StateSnapshotWriter & writer, CS_TYPE type);
+
+	/**
+	 * Validate all entries of the imported snapshot, and only if all are valid: set them.
+	 */
+	cs_ret_code_t applyImport(const EncryptionAccessLevel accessLevel);
+
+	/**
+	 * Whether the type is part of a snapshot for given access level.
+	 */
+	bool isSnapshotType(CS_TYPE type, const EncryptionAccessLevel accessLevel);
+};
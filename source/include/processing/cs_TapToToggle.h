@@ -8,13 +8,15 @@
 
 #include "events/cs_EventListener.h"
 #include "ble/cs_Nordic.h"
+#include "processing/cs_TapToToggleTable.h"
 
-struct __attribute__((__packed__)) t2t_entry_t {
-	uint8_t address[BLE_GAP_ADDR_LEN];
-	uint16_t score; // Score that decreases every tick, and increases when rssi is above threshold.
-};
+/**
+ * Number of MAC addresses of which a score is kept up, should be a power of 2.
+ */
+#ifndef T2T_TABLE_CAPACITY
+#define T2T_TABLE_CAPACITY 16
+#endif
 
-#define T2T_LIST_COUNT 3
 #define T2T_SCORE_INC (2000 / TICK_INTERVAL_MS)
 #define T2T_SCORE_THRESHOLD (3000 / TICK_INTERVAL_MS)
 #define T2T_SCORE_MAX (5000 / TICK_INTERVAL_MS)
@@ -26,9 +28,9 @@ struct __attribute__((__packed__)) t2t_entry_t {
  * Receives data from event EVT_ADV_BACKGROUND_PARSED.
  * Checks if tap to toggle is enabled in that data.
  * Determines whether a device is considered to be close. Implemented as a leaking bucket:
- * - A score per MAC address is kept up.
+ * - A score per MAC address is kept up, in a table of T2T_TABLE_CAPACITY addresses.
  * - Each received background advertisement with an RSSI above threshold, adds to the score.
- * - Each tick the score is decreased.
+ * - Each tick the score is decreased, this is computed when the score is needed.
  * - When going from below score threshold to above, a toggle is sent.
  * Makes sure there is some time between two toggles.
  * - Each time a toggle is sent, score additions will be blocked for a certain time.
@@ -49,7 +51,13 @@ private:
 	 */
 	TYPIFY(CONFIG_TAP_TO_TOGGLE_ENABLED) enabled = CONFIG_TAP_TO_TOGGLE_ENABLED_DEFAULT;
 
-	t2t_entry_t list[T2T_LIST_COUNT];
+	TapToToggleTable<T2T_TABLE_CAPACITY> table;
+
+	/**
+	 * Number of ticks since init, used to compute the decay of the scores.
+	 */
+	uint32_t tickCount = 0;
+
 	/**
 	 * Used to count down the timeout.
 	 */
@@ -99,7 +107,12 @@ private:
 	void handleBackgroundAdvertisement(adv_background_parsed_t* adv);
 
 	/**
-	 * Decrease score of each MAC address.
+	 * Let the scan prefilter accept the MAC addresses in the table.
+	 */
+	void updateScanPrefilter();
+
+	/**
+	 * Count down the timeout.
 	 */
 	void tick();
 };
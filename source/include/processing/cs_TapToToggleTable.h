@@ -0,0 +1,142 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <structs/cs_PacketsInternal.h>
+
+#include <cstdint>
+#include <cstring>
+
+struct __attribute__((__packed__)) t2t_entry_t {
+	uint8_t address[MAC_ADDRESS_LEN];
+	uint16_t score;      // Score at scoreTick, decreases by 1 every tick after that.
+	uint32_t scoreTick;  // Tick at which the score was set.
+};
+
+/**
+ * Preallocated table of tap to toggle scores, per MAC address.
+ *
+ * - An address can only be in a few slots after the slot its hash points to,
+ *   so that looking up an address only has to compare a few addresses.
+ * - Scores decay by 1 per tick, but are only computed when needed, from the tick at which the score was set.
+ *   So no work is done per tick.
+ * - When all candidate slots of an address are in use, the one with the lowest score is replaced.
+ *
+ * @param Capacity    Number of addresses, should be a power of 2.
+ */
+template <uint8_t Capacity>
+class TapToToggleTable {
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity should be a power of 2");
+public:
+	//! Number of slots in which an address can be placed.
+	static const constexpr uint8_t probeLength = (Capacity < 4) ? Capacity : 4;
+
+	TapToToggleTable() {
+		clear();
+	}
+
+	void clear() {
+		memset(_inUse, 0, sizeof(_inUse));
+		_evictedCount = 0;
+	}
+
+	/**
+	 * Get the slot of an address, adds the address with score 0 when it's not in the table.
+	 *
+	 * @param[in] address     MAC address.
+	 * @param[in] now         Current tick.
+	 * @param[out] added      Set to true when the address was added.
+	 *
+	 * @return The slot of the address.
+	 */
+	uint8_t getOrAdd(const uint8_t* address, uint32_t now, bool& added) {
+		uint8_t home = getHome(address);
+		uint8_t best = home;
+		uint16_t bestScore = 0xFFFF;
+		for (uint8_t i = 0; i < probeLength; ++i) {
+			uint8_t slot = (home + i) & (Capacity - 1);
+			if (!_inUse[slot]) {
+				// An address is never removed, so it can't be after an unused slot.
+				best = slot;
+				bestScore = 0;
+				break;
+			}
+			if (memcmp(_entries[slot].address, address, MAC_ADDRESS_LEN) == 0) {
+				added = false;
+				return slot;
+			}
+			uint16_t score = getScore(slot, now);
+			if (score < bestScore) {
+				best = slot;
+				bestScore = score;
+			}
+		}
+		if (bestScore) {
+			_evictedCount++;
+		}
+		_inUse[best] = true;
+		memcpy(_entries[best].address, address, MAC_ADDRESS_LEN);
+		_entries[best].score = 0;
+		_entries[best].scoreTick = now;
+		added = true;
+		return best;
+	}
+
+	/**
+	 * Get the score of a slot at given tick.
+	 */
+	uint16_t getScore(uint8_t slot, uint32_t now) {
+		uint32_t elapsed = now - _entries[slot].scoreTick;
+		return (elapsed < _entries[slot].score) ? _entries[slot].score - elapsed : 0;
+	}
+
+	/**
+	 * Increase the score of a slot.
+	 *
+	 * @param[in] slot        Slot, as returned by getOrAdd().
+	 * @param[in] increment   Value to add to the score.
+	 * @param[in] max         The score is capped at this value.
+	 * @param[in] now         Current tick.
+	 *
+	 * @return The score before the increment.
+	 */
+	uint16_t increaseScore(uint8_t slot, uint16_t increment, uint16_t max, uint32_t now) {
+		uint16_t prevScore = getScore(slot, now);
+		uint32_t score = prevScore + increment;
+		_entries[slot].score = (score > max) ? max : score;
+		_entries[slot].scoreTick = now;
+		return prevScore;
+	}
+
+	bool isInUse(uint8_t slot) {
+		return _inUse[slot];
+	}
+
+	const uint8_t* getAddress(uint8_t slot) {
+		return _entries[slot].address;
+	}
+
+	/**
+	 * Number of addresses that were replaced while they still had a score.
+	 */
+	uint32_t getEvictedCount() {
+		return _evictedCount;
+	}
+
+private:
+	t2t_entry_t _entries[Capacity];
+	bool _inUse[Capacity];
+	uint32_t _evictedCount;
+
+	static uint8_t getHome(const uint8_t* address) {
+		uint32_t hash = 0;
+		for (uint8_t i = 0; i < MAC_ADDRESS_LEN; ++i) {
+			hash = hash * 31 + address[i];
+		}
+		return ((hash * 2654435761U) >> 24) & (Capacity - 1);
+	}
+};
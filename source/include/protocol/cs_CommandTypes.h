@@ -16,6 +16,8 @@ enum CommandHandlerTypes {
 	CTRL_CMD_GET_BOOTLOADER_VERSION      = 4,
 	CTRL_CMD_GET_UICR_DATA               = 5,
 	CTRL_CMD_SET_IBEACON_CONFIG_ID       = 6,
+	CTRL_CMD_STATE_SNAPSHOT_GET          = 7,
+	CTRL_CMD_STATE_SNAPSHOT_SET          = 8,
 
 	CTRL_CMD_RESET                       = 10,
 	CTRL_CMD_GOTO_DFU                    = 11,
@@ -52,9 +54,17 @@ enum CommandHandlerTypes {
 	CTRL_CMD_GET_SWITCH_HISTORY          = 82,
 	CTRL_CMD_GET_POWER_SAMPLES           = 83,
 //	CTLR_CMD_GET_CPU_STATS               = 84,
+	CTRL_CMD_GET_MESH_LINK_QUALITY       = 85,
+	CTRL_CMD_GET_MESH_TELEMETRY          = 86,
+	CTRL_CMD_RESET_MESH_TELEMETRY        = 87,
+	CTRL_CMD_GET_SCAN_PREFILTER_STATS    = 88,
+	CTRL_CMD_GET_SCAN_DUTY_STATS         = 89,
 
 	CTRL_CMD_MICROAPP_UPLOAD             = 90,
 
+	CTRL_CMD_GET_EXTERNAL_STATE_STATS    = 91,
+	CTRL_CMD_GET_STORAGE_GC_STATS        = 92,
+
 	CTRL_CMD_UNKNOWN                     = 0xFFFF
 };
 
@@ -120,6 +120,21 @@ struct __attribute__((__packed__)) state_packet_header_t {
 	uint8_t reserved = 0;
 };
 
+/**
+ * State snapshot get packet.
+ */
+struct __attribute__((__packed__)) state_snapshot_get_packet_t {
+	uint16_t offset;
+};
+
+/**
+ * Header of a chunk of a state snapshot, followed by the chunk data.
+ */
+struct __attribute__((__packed__)) state_snapshot_chunk_header_t {
+	uint16_t offset;
+	uint16_t totalSize;
+};
+
 /**
  * Flags to determine how to send the mesh message.
  *
@@ -426,6 +441,76 @@ struct __attribute__((packed)) cs_switch_history_item_t {
 	{}
 };
 
+struct __attribute__((packed)) cs_mesh_link_quality_header_t {
+	uint8_t numGoodLinks;         // Number of neighbours with a good link.
+	uint8_t transmissions;        // Number of transmissions used for multicast messages with the default number of transmissions.
+	uint8_t count;                // Number of items.
+};
+
+struct __attribute__((packed)) cs_mesh_link_quality_item_t {
+	stone_id_t stoneId;           // Stone ID of the neighbour.
+	int8_t rssi;                  // Average RSSI of messages received directly from the neighbour.
+	uint8_t receptionRate;        // Percentage of messages of the neighbour that were received directly.
+	uint16_t lastSeenSeconds;     // Seconds since a message was received directly from the neighbour.
+};
+
+#define MESH_TELEMETRY_NUM_MODELS 3
+#define MESH_TELEMETRY_NUM_TYPES 24
+#define MESH_TELEMETRY_HISTOGRAM_SIZE 8
+
+struct __attribute__((packed)) cs_mesh_telemetry_model_t {
+	uint32_t queued;              // Number of messages added to the queue.
+	uint32_t dropped;             // Number of messages not added, because the queue was full.
+	uint32_t sent;                // Number of messages handed to the mesh stack, including repeated transmissions and retries.
+	uint32_t received;            // Number of messages received.
+	uint32_t receivedRelayed;     // Number of messages received via other stones.
+	uint16_t retries;             // Number of retries of acked messages.
+	uint16_t ackTimeouts;         // Number of acked messages that timed out.
+};
+
+struct __attribute__((packed)) cs_mesh_telemetry_type_t {
+	uint16_t queued;              // Number of messages of this type added to a queue.
+	uint16_t received;            // Number of messages of this type received.
+};
+
+struct __attribute__((packed)) cs_mesh_telemetry_t {
+	uint32_t durationSeconds;     // Seconds since the telemetry was reset.
+	cs_mesh_telemetry_model_t models[MESH_TELEMETRY_NUM_MODELS];      // Multicast, multicast acked, unicast.
+	cs_mesh_telemetry_type_t types[MESH_TELEMETRY_NUM_TYPES];         // Per message type, the last one counts all higher types.
+	uint16_t queueWaitHistogram[MESH_TELEMETRY_HISTOGRAM_SIZE];       // Time from queueing a message until it's first sent.
+	uint16_t ackedLatencyHistogram[MESH_TELEMETRY_HISTOGRAM_SIZE];    // Time from queueing an acked message until all acks are received.
+};
+
+struct __attribute__((packed)) cs_scan_prefilter_stats_t {
+	uint32_t accepted;            // Number of scanned devices that were dispatched.
+	uint32_t acceptedByAddress;   // Number of those that did not match a rule, but were accepted by address.
+	uint32_t rejected;            // Number of scanned devices that were dropped.
+};
+
+struct __attribute__((packed)) cs_scan_duty_stats_t {
+	uint8_t dutyPercent;          // Percentage of the scan period that is currently spent scanning.
+	uint8_t minPercent;           // Lowest duty.
+	uint8_t maxPercent;           // Highest duty.
+	uint16_t hitsPerSecondCenti;  // Average number of relevant scanned devices per second, in 1/100.
+	uint32_t totalHits;           // Number of relevant scanned devices since boot.
+};
+
+struct __attribute__((packed)) cs_external_state_stats_t {
+	uint32_t averageStaleness;    // Average time in seconds since the broadcasted states of other stones were received.
+	uint32_t numBroadcasted;      // Number of broadcasted states of other stones that the average is over.
+};
+
+struct __attribute__((packed)) cs_storage_gc_stats_t {
+	uint32_t runs;                // Number of garbage collections started, for any reason.
+	uint32_t idleRuns;            // Number of garbage collections started because the device was idle.
+	uint32_t urgentRuns;          // Number of garbage collections started because the reserve was reached.
+	uint32_t deferredRuns;        // Number of garbage collections started because it had been postponed for too long.
+	uint32_t reactiveRuns;        // Number of garbage collections started because a write failed due to lack of space.
+	uint32_t reclaimedWords;      // Total number of words reclaimed.
+	uint32_t lastDurationMs;      // Duration of the last garbage collection, during which writes are stalled.
+	uint32_t maxDurationMs;       // Longest duration of a garbage collection.
+};
+
 
 // ========================= functions =========================
 
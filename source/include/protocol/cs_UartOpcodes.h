@@ -43,6 +43,7 @@ enum UartOpcodeTx {
 	UART_OPCODE_TX_MESH_STATE_PART_1 =                104, // Received part of state of external stone, payload: cs_mesh_model_msg_state_1_t
 	UART_OPCODE_TX_MESH_RESULT =                      105, // Received the result of a mesh command, payload: uart_msg_mesh_result_packet_header_t + data.
 	UART_OPCODE_TX_MESH_ACK_ALL_RESULT =              106, // Whether all stone IDs were acked, payload: result_packet_header_t.
+	UART_OPCODE_TX_MESH_TELEMETRY =                   107, // Mesh traffic telemetry, sent at an interval, payload: cs_mesh_telemetry_t.
 
 	UART_OPCODE_TX_ADVERTISEMENT_ENABLED =            10000, // Whether advertising is enabled (payload: bool)
 	UART_OPCODE_TX_MESH_ENABLED =                     10001, // Whether mesh is enabled (payload: bool)
@@ -26,6 +26,7 @@ bool state0IsValid(const cs_mesh_model_msg_state_0_t* packet, size16_t size);
 bool state1IsValid(const cs_mesh_model_msg_state_1_t* packet, size16_t size);
 bool profileLocationIsValid(const cs_mesh_model_msg_profile_location_t* packet, size16_t size);
 bool setBehaviourSettingsIsValid(const behaviour_settings_t* packet, size16_t size);
+bool aggregateIsValid(uint8_t* packet, size16_t size);
 
 cs_mesh_model_msg_type_t getType(const uint8_t* meshMsg);
 
@@ -78,6 +79,32 @@ bool setMeshMessage(cs_mesh_model_msg_type_t type, const uint8_t* payload, size1
  */
 bool setMeshPayload(uint8_t* meshMsg, size16_t meshMsgSize, const uint8_t* payload, size16_t payloadSize);
 
+/**
+ * Get the next entry of an aggregate message payload.
+ *
+ * @param[in]      payload        Payload of the aggregate message.
+ * @param[in]      payloadSize    Size of the payload.
+ * @param[in,out]  offset         Offset of the entry, start with 0. Set to offset of the next entry on success.
+ * @param[out]     type           Set to the mesh msg type of the entry.
+ * @param[out]     entryPayload   Set to the payload of the entry.
+ * @param[out]     entrySize      Set to the payload size of the entry.
+ * @retval                        True when an entry was found, false when at the end, or when the entry doesn't fit.
+ */
+bool getNextAggregateEntry(uint8_t* payload, size16_t payloadSize, size16_t& offset, cs_mesh_model_msg_type_t& type, uint8_t*& entryPayload, size16_t& entrySize);
+
+/**
+ * Add an entry to an aggregate message payload.
+ *
+ * @param[in]      type           Mesh msg type of the entry.
+ * @param[in]      entryPayload   Payload of the entry.
+ * @param[in]      entrySize      Payload size of the entry.
+ * @param[in,out]  payload        Payload of the aggregate message, must already be allocated.
+ * @param[in]      payloadSize    Size of the allocated payload.
+ * @param[in,out]  offset         Offset to write the entry, set to the offset of the next entry on success.
+ * @retval                        True on success.
+ */
+bool addAggregateEntry(cs_mesh_model_msg_type_t type, const uint8_t* entryPayload, size16_t entrySize, uint8_t* payload, size16_t payloadSize, size16_t& offset);
+
 CommandHandlerTypes getCtrlCmdType(cs_mesh_model_msg_type_t meshType);
 cs_mesh_model_msg_type_t getMeshType(CommandHandlerTypes ctrlCmdType);
 
@@ -23,6 +23,7 @@ enum cs_mesh_model_opcode_t {
 	CS_MESH_MODEL_OPCODE_UNICAST_REPLY = 0xC2,
 	CS_MESH_MODEL_OPCODE_MULTICAST_RELIABLE_MSG = 0xC3,
 	CS_MESH_MODEL_OPCODE_MULTICAST_REPLY = 0xC4,
+	CS_MESH_MODEL_OPCODE_UNICAST_MSG = 0xC5,
 };
 
 /**
@@ -62,6 +63,9 @@ enum cs_mesh_model_msg_type_t {
 	CS_MESH_MODEL_TYPE_STATE_SET                 = 17, // Payload: cs_mesh_model_msg_state_header_ext_t + payload
 	CS_MESH_MODEL_TYPE_RESULT                    = 18, // Payload: cs_mesh_model_msg_result_header_t + payload
 	CS_MESH_MODEL_TYPE_SET_IBEACON_CONFIG_ID     = 19, // Payload: set_ibeacon_config_id_packet_t
+	CS_MESH_MODEL_TYPE_AGGREGATE                 = 20, // Payload: list of cs_mesh_model_msg_aggregate_entry_header_t + payload
+	CS_MESH_MODEL_TYPE_BULK_ACK_REQUEST          = 21, // Payload: cs_mesh_model_msg_bulk_ack_request_t
+	CS_MESH_MODEL_TYPE_BULK_CHUNK                = 22, // Payload: cs_mesh_model_msg_bulk_chunk_header_t + chunk data
 
 	CS_MESH_MODEL_TYPE_UNKNOWN                   = 255
 };
@@ -158,3 +162,41 @@ struct __attribute__((__packed__)) cs_mesh_model_msg_result_header_t {
 	uint8_t msgType; // Mesh msg type of which this is the result.
 	uint8_t retCode;
 };
+
+/**
+ * Header of each entry in an aggregate message, followed by the payload of the entry.
+ *
+ * Only types that fit in 5 bits can be aggregated.
+ */
+struct __attribute__((__packed__)) cs_mesh_model_msg_aggregate_entry_header_t {
+	uint8_t type : 5;             // Mesh msg type of the entry.
+	uint8_t size : 3;             // Payload size of the entry.
+};
+
+/**
+ * Sent reliably by the sender of a bulk transfer, to start the transfer, and to get the chunks that have been received.
+ * The result data of the reply is a cs_mesh_model_msg_bulk_ack_t.
+ */
+struct __attribute__((__packed__)) cs_mesh_model_msg_bulk_ack_request_t {
+	uint8_t transferId;
+	uint8_t seq;                  // Sequence number, copied to the ack. Makes each ack unique.
+	uint8_t type;                 // Type of data, for the receiver.
+	uint16_t size;                // Total size of the data.
+	uint16_t checksum;            // Fletcher32 of the data, folded to 16 bits. Tells transfers with the same ID apart.
+};
+
+#define MESH_BULK_ACK_BITMASK_SIZE 3
+
+struct __attribute__((__packed__)) cs_mesh_model_msg_bulk_ack_t {
+	uint8_t seq;
+	uint8_t nextIndex;            // All chunks before this index have been received.
+	uint8_t bitmask[MESH_BULK_ACK_BITMASK_SIZE]; // Bit i is set when chunk nextIndex + i has been received.
+};
+
+/**
+ * Header of a chunk of a bulk transfer, sent unacked, followed by the chunk data.
+ */
+struct __attribute__((__packed__)) cs_mesh_model_msg_bulk_chunk_header_t {
+	uint8_t transferId;
+	uint8_t index;
+};
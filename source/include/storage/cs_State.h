@@ -12,6 +12,8 @@
 #include <drivers/cs_Storage.h>
 #include <drivers/cs_Timer.h>
 #include <protocol/cs_ErrorCodes.h>
+#include <storage/cs_StateCache.h>
+#include <storage/cs_StateSubscriptions.h>
 #include <vector>
 
 constexpr const char* TypeName(OperationMode const & mode) {
@@ -270,6 +272,33 @@ public:
 	 */
 	cs_ret_code_t remove(const CS_TYPE & type, cs_state_id_t id, const PersistenceMode mode = PersistenceMode::STRATEGY1);
 
+	/**
+	 * Subscribe to changes of a state type.
+	 *
+	 * The subscriber gets the old and new value, but only when a set actually changed the value.
+	 *
+	 * @param[in] type            State type.
+	 * @param[in] subscriber      Subscriber to call on changes.
+	 * @return                    Return code.
+	 */
+	cs_ret_code_t subscribe(CS_TYPE type, StateSubscriber* subscriber);
+
+	/**
+	 * Unsubscribe from changes of a state type.
+	 *
+	 * @param[in] type            State type.
+	 * @param[in] subscriber      Subscriber that was subscribed.
+	 * @return                    Return code.
+	 */
+	cs_ret_code_t unsubscribe(CS_TYPE type, StateSubscriber* subscriber);
+
+	/**
+	 * Get statistics of the cache of values with default location FLASH_CACHED.
+	 */
+	const state_cache_stats_t & getCacheStats() {
+		return _cache.getStats();
+	}
+
 	/**
 	 * Erase all used persistent storage.
 	 */
@@ -452,6 +481,32 @@ protected:
 
 	bool _performingFactoryReset = false;
 
+	StateSubscriptions _subscriptions;
+
+	/**
+	 * Keeps up which values of types with default location FLASH_CACHED are in RAM.
+	 */
+	StateCache _cache;
+
+	/**
+	 * Get a value of a type with default location FLASH_CACHED that is not in RAM, and add it to RAM.
+	 *
+	 * @param[in,out] data        Data struct with state type, id, data, and size.
+	 * @return                    Return code.
+	 */
+	cs_ret_code_t loadFromFlashCached(cs_state_data_t & data);
+
+	/**
+	 * Remove least recently used values of types with default location FLASH_CACHED from RAM, until the cache
+	 * is small enough.
+	 */
+	void evictFromCache();
+
+	/**
+	 * Unpin a cached value, once it has been written to flash.
+	 */
+	void handleWriteDone(const cs_type_and_id_t & typeAndId);
+
 private:
 
 	//! State constructor, singleton, thus made private
@@ -0,0 +1,103 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <common/cs_Types.h>
+#include <vector>
+
+struct __attribute__((packed)) state_cache_stats_t {
+	uint32_t hits = 0;
+	uint32_t misses = 0;
+	uint32_t evictions = 0;
+	//! Total size of the cached values.
+	uint32_t size = 0;
+	//! Highest total size of the cached values.
+	uint32_t maxSize = 0;
+};
+
+/**
+ * Keeps up the working set of state values with persistence mode FLASH_CACHED that are held in RAM.
+ *
+ * This class only does the bookkeeping: which values are cached, their size, and which one was least recently used.
+ * The values themselves are stored by State.
+ *
+ * Values that are pinned are never evicted, for example because they still have to be written to flash.
+ */
+class StateCache {
+public:
+	/**
+	 * @param[in] maxSize         Total size of cached values, above which values are evicted.
+	 */
+	StateCache(uint32_t maxSize);
+
+	/**
+	 * Mark a value as most recently used, adds it when it's not cached yet.
+	 */
+	void touch(CS_TYPE type, cs_state_id_t id, size16_t size);
+
+	/**
+	 * Pin or unpin a cached value.
+	 */
+	void setPinned(CS_TYPE type, cs_state_id_t id, bool pinned);
+
+	/**
+	 * Remove a value from the cache.
+	 */
+	void remove(CS_TYPE type, cs_state_id_t id);
+
+	/**
+	 * Get the value that should be evicted next, if any.
+	 *
+	 * @param[out] type           Type of the value to evict.
+	 * @param[out] id             Id of the value to evict.
+	 * @return                    True when the cache is too large, and an unpinned value can be evicted.
+	 */
+	bool getEvictionCandidate(CS_TYPE & type, cs_state_id_t & id);
+
+	/**
+	 * Remove an evicted value from the cache.
+	 */
+	void evicted(CS_TYPE type, cs_state_id_t id);
+
+	void addHit() {
+		_stats.hits++;
+	}
+
+	void addMiss() {
+		_stats.misses++;
+	}
+
+	const state_cache_stats_t & getStats() {
+		return _stats;
+	}
+
+	/**
+	 * Get the percentage of gets that were served from the cache.
+	 */
+	uint8_t getHitRatePercent();
+
+private:
+	struct __attribute__((packed)) state_cache_entry_t {
+		CS_TYPE type;
+		cs_state_id_t id;
+		size16_t size;
+		bool pinned;
+		uint32_t lastUsed;
+	};
+
+	std::vector<state_cache_entry_t> _entries;
+
+	uint32_t _maxSize;
+
+	//! Incremented on each use, so that a higher value means more recently used.
+	uint32_t _useCounter = 0;
+
+	state_cache_stats_t _stats;
+
+	state_cache_entry_t* find(CS_TYPE type, cs_state_id_t id);
+};
@@ -70,6 +70,10 @@ cs_ret_code_t getDefault(cs_state_data_t & data, const boards_config_t& boardsCo
  * a fallback when the FLASH value is not present. Moreover, we can have a list that specifies if a value should be
  * in RAM or in FLASH by default. This complete persistence strategy is called STRATEGY1.
  *
+ * 4. Large values that there can be many of, like behaviours, are stored in FLASH, but only a limited working set of
+ * them is kept in RAM. The least recently used values are evicted from RAM, and read from FLASH again when needed.
+ * This is called FLASH_CACHED, and is only used as default location.
+ *
  * NOTE. Suppose we have a new firmware available and we definitely want to use a new FIRMWARE_DEFAULT value. For
  * example, we use more peripherals and need to have a CONFIG_BOOT_DELAY that is higher or else it will be in an
  * infinite reboot loop. Before we upload the new firmware to the Crownstone, we need to explicitly clear the value.
@@ -81,7 +85,8 @@ enum class PersistenceMode: uint8_t {
 	RAM,
 	FIRMWARE_DEFAULT,
 	STRATEGY1,
-	NEITHER_RAM_NOR_FLASH
+	NEITHER_RAM_NOR_FLASH,
+	FLASH_CACHED
 };
 
 PersistenceModeGet toPersistenceModeGet(uint8_t mode);
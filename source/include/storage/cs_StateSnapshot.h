@@ -0,0 +1,133 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <protocol/cs_ErrorCodes.h>
+#include <protocol/cs_Typedefs.h>
+#include <cstdint>
+
+#define STATE_SNAPSHOT_PROTOCOL_VERSION 0
+
+/**
+ * A state snapshot is a list of state values, serialized as:
+ *   state_snapshot_header_t
+ *   numEntries x (state_snapshot_entry_header_t + value)
+ *   uint32_t checksum: Fletcher32 over all preceding bytes.
+ */
+struct __attribute__((__packed__)) state_snapshot_header_t {
+	uint8_t protocol;
+	uint16_t numEntries;
+};
+
+struct __attribute__((__packed__)) state_snapshot_entry_header_t {
+	uint16_t type;
+	uint16_t id;
+	uint16_t size;
+};
+
+/**
+ * A single entry of a snapshot. The value points into the snapshot buffer.
+ */
+struct state_snapshot_entry_t {
+	uint16_t type;
+	uint16_t id;
+	uint8_t* value;
+	uint16_t size;
+};
+
+/**
+ * Serializes state values into a snapshot.
+ */
+class StateSnapshotWriter {
+public:
+	/**
+	 * @param[in] buf             Buffer to write the snapshot to.
+	 * @param[in] size            Size of the buffer.
+	 */
+	StateSnapshotWriter(buffer_ptr_t buf, cs_buffer_size_t size);
+
+	/**
+	 * Add a state value to the snapshot.
+	 *
+	 * @retval ERR_SUCCESS                  When added.
+	 * @retval ERR_BUFFER_TOO_SMALL         When the value does not fit, including the checksum.
+	 * @retval ERR_WRONG_STATE              When already finalized.
+	 */
+	cs_ret_code_t add(uint16_t type, uint16_t id, const uint8_t* value, uint16_t size);
+
+	/**
+	 * Write the header and checksum. No values can be added afterwards.
+	 *
+	 * @retval ERR_SUCCESS                  When finalized.
+	 * @retval ERR_BUFFER_TOO_SMALL         When the buffer can't even hold an empty snapshot.
+	 */
+	cs_ret_code_t finalize();
+
+	/**
+	 * Get the size of the snapshot, only valid after finalize().
+	 */
+	cs_buffer_size_t getSize() {
+		return _size;
+	}
+
+private:
+	buffer_ptr_t _buf;
+	cs_buffer_size_t _bufSize;
+	cs_buffer_size_t _size;
+	uint16_t _numEntries = 0;
+	bool _finalized = false;
+};
+
+/**
+ * Parses a snapshot.
+ *
+ * The whole snapshot is validated at once, so that it can be applied all or nothing.
+ */
+class StateSnapshotReader {
+public:
+	StateSnapshotReader(buffer_ptr_t buf, cs_buffer_size_t size);
+
+	/**
+	 * Check the header, the checksum, and whether all entries fit exactly.
+	 *
+	 * @retval ERR_SUCCESS                  When valid.
+	 * @retval ERR_PROTOCOL_UNSUPPORTED     When the protocol version is not supported.
+	 * @retval ERR_WRONG_PAYLOAD_LENGTH     When the size doesn't match the entries.
+	 * @retval ERR_INVALID_MESSAGE          When the checksum doesn't match.
+	 */
+	cs_ret_code_t validate();
+
+	/**
+	 * Number of entries, only valid after validate().
+	 */
+	uint16_t getNumEntries() {
+		return _numEntries;
+	}
+
+	/**
+	 * Get the next entry, starts at the first entry after validate().
+	 *
+	 * @retval ERR_SUCCESS                  When an entry was read.
+	 * @retval ERR_NOT_FOUND                When there are no more entries.
+	 * @retval ERR_WRONG_STATE              When not validated.
+	 */
+	cs_ret_code_t getNext(state_snapshot_entry_t & entry);
+
+	/**
+	 * Start again at the first entry.
+	 */
+	void rewind();
+
+private:
+	buffer_ptr_t _buf;
+	cs_buffer_size_t _size;
+	uint16_t _numEntries = 0;
+	bool _valid = false;
+	cs_buffer_size_t _readIndex = 0;
+	uint16_t _readEntries = 0;
+};
@@ -0,0 +1,82 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <cfg/cs_Config.h>
+#include <common/cs_Types.h>
+
+/**
+ * A change of a state value.
+ */
+struct state_change_t {
+	CS_TYPE type;
+	cs_state_id_t id;
+	//! Previous value, or nullptr when there was no previous value.
+	const uint8_t* oldValue;
+	const uint8_t* newValue;
+	size16_t size;
+};
+
+/**
+ * State subscriber.
+ */
+class StateSubscriber {
+public:
+	virtual ~StateSubscriber() {};
+
+	/**
+	 * Handle a state change.
+	 *
+	 * Only called when the value actually changed, the values are only valid during this call.
+	 */
+	virtual void handleStateChange(const state_change_t & change) = 0;
+};
+
+/**
+ * Keeps up which subscribers are subscribed to which state types.
+ *
+ * Unlike events, which are dispatched to all listeners for every set, subscribers only get called for the types
+ * they subscribed to, and only when the value changed.
+ */
+class StateSubscriptions {
+public:
+	/**
+	 * Subscribe to changes of given type.
+	 *
+	 * @retval ERR_SUCCESS                  When subscribed, or already subscribed.
+	 * @retval ERR_NO_SPACE                 When there are already STATE_MAX_SUBSCRIPTIONS subscriptions.
+	 */
+	cs_ret_code_t subscribe(CS_TYPE type, StateSubscriber* subscriber);
+
+	/**
+	 * Unsubscribe from changes of given type.
+	 *
+	 * @retval ERR_SUCCESS                  When unsubscribed.
+	 * @retval ERR_NOT_FOUND                When not subscribed.
+	 */
+	cs_ret_code_t unsubscribe(CS_TYPE type, StateSubscriber* subscriber);
+
+	/**
+	 * Whether anyone is subscribed to given type.
+	 */
+	bool isSubscribed(CS_TYPE type);
+
+	/**
+	 * Call all subscribers of the changed type.
+	 */
+	void notify(const state_change_t & change);
+
+private:
+	struct __attribute__((__packed__)) subscription_t {
+		CS_TYPE type;
+		StateSubscriber* subscriber;
+	};
+
+	subscription_t _subscriptions[STATE_MAX_SUBSCRIPTIONS];
+	uint8_t _numSubscriptions = 0;
+};
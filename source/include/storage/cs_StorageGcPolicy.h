@@ -0,0 +1,145 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <protocol/cs_Packets.h>
+#include <structs/cs_PacketsInternal.h>
+
+#include <cstdint>
+
+/**
+ * Thresholds of the garbage collection policy.
+ */
+struct storage_gc_config_t {
+	//! Percentage of used words that have to be freeable, before an idle garbage collection is considered.
+	uint8_t dirtyRatioPercent;
+	//! Minimal number of freeable words, before any garbage collection is considered.
+	uint32_t minFreeableWords;
+	//! When the largest contiguous free space drops below this number of words, collect garbage without waiting for idle.
+	uint32_t reserveWords;
+	//! Time without writes, connections or mesh activity before the device is considered idle.
+	uint32_t idleTimeMs;
+	//! Max number of events in the scheduler queue for the device to be considered idle.
+	uint16_t maxSchedulerQueueUse;
+	//! Max time to postpone garbage collection when the dirty ratio is reached, but the device is never idle.
+	uint32_t maxDeferMs;
+};
+
+/**
+ * Flash usage, as reported by the storage backend.
+ */
+struct storage_gc_flash_stats_t {
+	//! Number of words written, including the ones that can be freed.
+	uint32_t usedWords;
+	//! Number of words that will be freed by garbage collection.
+	uint32_t freeableWords;
+	//! Largest number of contiguous free words that can be used for a write.
+	uint32_t largestContiguousWords;
+};
+
+enum class StorageGcReason : uint8_t {
+	NONE = 0,
+	IDLE,
+	URGENT,
+	DEFERRED,
+	REACTIVE,
+};
+
+/**
+ * Decides when to perform garbage collection of flash storage.
+ *
+ * Garbage collection blocks all writes until it is done. Without a policy, it is only started once a write fails
+ * due to lack of space, so that write has to wait for a full garbage collection.
+ * This class instead starts garbage collection when enough space can be reclaimed and the device is idle.
+ *
+ * Writes never stall longer than a single garbage collection, because:
+ * - Garbage collection is started before free space drops below the reserve, so writes don't run out of space.
+ * - Garbage collection is never postponed longer than the max defer time, so the reserve is not eaten up by waiting.
+ *
+ * This class only holds the logic: it doesn't access flash or time itself, so it can be tested on the host.
+ * Times are in ms, and may overflow.
+ */
+class StorageGcPolicy {
+public:
+	void setConfig(const storage_gc_config_t & config);
+
+	/**
+	 * To be called when a record has been written or removed.
+	 */
+	void onWrite(uint32_t nowMs);
+
+	/**
+	 * To be called when there was mesh activity.
+	 */
+	void onMeshActivity(uint32_t nowMs);
+
+	/**
+	 * To be called when a device connects or disconnects.
+	 */
+	void setConnected(bool connected, uint32_t nowMs);
+
+	/**
+	 * Check whether garbage collection should be started now.
+	 *
+	 * @param[in] stats                Current flash usage.
+	 * @param[in] schedulerQueueUse    Number of events in the scheduler queue.
+	 * @param[in] nowMs                Current time.
+	 *
+	 * @return                         Reason to collect garbage, or NONE when it should not be done now.
+	 */
+	StorageGcReason check(const storage_gc_flash_stats_t & stats, uint16_t schedulerQueueUse, uint32_t nowMs);
+
+	/**
+	 * To be called when garbage collection has started.
+	 */
+	void onStarted(StorageGcReason reason, const storage_gc_flash_stats_t & stats, uint32_t nowMs);
+
+	/**
+	 * To be called when garbage collection is done, successful or not.
+	 */
+	void onDone(const storage_gc_flash_stats_t & stats, uint32_t nowMs);
+
+	/**
+	 * Whether garbage collection is in progress.
+	 */
+	bool isRunning() {
+		return _running;
+	}
+
+	/**
+	 * Statistics of the garbage collections since boot.
+	 */
+	const cs_storage_gc_stats_t & getTelemetry() {
+		return _telemetry;
+	}
+
+	/**
+	 * Write the statistics of the garbage collections to the result.
+	 */
+	void getStats(cs_result_t& result);
+
+private:
+	storage_gc_config_t _config = {};
+	cs_storage_gc_stats_t _telemetry = {};
+
+	bool _connected = false;
+	bool _running = false;
+
+	uint32_t _lastActivityMs = 0;
+
+	//! Whether the dirty ratio has been reached, and garbage collection is waiting for the device to be idle.
+	bool _pending = false;
+	uint32_t _pendingSinceMs = 0;
+
+	uint32_t _startedMs = 0;
+	uint32_t _startFreeableWords = 0;
+
+	void onActivity(uint32_t nowMs);
+
+	bool isIdle(uint16_t schedulerQueueUse, uint32_t nowMs);
+};
@@ -0,0 +1,112 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * RAM index of the location of records in flash, by file id and record key.
+ *
+ * - Entries are kept sorted by file id and record key, so that a lookup is a binary search.
+ * - Only one entry per file id and record key: setting it again replaces the record descriptor.
+ *
+ * @param RecordDesc    Record descriptor, should have a record_id field, like fds_record_desc_t.
+ */
+template <typename RecordDesc>
+class StorageRecordIndex {
+public:
+	struct entry_t {
+		uint32_t key;
+		RecordDesc recordDesc;
+	};
+
+	/**
+	 * Remove all entries.
+	 */
+	void clear() {
+		_entries.clear();
+	}
+
+	/**
+	 * Find the record descriptor of a file id and record key.
+	 *
+	 * @return Pointer to the record descriptor, or NULL when not found.
+	 *         Only valid until the index is modified.
+	 */
+	RecordDesc* find(uint16_t fileId, uint16_t recordKey) {
+		uint32_t key = getKey(fileId, recordKey);
+		auto it = lowerBound(key);
+		if (it == _entries.end() || it->key != key) {
+			return NULL;
+		}
+		return &(it->recordDesc);
+	}
+
+	/**
+	 * Add a record descriptor, or replace it when the file id and record key are already indexed.
+	 */
+	void set(uint16_t fileId, uint16_t recordKey, const RecordDesc & recordDesc) {
+		uint32_t key = getKey(fileId, recordKey);
+		auto it = lowerBound(key);
+		if (it != _entries.end() && it->key == key) {
+			it->recordDesc = recordDesc;
+			return;
+		}
+		entry_t entry;
+		entry.key = key;
+		entry.recordDesc = recordDesc;
+		_entries.insert(it, entry);
+	}
+
+	/**
+	 * Remove the entry with given record id.
+	 *
+	 * @return True when an entry was removed.
+	 */
+	bool remove(uint32_t recordId) {
+		for (auto it = _entries.begin(); it != _entries.end(); it++) {
+			if (it->recordDesc.record_id == recordId) {
+				_entries.erase(it);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * Remove all entries with given file id.
+	 */
+	void removeFile(uint16_t fileId) {
+		auto first = lowerBound(getKey(fileId, 0));
+		auto last = first;
+		while (last != _entries.end() && (last->key >> 16) == fileId) {
+			last++;
+		}
+		_entries.erase(first, last);
+	}
+
+	size_t size() {
+		return _entries.size();
+	}
+
+private:
+	std::vector<entry_t> _entries;
+
+	static uint32_t getKey(uint16_t fileId, uint16_t recordKey) {
+		return ((uint32_t)fileId << 16) | recordKey;
+	}
+
+	typename std::vector<entry_t>::iterator lowerBound(uint32_t key) {
+		return std::lower_bound(_entries.begin(), _entries.end(), key, [](const entry_t & entry, uint32_t key) -> bool {
+			return entry.key < key;
+		});
+	}
+};
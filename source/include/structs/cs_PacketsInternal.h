@@ -84,6 +84,27 @@ struct cs_result_t {
 	{}
 };
 
+/**
+ * Location of an AD structure in advertisement data.
+ */
+struct __attribute__((packed)) adv_field_t {
+	//! Offset of the data of the AD structure, after the type. 0 when not found.
+	uint8_t offset;
+	uint8_t len;
+};
+
+/**
+ * Index of the AD structures that handlers of scanned devices look for.
+ * Built once per scanned device, so that not every handler has to parse the advertisement data again.
+ * Holds the first AD structure of each type.
+ */
+struct __attribute__((packed)) adv_index_t {
+	adv_field_t manufacturerData;
+	adv_field_t services16bit;
+	adv_field_t services128bit;
+	adv_field_t serviceData16bit;
+};
+
 /**
  * Scanned device.
  */
@@ -95,10 +116,33 @@ struct __attribute__((packed)) scanned_device_t {
 	uint8_t dataSize;
 //	uint8_t data[ADVERTISEMENT_DATA_MAX_SIZE];
 	uint8_t *data;
+	//! Index of the data, see BLEutil::indexAdvData().
+	adv_index_t advIndex;
 	// See ble_gap_evt_adv_report_t
 	// More possibilities: addressType, connectable, isScanResponse, directed, scannable, extended advertisements, etc.
 };
 
+/**
+ * Scanned device in a batch, with its own copy of the advertisement data.
+ */
+struct scanned_device_record_t {
+	//! The data points to the data of this record. When duplicates are collapsed, the RSSI is the average.
+	scanned_device_t device;
+	//! Highest RSSI of the collapsed duplicates.
+	int8_t rssiMax;
+	//! Number of advertisements collapsed into this record.
+	uint8_t count;
+	uint8_t data[ADVERTISEMENT_DATA_MAX_SIZE];
+};
+
+/**
+ * Batch of scanned devices, see ScanAggregator.
+ */
+struct scanned_device_batch_t {
+	uint8_t size;
+	scanned_device_record_t* records;
+};
+
 
 /**
  * A single multi switch command.
@@ -176,6 +220,27 @@ struct cs_mesh_msg_t {
 	cs_mesh_msg_urgency urgency = CS_MESH_URGENCY_LOW;
 };
 
+/**
+ * Data sent or received with a bulk transfer via the mesh.
+ * stoneId         Stone ID of the target when sending, or of the source when received.
+ * type            Type of data, up to the user.
+ * data            The data.
+ */
+struct cs_mesh_bulk_transfer_t {
+	stone_id_t stoneId;
+	uint8_t type;
+	cs_data_t data;
+};
+
+/**
+ * Result of a bulk transfer via the mesh.
+ */
+struct cs_mesh_bulk_transfer_result_t {
+	stone_id_t stoneId;
+	uint8_t type;
+	cs_ret_code_t returnCode;
+};
+
 /**
  * Struct to communicate received state of other stones.
  * rssi            RSSI to this stone, or 0 if not received the state directly from that stone.
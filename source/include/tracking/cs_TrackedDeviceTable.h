@@ -0,0 +1,313 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <structs/cs_PacketsInternal.h>
+
+#include <cstring>
+
+/**
+ * Maximum number of tracked devices.
+ */
+#ifndef MAX_TRACKED_DEVICES
+#define MAX_TRACKED_DEVICES 20
+#endif
+
+struct __attribute__((packed)) TrackedDevice {
+	uint8_t fieldsSet = 0;
+	uint8_t locationIdTimeout = 0;
+	internal_register_tracked_device_packet_t data;
+};
+
+/**
+ * Preallocated table of tracked devices.
+ *
+ * - Devices are looked up by device ID, and by device token, via open addressing hash tables with linear probing.
+ * - Devices are kept in a list, ordered from most to least recently used.
+ *   When the table is full, the least recently used device is removed to make space.
+ *
+ * @param Capacity    Maximum number of devices, should be smaller than 0x7FFF.
+ */
+template <uint16_t Capacity>
+class TrackedDeviceTable {
+public:
+	TrackedDeviceTable() {
+		clear();
+	}
+
+	void clear() {
+		memset(_idIndex, 0xFF, sizeof(_idIndex));
+		memset(_tokenIndex, 0xFF, sizeof(_tokenIndex));
+		memset(_tokenIndexed, 0, sizeof(_tokenIndexed));
+		for (uint16_t i = 0; i < Capacity; ++i) {
+			_next[i] = (i + 1 < Capacity) ? i + 1 : NONE;
+		}
+		_freeHead = 0;
+		_head = NONE;
+		_tail = NONE;
+		_size = 0;
+	}
+
+	uint16_t size() {
+		return _size;
+	}
+
+	/**
+	 * Find device with given ID.
+	 *
+	 * Returns null if it couldn't be found.
+	 */
+	TrackedDevice* find(device_id_t deviceId) {
+		uint16_t pos = findPos(_idIndex, hashId(deviceId), deviceId);
+		if (pos == NONE) {
+			return nullptr;
+		}
+		return &_devices[_idIndex[pos]];
+	}
+
+	/**
+	 * Find device with given token.
+	 *
+	 * Returns null if it couldn't be found.
+	 */
+	TrackedDevice* findToken(const uint8_t* deviceToken) {
+		uint32_t token = getToken(deviceToken);
+		uint16_t pos = findPos(_tokenIndex, hashToken(token), token);
+		if (pos == NONE) {
+			return nullptr;
+		}
+		return &_devices[_tokenIndex[pos]];
+	}
+
+	/**
+	 * Add a device with given ID, which should not be in the table yet.
+	 *
+	 * When the table is full, the least recently used device is removed.
+	 */
+	TrackedDevice* add(device_id_t deviceId) {
+		if (_freeHead == NONE) {
+			remove(&_devices[_tail]);
+		}
+		uint16_t slot = _freeHead;
+		_freeHead = _next[slot];
+		_devices[slot] = TrackedDevice();
+		_devices[slot].data.data.deviceId = deviceId;
+		insertPos(_idIndex, hashId(deviceId), slot);
+		pushFront(slot);
+		_size++;
+		return &_devices[slot];
+	}
+
+	/**
+	 * Remove a device.
+	 */
+	void remove(TrackedDevice* device) {
+		uint16_t slot = getSlot(device);
+		removePos(_idIndex, findSlotPos(_idIndex, getHome(_idIndex, slot), slot));
+		removeToken(slot);
+		unlink(slot);
+		_next[slot] = _freeHead;
+		_freeHead = slot;
+		_size--;
+	}
+
+	/**
+	 * Set the token of a device, which should not be in use by another device.
+	 */
+	void setToken(TrackedDevice* device, const uint8_t* deviceToken) {
+		uint16_t slot = getSlot(device);
+		removeToken(slot);
+		memcpy(device->data.data.deviceToken, deviceToken, TRACKED_DEVICE_TOKEN_SIZE);
+		insertPos(_tokenIndex, hashToken(getToken(deviceToken)), slot);
+		_tokenIndexed[slot / 8] |= (1 << (slot % 8));
+	}
+
+	/**
+	 * Mark a device as most recently used.
+	 */
+	void touch(TrackedDevice* device) {
+		uint16_t slot = getSlot(device);
+		if (slot == _head) {
+			return;
+		}
+		unlink(slot);
+		pushFront(slot);
+	}
+
+	/**
+	 * Call a function for each device, from most to least recently used.
+	 */
+	template <class F>
+	void forEach(F func) {
+		for (uint16_t slot = _head; slot != NONE; slot = _next[slot]) {
+			func(_devices[slot]);
+		}
+	}
+
+	/**
+	 * Remove all devices for which the predicate returns true.
+	 */
+	template <class P>
+	void removeIf(P predicate) {
+		uint16_t slot = _head;
+		while (slot != NONE) {
+			uint16_t next = _next[slot];
+			if (predicate(_devices[slot])) {
+				remove(&_devices[slot]);
+			}
+			slot = next;
+		}
+	}
+
+private:
+	static const uint16_t NONE = 0xFFFF;
+
+	/**
+	 * Size of the hash tables: a power of 2, at least twice the capacity, so that probe sequences stay short.
+	 */
+	static constexpr uint16_t indexSize(uint16_t size = 1) {
+		return (size >= 2 * Capacity) ? size : indexSize(size * 2);
+	}
+	static const uint16_t INDEX_SIZE = indexSize();
+
+	TrackedDevice _devices[Capacity];
+
+	//! Links of the list of used devices, or of the list of free slots.
+	uint16_t _prev[Capacity];
+	uint16_t _next[Capacity];
+	uint16_t _head;
+	uint16_t _tail;
+	uint16_t _freeHead;
+	uint16_t _size;
+
+	//! Slot of the device, or NONE.
+	uint16_t _idIndex[INDEX_SIZE];
+	uint16_t _tokenIndex[INDEX_SIZE];
+	//! Bit per slot: whether the token of the device is in the token index.
+	uint8_t _tokenIndexed[(Capacity + 7) / 8];
+
+	uint16_t getSlot(TrackedDevice* device) {
+		return device - _devices;
+	}
+
+	static uint32_t getToken(const uint8_t* deviceToken) {
+		return deviceToken[0] | (deviceToken[1] << 8) | (deviceToken[2] << 16);
+	}
+
+	static uint16_t hash(uint32_t key) {
+		return (key * 2654435761U) >> 16;
+	}
+
+	uint16_t hashId(device_id_t deviceId) {
+		return hash(deviceId) & (INDEX_SIZE - 1);
+	}
+
+	uint16_t hashToken(uint32_t token) {
+		return hash(token) & (INDEX_SIZE - 1);
+	}
+
+	uint32_t getKey(uint16_t* index, uint16_t slot) {
+		if (index == _idIndex) {
+			return _devices[slot].data.data.deviceId;
+		}
+		return getToken(_devices[slot].data.data.deviceToken);
+	}
+
+	uint16_t getHome(uint16_t* index, uint16_t slot) {
+		if (index == _idIndex) {
+			return hashId(_devices[slot].data.data.deviceId);
+		}
+		return hashToken(getToken(_devices[slot].data.data.deviceToken));
+	}
+
+	/**
+	 * Returns the position of the key in the index, or NONE.
+	 */
+	uint16_t findPos(uint16_t* index, uint16_t home, uint32_t key) {
+		for (uint16_t pos = home; index[pos] != NONE; pos = (pos + 1) & (INDEX_SIZE - 1)) {
+			if (getKey(index, index[pos]) == key) {
+				return pos;
+			}
+		}
+		return NONE;
+	}
+
+	/**
+	 * Returns the position of the slot in the index.
+	 */
+	uint16_t findSlotPos(uint16_t* index, uint16_t home, uint16_t slot) {
+		uint16_t pos = home;
+		while (index[pos] != slot) {
+			pos = (pos + 1) & (INDEX_SIZE - 1);
+		}
+		return pos;
+	}
+
+	void insertPos(uint16_t* index, uint16_t home, uint16_t slot) {
+		uint16_t pos = home;
+		while (index[pos] != NONE) {
+			pos = (pos + 1) & (INDEX_SIZE - 1);
+		}
+		index[pos] = slot;
+	}
+
+	/**
+	 * Remove an entry, and shift back the entries after it, so that no probe sequence is broken.
+	 */
+	void removePos(uint16_t* index, uint16_t pos) {
+		uint16_t next = pos;
+		while (true) {
+			next = (next + 1) & (INDEX_SIZE - 1);
+			if (index[next] == NONE) {
+				break;
+			}
+			uint16_t home = getHome(index, index[next]);
+			// Only move the entry when its home is not in (pos, next].
+			bool inRange = (pos <= next) ? (pos < home && home <= next) : (pos < home || home <= next);
+			if (!inRange) {
+				index[pos] = index[next];
+				pos = next;
+			}
+		}
+		index[pos] = NONE;
+	}
+
+	void removeToken(uint16_t slot) {
+		if (!(_tokenIndexed[slot / 8] & (1 << (slot % 8)))) {
+			return;
+		}
+		removePos(_tokenIndex, findSlotPos(_tokenIndex, getHome(_tokenIndex, slot), slot));
+		_tokenIndexed[slot / 8] &= ~(1 << (slot % 8));
+	}
+
+	void pushFront(uint16_t slot) {
+		_prev[slot] = NONE;
+		_next[slot] = _head;
+		if (_head != NONE) {
+			_prev[_head] = slot;
+		}
+		_head = slot;
+		if (_tail == NONE) {
+			_tail = slot;
+		}
+	}
+
+	void unlink(uint16_t slot) {
+		if (_prev[slot] != NONE) {
+			_next[_prev[slot]] = _next[slot];
+		}
+		else {
+			_head = _next[slot];
+		}
+		if (_next[slot] != NONE) {
+			_prev[_next[slot]] = _prev[slot];
+		}
+		else {
+			_tail = _prev[slot];
+		}
+	}
+};
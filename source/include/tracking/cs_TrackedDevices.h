@@ -7,7 +7,7 @@
 #pragma once
 
 #include <events/cs_EventListener.h>
-#include <forward_list>
+#include <tracking/cs_TrackedDeviceTable.h>
 
 /**
  * Class that keeps up devices to be tracked.
@@ -34,8 +34,6 @@ public:
 	void handleEvent(event_t& evt) override;
 
 private:
-	static const uint8_t MAX_TRACKED_DEVICES = 20;
-
 	/**
 	 * After N minutes not hearing anything from the device, the location ID will be set to 0 (in sphere).
 	 * This prevents sending out old locations.
@@ -54,22 +52,14 @@ private:
 	};
 	static const uint8_t ALL_FIELDS_SET = 0x7F;
 
-	struct __attribute__((packed)) TrackedDevice {
-		uint8_t fieldsSet = 0;
-		uint8_t locationIdTimeout = LOCATION_ID_TIMEOUT_MINUTES;
-		internal_register_tracked_device_packet_t data;
-	};
-
 	uint16_t ticksLeft = TICKS_PER_MINUTES;
 
 	/**
-	 * List of all tracked devices.
+	 * All tracked devices.
 	 *
 	 * Device ID should be unique.
 	 */
-	std::forward_list<TrackedDevice> devices;
-
-	uint8_t deviceListSize = 0;
+	TrackedDeviceTable<MAX_TRACKED_DEVICES> devices;
 
 	/**
 	 * Whether there has been a successful sync of tracked devices.
@@ -106,18 +96,11 @@ private:
 	TrackedDevice* findToken(uint8_t* deviceToken, uint8_t size);
 
 	/**
-	 * Add device to list.
-	 *
-	 * returns null if couldn't be added.
-	 */
-	TrackedDevice* add();
-
-	/**
-	 * Remove a device from the list.
+	 * Add device to the table.
 	 *
-	 * Either a record with incomplete data, otherwise the oldest.
+	 * When the table is full, the least recently used device is removed.
 	 */
-	cs_ret_code_t removeDevice();
+	TrackedDevice* add(device_id_t deviceId);
 
 	cs_ret_code_t handleRegister(internal_register_tracked_device_packet_t& packet);
 	cs_ret_code_t handleUpdate(internal_update_tracked_device_packet_t& packet);
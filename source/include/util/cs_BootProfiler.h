@@ -0,0 +1,91 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+#pragma once
+
+#include <common/cs_Types.h>
+
+/**
+ * Max number of boot stages that can be recorded.
+ */
+#define BOOT_PROFILER_MAX_STAGES      24
+
+/**
+ * Max number of different state types of which the reads are recorded.
+ */
+#define BOOT_PROFILER_MAX_STATE_TYPES 48
+
+struct boot_profiler_stage_t {
+	const char* name;
+	uint32_t ticks;
+};
+
+struct boot_profiler_state_read_t {
+	CS_TYPE type;
+	uint16_t count;
+	uint32_t ticks;
+};
+
+/**
+ * Records how long boot takes.
+ *
+ * The time between consecutive calls to stage() is attributed to the stage name given in the last call.
+ * Besides that, the time spent reading state values from flash is recorded per state type.
+ *
+ * Times are measured in RTC ticks, and only recorded until finish() is called, so this costs nothing after boot.
+ */
+class BootProfiler {
+public:
+	static BootProfiler& getInstance() {
+		static BootProfiler instance;
+		return instance;
+	}
+
+	/**
+	 * Ends the current stage, and starts a new one.
+	 *
+	 * @param[in] name            Name of the new stage, must be a string literal.
+	 */
+	void stage(const char* name);
+
+	/**
+	 * Record a read of a state value from flash.
+	 *
+	 * @param[in] type            Type that was read.
+	 * @param[in] ticks           RTC ticks the read took.
+	 */
+	void addStateRead(CS_TYPE type, uint32_t ticks);
+
+	/**
+	 * Ends the current stage, stops recording, and logs the results.
+	 */
+	void finish();
+
+	/**
+	 * Whether the profiler is still recording.
+	 */
+	bool isRecording() {
+		return _recording;
+	}
+
+private:
+	BootProfiler();
+	BootProfiler(BootProfiler const&);
+	void operator=(BootProfiler const &);
+
+	bool _recording = true;
+
+	uint32_t _startTicks = 0;
+	uint32_t _stageStartTicks = 0;
+
+	boot_profiler_stage_t _stages[BOOT_PROFILER_MAX_STAGES];
+	uint8_t _numStages = 0;
+
+	boot_profiler_state_read_t _stateReads[BOOT_PROFILER_MAX_STATE_TYPES];
+	uint8_t _numStateTypes = 0;
+
+	void endStage(uint32_t now);
+};
@@ -0,0 +1,158 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Keeps up which slots of a queue are in use, and which of them have priority.
+ *
+ * Meant to schedule a queue that is stored elsewhere, in O(1):
+ * - getFree() finds a free slot, starting at a given index, then going backwards.
+ * - getNext() finds the first used slot, starting at a given index, then going forward.
+ * Both wrap around, and use count leading / trailing zeros on 32 bit words.
+ *
+ * @param Size     Number of slots.
+ */
+template<uint16_t Size>
+class ReadySet {
+public:
+	static_assert(Size > 0 && Size < 0x7FFF, "Invalid size");
+
+	ReadySet() {
+		clear();
+	}
+
+	/**
+	 * Mark all slots as free.
+	 */
+	void clear() {
+		for (uint16_t i = 0; i < NumWords; ++i) {
+			_ready[i] = 0;
+			_priority[i] = 0;
+		}
+	}
+
+	/**
+	 * Mark a slot as in use.
+	 *
+	 * @param[in] index           Index of the slot.
+	 * @param[in] priority        Whether the slot has priority.
+	 */
+	void setReady(uint16_t index, bool priority) {
+		_ready[index / 32] |= bit(index);
+		if (priority) {
+			_priority[index / 32] |= bit(index);
+		}
+		else {
+			_priority[index / 32] &= ~bit(index);
+		}
+	}
+
+	/**
+	 * Mark a slot as free.
+	 */
+	void release(uint16_t index) {
+		_ready[index / 32] &= ~bit(index);
+		_priority[index / 32] &= ~bit(index);
+	}
+
+	bool isReady(uint16_t index) {
+		return _ready[index / 32] & bit(index);
+	}
+
+	/**
+	 * Find a free slot.
+	 *
+	 * Checks startIndex first, then startIndex - 1, and so on, wrapping around.
+	 *
+	 * @return                    Index of a free slot, or -1 when all slots are in use.
+	 */
+	int16_t getFree(uint16_t startIndex) {
+		int16_t index = findLast(_ready, true, 0, startIndex + 1);
+		if (index < 0) {
+			index = findLast(_ready, true, startIndex + 1, Size);
+		}
+		return index;
+	}
+
+	/**
+	 * Find a slot that is in use.
+	 *
+	 * Checks startIndex first, then startIndex + 1, and so on, wrapping around.
+	 *
+	 * @param[in] startIndex      Index to start looking.
+	 * @param[in] priority        True to only look at slots with priority.
+	 * @return                    Index of the slot, or -1 when none found.
+	 */
+	int16_t getNext(uint16_t startIndex, bool priority) {
+		const uint32_t* mask = priority ? _priority : _ready;
+		int16_t index = findFirst(mask, startIndex, Size);
+		if (index < 0) {
+			index = findFirst(mask, 0, startIndex);
+		}
+		return index;
+	}
+
+private:
+	static const uint16_t NumWords = (Size + 31) / 32;
+
+	//! Bit is set when the slot is in use.
+	uint32_t _ready[NumWords];
+
+	//! Bit is set when the slot is in use, and has priority.
+	uint32_t _priority[NumWords];
+
+	static uint32_t bit(uint16_t index) {
+		return 1u << (index % 32);
+	}
+
+	/**
+	 * Get the bits of word w that are in the range [from, to).
+	 */
+	static uint32_t rangeMask(uint16_t w, uint16_t from, uint16_t to) {
+		uint16_t wordStart = w * 32;
+		uint16_t low = (from > wordStart) ? from - wordStart : 0;
+		uint16_t high = (to - wordStart >= 32) ? 32 : to - wordStart;
+		uint32_t highMask = (high == 32) ? 0xFFFFFFFF : ((1u << high) - 1);
+		uint32_t lowMask = ~((1u << low) - 1);
+		return highMask & lowMask;
+	}
+
+	/**
+	 * Get the lowest set bit in the range [from, to), or -1 if none.
+	 */
+	static int16_t findFirst(const uint32_t* mask, uint16_t from, uint16_t to) {
+		if (from >= to) {
+			return -1;
+		}
+		for (uint16_t w = from / 32; w * 32 < to; ++w) {
+			uint32_t bits = mask[w] & rangeMask(w, from, to);
+			if (bits) {
+				return w * 32 + __builtin_ctz(bits);
+			}
+		}
+		return -1;
+	}
+
+	/**
+	 * Get the highest set bit in the range [from, to), or -1 if none.
+	 */
+	static int16_t findLast(const uint32_t* mask, bool inverted, uint16_t from, uint16_t to) {
+		if (from >= to) {
+			return -1;
+		}
+		for (int16_t w = (to - 1) / 32; w >= from / 32; --w) {
+			uint32_t bits = (inverted ? ~mask[w] : mask[w]) & rangeMask(w, from, to);
+			if (bits) {
+				return w * 32 + 31 - __builtin_clz(bits);
+			}
+		}
+		return -1;
+	}
+};
@@ -157,6 +157,11 @@ inline static cs_ret_code_t findAdvType(uint8_t type, uint8_t* advData, uint8_t
 		if (index + fieldLen >= advLen) {
 			return ERR_NOT_FOUND;
 		}
+		if (fieldLen == 0) {
+			// Empty AD structure, without type.
+			index++;
+			continue;
+		}
 
 		if (fieldType == type) {
 			foundData->data = &advData[index+2];
@@ -168,6 +173,89 @@ inline static cs_ret_code_t findAdvType(uint8_t type, uint8_t* advData, uint8_t
 	return ERR_NOT_FOUND;
 }
 
+/**
+ * @brief Parses advertisement data once, storing the location of the AD structures that are looked up often.
+ *
+ * Stops at the first AD structure that does not fit, like findAdvType().
+ *
+ * @param[in]  Pointer to advertisement data.
+ * @param[in]  Advertisement data length.
+ * @param[out] The index.
+ */
+inline static void indexAdvData(uint8_t* advData, uint8_t advLen, adv_index_t* index) {
+	*index = {};
+	int i = 0;
+	while (i < advLen-1) {
+		uint8_t fieldLen = advData[i];
+		uint8_t fieldType = advData[i+1];
+		if (i + fieldLen >= advLen) {
+			return;
+		}
+		if (fieldLen == 0) {
+			// Empty AD structure, without type.
+			i++;
+			continue;
+		}
+		adv_field_t* field = NULL;
+		switch (fieldType) {
+		case BLE_GAP_AD_TYPE_MANUFACTURER_SPECIFIC_DATA:
+			field = &(index->manufacturerData);
+			break;
+		case BLE_GAP_AD_TYPE_16BIT_SERVICE_UUID_COMPLETE:
+			field = &(index->services16bit);
+			break;
+		case BLE_GAP_AD_TYPE_128BIT_SERVICE_UUID_COMPLETE:
+			field = &(index->services128bit);
+			break;
+		case BLE_GAP_AD_TYPE_SERVICE_DATA:
+			field = &(index->serviceData16bit);
+			break;
+		}
+		if (field != NULL && field->offset == 0) {
+			field->offset = i+2;
+			field->len = fieldLen-1;
+		}
+		i += fieldLen+1;
+	}
+}
+
+/**
+ * @brief Finds an AD structure of a scanned device, using its index when the type is indexed.
+ *
+ * @param[in]  Type of data to be looked for in advertisement data.
+ * @param[in]  The scanned device, of which the index has been built with indexAdvData().
+ * @param[out] If data type requested is found: pointer to and length of data of given type.
+ *
+ * @retval ERR_SUCCESS if the data type is found in the report.
+ * @retval ERR_NOT_FOUND if the type could not be found.
+ */
+inline static cs_ret_code_t findAdvType(uint8_t type, scanned_device_t* scannedDevice, cs_data_t* foundData) {
+	const adv_field_t* field;
+	switch (type) {
+	case BLE_GAP_AD_TYPE_MANUFACTURER_SPECIFIC_DATA:
+		field = &(scannedDevice->advIndex.manufacturerData);
+		break;
+	case BLE_GAP_AD_TYPE_16BIT_SERVICE_UUID_COMPLETE:
+		field = &(scannedDevice->advIndex.services16bit);
+		break;
+	case BLE_GAP_AD_TYPE_128BIT_SERVICE_UUID_COMPLETE:
+		field = &(scannedDevice->advIndex.services128bit);
+		break;
+	case BLE_GAP_AD_TYPE_SERVICE_DATA:
+		field = &(scannedDevice->advIndex.serviceData16bit);
+		break;
+	default:
+		return findAdvType(type, scannedDevice->data, scannedDevice->dataSize, foundData);
+	}
+	if (field->offset == 0) {
+		foundData->data = NULL;
+		foundData->len = 0;
+		return ERR_NOT_FOUND;
+	}
+	foundData->data = &(scannedDevice->data[field->offset]);
+	foundData->len = field->len;
+	return ERR_SUCCESS;
+}
 
 /**
  * @brief Calculates a hash of given data.
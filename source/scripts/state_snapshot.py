@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+
+"""
+Inspect, create, and edit state snapshots, see the state snapshot section in docs/PROTOCOL.md.
+
+Usage:
+  state_snapshot.py dump <snapshot.bin>                   Print the snapshot as json.
+  state_snapshot.py build <snapshot.json> <snapshot.bin>  Create a snapshot from json, as printed by dump.
+"""
+
+import json
+import os
+import re
+import struct
+import sys
+
+STATE_TYPE_FILE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "../include/common/cs_Types.h")
+
+STATE_TYPE_START_PATTERN = re.compile("^enum class CS_TYPE")
+STATE_TYPE_PATTERN = re.compile(r"\s*(\S+)\s+=\s*(\d+)")
+
+PROTOCOL_VERSION = 0
+HEADER_FORMAT = "<BH"
+ENTRY_HEADER_FORMAT = "<HHH"
+CHECKSUM_FORMAT = "<I"
+
+
+def parseStateTypes():
+    """ Returns a dict with type number as key, and type name as value. """
+    types = {}
+    try:
+        with open(STATE_TYPE_FILE, 'r') as file:
+            foundStart = False
+            for line in file:
+                if STATE_TYPE_START_PATTERN.match(line):
+                    foundStart = True
+                    continue
+                if not foundStart:
+                    continue
+                if line.startswith("}"):
+                    break
+                match = STATE_TYPE_PATTERN.match(line)
+                if match:
+                    types[int(match.group(2))] = match.group(1)
+    except IOError:
+        pass
+    return types
+
+
+def fletcher(data):
+    """ Same as Fletcher() in cs_Hash.cpp: little endian uint16 words, odd length is padded with 0x00. """
+    c0 = 0
+    c1 = 0
+    for i in range(0, len(data), 2):
+        word = data[i]
+        if i + 1 < len(data):
+            word |= data[i + 1] << 8
+        c0 = (c0 + word) % 0xffff
+        c1 = (c1 + c0) % 0xffff
+    return (c1 << 16) | c0
+
+
+def parseSnapshot(data):
+    """ Returns a list of entries, raises ValueError when the snapshot is invalid. """
+    headerSize = struct.calcsize(HEADER_FORMAT)
+    checksumSize = struct.calcsize(CHECKSUM_FORMAT)
+    entryHeaderSize = struct.calcsize(ENTRY_HEADER_FORMAT)
+    if len(data) < headerSize + checksumSize:
+        raise ValueError("Snapshot too small")
+    protocol, numEntries = struct.unpack_from(HEADER_FORMAT, data, 0)
+    if protocol != PROTOCOL_VERSION:
+        raise ValueError("Unsupported protocol %u" % protocol)
+    dataSize = len(data) - checksumSize
+    (checksum,) = struct.unpack_from(CHECKSUM_FORMAT, data, dataSize)
+    if checksum != fletcher(data[:dataSize]):
+        raise ValueError("Checksum mismatch")
+
+    entries = []
+    index = headerSize
+    for i in range(0, numEntries):
+        if index + entryHeaderSize > dataSize:
+            raise ValueError("Entry %u exceeds snapshot" % i)
+        stateType, stateId, size = struct.unpack_from(ENTRY_HEADER_FORMAT, data, index)
+        index += entryHeaderSize
+        if index + size > dataSize:
+            raise ValueError("Entry %u exceeds snapshot" % i)
+        entries.append({"type": stateType, "id": stateId, "value": data[index:index + size].hex()})
+        index += size
+    if index != dataSize:
+        raise ValueError("Snapshot has %u trailing bytes" % (dataSize - index))
+    return entries
+
+
+def buildSnapshot(entries):
+    data = bytearray(struct.pack(HEADER_FORMAT, PROTOCOL_VERSION, len(entries)))
+    for entry in entries:
+        value = bytes.fromhex(entry["value"])
+        data += struct.pack(ENTRY_HEADER_FORMAT, entry["type"], entry.get("id", 0), len(value))
+        data += value
+    data += struct.pack(CHECKSUM_FORMAT, fletcher(data))
+    return bytes(data)
+
+
+def dump(inputFileName):
+    with open(inputFileName, 'rb') as file:
+        entries = parseSnapshot(file.read())
+    types = parseStateTypes()
+    for entry in entries:
+        if entry["type"] in types:
+            entry["name"] = types[entry["type"]]
+    print(json.dumps(entries, indent=2))
+
+
+def build(inputFileName, outputFileName):
+    with open(inputFileName, 'r') as file:
+        entries = json.load(file)
+    with open(outputFileName, 'wb') as file:
+        file.write(buildSnapshot(entries))
+
+
+if __name__ == "__main__":
+    if len(sys.argv) == 3 and sys.argv[1] == "dump":
+        dump(sys.argv[2])
+    elif len(sys.argv) == 4 and sys.argv[1] == "build":
+        build(sys.argv[2], sys.argv[3])
+    else:
+        print(__doc__)
+        sys.exit(1)
@@ -49,6 +49,17 @@ void ServiceData::init() {
 
 	EventDispatcher::getInstance().addListener(this);
 
+	State::getInstance().subscribe(CS_TYPE::STATE_ERRORS, this);
+	State::getInstance().subscribe(CS_TYPE::STATE_BEHAVIOUR_SETTINGS, this);
+	State::getInstance().subscribe(CS_TYPE::CONFIG_PWM_ALLOWED, this);
+	State::getInstance().subscribe(CS_TYPE::CONFIG_SWITCH_LOCKED, this);
+	State::getInstance().subscribe(CS_TYPE::CONFIG_SWITCHCRAFT_ENABLED, this);
+	State::getInstance().subscribe(CS_TYPE::CONFIG_TAP_TO_TOGGLE_ENABLED, this);
+
+	uint32_t seed;
+	RNG::fillBuffer((uint8_t*)&seed, sizeof(seed));
+	_statePublisher.init(getMeshStateSample(), seed);
+
 	// set the initial advertisement.
 	updateAdvertisement(true);
 }
@@ -58,23 +69,6 @@ void ServiceData::setDeviceType(uint8_t deviceType) {
 	_serviceData.params.deviceType = deviceType;
 }
 
-void ServiceData::updatePowerUsage(int32_t powerUsage) {
-	_powerUsageReal = powerUsage;
-	_powerFactor = 127;
-}
-
-void ServiceData::updateAccumulatedEnergy(int32_t energy) {
-	_energyUsed = energy;
-}
-
-void ServiceData::updateCrownstoneId(uint8_t crownstoneId) {
-	_crownstoneId = crownstoneId;
-}
-
-void ServiceData::updateSwitchState(uint8_t switchState) {
-	_switchState = switchState;
-}
-
 void ServiceData::updateFlagsBitmask(uint8_t bitmask) {
 	_flags = bitmask;
 }
@@ -97,8 +91,46 @@ void ServiceData::updateExtraFlagsBitmask(uint8_t bit, bool set) {
 	}
 }
 
-void ServiceData::updateTemperature(int8_t temperature) {
-	_temperature = temperature;
+stone_id_t ServiceData::getCrownstoneId() {
+	TYPIFY(CONFIG_CROWNSTONE_ID) crownstoneId = 0;
+	State::getInstance().get(CS_TYPE::CONFIG_CROWNSTONE_ID, &crownstoneId, sizeof(crownstoneId));
+	return crownstoneId;
+}
+
+uint8_t ServiceData::getSwitchState() {
+	TYPIFY(STATE_SWITCH_STATE) switchState;
+	switchState.asInt = 0;
+	State::getInstance().get(CS_TYPE::STATE_SWITCH_STATE, &switchState, sizeof(switchState));
+	return switchState.asInt;
+}
+
+int8_t ServiceData::getTemperature() {
+	TYPIFY(STATE_TEMPERATURE) temperature = 0;
+	State::getInstance().get(CS_TYPE::STATE_TEMPERATURE, &temperature, sizeof(temperature));
+	return temperature;
+}
+
+int32_t ServiceData::getPowerUsage() {
+	TYPIFY(STATE_POWER_USAGE) powerUsage = 0;
+	State::getInstance().get(CS_TYPE::STATE_POWER_USAGE, &powerUsage, sizeof(powerUsage));
+	return powerUsage;
+}
+
+int32_t ServiceData::getEnergyUsed() {
+	TYPIFY(STATE_ACCUMULATED_ENERGY) energyUsed = 0;
+	State::getInstance().get(CS_TYPE::STATE_ACCUMULATED_ENERGY, &energyUsed, sizeof(energyUsed));
+	return energyUsed / 1000 / 1000 / 64;
+}
+
+cs_mesh_state_sample_t ServiceData::getMeshStateSample() {
+	TYPIFY(STATE_ERRORS) stateErrors;
+	State::getInstance().get(CS_TYPE::STATE_ERRORS, &stateErrors, sizeof(stateErrors));
+	cs_mesh_state_sample_t sample;
+	sample.switchState = getSwitchState();
+	sample.flags = _flags;
+	sample.errors = stateErrors.asInt;
+	sample.powerUsageMilliWatt = getPowerUsage();
+	return sample;
 }
 
 uint8_t* ServiceData::getArray() {
@@ -128,6 +160,11 @@ void ServiceData::updateAdvertisement(bool initial) {
 	State::getInstance().get(CS_TYPE::STATE_ERRORS, &stateErrors, sizeof(stateErrors));
 	updateFlagsBitmask(SERVICE_DATA_FLAGS_ERROR, stateErrors.asInt);
 
+	stone_id_t crownstoneId = getCrownstoneId();
+	uint8_t switchState = getSwitchState();
+	int8_t temperature = getTemperature();
+	int32_t powerUsage = getPowerUsage();
+
 	// Set error timestamp
 	if (stateErrors.asInt == 0) {
 		_firstErrorTimestamp = 0;
@@ -140,11 +177,11 @@ void ServiceData::updateAdvertisement(bool initial) {
 		// In setup mode, only advertise this state.
 		_serviceData.params.protocolVersion = SERVICE_DATA_TYPE_SETUP;
 		_serviceData.params.setup.type = 0;
-		_serviceData.params.setup.state.switchState = _switchState;
+		_serviceData.params.setup.state.switchState = switchState;
 		_serviceData.params.setup.state.flags = _flags;
-		_serviceData.params.setup.state.temperature = _temperature;
+		_serviceData.params.setup.state.temperature = temperature;
 		_serviceData.params.setup.state.powerFactor = _powerFactor;
-		_serviceData.params.setup.state.powerUsageReal = compressPowerUsageMilliWatt(_powerUsageReal);
+		_serviceData.params.setup.state.powerUsageReal = compressPowerUsageMilliWatt(powerUsage);
 		_serviceData.params.setup.state.errors = stateErrors.asInt;
 		_serviceData.params.setup.state.counter = _updateCount;
 		memset(_serviceData.params.setup.state.reserved, 0, sizeof(_serviceData.params.setup.state.reserved));
@@ -156,16 +193,16 @@ void ServiceData::updateAdvertisement(bool initial) {
 		if (stateErrors.asInt != 0) {
 			_serviceData.params.protocolVersion = SERVICE_DATA_TYPE_ENCRYPTED;
 			_serviceData.params.encrypted.type = SERVICE_DATA_TYPE_ERROR;
-			_serviceData.params.encrypted.error.id = _crownstoneId;
+			_serviceData.params.encrypted.error.id = crownstoneId;
 			_serviceData.params.encrypted.error.errors = stateErrors.asInt;
 			_serviceData.params.encrypted.error.timestamp = _firstErrorTimestamp;
 			_serviceData.params.encrypted.error.flags = _flags;
-			_serviceData.params.encrypted.error.temperature = _temperature;
+			_serviceData.params.encrypted.error.temperature = temperature;
 			_serviceData.params.encrypted.error.partialTimestamp = getPartialTimestampOrCounter(timestamp, _updateCount);
-			_serviceData.params.encrypted.error.powerUsageReal = compressPowerUsageMilliWatt(_powerUsageReal);
+			_serviceData.params.encrypted.error.powerUsageReal = compressPowerUsageMilliWatt(powerUsage);
 			serviceDataSet = true;
 		}
-		else if (getExternalAdvertisement(_crownstoneId, _serviceData)) {
+		else if (getExternalAdvertisement(crownstoneId, _serviceData)) {
 			serviceDataSet = true;
 		}
 	}
@@ -176,8 +213,8 @@ void ServiceData::updateAdvertisement(bool initial) {
 			State::getInstance().get(CS_TYPE::STATE_BEHAVIOUR_MASTER_HASH, &behaviourHash, sizeof(behaviourHash));
 			_serviceData.params.protocolVersion = SERVICE_DATA_TYPE_ENCRYPTED;
 			_serviceData.params.encrypted.type = SERVICE_DATA_TYPE_ALTERNATIVE_STATE;
-			_serviceData.params.encrypted.altState.id = _crownstoneId;
-			_serviceData.params.encrypted.altState.switchState = _switchState;
+			_serviceData.params.encrypted.altState.id = crownstoneId;
+			_serviceData.params.encrypted.altState.switchState = switchState;
 			_serviceData.params.encrypted.altState.flags = _flags;
 			_serviceData.params.encrypted.altState.behaviourMasterHash = getPartialBehaviourHash(behaviourHash);
 			memset(_serviceData.params.encrypted.altState.reserved, 0, sizeof(_serviceData.params.encrypted.altState.reserved));
@@ -189,13 +226,13 @@ void ServiceData::updateAdvertisement(bool initial) {
 		else {
 			_serviceData.params.protocolVersion = SERVICE_DATA_TYPE_ENCRYPTED;
 			_serviceData.params.encrypted.type = SERVICE_DATA_TYPE_STATE;
-			_serviceData.params.encrypted.state.id = _crownstoneId;
-			_serviceData.params.encrypted.state.switchState = _switchState;
+			_serviceData.params.encrypted.state.id = crownstoneId;
+			_serviceData.params.encrypted.state.switchState = switchState;
 			_serviceData.params.encrypted.state.flags = _flags;
-			_serviceData.params.encrypted.state.temperature = _temperature;
+			_serviceData.params.encrypted.state.temperature = temperature;
 			_serviceData.params.encrypted.state.powerFactor = _powerFactor;
-			_serviceData.params.encrypted.state.powerUsageReal = compressPowerUsageMilliWatt(_powerUsageReal);
-			_serviceData.params.encrypted.state.energyUsed = _energyUsed;
+			_serviceData.params.encrypted.state.powerUsageReal = compressPowerUsageMilliWatt(powerUsage);
+			_serviceData.params.encrypted.state.energyUsed = getEnergyUsed();
 			_serviceData.params.encrypted.state.partialTimestamp = getPartialTimestampOrCounter(timestamp, _updateCount);
 			_serviceData.params.encrypted.state.extraFlags = _extraFlags;
 			_serviceData.params.encrypted.state.validation = SERVICE_DATA_VALIDATION;
@@ -266,92 +303,79 @@ void ServiceData::handleEvent(event_t & event) {
 //			LOGd("Event: %s", TypeName(event.type));
 //			updateFlagsBitmask(SERVICE_DATA_FLAGS_ERROR, true);
 //			break;
-		case CS_TYPE::STATE_ERRORS: {
-			LOGd("Event: %s", TypeName(event.type));
-			state_errors_t* stateErrors = (TYPIFY(STATE_ERRORS)*) event.data;
-			updateFlagsBitmask(SERVICE_DATA_FLAGS_ERROR, stateErrors->asInt);
-			break;
-		}
-		case CS_TYPE::CONFIG_CROWNSTONE_ID: {
-			updateCrownstoneId(*(TYPIFY(CONFIG_CROWNSTONE_ID)*)event.data);
+		case CS_TYPE::EVT_TIME_SET: {
+			updateFlagsBitmask(SERVICE_DATA_FLAGS_TIME_SET, true);
 			break;
 		}
-		case CS_TYPE::STATE_SWITCH_STATE: {
-			switch_state_t* state = (TYPIFY(STATE_SWITCH_STATE)*)event.data;
-			updateSwitchState(state->asInt);
-//			sendMeshState(true);
-			// Abuse the state update timeout.
-			_sendStateCountdown = 300 / TICK_INTERVAL_MS;
+		case CS_TYPE::EVT_DIMMER_POWERED: {
+			updateFlagsBitmask(SERVICE_DATA_FLAGS_DIMMING_AVAILABLE, *(TYPIFY(EVT_DIMMER_POWERED)*)event.data);
 			break;
 		}
-		case CS_TYPE::STATE_ACCUMULATED_ENERGY: {
-			int32_t energyUsed = (*(TYPIFY(STATE_ACCUMULATED_ENERGY)*)event.data) / 1000 / 1000 / 64;
-			updateAccumulatedEnergy(energyUsed);
-			// todo create mesh state event if changes significantly
+		case CS_TYPE::EVT_BEHAVIOUR_OVERRIDDEN: {
+			updateFlagsBitmask(SERVICE_DATA_FLAGS_BEHAVIOUR_OVERRIDDEN, *(TYPIFY(EVT_BEHAVIOUR_OVERRIDDEN)*)event.data);
 			break;
 		}
-		case CS_TYPE::STATE_POWER_USAGE: {
-			updatePowerUsage(*(TYPIFY(STATE_POWER_USAGE)*)event.data);
-			// todo create mesh state event if changes significantly
+		case CS_TYPE::EVT_TICK: {
+			TYPIFY(EVT_TICK) tickCount = *(TYPIFY(EVT_TICK)*)event.data;
+			_externalStates.tick(tickCount);
+			switch (_statePublisher.tick(getMeshStateSample())) {
+				case MESH_STATE_PUBLISH_CHANGE:
+					sendMeshState(true);
+					break;
+				case MESH_STATE_PUBLISH_KEEP_ALIVE:
+					sendMeshState(false);
+					break;
+				case MESH_STATE_PUBLISH_NONE:
+					break;
+			}
 			break;
 		}
-		case CS_TYPE::STATE_TEMPERATURE: {
-			updateTemperature(*(TYPIFY(STATE_TEMPERATURE)*)event.data);
+		case CS_TYPE::EVT_STATE_EXTERNAL_STONE: {
+			TYPIFY(EVT_STATE_EXTERNAL_STONE)* extState = (TYPIFY(EVT_STATE_EXTERNAL_STONE)*)event.data;
+			_externalStates.receivedState(extState);
 			break;
 		}
-		case CS_TYPE::STATE_BEHAVIOUR_SETTINGS: {
-			TYPIFY(STATE_BEHAVIOUR_SETTINGS)* behaviourSettings = (TYPIFY(STATE_BEHAVIOUR_SETTINGS)*)event.data;
-			updateExtraFlagsBitmask(SERVICE_DATA_EXTRA_FLAGS_BEHAVIOUR_ENABLED, behaviourSettings->flags.enabled);
+		case CS_TYPE::CMD_GET_EXTERNAL_STATE_STATS: {
+			_externalStates.getStats(event.result);
 			break;
 		}
-		case CS_TYPE::EVT_TIME_SET: {
-			updateFlagsBitmask(SERVICE_DATA_FLAGS_TIME_SET, true);
+		// TODO: add bitmask events
+		default:
+			return;
+	}
+}
+
+void ServiceData::handleStateChange(const state_change_t & change) {
+	switch (change.type) {
+		case CS_TYPE::STATE_ERRORS: {
+			LOGd("State change: %s", TypeName(change.type));
+			TYPIFY(STATE_ERRORS)* stateErrors = (TYPIFY(STATE_ERRORS)*) change.newValue;
+			updateFlagsBitmask(SERVICE_DATA_FLAGS_ERROR, stateErrors->asInt);
 			break;
 		}
-		case CS_TYPE::EVT_DIMMER_POWERED: {
-			updateFlagsBitmask(SERVICE_DATA_FLAGS_DIMMING_AVAILABLE, *(TYPIFY(EVT_DIMMER_POWERED)*)event.data);
+		case CS_TYPE::STATE_BEHAVIOUR_SETTINGS: {
+			TYPIFY(STATE_BEHAVIOUR_SETTINGS)* behaviourSettings = (TYPIFY(STATE_BEHAVIOUR_SETTINGS)*)change.newValue;
+			updateExtraFlagsBitmask(SERVICE_DATA_EXTRA_FLAGS_BEHAVIOUR_ENABLED, behaviourSettings->flags.enabled);
 			break;
 		}
 		case CS_TYPE::CONFIG_PWM_ALLOWED: {
-			updateFlagsBitmask(SERVICE_DATA_FLAGS_MARKED_DIMMABLE, *(TYPIFY(CONFIG_PWM_ALLOWED)*)event.data);
+			updateFlagsBitmask(SERVICE_DATA_FLAGS_MARKED_DIMMABLE, *(TYPIFY(CONFIG_PWM_ALLOWED)*)change.newValue);
 			break;
 		}
 		case CS_TYPE::CONFIG_SWITCH_LOCKED: {
-			updateFlagsBitmask(SERVICE_DATA_FLAGS_SWITCH_LOCKED, *(TYPIFY(CONFIG_SWITCH_LOCKED)*)event.data);
+			updateFlagsBitmask(SERVICE_DATA_FLAGS_SWITCH_LOCKED, *(TYPIFY(CONFIG_SWITCH_LOCKED)*)change.newValue);
 			break;
 		}
 		case CS_TYPE::CONFIG_SWITCHCRAFT_ENABLED: {
-			updateFlagsBitmask(SERVICE_DATA_FLAGS_SWITCHCRAFT_ENABLED, *(TYPIFY(CONFIG_SWITCHCRAFT_ENABLED)*)event.data);
+			updateFlagsBitmask(SERVICE_DATA_FLAGS_SWITCHCRAFT_ENABLED, *(TYPIFY(CONFIG_SWITCHCRAFT_ENABLED)*)change.newValue);
 			break;
 		}
 		case CS_TYPE::CONFIG_TAP_TO_TOGGLE_ENABLED: {
-			updateFlagsBitmask(SERVICE_DATA_FLAGS_TAP_TO_TOGGLE_ENABLED, *(TYPIFY(CONFIG_TAP_TO_TOGGLE_ENABLED)*)event.data);
+			updateFlagsBitmask(SERVICE_DATA_FLAGS_TAP_TO_TOGGLE_ENABLED, *(TYPIFY(CONFIG_TAP_TO_TOGGLE_ENABLED)*)change.newValue);
 			break;
 		}
-		case CS_TYPE::EVT_BEHAVIOUR_OVERRIDDEN: {
-			updateFlagsBitmask(SERVICE_DATA_FLAGS_BEHAVIOUR_OVERRIDDEN, *(TYPIFY(EVT_BEHAVIOUR_OVERRIDDEN)*)event.data);
-			break;
-		}
-		case CS_TYPE::EVT_TICK: {
-			TYPIFY(EVT_TICK) tickCount = *(TYPIFY(EVT_TICK)*)event.data;
-			_externalStates.tick(tickCount);
-			if (_sendStateCountdown-- == 0) {
-				uint8_t rand8;
-				RNG::fillBuffer(&rand8, 1);
-				uint32_t randMs = MESH_SEND_STATE_INTERVAL_MS + rand8 * MESH_SEND_STATE_INTERVAL_MS_VARIATION / 255;
-				_sendStateCountdown = randMs / TICK_INTERVAL_MS;
-				sendMeshState(false);
-			}
-			break;
-		}
-		case CS_TYPE::EVT_STATE_EXTERNAL_STONE: {
-			TYPIFY(EVT_STATE_EXTERNAL_STONE)* extState = (TYPIFY(EVT_STATE_EXTERNAL_STONE)*)event.data;
-			_externalStates.receivedState(extState);
-			break;
-		}
-		// TODO: add bitmask events
 		default:
-			return;
+			break;
 	}
 }
 
@@ -420,10 +444,13 @@ void ServiceData::sendMeshState(bool event) {
 		meshMsg.reliability = CS_MESH_RELIABILITY_LOW;
 		meshMsg.urgency = CS_MESH_URGENCY_LOW;
 	}
+	uint8_t switchState = getSwitchState();
+	int8_t temperature = getTemperature();
+	int32_t powerUsage = getPowerUsage();
 	{
 		cs_mesh_model_msg_state_1_t packet;
-		packet.temperature = _temperature;
-		packet.energyUsed = _energyUsed;
+		packet.temperature = temperature;
+		packet.energyUsed = getEnergyUsed();
 		packet.partialTimestamp = getPartialTimestampOrCounter(timestamp, _updateCount);
 
 		meshMsg.type = CS_MESH_MODEL_TYPE_STATE_1;
@@ -435,10 +462,10 @@ void ServiceData::sendMeshState(bool event) {
 	}
 	{
 		cs_mesh_model_msg_state_0_t packet;
-		packet.switchState = _switchState;
+		packet.switchState = switchState;
 		packet.flags = _flags;
 		packet.powerFactor = _powerFactor;
-		packet.powerUsageReal = compressPowerUsageMilliWatt(_powerUsageReal);
+		packet.powerUsageReal = compressPowerUsageMilliWatt(powerUsage);
 		packet.partialTimestamp = getPartialTimestampOrCounter(timestamp, _updateCount);
 
 		meshMsg.type = CS_MESH_MODEL_TYPE_STATE_0;
@@ -14,6 +14,8 @@
 #include <common/cs_Handlers.h>
 #include <drivers/cs_Storage.h>
 #include <events/cs_EventDispatcher.h>
+#include <processing/cs_ScanAggregator.h>
+#include <processing/cs_ScanPrefilter.h>
 #include <processing/cs_Scanner.h>
 #include <storage/cs_State.h>
 #include "structs/buffer/cs_CharacteristicReadBuffer.h"
@@ -525,6 +527,10 @@ void csStackOnScan(const ble_gap_evt_adv_report_t* advReport) {
 	scan.channel = advReport->ch_index;
 	scan.dataSize = advReport->data.len;
 	scan.data = advReport->data.p_data;
+	BLEutil::indexAdvData(scan.data, scan.dataSize, &scan.advIndex);
+	if (!ScanPrefilter::getInstance().accept(&scan)) {
+		return;
+	}
 
 //	uint16_t type = *((uint16_t*)&(advReport->type));
 //	const uint8_t* addr = scan.address;
@@ -537,8 +543,12 @@ void csStackOnScan(const ble_gap_evt_adv_report_t* advReport) {
 //		LOGi("  adv_type=%u len=%u data=", type, scan.dataSize);
 //		BLEutil::printArray(scan.data, scan.dataSize);
 //	}
+#if SCAN_BATCH_ENABLED == 1
+	ScanAggregator::getInstance().add(&scan);
+#else
 	event_t event(CS_TYPE::EVT_DEVICE_SCANNED, (void*)&scan, sizeof(scan));
 	EventDispatcher::getInstance().dispatch(event);
+#endif
 }
 
 void csStackOnScan(void * p_event_data, uint16_t event_size) {
@@ -93,6 +93,7 @@ CS_TYPE toCsType(uint16_t type) {
 	case CS_TYPE::EVT_SCAN_STARTED:
 	case CS_TYPE::EVT_SCAN_STOPPED:
 	case CS_TYPE::EVT_DEVICE_SCANNED:
+	case CS_TYPE::EVT_DEVICE_SCANNED_BATCH:
 	case CS_TYPE::EVT_CURRENT_USAGE_ABOVE_THRESHOLD_DIMMER:
 	case CS_TYPE::EVT_CURRENT_USAGE_ABOVE_THRESHOLD:
 	case CS_TYPE::EVT_DIMMER_ON_FAILURE_DETECTED:
@@ -176,12 +177,22 @@ CS_TYPE toCsType(uint16_t type) {
 	case CS_TYPE::EVT_MESH_PAGES_ERASED:
 	case CS_TYPE::EVT_MESH_EXT_STATE_0:
 	case CS_TYPE::EVT_MESH_EXT_STATE_1:
+	case CS_TYPE::CMD_SEND_MESH_BULK_TRANSFER:
+	case CS_TYPE::EVT_MESH_BULK_TRANSFER_RECEIVED:
+	case CS_TYPE::EVT_MESH_BULK_TRANSFER_RESULT:
 	case CS_TYPE::CMD_SEND_MESH_MSG_SET_TIME:
 	case CS_TYPE::CMD_SET_IBEACON_CONFIG_ID:
 	case CS_TYPE::CMD_SEND_MESH_MSG_NOOP:
 	case CS_TYPE::CMD_GET_ADC_RESTARTS:
 	case CS_TYPE::CMD_GET_SWITCH_HISTORY:
 	case CS_TYPE::CMD_GET_POWER_SAMPLES:
+	case CS_TYPE::CMD_GET_MESH_LINK_QUALITY:
+	case CS_TYPE::CMD_GET_MESH_TELEMETRY:
+	case CS_TYPE::CMD_RESET_MESH_TELEMETRY:
+	case CS_TYPE::CMD_GET_SCAN_PREFILTER_STATS:
+	case CS_TYPE::CMD_GET_SCAN_DUTY_STATS:
+	case CS_TYPE::CMD_GET_EXTERNAL_STATE_STATS:
+	case CS_TYPE::CMD_GET_STORAGE_GC_STATS:
 	case CS_TYPE::EVT_GENERIC_TEST:
 	case CS_TYPE::CMD_MICROAPP_UPLOAD:
 	case CS_TYPE::EVT_MICROAPP:
@@ -365,6 +376,8 @@ size16_t TypeSize(CS_TYPE const & type){
 		return 0;
 	case CS_TYPE::EVT_DEVICE_SCANNED:
 		return sizeof(TYPIFY(EVT_DEVICE_SCANNED));
+	case CS_TYPE::EVT_DEVICE_SCANNED_BATCH:
+		return sizeof(TYPIFY(EVT_DEVICE_SCANNED_BATCH));
 	case CS_TYPE::EVT_CURRENT_USAGE_ABOVE_THRESHOLD_DIMMER:
 		return 0;
 	case CS_TYPE::EVT_CURRENT_USAGE_ABOVE_THRESHOLD:
@@ -531,6 +544,12 @@ size16_t TypeSize(CS_TYPE const & type){
 		return sizeof(TYPIFY(EVT_MESH_EXT_STATE_0));
 	case CS_TYPE::EVT_MESH_EXT_STATE_1:
 		return sizeof(TYPIFY(EVT_MESH_EXT_STATE_1));
+	case CS_TYPE::CMD_SEND_MESH_BULK_TRANSFER:
+		return sizeof(TYPIFY(CMD_SEND_MESH_BULK_TRANSFER));
+	case CS_TYPE::EVT_MESH_BULK_TRANSFER_RECEIVED:
+		return sizeof(TYPIFY(EVT_MESH_BULK_TRANSFER_RECEIVED));
+	case CS_TYPE::EVT_MESH_BULK_TRANSFER_RESULT:
+		return sizeof(TYPIFY(EVT_MESH_BULK_TRANSFER_RESULT));
 	case CS_TYPE::CMD_SEND_MESH_MSG_SET_TIME:
 		return sizeof(TYPIFY(CMD_SEND_MESH_MSG_SET_TIME));
 	case CS_TYPE::CMD_SET_IBEACON_CONFIG_ID:
@@ -543,6 +562,20 @@ size16_t TypeSize(CS_TYPE const & type){
 		return 0;
 	case CS_TYPE::CMD_GET_POWER_SAMPLES:
 		return sizeof(TYPIFY(CMD_GET_POWER_SAMPLES));
+	case CS_TYPE::CMD_GET_MESH_LINK_QUALITY:
+		return 0;
+	case CS_TYPE::CMD_GET_MESH_TELEMETRY:
+		return 0;
+	case CS_TYPE::CMD_RESET_MESH_TELEMETRY:
+		return 0;
+	case CS_TYPE::CMD_GET_SCAN_PREFILTER_STATS:
+		return 0;
+	case CS_TYPE::CMD_GET_SCAN_DUTY_STATS:
+		return 0;
+	case CS_TYPE::CMD_GET_EXTERNAL_STATE_STATS:
+		return 0;
+	case CS_TYPE::CMD_GET_STORAGE_GC_STATS:
+		return 0;
 	case CS_TYPE::EVT_GENERIC_TEST:
 		return 0;
 	case CS_TYPE::CMD_MICROAPP_UPLOAD:
@@ -623,6 +656,7 @@ const char* TypeName(CS_TYPE const & type) {
 	case CS_TYPE::CMD_DEC_CURRENT_RANGE: return "EVT_DEC_CURRENT_RANGE";
 	case CS_TYPE::CMD_DEC_VOLTAGE_RANGE: return "EVT_DEC_VOLTAGE_RANGE";
 	case CS_TYPE::EVT_DEVICE_SCANNED: return "EVT_DEVICE_SCANNED";
+	case CS_TYPE::EVT_DEVICE_SCANNED_BATCH: return "EVT_DEVICE_SCANNED_BATCH";
 	case CS_TYPE::EVT_DIMMER_OFF_FAILURE_DETECTED: return "EVT_DIMMER_OFF_FAILURE_DETECTED";
 	case CS_TYPE::EVT_DIMMER_ON_FAILURE_DETECTED: return "EVT_DIMMER_ON_FAILURE_DETECTED";
 	case CS_TYPE::CMD_ENABLE_ADC_DIFFERENTIAL_CURRENT: return "EVT_ENABLE_ADC_DIFFERENTIAL_CURRENT";
@@ -722,12 +756,22 @@ const char* TypeName(CS_TYPE const & type) {
 	case CS_TYPE::EVT_MESH_PAGES_ERASED: return "EVT_MESH_PAGES_ERASED";
 	case CS_TYPE::EVT_MESH_EXT_STATE_0: return "EVT_MESH_EXT_STATE_0";
 	case CS_TYPE::EVT_MESH_EXT_STATE_1: return "EVT_MESH_EXT_STATE_1";
+	case CS_TYPE::CMD_SEND_MESH_BULK_TRANSFER: return "CMD_SEND_MESH_BULK_TRANSFER";
+	case CS_TYPE::EVT_MESH_BULK_TRANSFER_RECEIVED: return "EVT_MESH_BULK_TRANSFER_RECEIVED";
+	case CS_TYPE::EVT_MESH_BULK_TRANSFER_RESULT: return "EVT_MESH_BULK_TRANSFER_RESULT";
 	case CS_TYPE::CMD_SEND_MESH_MSG_SET_TIME: return "CMD_SEND_MESH_MSG_SET_TIME";
 	case CS_TYPE::CMD_SET_IBEACON_CONFIG_ID: return "CMD_SET_IBEACON_CONFIG_ID";
 	case CS_TYPE::CMD_SEND_MESH_MSG_NOOP: return "CMD_SEND_MESH_MSG_NOOP";
 	case CS_TYPE::CMD_GET_ADC_RESTARTS: return "CMD_GET_ADC_RESTARTS";
 	case CS_TYPE::CMD_GET_SWITCH_HISTORY: return "CMD_GET_SWITCH_HISTORY";
 	case CS_TYPE::CMD_GET_POWER_SAMPLES: return "CMD_GET_POWER_SAMPLES";
+	case CS_TYPE::CMD_GET_MESH_LINK_QUALITY: return "CMD_GET_MESH_LINK_QUALITY";
+	case CS_TYPE::CMD_GET_MESH_TELEMETRY: return "CMD_GET_MESH_TELEMETRY";
+	case CS_TYPE::CMD_RESET_MESH_TELEMETRY: return "CMD_RESET_MESH_TELEMETRY";
+	case CS_TYPE::CMD_GET_SCAN_PREFILTER_STATS: return "CMD_GET_SCAN_PREFILTER_STATS";
+	case CS_TYPE::CMD_GET_SCAN_DUTY_STATS: return "CMD_GET_SCAN_DUTY_STATS";
+	case CS_TYPE::CMD_GET_EXTERNAL_STATE_STATS: return "CMD_GET_EXTERNAL_STATE_STATS";
+	case CS_TYPE::CMD_GET_STORAGE_GC_STATS: return "CMD_GET_STORAGE_GC_STATS";
 	case CS_TYPE::EVT_GENERIC_TEST: return "EVT_GENERIC_TEST";
 	case CS_TYPE::CMD_MICROAPP_UPLOAD: return "CMD_MICROAPP_UPLOAD";
 	case CS_TYPE::EVT_MICROAPP: return "EVT_MICROAPP";
@@ -812,6 +856,7 @@ bool hasMultipleIds(CS_TYPE const & type){
 	case CS_TYPE::EVT_SCAN_STARTED:
 	case CS_TYPE::EVT_SCAN_STOPPED:
 	case CS_TYPE::EVT_DEVICE_SCANNED:
+	case CS_TYPE::EVT_DEVICE_SCANNED_BATCH:
 	case CS_TYPE::EVT_CURRENT_USAGE_ABOVE_THRESHOLD_DIMMER:
 	case CS_TYPE::EVT_CURRENT_USAGE_ABOVE_THRESHOLD:
 	case CS_TYPE::EVT_DIMMER_ON_FAILURE_DETECTED:
@@ -895,12 +940,22 @@ bool hasMultipleIds(CS_TYPE const & type){
 	case CS_TYPE::EVT_MESH_PAGES_ERASED:
 	case CS_TYPE::EVT_MESH_EXT_STATE_0:
 	case CS_TYPE::EVT_MESH_EXT_STATE_1:
+	case CS_TYPE::CMD_SEND_MESH_BULK_TRANSFER:
+	case CS_TYPE::EVT_MESH_BULK_TRANSFER_RECEIVED:
+	case CS_TYPE::EVT_MESH_BULK_TRANSFER_RESULT:
 	case CS_TYPE::CMD_SEND_MESH_MSG_SET_TIME:
 	case CS_TYPE::CMD_SET_IBEACON_CONFIG_ID:
 	case CS_TYPE::CMD_SEND_MESH_MSG_NOOP:
 	case CS_TYPE::CMD_GET_ADC_RESTARTS:
 	case CS_TYPE::CMD_GET_SWITCH_HISTORY:
 	case CS_TYPE::CMD_GET_POWER_SAMPLES:
+	case CS_TYPE::CMD_GET_MESH_LINK_QUALITY:
+	case CS_TYPE::CMD_GET_MESH_TELEMETRY:
+	case CS_TYPE::CMD_RESET_MESH_TELEMETRY:
+	case CS_TYPE::CMD_GET_SCAN_PREFILTER_STATS:
+	case CS_TYPE::CMD_GET_SCAN_DUTY_STATS:
+	case CS_TYPE::CMD_GET_EXTERNAL_STATE_STATS:
+	case CS_TYPE::CMD_GET_STORAGE_GC_STATS:
 	case CS_TYPE::EVT_GENERIC_TEST:
 	case CS_TYPE::CMD_MICROAPP_UPLOAD:
 	case CS_TYPE::EVT_MICROAPP:
@@ -1004,6 +1059,7 @@ bool removeOnFactoryReset(CS_TYPE const & type, cs_state_id_t id) {
 	case CS_TYPE::EVT_SCAN_STARTED:
 	case CS_TYPE::EVT_SCAN_STOPPED:
 	case CS_TYPE::EVT_DEVICE_SCANNED:
+	case CS_TYPE::EVT_DEVICE_SCANNED_BATCH:
 	case CS_TYPE::EVT_CURRENT_USAGE_ABOVE_THRESHOLD_DIMMER:
 	case CS_TYPE::EVT_CURRENT_USAGE_ABOVE_THRESHOLD:
 	case CS_TYPE::EVT_DIMMER_ON_FAILURE_DETECTED:
@@ -1087,12 +1143,22 @@ bool removeOnFactoryReset(CS_TYPE const & type, cs_state_id_t id) {
 	case CS_TYPE::EVT_MESH_PAGES_ERASED:
 	case CS_TYPE::EVT_MESH_EXT_STATE_0:
 	case CS_TYPE::EVT_MESH_EXT_STATE_1:
+	case CS_TYPE::CMD_SEND_MESH_BULK_TRANSFER:
+	case CS_TYPE::EVT_MESH_BULK_TRANSFER_RECEIVED:
+	case CS_TYPE::EVT_MESH_BULK_TRANSFER_RESULT:
 	case CS_TYPE::CMD_SEND_MESH_MSG_SET_TIME:
 	case CS_TYPE::CMD_SET_IBEACON_CONFIG_ID:
 	case CS_TYPE::CMD_SEND_MESH_MSG_NOOP:
 	case CS_TYPE::CMD_GET_ADC_RESTARTS:
 	case CS_TYPE::CMD_GET_SWITCH_HISTORY:
 	case CS_TYPE::CMD_GET_POWER_SAMPLES:
+	case CS_TYPE::CMD_GET_MESH_LINK_QUALITY:
+	case CS_TYPE::CMD_GET_MESH_TELEMETRY:
+	case CS_TYPE::CMD_RESET_MESH_TELEMETRY:
+	case CS_TYPE::CMD_GET_SCAN_PREFILTER_STATS:
+	case CS_TYPE::CMD_GET_SCAN_DUTY_STATS:
+	case CS_TYPE::CMD_GET_EXTERNAL_STATE_STATS:
+	case CS_TYPE::CMD_GET_STORAGE_GC_STATS:
 	case CS_TYPE::EVT_GENERIC_TEST:
 	case CS_TYPE::CMD_MICROAPP_UPLOAD:
 	case CS_TYPE::EVT_MICROAPP:
@@ -1214,6 +1280,7 @@ EncryptionAccessLevel getUserAccessLevelSet(CS_TYPE const & type)  {
 	case CS_TYPE::EVT_CURRENT_USAGE_ABOVE_THRESHOLD_DIMMER:
 	case CS_TYPE::EVT_CURRENT_USAGE_ABOVE_THRESHOLD:
 	case CS_TYPE::EVT_DEVICE_SCANNED:
+	case CS_TYPE::EVT_DEVICE_SCANNED_BATCH:
 	case CS_TYPE::EVT_DIMMER_FORCED_OFF:
 	case CS_TYPE::EVT_DIMMER_OFF_FAILURE_DETECTED:
 	case CS_TYPE::EVT_DIMMER_ON_FAILURE_DETECTED:
@@ -1270,12 +1337,22 @@ EncryptionAccessLevel getUserAccessLevelSet(CS_TYPE const & type)  {
 	case CS_TYPE::EVT_MESH_PAGES_ERASED:
 	case CS_TYPE::EVT_MESH_EXT_STATE_0:
 	case CS_TYPE::EVT_MESH_EXT_STATE_1:
+	case CS_TYPE::CMD_SEND_MESH_BULK_TRANSFER:
+	case CS_TYPE::EVT_MESH_BULK_TRANSFER_RECEIVED:
+	case CS_TYPE::EVT_MESH_BULK_TRANSFER_RESULT:
 	case CS_TYPE::CMD_SEND_MESH_MSG_SET_TIME:
 	case CS_TYPE::CMD_SET_IBEACON_CONFIG_ID:
 	case CS_TYPE::CMD_SEND_MESH_MSG_NOOP:
 	case CS_TYPE::CMD_GET_ADC_RESTARTS:
 	case CS_TYPE::CMD_GET_SWITCH_HISTORY:
 	case CS_TYPE::CMD_GET_POWER_SAMPLES:
+	case CS_TYPE::CMD_GET_MESH_LINK_QUALITY:
+	case CS_TYPE::CMD_GET_MESH_TELEMETRY:
+	case CS_TYPE::CMD_RESET_MESH_TELEMETRY:
+	case CS_TYPE::CMD_GET_SCAN_PREFILTER_STATS:
+	case CS_TYPE::CMD_GET_SCAN_DUTY_STATS:
+	case CS_TYPE::CMD_GET_EXTERNAL_STATE_STATS:
+	case CS_TYPE::CMD_GET_STORAGE_GC_STATS:
 	case CS_TYPE::EVT_GENERIC_TEST:
 	case CS_TYPE::CMD_MICROAPP_UPLOAD:
 	case CS_TYPE::EVT_MICROAPP:
@@ -1397,6 +1474,7 @@ EncryptionAccessLevel getUserAccessLevelGet(CS_TYPE const & type) {
 	case CS_TYPE::EVT_CURRENT_USAGE_ABOVE_THRESHOLD_DIMMER:
 	case CS_TYPE::EVT_CURRENT_USAGE_ABOVE_THRESHOLD:
 	case CS_TYPE::EVT_DEVICE_SCANNED:
+	case CS_TYPE::EVT_DEVICE_SCANNED_BATCH:
 	case CS_TYPE::EVT_DIMMER_FORCED_OFF:
 	case CS_TYPE::EVT_DIMMER_OFF_FAILURE_DETECTED:
 	case CS_TYPE::EVT_DIMMER_ON_FAILURE_DETECTED:
@@ -1453,12 +1531,22 @@ EncryptionAccessLevel getUserAccessLevelGet(CS_TYPE const & type) {
 	case CS_TYPE::EVT_MESH_PAGES_ERASED:
 	case CS_TYPE::EVT_MESH_EXT_STATE_0:
 	case CS_TYPE::EVT_MESH_EXT_STATE_1:
+	case CS_TYPE::CMD_SEND_MESH_BULK_TRANSFER:
+	case CS_TYPE::EVT_MESH_BULK_TRANSFER_RECEIVED:
+	case CS_TYPE::EVT_MESH_BULK_TRANSFER_RESULT:
 	case CS_TYPE::CMD_SEND_MESH_MSG_SET_TIME:
 	case CS_TYPE::CMD_SET_IBEACON_CONFIG_ID:
 	case CS_TYPE::CMD_SEND_MESH_MSG_NOOP:
 	case CS_TYPE::CMD_GET_ADC_RESTARTS:
 	case CS_TYPE::CMD_GET_SWITCH_HISTORY:
 	case CS_TYPE::CMD_GET_POWER_SAMPLES:
+	case CS_TYPE::CMD_GET_MESH_LINK_QUALITY:
+	case CS_TYPE::CMD_GET_MESH_TELEMETRY:
+	case CS_TYPE::CMD_RESET_MESH_TELEMETRY:
+	case CS_TYPE::CMD_GET_SCAN_PREFILTER_STATS:
+	case CS_TYPE::CMD_GET_SCAN_DUTY_STATS:
+	case CS_TYPE::CMD_GET_EXTERNAL_STATE_STATS:
+	case CS_TYPE::CMD_GET_STORAGE_GC_STATS:
 	case CS_TYPE::EVT_GENERIC_TEST:
 	case CS_TYPE::CMD_MICROAPP_UPLOAD:
 	case CS_TYPE::EVT_MICROAPP:
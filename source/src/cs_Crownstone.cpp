@@ -55,6 +55,7 @@
 #include <structs/buffer/cs_EncryptionBuffer.h>
 #include <switch/cs_SwitchAggregator.h>
 #include <time/cs_SystemTime.h>
+#include <util/cs_BootProfiler.h>
 #include <util/cs_Utils.h>
 
 extern "C" {
@@ -239,6 +240,7 @@ void Crownstone::init1() {
 	_operationMode = getOperationMode(mode);
 
 	//! configure the crownstone
+	BootProfiler::getInstance().stage("configure");
 	LOGi(FMT_HEADER, "configure");
 	configure();
 	LOG_FLUSH();
@@ -247,10 +249,12 @@ void Crownstone::init1() {
 	_timer->createSingleShot(_mainTimerId, (app_timer_timeout_handler_t)Crownstone::staticTick);
 	LOG_FLUSH();
 
+	BootProfiler::getInstance().stage("mode");
 	LOGi(FMT_HEADER, "mode");
 	switchMode(_operationMode);
 	LOG_FLUSH();
 
+	BootProfiler::getInstance().stage("services init");
 	LOGi(FMT_HEADER, "init services");
 	_stack->initServices();
 	LOG_FLUSH();
@@ -290,6 +294,7 @@ void Crownstone::initDrivers0() {
 	}
 #endif
 
+	BootProfiler::getInstance().stage("storage init");
 	cs_ret_code_t retCode = _storage->init();
 	if (retCode != ERR_SUCCESS) {
 		// We can try to erase all pages.
@@ -305,6 +310,7 @@ void Crownstone::initDrivers0() {
 }
 
 void Crownstone::initDrivers1() {
+	BootProfiler::getInstance().stage("state init");
 	_state->init(&_boardsConfig);
 
 		// If not done already, init UART
@@ -339,6 +345,7 @@ void Crownstone::initDrivers1() {
 			_state->set(CS_TYPE::STATE_SWITCH_STATE, &switchState, sizeof(switchState));
 		}
 
+		BootProfiler::getInstance().stage("handlers init");
 		LOGi(FMT_INIT, "command handler");
 		_commandHandler->init(&_boardsConfig);
 
@@ -350,12 +357,14 @@ void Crownstone::initDrivers1() {
 
 
 		if (IS_CROWNSTONE(_boardsConfig.deviceType)) {
+			BootProfiler::getInstance().stage("switch init");
 			LOGi(FMT_INIT, "switch");
 			SwitchAggregator::getInstance().init(_boardsConfig);
 
 			LOGi(FMT_INIT, "temperature guard");
 			_temperatureGuard->init(_boardsConfig);
 
+			BootProfiler::getInstance().stage("power sampler init");
 			LOGi(FMT_INIT, "power sampler");
 			_powerSampler->init(_boardsConfig);
 		}
@@ -434,25 +443,6 @@ void Crownstone::configureAdvertisement() {
 	_serviceData->setDeviceType(_boardsConfig.deviceType);
 	_serviceData->init();
 
-	// The service data is populated with State information, but only in NORMAL mode.
-	if (_operationMode == OperationMode::OPERATION_MODE_NORMAL) {
-		LOGd("Normal mode, fill with state info");
-
-		// Write crownstone id to the service data object.
-		TYPIFY(CONFIG_CROWNSTONE_ID) crownstoneId;
-		_state->get(CS_TYPE::CONFIG_CROWNSTONE_ID, &crownstoneId, sizeof(crownstoneId));
-		_serviceData->updateCrownstoneId(crownstoneId);
-		LOGi("Set crownstone id to %u", crownstoneId);
-
-		// Write switch state to the service data object.
-		TYPIFY(STATE_SWITCH_STATE) switchState;
-		_state->get(CS_TYPE::STATE_SWITCH_STATE, &switchState, sizeof(switchState));
-		_serviceData->updateSwitchState(switchState.asInt);
-
-		// Write temperature to the service data object.
-		_serviceData->updateTemperature(getTemperature());
-	}
-
 	// assign service data to stack
 	_advertiser->setServiceData(_serviceData);
 	_advertiser->configureAdvertisement(_boardsConfig.deviceType);
@@ -630,6 +620,7 @@ void Crownstone::startOperationMode(const OperationMode & mode) {
 }
 
 void Crownstone::startUp() {
+	BootProfiler::getInstance().stage("startup");
 
 	LOGi(FMT_HEADER, "startup");
 
@@ -675,6 +666,7 @@ void Crownstone::startUp() {
 	// The rest we only execute if we are in normal operation.
 	// During other operation modes, most of the crownstone's functionality is disabled.
 	if (_operationMode == OperationMode::OPERATION_MODE_NORMAL) {
+		BootProfiler::getInstance().stage("startup normal mode");
 		_systemTime.listen();
 		
 		TapToToggle::getInstance().init(_boardsConfig.tapToToggleDefaultRssiThreshold);
@@ -700,6 +692,7 @@ void Crownstone::startUp() {
 			LOGi("Mesh not enabled");
 		}
 
+		BootProfiler::getInstance().stage("behaviour store init");
 		_behaviourStore.init();
 	}
 
@@ -715,6 +708,8 @@ void Crownstone::startUp() {
 
 	_state->startWritesToFlash();
 
+	BootProfiler::getInstance().finish();
+
 #if BUILD_MESHING == 1
 	_mesh->startSync();
 #endif
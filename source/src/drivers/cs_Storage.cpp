@@ -6,6 +6,7 @@
  */
 
 
+#include <cfg/cs_Config.h>
 #include <climits>
 #include <common/cs_Handlers.h>
 #include <drivers/cs_Serial.h>
@@ -26,6 +27,15 @@
 Storage::Storage() : EventListener() {
 	LOGStorageDebug(FMT_CREATE, "storage");
 
+	storage_gc_config_t gcConfig;
+	gcConfig.dirtyRatioPercent = STORAGE_GC_DIRTY_RATIO_PERCENT;
+	gcConfig.minFreeableWords = STORAGE_GC_MIN_FREEABLE_WORDS;
+	gcConfig.reserveWords = STORAGE_GC_RESERVE_WORDS;
+	gcConfig.idleTimeMs = STORAGE_GC_IDLE_TIME_MS;
+	gcConfig.maxSchedulerQueueUse = STORAGE_GC_MAX_SCHEDULER_QUEUE_USE;
+	gcConfig.maxDeferMs = STORAGE_GC_MAX_DEFER_MS;
+	_gcPolicy.setConfig(gcConfig);
+
 	EventDispatcher::getInstance().addListener(this);
 }
 
@@ -144,8 +154,23 @@ cs_ret_code_t Storage::read(cs_state_data_t & stateData) {
 	}
 	fds_record_desc_t recordDesc;
 	cs_ret_code_t csRetCode = ERR_NOT_FOUND;
-	bool done = false;
 	LOGStorageDebug("Read record key=%u file=%u", recordKey, fileId);
+	if (_recordIndexValid) {
+		fds_record_desc_t* indexedRecordDesc = _recordIndex.find(fileId, recordKey);
+		if (indexedRecordDesc == NULL) {
+			LOGStorageDebug("Record not found");
+			return ERR_NOT_FOUND;
+		}
+		csRetCode = readRecord(*indexedRecordDesc, stateData.value, stateData.size, fileId);
+		if (csRetCode != ERR_NOT_FOUND) {
+			return csRetCode;
+		}
+		// Should not happen, as the index is updated on each write and remove.
+		LOGw("Indexed record not found key=%u file=%u", recordKey, fileId);
+		_recordIndex.remove(indexedRecordDesc->record_id);
+	}
+	bool done = false;
+	fds_record_desc_t foundRecordDesc;
 	initSearch();
 	while (fds_record_find(fileId, recordKey, &recordDesc, &_findToken) == NRF_SUCCESS) {
 		if (done) {
@@ -154,12 +179,16 @@ cs_ret_code_t Storage::read(cs_state_data_t & stateData) {
 		csRetCode = readRecord(recordDesc, stateData.value, stateData.size, fileId);
 		if (csRetCode == ERR_SUCCESS) {
 			done = true;
+			foundRecordDesc = recordDesc;
 		}
 //		if (done) {
 //			break;
 //		}
 	}
 	if (done) {
+		if (_recordIndexValid) {
+			_recordIndex.set(fileId, recordKey, foundRecordDesc);
+		}
 		return ERR_SUCCESS;
 	}
 	if (csRetCode == ERR_NOT_FOUND) {
@@ -265,7 +294,10 @@ cs_ret_code_t Storage::readNextInternal(uint16_t recordKey, uint16_t & fileId, u
 	return csRetCode;
 }
 
-cs_ret_code_t Storage::readRecord(fds_record_desc_t recordDesc, uint8_t* buf, uint16_t size, uint16_t & fileId) {
+/**
+ * The record descriptor is passed by reference, so that FDS can update the cached record address in it.
+ */
+cs_ret_code_t Storage::readRecord(fds_record_desc_t & recordDesc, uint8_t* buf, uint16_t size, uint16_t & fileId) {
 	fds_flash_record_t flashRecord;
 	ret_code_t fdsRetCode = fds_record_open(&recordDesc, &flashRecord);
 	switch (fdsRetCode) {
@@ -351,7 +383,7 @@ ret_code_t Storage::writeInternal(const cs_state_data_t & stateData) {
 		break;
 	case FDS_ERR_NO_SPACE_IN_FLASH: {
 		LOGStorageInfo("Flash is full, start garbage collection");
-		ret_code_t gcRetCode = garbageCollect();
+		ret_code_t gcRetCode = garbageCollectInternal(StorageGcReason::REACTIVE);
 		if (gcRetCode == NRF_SUCCESS) {
 			fdsRetCode = FDS_ERR_BUSY;
 		}
@@ -534,10 +566,10 @@ cs_ret_code_t Storage::continueFactoryReset() {
 }
 
 cs_ret_code_t Storage::garbageCollect() {
-	return getErrorCode(garbageCollectInternal());
+	return getErrorCode(garbageCollectInternal(StorageGcReason::REACTIVE));
 }
 
-ret_code_t Storage::garbageCollectInternal() {
+ret_code_t Storage::garbageCollectInternal(StorageGcReason reason) {
 	if (!_initialized) {
 		LOGe("Storage not initialized");
 		return ERR_NOT_INITIALIZED;
@@ -556,12 +588,82 @@ ret_code_t Storage::garbageCollectInternal() {
 		LOGw("Failed to start garbage collection (err=%i)", fdsRetCode);
 	}
 	else {
-		LOGStorageDebug("Started garbage collection");
+		LOGStorageDebug("Started garbage collection reason=%u", (uint8_t)reason);
 		_collectingGarbage = true;
+		storage_gc_flash_stats_t stats;
+		getFlashStats(stats);
+		_gcPolicy.onStarted(reason, stats, _uptimeMs);
 	}
 	return fdsRetCode;
 }
 
+void Storage::getFlashStats(storage_gc_flash_stats_t & stats) {
+	fds_stat_t fdsStats;
+	if (fds_stat(&fdsStats) != NRF_SUCCESS) {
+		stats.usedWords = 0;
+		stats.freeableWords = 0;
+		stats.largestContiguousWords = 0;
+		return;
+	}
+	stats.usedWords = fdsStats.words_used;
+	stats.freeableWords = fdsStats.freeable_words;
+	stats.largestContiguousWords = fdsStats.largest_contig;
+}
+
+void Storage::checkGarbageCollection() {
+	if (!_initialized || isErasingPages()) {
+		return;
+	}
+	if (_collectingGarbage || _removingFile || _performingFactoryReset || !_busyRecordKeys.empty()) {
+		// Use this check instead of isBusy(), as that one logs a warning.
+		return;
+	}
+	storage_gc_flash_stats_t stats;
+	getFlashStats(stats);
+	uint16_t schedulerQueueUse = SCHED_QUEUE_SIZE - app_sched_queue_space_get();
+	StorageGcReason reason = _gcPolicy.check(stats, schedulerQueueUse, _uptimeMs);
+	if (reason == StorageGcReason::NONE) {
+		return;
+	}
+	LOGStorageInfo("Background garbage collection reason=%u used=%u freeable=%u contig=%u", (uint8_t)reason, stats.usedWords, stats.freeableWords, stats.largestContiguousWords);
+	garbageCollectInternal(reason);
+}
+
+void Storage::handleEvent(event_t & event) {
+	switch (event.type) {
+		case CS_TYPE::EVT_TICK: {
+			TYPIFY(EVT_TICK) tickCount = *((TYPIFY(EVT_TICK)*)event.data);
+			_uptimeMs = tickCount * TICK_INTERVAL_MS;
+			if (tickCount % (STORAGE_GC_CHECK_INTERVAL_MS / TICK_INTERVAL_MS) == 0) {
+				checkGarbageCollection();
+			}
+			break;
+		}
+		case CS_TYPE::EVT_BLE_CONNECT: {
+			_gcPolicy.setConnected(true, _uptimeMs);
+			break;
+		}
+		case CS_TYPE::EVT_BLE_DISCONNECT: {
+			_gcPolicy.setConnected(false, _uptimeMs);
+			break;
+		}
+		case CS_TYPE::CMD_GET_STORAGE_GC_STATS: {
+			_gcPolicy.getStats(event.result);
+			break;
+		}
+		case CS_TYPE::CMD_SEND_MESH_MSG:
+		case CS_TYPE::CMD_SEND_MESH_MSG_MULTI_SWITCH:
+		case CS_TYPE::EVT_MESH_EXT_STATE_0:
+		case CS_TYPE::EVT_MESH_EXT_STATE_1:
+		case CS_TYPE::EVT_MESH_SYNC_REQUEST_INCOMING: {
+			_gcPolicy.onMeshActivity(_uptimeMs);
+			break;
+		}
+		default:
+			break;
+	}
+}
+
 cs_ret_code_t Storage::eraseAllPages() {
 	LOGw("eraseAllPages");
 	if (_initialized || isErasingPages()) {
@@ -702,6 +804,14 @@ void Storage::initSearch() {
  * Returns the last found record.
  */
 ret_code_t Storage::exists(cs_file_id_t fileId, uint16_t recordKey, fds_record_desc_t & record_desc, bool & result) {
+	if (_recordIndexValid) {
+		fds_record_desc_t* indexedRecordDesc = _recordIndex.find(fileId, recordKey);
+		result = (indexedRecordDesc != NULL);
+		if (result) {
+			record_desc = *indexedRecordDesc;
+		}
+		return ERR_SUCCESS;
+	}
 	initSearch();
 	result = false;
 	while (fds_record_find(fileId, recordKey, &record_desc, &_findToken) == NRF_SUCCESS) {
@@ -716,6 +826,32 @@ ret_code_t Storage::exists(cs_file_id_t fileId, uint16_t recordKey, fds_record_d
 	return ERR_SUCCESS;
 }
 
+void Storage::buildRecordIndex() {
+	_recordIndex.clear();
+	fds_find_token_t findToken;
+	memset(&findToken, 0x00, sizeof(fds_find_token_t));
+	fds_record_desc_t recordDesc;
+	fds_flash_record_t flashRecord;
+	// Records are iterated in order of writing, so in case of duplicates, the last written record ends up in the index.
+	while (fds_record_iterate(&recordDesc, &findToken) == NRF_SUCCESS) {
+		if (fds_record_open(&recordDesc, &flashRecord) != NRF_SUCCESS) {
+			// Corrupted records are not indexed.
+			continue;
+		}
+		uint16_t fileId = flashRecord.p_header->file_id;
+		uint16_t recordKey = flashRecord.p_header->record_key;
+		if (fds_record_close(&recordDesc) != NRF_SUCCESS) {
+			LOGe("Error on closing record");
+		}
+		if (_recordIndex.find(fileId, recordKey) != NULL) {
+			LOGe("Duplicate record key=%u file=%u", recordKey, fileId);
+		}
+		_recordIndex.set(fileId, recordKey, recordDesc);
+	}
+	_recordIndexValid = true;
+	LOGStorageInfo("Indexed %u records", _recordIndex.size());
+}
+
 void Storage::setBusy(uint16_t recordKey) {
 	_busyRecordKeys.push_back(recordKey);
 }
@@ -789,6 +925,13 @@ void Storage::handleWriteEvent(fds_evt_t const * p_fds_evt) {
 	eventData.id = getStateId(p_fds_evt->write.file_id);
 	switch (p_fds_evt->result) {
 	case NRF_SUCCESS: {
+		if (_recordIndexValid) {
+			// FDS looks up the record address by record id on first use of the descriptor.
+			fds_record_desc_t recordDesc;
+			fds_descriptor_from_rec_id(&recordDesc, p_fds_evt->write.record_id);
+			_recordIndex.set(p_fds_evt->write.file_id, p_fds_evt->write.record_key, recordDesc);
+		}
+		_gcPolicy.onWrite(_uptimeMs);
 		LOGStorageDebug("Write done, key=%u file=%u type=%u id=%u", p_fds_evt->del.record_key, p_fds_evt->del.file_id, to_underlying_type(eventData.type), eventData.id);
 		event_t event(CS_TYPE::EVT_STORAGE_WRITE_DONE, &eventData, sizeof(eventData));
 		EventDispatcher::getInstance().dispatch(event);
@@ -813,6 +956,8 @@ void Storage::handleRemoveRecordEvent(fds_evt_t const * p_fds_evt) {
 	eventData.id = getStateId(p_fds_evt->del.file_id);
 	switch (p_fds_evt->result) {
 	case NRF_SUCCESS: {
+		_recordIndex.remove(p_fds_evt->del.record_id);
+		_gcPolicy.onWrite(_uptimeMs);
 		LOGStorageInfo("Remove done, key=%u file=%u type=%u id=%u", p_fds_evt->del.record_key, p_fds_evt->del.file_id, to_underlying_type(eventData.type), eventData.id);
 		if (_performingFactoryReset) {
 			continueFactoryReset();
@@ -839,6 +984,7 @@ void Storage::handleRemoveFileEvent(fds_evt_t const * p_fds_evt) {
 	cs_state_id_t id = getStateId(p_fds_evt->write.file_id);
 	switch (p_fds_evt->result) {
 	case NRF_SUCCESS: {
+		_recordIndex.removeFile(p_fds_evt->del.file_id);
 		LOGStorageInfo("Remove file done, file=%u id=%u", p_fds_evt->del.file_id, id);
 		event_t event(CS_TYPE::EVT_STORAGE_REMOVE_ALL_TYPES_WITH_ID_DONE, &id, sizeof(id));
 		EventDispatcher::getInstance().dispatch(event);
@@ -857,9 +1003,14 @@ void Storage::handleRemoveFileEvent(fds_evt_t const * p_fds_evt) {
 
 void Storage::handleGarbageCollectionEvent(fds_evt_t const * p_fds_evt) {
 	_collectingGarbage = false;
+	storage_gc_flash_stats_t stats;
+	getFlashStats(stats);
+	_gcPolicy.onDone(stats, _uptimeMs);
 	switch (p_fds_evt->result) {
 	case NRF_SUCCESS: {
 		LOGStorageInfo("Garbage collection successful");
+		// Records have been moved, so refresh all record addresses.
+		buildRecordIndex();
 		if (_performingFactoryReset) {
 			_performingFactoryReset = false;
 			event_t resetEvent(CS_TYPE::EVT_STORAGE_FACTORY_RESET_DONE);
@@ -900,6 +1051,7 @@ void Storage::handleFileStorageEvent(fds_evt_t const * p_fds_evt) {
 		if (p_fds_evt->result == NRF_SUCCESS) {
 			LOGStorageDebug("Storage initialized");
 			_initialized = true;
+			buildRecordIndex();
 			event_t event(CS_TYPE::EVT_STORAGE_INITIALIZED);
 			EventDispatcher::getInstance().dispatch(event);
 		}
@@ -41,7 +41,7 @@ bool Mesh::checkFlashValid() {
 
 cs_ret_code_t Mesh::init(const boards_config_t& board) {
 	LOGi("init");
-	_msgHandler.init();
+	_msgHandler.init(&_linkQuality, &_bulkTransfer);
 	_core->registerModelInitCallback([&]() -> void {
 		initModels();
 	});
@@ -51,8 +51,21 @@ cs_ret_code_t Mesh::init(const boards_config_t& board) {
 	_core->registerScanCallback([&](const nrf_mesh_adv_packet_rx_data_t *scanData) -> void {
 		_scanner.onScan(scanData);
 	});
+#if MESH_RELAY_SUPPRESSION == 1
+	_core->registerRelayCallback([&](uint16_t srcAddress, uint16_t dstAddress, uint8_t ttl) -> bool {
+		uint8_t rand8;
+		RNG::fillBuffer(&rand8, 1);
+		return _linkQuality.shouldRelay(srcAddress, ACCESS_DEFAULT_TTL - ttl, rand8);
+	});
+#endif
+	_modelMulticast.setTelemetry(&_telemetry);
+	_modelMulticastAcked.setTelemetry(&_telemetry);
+	_modelUnicast.setTelemetry(&_telemetry);
 	_modelSelector.init(&_modelMulticast, &_modelMulticastAcked, &_modelUnicast);
-	_msgSender.init(&_modelSelector);
+	_msgSender.init(&_modelSelector, &_linkQuality);
+	uint8_t firstTransferId;
+	RNG::fillBuffer(&firstTransferId, 1);
+	_bulkTransfer.init(&_modelSelector, firstTransferId);
 	return _core->init(board);
 }
 
@@ -180,6 +193,15 @@ void Mesh::handleEvent(event_t & event) {
 		_modelMulticast.tick(tickCount);
 		_modelMulticastAcked.tick(tickCount);
 		_modelUnicast.tick(tickCount);
+		_msgHandler.tick(tickCount);
+		_linkQuality.tick(tickCount);
+		_bulkTransfer.tick(tickCount);
+		_telemetry.tick(tickCount);
+#if MESH_TELEMETRY_UART_INTERVAL_MS != 0
+		if (tickCount % (MESH_TELEMETRY_UART_INTERVAL_MS / TICK_INTERVAL_MS) == 0) {
+			UartProtocol::getInstance().writeMsg(UART_OPCODE_TX_MESH_TELEMETRY, (uint8_t*)&(_telemetry.getStats()), sizeof(cs_mesh_telemetry_t));
+		}
+#endif
 		break;
 	}
 	case CS_TYPE::CMD_ENABLE_MESH: {
@@ -195,6 +217,24 @@ void Mesh::handleEvent(event_t & event) {
 #endif
 			break;
 	}
+	case CS_TYPE::CMD_GET_MESH_LINK_QUALITY: {
+		_linkQuality.getTable(event.result);
+		break;
+	}
+	case CS_TYPE::CMD_GET_MESH_TELEMETRY: {
+		_telemetry.getStats(event.result);
+		break;
+	}
+	case CS_TYPE::CMD_RESET_MESH_TELEMETRY: {
+		_telemetry.reset();
+		event.result.returnCode = ERR_SUCCESS;
+		break;
+	}
+	case CS_TYPE::CMD_SEND_MESH_BULK_TRANSFER: {
+		TYPIFY(CMD_SEND_MESH_BULK_TRANSFER)* transfer = (TYPIFY(CMD_SEND_MESH_BULK_TRANSFER)*)event.data;
+		event.result.returnCode = _bulkTransfer.send(transfer->stoneId, transfer->type, transfer->data);
+		break;
+	}
 	case CS_TYPE::EVT_GENERIC_TEST: {
 		LOGd("generic test event received, calling requestSync()");
 		requestSync();
@@ -0,0 +1,399 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <drivers/cs_Serial.h>
+#include <events/cs_Event.h>
+#include <mesh/cs_MeshBulkTransfer.h>
+#include <util/cs_BleError.h>
+#include <util/cs_Hash.h>
+
+#include <cstdlib>
+#include <cstring>
+
+#define LOGMeshBulkTransferDebug LOGnone
+
+static_assert(MESH_BULK_TRANSFER_MAX_SIZE / MESH_BULK_TRANSFER_CHUNK_SIZE < 0xFF, "Chunk index must fit in a uint8_t");
+static_assert(MESH_BULK_TRANSFER_WINDOW_SIZE <= 8 * MESH_BULK_ACK_BITMASK_SIZE, "Window must fit in the ack bitmask");
+static_assert(sizeof(cs_mesh_model_msg_bulk_ack_request_t) <= MAX_MESH_MSG_NON_SEGMENTED_SIZE - MESH_HEADER_SIZE, "Ack request must not be segmented");
+
+void MeshBulkTransfer::init(MeshModelSelector* selector, uint8_t firstTransferId) {
+	_selector = selector;
+	// Incremented before each transfer.
+	_sendTransferId = firstTransferId - 1;
+}
+
+uint8_t MeshBulkTransfer::getNumChunks(size16_t size) {
+	return (size + MESH_BULK_TRANSFER_CHUNK_SIZE - 1) / MESH_BULK_TRANSFER_CHUNK_SIZE;
+}
+
+uint16_t MeshBulkTransfer::getChecksum(const uint8_t* data, size16_t size) {
+	uint32_t hash = Fletcher(data, size);
+	return (hash >> 16) ^ (hash & 0xFFFF);
+}
+
+bool MeshBulkTransfer::isSameTransfer(const cs_mesh_model_msg_bulk_ack_request_t& request1, const cs_mesh_model_msg_bulk_ack_request_t& request2) {
+	return request1.transferId == request2.transferId
+			&& request1.type == request2.type
+			&& request1.size == request2.size
+			&& request1.checksum == request2.checksum;
+}
+
+MeshBulkTransfer::cs_mesh_bulk_transfer_stats_t& MeshBulkTransfer::getStats() {
+	return _stats;
+}
+
+void MeshBulkTransfer::tick(uint32_t tickCount) {
+	sendTick();
+
+	if (_recvBuf != nullptr && --_recvTimeoutTicks == 0) {
+		LOGw("Bulk transfer from %u timed out", _recvSrcId);
+		clearReceive();
+	}
+
+	if (_recvDoneSrcId != 0 && --_recvDoneTimeoutTicks == 0) {
+		_recvDoneSrcId = 0;
+	}
+}
+
+/*
+ * Sender.
+ */
+
+cs_ret_code_t MeshBulkTransfer::send(stone_id_t targetId, uint8_t type, cs_data_t data) {
+	assert(_selector != nullptr, "No model selector set.");
+	if (_sendState != SEND_STATE_IDLE) {
+		return ERR_BUSY;
+	}
+	if (data.len == 0 || data.len > MESH_BULK_TRANSFER_MAX_SIZE) {
+		return ERR_WRONG_PAYLOAD_LENGTH;
+	}
+	_sendBuf = (uint8_t*)malloc(data.len);
+	if (_sendBuf == nullptr) {
+		return ERR_NO_SPACE;
+	}
+	memcpy(_sendBuf, data.data, data.len);
+	_sendInfo.stoneId = targetId;
+	_sendInfo.type = type;
+	_sendInfo.returnCode = ERR_SUCCESS;
+	_sendSize = data.len;
+	_sendChecksum = getChecksum(_sendBuf, _sendSize);
+	_sendNumChunks = getNumChunks(data.len);
+	_sendTransferId++;
+	_sendAckedIndex = 0;
+	_sendAckedBitmask = 0;
+	_sendIndex = 0;
+	_sendHighestIndex = 0;
+	_sendRetries = 0;
+	_sendState = SEND_STATE_REQUEST;
+	LOGi("Start bulk transfer id=%u to %u: type=%u size=%u chunks=%u", _sendTransferId, targetId, type, _sendSize, _sendNumChunks);
+	sendTick();
+	return ERR_SUCCESS;
+}
+
+bool MeshBulkTransfer::isSending() {
+	return _sendState != SEND_STATE_IDLE;
+}
+
+void MeshBulkTransfer::sendTick() {
+	switch (_sendState) {
+		case SEND_STATE_IDLE:
+			break;
+		case SEND_STATE_REQUEST:
+			if (sendAckRequest()) {
+				_sendState = SEND_STATE_WAIT_FOR_ACK;
+				_sendWaitTicks = (MESH_BULK_TRANSFER_ACK_TIMEOUT_S * 1000 + MESH_BULK_TRANSFER_RETRY_DELAY_MS) / TICK_INTERVAL_MS;
+			}
+			break;
+		case SEND_STATE_WAIT_FOR_ACK:
+			if (--_sendWaitTicks == 0) {
+				LOGw("Bulk transfer ack timeout");
+				_stats.ackTimeouts++;
+				retry();
+			}
+			break;
+		case SEND_STATE_SEND_CHUNKS:
+			sendChunks();
+			break;
+		case SEND_STATE_WAIT_FOR_RETRY:
+			if (--_sendWaitTicks == 0) {
+				_sendState = SEND_STATE_REQUEST;
+			}
+			break;
+	}
+}
+
+bool MeshBulkTransfer::sendAckRequest() {
+	cs_mesh_model_msg_bulk_ack_request_t request;
+	request.transferId = _sendTransferId;
+	request.seq = ++_sendSeq;
+	request.type = _sendInfo.type;
+	request.size = _sendSize;
+	request.checksum = _sendChecksum;
+
+	MeshUtil::cs_mesh_queue_item_t item;
+	item.metaData.id = 0;
+	item.metaData.type = CS_MESH_MODEL_TYPE_BULK_ACK_REQUEST;
+	item.metaData.transmissionsOrTimeout = MESH_BULK_TRANSFER_ACK_TIMEOUT_S;
+	item.metaData.priority = false;
+	item.reliable = true;
+	item.broadcast = false;
+	item.numIds = 1;
+	item.stoneIdsPtr = &(_sendInfo.stoneId);
+	item.msgPayload.data = (uint8_t*)&request;
+	item.msgPayload.len = sizeof(request);
+
+	// An older request might still be queued, when its reply got lost.
+	_selector->remFromQueue(item);
+	cs_ret_code_t retCode = _selector->addToQueue(item);
+	LOGMeshBulkTransferDebug("Request ack seq=%u retCode=%u", request.seq, retCode);
+	if (retCode != ERR_SUCCESS) {
+		return false;
+	}
+	_stats.ackRequests++;
+	return true;
+}
+
+void MeshBulkTransfer::sendChunks() {
+	uint8_t windowEnd = _sendAckedIndex + MESH_BULK_TRANSFER_WINDOW_SIZE;
+	if (windowEnd > _sendNumChunks) {
+		windowEnd = _sendNumChunks;
+	}
+	uint8_t buf[sizeof(cs_mesh_model_msg_bulk_chunk_header_t) + MESH_BULK_TRANSFER_CHUNK_SIZE];
+	cs_mesh_model_msg_bulk_chunk_header_t* header = (cs_mesh_model_msg_bulk_chunk_header_t*)buf;
+
+	MeshUtil::cs_mesh_queue_item_t item;
+	item.metaData.id = 0;
+	item.metaData.type = CS_MESH_MODEL_TYPE_BULK_CHUNK;
+	item.metaData.transmissionsOrTimeout = 1;
+	item.metaData.priority = false;
+	item.reliable = false;
+	item.broadcast = false;
+	item.numIds = 1;
+	item.stoneIdsPtr = &(_sendInfo.stoneId);
+	item.msgPayload.data = buf;
+
+	uint8_t numSent = 0;
+	while (_sendIndex < windowEnd && numSent < MESH_BULK_TRANSFER_CHUNKS_PER_TICK) {
+		uint8_t offset = _sendIndex - _sendAckedIndex;
+		if (_sendAckedBitmask & (1 << offset)) {
+			_sendIndex++;
+			continue;
+		}
+		size16_t chunkStart = _sendIndex * MESH_BULK_TRANSFER_CHUNK_SIZE;
+		size16_t chunkSize = _sendSize - chunkStart;
+		if (chunkSize > MESH_BULK_TRANSFER_CHUNK_SIZE) {
+			chunkSize = MESH_BULK_TRANSFER_CHUNK_SIZE;
+		}
+		header->transferId = _sendTransferId;
+		header->index = _sendIndex;
+		memcpy(buf + sizeof(*header), _sendBuf + chunkStart, chunkSize);
+		item.msgPayload.len = sizeof(*header) + chunkSize;
+
+		cs_ret_code_t retCode = _selector->addToQueue(item);
+		if (retCode == ERR_BUSY) {
+			// Try again next tick.
+			return;
+		}
+		if (retCode != ERR_SUCCESS) {
+			finishSend(retCode);
+			return;
+		}
+		_stats.chunksSent++;
+		if (_sendIndex < _sendHighestIndex) {
+			_stats.chunksResent++;
+		}
+		_sendIndex++;
+		if (_sendIndex > _sendHighestIndex) {
+			_sendHighestIndex = _sendIndex;
+		}
+		numSent++;
+	}
+	if (_sendIndex >= windowEnd) {
+		// Request the ack next tick, so that the last chunk is sent first.
+		_sendState = SEND_STATE_REQUEST;
+	}
+}
+
+void MeshBulkTransfer::handleAck(stone_id_t srcId, cs_ret_code_t retCode, cs_data_t resultData) {
+	if (_sendState != SEND_STATE_WAIT_FOR_ACK || srcId != _sendInfo.stoneId) {
+		return;
+	}
+	if (resultData.len != sizeof(cs_mesh_model_msg_bulk_ack_t)) {
+		LOGw("Wrong ack size: %u", resultData.len);
+		return;
+	}
+	cs_mesh_model_msg_bulk_ack_t* ack = (cs_mesh_model_msg_bulk_ack_t*)resultData.data;
+	if (ack->seq != _sendSeq) {
+		// Reply to an older request.
+		return;
+	}
+	LOGMeshBulkTransferDebug("Ack seq=%u retCode=%u nextIndex=%u", ack->seq, retCode, ack->nextIndex);
+	switch (retCode) {
+		case ERR_SUCCESS:
+			break;
+		case ERR_BUSY:
+			retry();
+			return;
+		default:
+			finishSend(retCode);
+			return;
+	}
+	_sendRetries = 0;
+	_sendAckedIndex = ack->nextIndex;
+	_sendAckedBitmask = 0;
+	for (uint8_t i = 0; i < MESH_BULK_ACK_BITMASK_SIZE; ++i) {
+		_sendAckedBitmask |= ack->bitmask[i] << (8 * i);
+	}
+	if (_sendAckedIndex >= _sendNumChunks) {
+		finishSend(ERR_SUCCESS);
+		return;
+	}
+	_sendIndex = _sendAckedIndex;
+	_sendState = SEND_STATE_SEND_CHUNKS;
+}
+
+void MeshBulkTransfer::retry() {
+	if (_sendRetries >= MESH_BULK_TRANSFER_MAX_RETRIES) {
+		finishSend(ERR_TIMEOUT);
+		return;
+	}
+	_sendWaitTicks = (MESH_BULK_TRANSFER_RETRY_DELAY_MS << _sendRetries) / TICK_INTERVAL_MS;
+	_sendRetries++;
+	_sendState = SEND_STATE_WAIT_FOR_RETRY;
+}
+
+void MeshBulkTransfer::finishSend(cs_ret_code_t retCode) {
+	LOGi("Bulk transfer id=%u to %u done: retCode=%u", _sendTransferId, _sendInfo.stoneId, retCode);
+	free(_sendBuf);
+	_sendBuf = nullptr;
+	_sendState = SEND_STATE_IDLE;
+	_sendInfo.returnCode = retCode;
+	event_t event(CS_TYPE::EVT_MESH_BULK_TRANSFER_RESULT, &_sendInfo, sizeof(_sendInfo));
+	event.dispatch();
+}
+
+/*
+ * Receiver.
+ */
+
+void MeshBulkTransfer::handleAckRequest(stone_id_t srcId, uint8_t* payload, size16_t payloadSize, cs_result_t& result) {
+	cs_mesh_model_msg_bulk_ack_request_t* request = (cs_mesh_model_msg_bulk_ack_request_t*)payload;
+	if (result.buf.len < sizeof(cs_mesh_model_msg_bulk_ack_t)) {
+		result.returnCode = ERR_BUFFER_TOO_SMALL;
+		return;
+	}
+	cs_mesh_model_msg_bulk_ack_t* ack = (cs_mesh_model_msg_bulk_ack_t*)result.buf.data;
+	memset(ack, 0, sizeof(*ack));
+	// Always set the ack, so that each reply is unique.
+	ack->seq = request->seq;
+	result.dataSize = sizeof(*ack);
+
+	if (_recvDoneSrcId != 0 && srcId == _recvDoneSrcId && isSameTransfer(*request, _recvDoneInfo)) {
+		// The reply to a previous request got lost.
+		ack->nextIndex = _recvDoneNumChunks;
+		result.returnCode = ERR_SUCCESS;
+		return;
+	}
+
+	if (_recvBuf != nullptr && srcId == _recvSrcId && isSameTransfer(*request, _recvInfo)) {
+		_recvTimeoutTicks = MESH_BULK_TRANSFER_RECEIVE_TIMEOUT_MS / TICK_INTERVAL_MS;
+	}
+	else {
+		if (_recvBuf != nullptr && srcId != _recvSrcId) {
+			result.returnCode = ERR_BUSY;
+			return;
+		}
+		// New transfer, which replaces an older one of the same source.
+		if (request->size == 0 || request->size > MESH_BULK_TRANSFER_MAX_SIZE) {
+			result.returnCode = ERR_WRONG_PAYLOAD_LENGTH;
+			return;
+		}
+		clearReceive();
+		_recvBuf = (uint8_t*)malloc(request->size);
+		if (_recvBuf == nullptr) {
+			result.returnCode = ERR_NO_SPACE;
+			return;
+		}
+		LOGi("Receive bulk transfer id=%u from %u: type=%u size=%u", request->transferId, srcId, request->type, request->size);
+		_recvInfo = *request;
+		_recvSrcId = srcId;
+		_recvNumChunks = getNumChunks(request->size);
+		_recvNumReceived = 0;
+		memset(_recvReceivedBitmask, 0, sizeof(_recvReceivedBitmask));
+		_recvTimeoutTicks = MESH_BULK_TRANSFER_RECEIVE_TIMEOUT_MS / TICK_INTERVAL_MS;
+	}
+
+	uint8_t nextIndex = 0;
+	while (nextIndex < _recvNumChunks && isReceived(nextIndex)) {
+		nextIndex++;
+	}
+	ack->nextIndex = nextIndex;
+	for (uint8_t i = 0; i < 8 * MESH_BULK_ACK_BITMASK_SIZE && nextIndex + i < _recvNumChunks; ++i) {
+		if (isReceived(nextIndex + i)) {
+			ack->bitmask[i / 8] |= 1 << (i % 8);
+		}
+	}
+	result.returnCode = ERR_SUCCESS;
+}
+
+cs_ret_code_t MeshBulkTransfer::handleChunk(stone_id_t srcId, uint8_t* payload, size16_t payloadSize) {
+	cs_mesh_model_msg_bulk_chunk_header_t* header = (cs_mesh_model_msg_bulk_chunk_header_t*)payload;
+	if (_recvBuf == nullptr || srcId != _recvSrcId || header->transferId != _recvInfo.transferId) {
+		return ERR_WRONG_STATE;
+	}
+	if (header->index >= _recvNumChunks) {
+		return ERR_WRONG_PARAMETER;
+	}
+	size16_t chunkStart = header->index * MESH_BULK_TRANSFER_CHUNK_SIZE;
+	size16_t chunkSize = _recvInfo.size - chunkStart;
+	if (chunkSize > MESH_BULK_TRANSFER_CHUNK_SIZE) {
+		chunkSize = MESH_BULK_TRANSFER_CHUNK_SIZE;
+	}
+	if (payloadSize != sizeof(*header) + chunkSize) {
+		return ERR_WRONG_PAYLOAD_LENGTH;
+	}
+	_recvTimeoutTicks = MESH_BULK_TRANSFER_RECEIVE_TIMEOUT_MS / TICK_INTERVAL_MS;
+	if (isReceived(header->index)) {
+		return ERR_SUCCESS;
+	}
+	memcpy(_recvBuf + chunkStart, payload + sizeof(*header), chunkSize);
+	_recvReceivedBitmask[header->index / 8] |= 1 << (header->index % 8);
+	_recvNumReceived++;
+	LOGMeshBulkTransferDebug("Received chunk %u (%u/%u)", header->index, _recvNumReceived, _recvNumChunks);
+	if (_recvNumReceived == _recvNumChunks) {
+		finishReceive();
+	}
+	return ERR_SUCCESS;
+}
+
+bool MeshBulkTransfer::isReceived(uint8_t index) {
+	return _recvReceivedBitmask[index / 8] & (1 << (index % 8));
+}
+
+void MeshBulkTransfer::finishReceive() {
+	LOGi("Received bulk transfer id=%u from %u", _recvInfo.transferId, _recvSrcId);
+	_recvDoneSrcId = _recvSrcId;
+	_recvDoneInfo = _recvInfo;
+	_recvDoneNumChunks = _recvNumChunks;
+	_recvDoneTimeoutTicks = MESH_BULK_TRANSFER_RECEIVE_TIMEOUT_MS / TICK_INTERVAL_MS;
+
+	TYPIFY(EVT_MESH_BULK_TRANSFER_RECEIVED) received;
+	received.stoneId = _recvSrcId;
+	received.type = _recvInfo.type;
+	received.data.data = _recvBuf;
+	received.data.len = _recvInfo.size;
+	event_t event(CS_TYPE::EVT_MESH_BULK_TRANSFER_RECEIVED, &received, sizeof(received));
+	event.dispatch();
+
+	clearReceive();
+}
+
+void MeshBulkTransfer::clearReceive() {
+	free(_recvBuf);
+	_recvBuf = nullptr;
+	_recvSrcId = 0;
+}
@@ -213,6 +213,14 @@ void MeshCore::scanCallback(const nrf_mesh_adv_packet_rx_data_t *scanData) {
 	_scanCallback(scanData);
 }
 
+static bool relay_cb(uint16_t src, uint16_t dst, uint8_t ttl) {
+	return MeshCore::getInstance().relayCallback(src, dst, ttl);
+}
+
+bool MeshCore::relayCallback(uint16_t srcAddress, uint16_t dstAddress, uint8_t ttl) {
+	return _relayCallback(srcAddress, dstAddress, ttl);
+}
+
 
 static void staticModelsInitCallback() {
 	MeshCore::getInstance().modelsInitCallback();
@@ -245,6 +253,10 @@ void MeshCore::registerScanCallback(const callback_scan_t& closure) {
 	_scanCallback = closure;
 }
 
+void MeshCore::registerRelayCallback(const callback_relay_t& closure) {
+	_relayCallback = closure;
+}
+
 cs_ret_code_t MeshCore::init(const boards_config_t& board) {
 #if CS_SERIAL_NRF_LOG_ENABLED == 1
 	__LOG_INIT(LOG_SRC_APP | LOG_SRC_PROV | LOG_SRC_ACCESS | LOG_SRC_BEARER | LOG_SRC_TRANSPORT | LOG_SRC_NETWORK, LOG_LEVEL_DBG3, LOG_CALLBACK_DEFAULT);
@@ -271,7 +283,7 @@ cs_ret_code_t MeshCore::init(const boards_config_t& board) {
 	init_params.core.irq_priority       = NRF_MESH_IRQ_PRIORITY_THREAD; // See mesh_interrupt_priorities.md
 	init_params.core.lfclksrc           = lfclksrc;
 	init_params.core.p_uuid             = NULL;
-	init_params.core.relay_cb           = NULL;
+	init_params.core.relay_cb           = (_relayCallback == nullptr) ? NULL : relay_cb;
 	init_params.models.models_init_cb   = staticModelsInitCallback;
 	init_params.models.config_server_cb = configServerEventCallback;
 
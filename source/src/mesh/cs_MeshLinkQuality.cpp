@@ -0,0 +1,203 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <cfg/cs_Config.h>
+#include <mesh/cs_MeshLinkQuality.h>
+
+#include <cstring>
+
+#define RECEPTION_RATE_MAX 0xFFFF
+
+MeshLinkQuality::MeshLinkQuality() {
+	clear();
+}
+
+void MeshLinkQuality::clear() {
+	for (uint8_t i = 0; i < MESH_LINK_QUALITY_TABLE_SIZE; ++i) {
+		_entries[i].stoneId = 0;
+	}
+}
+
+void MeshLinkQuality::setAdaptive(bool enable) {
+	_adaptive = enable;
+}
+
+void MeshLinkQuality::setRelaySuppression(bool enable) {
+	_relaySuppression = enable;
+}
+
+MeshLinkQuality::cs_mesh_link_quality_entry_t* MeshLinkQuality::find(stone_id_t stoneId) {
+	for (uint8_t i = 0; i < MESH_LINK_QUALITY_TABLE_SIZE; ++i) {
+		if (_entries[i].stoneId == stoneId) {
+			return &(_entries[i]);
+		}
+	}
+	return nullptr;
+}
+
+MeshLinkQuality::cs_mesh_link_quality_entry_t* MeshLinkQuality::getFreeEntry() {
+	cs_mesh_link_quality_entry_t* oldest = &(_entries[0]);
+	for (uint8_t i = 0; i < MESH_LINK_QUALITY_TABLE_SIZE; ++i) {
+		if (_entries[i].stoneId == 0) {
+			return &(_entries[i]);
+		}
+		if (_entries[i].lastSeenSeconds > oldest->lastSeenSeconds) {
+			oldest = &(_entries[i]);
+		}
+	}
+	return oldest;
+}
+
+void MeshLinkQuality::onReceived(stone_id_t srcId, int8_t rssi, uint8_t hops) {
+	if (srcId == 0) {
+		return;
+	}
+	cs_mesh_link_quality_entry_t* entry = find(srcId);
+	if (hops != 0) {
+		// Only counts as a missed direct reception for known neighbours.
+		if (entry != nullptr) {
+			entry->receptionRate -= entry->receptionRate >> MESH_LINK_QUALITY_EWMA_SHIFT;
+		}
+		return;
+	}
+	if (entry == nullptr) {
+		entry = getFreeEntry();
+		entry->stoneId = srcId;
+		entry->rssi = rssi * 16;
+		entry->receptionRate = RECEPTION_RATE_MAX;
+	}
+	else {
+		entry->rssi += (rssi * 16 - entry->rssi) / (1 << MESH_LINK_QUALITY_EWMA_SHIFT);
+		entry->receptionRate += (RECEPTION_RATE_MAX - entry->receptionRate) >> MESH_LINK_QUALITY_EWMA_SHIFT;
+	}
+	entry->lastSeenSeconds = 0;
+}
+
+void MeshLinkQuality::tick(uint32_t tickCount) {
+	if (tickCount % (1000 / TICK_INTERVAL_MS) != 0) {
+		return;
+	}
+	for (uint8_t i = 0; i < MESH_LINK_QUALITY_TABLE_SIZE; ++i) {
+		if (_entries[i].stoneId == 0) {
+			continue;
+		}
+		_entries[i].lastSeenSeconds++;
+		if (_entries[i].lastSeenSeconds >= MESH_LINK_QUALITY_TIMEOUT_MS / 1000) {
+			_entries[i].stoneId = 0;
+		}
+	}
+}
+
+bool MeshLinkQuality::isGoodLink(const cs_mesh_link_quality_entry_t& entry) {
+	return entry.stoneId != 0
+			&& entry.rssi >= MESH_LINK_QUALITY_GOOD_RSSI * 16
+			&& entry.receptionRate >= (uint32_t)RECEPTION_RATE_MAX * MESH_LINK_QUALITY_GOOD_RECEPTION_RATE_PERCENTAGE / 100;
+}
+
+uint8_t MeshLinkQuality::getNumGoodLinks() {
+	uint8_t count = 0;
+	for (uint8_t i = 0; i < MESH_LINK_QUALITY_TABLE_SIZE; ++i) {
+		if (isGoodLink(_entries[i])) {
+			count++;
+		}
+	}
+	return count;
+}
+
+uint8_t MeshLinkQuality::getTransmissions(uint8_t defaultTransmissions) {
+	if (!_adaptive) {
+		return defaultTransmissions;
+	}
+	bool anyNeighbour = false;
+	for (uint8_t i = 0; i < MESH_LINK_QUALITY_TABLE_SIZE; ++i) {
+		if (_entries[i].stoneId != 0) {
+			anyNeighbour = true;
+			break;
+		}
+	}
+	if (!anyNeighbour) {
+		return defaultTransmissions;
+	}
+	uint8_t numGoodLinks = getNumGoodLinks();
+	uint16_t transmissions = defaultTransmissions;
+	if (numGoodLinks >= MESH_LINK_QUALITY_DENSE_NEIGHBOURS) {
+		transmissions = (transmissions + 1) / 2;
+	}
+	else if (numGoodLinks == 0) {
+		transmissions += 2;
+	}
+	else if (numGoodLinks < MESH_LINK_QUALITY_SPARSE_NEIGHBOURS) {
+		transmissions += 1;
+	}
+	if (transmissions > MESH_MODEL_TRANSMISSIONS_MAX) {
+		transmissions = MESH_MODEL_TRANSMISSIONS_MAX;
+	}
+	return transmissions;
+}
+
+uint8_t MeshLinkQuality::getRelayPercentage() {
+	if (!_relaySuppression) {
+		return 100;
+	}
+	uint8_t numGoodLinks = getNumGoodLinks();
+	if (numGoodLinks < MESH_RELAY_SUPPRESSION_MIN_NEIGHBOURS) {
+		return 100;
+	}
+	uint8_t percentage = MESH_RELAY_SUPPRESSION_RELAYERS * 100 / numGoodLinks;
+	if (percentage < MESH_RELAY_SUPPRESSION_MIN_PERCENTAGE) {
+		percentage = MESH_RELAY_SUPPRESSION_MIN_PERCENTAGE;
+	}
+	return percentage;
+}
+
+bool MeshLinkQuality::shouldRelay(stone_id_t srcId, uint8_t hops, uint8_t random) {
+	uint8_t percentage = getRelayPercentage();
+	if (percentage >= 100) {
+		return true;
+	}
+	if (hops == 0) {
+		if (srcId == 0) {
+			return true;
+		}
+		cs_mesh_link_quality_entry_t* entry = find(srcId);
+		if (entry == nullptr || !isGoodLink(*entry)) {
+			return true;
+		}
+	}
+	return (uint16_t)random * 100 / 256 < percentage;
+}
+
+void MeshLinkQuality::getTable(cs_result_t& result) {
+	uint16_t count = 0;
+	for (uint8_t i = 0; i < MESH_LINK_QUALITY_TABLE_SIZE; ++i) {
+		if (_entries[i].stoneId != 0) {
+			count++;
+		}
+	}
+	size16_t size = sizeof(cs_mesh_link_quality_header_t) + count * sizeof(cs_mesh_link_quality_item_t);
+	if (result.buf.len < size) {
+		result.returnCode = ERR_BUFFER_TOO_SMALL;
+		return;
+	}
+	cs_mesh_link_quality_header_t* header = (cs_mesh_link_quality_header_t*)result.buf.data;
+	header->numGoodLinks = getNumGoodLinks();
+	header->transmissions = getTransmissions(MESH_MODEL_TRANSMISSIONS_DEFAULT);
+	header->count = count;
+	cs_mesh_link_quality_item_t* item = (cs_mesh_link_quality_item_t*)(result.buf.data + sizeof(cs_mesh_link_quality_header_t));
+	for (uint8_t i = 0; i < MESH_LINK_QUALITY_TABLE_SIZE; ++i) {
+		if (_entries[i].stoneId == 0) {
+			continue;
+		}
+		item->stoneId = _entries[i].stoneId;
+		item->rssi = _entries[i].rssi / 16;
+		item->receptionRate = (uint32_t)_entries[i].receptionRate * 100 / RECEPTION_RATE_MAX;
+		item->lastSeenSeconds = _entries[i].lastSeenSeconds;
+		item++;
+	}
+	result.dataSize = size;
+	result.returnCode = ERR_SUCCESS;
+}
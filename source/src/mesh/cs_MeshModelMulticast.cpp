@@ -31,6 +31,10 @@ void MeshModelMulticast::registerMsgHandler(const callback_msg_t& closure) {
 	_msgCallback = closure;
 }
 
+void MeshModelMulticast::setTelemetry(MeshTelemetry* telemetry) {
+	_telemetry = telemetry;
+}
+
 void MeshModelMulticast::init(uint16_t modelId) {
 	assert(_msgCallback != nullptr, "Callback not set");
 	uint32_t retVal;
@@ -103,6 +107,9 @@ void MeshModelMulticast::handleMsg(const access_message_rx_t * accessMsg) {
 	msg.msgSize = accessMsg->length;
 	msg.rssi = MeshUtil::getRssi(accessMsg->meta_data.p_core_metadata);
 	msg.hops = ACCESS_DEFAULT_TTL - accessMsg->meta_data.ttl;
+	if (_telemetry != nullptr) {
+		_telemetry->onReceived(MESH_TELEMETRY_MODEL_MULTICAST, (msg.msgSize >= MESH_HEADER_SIZE) ? MeshUtil::getType(msg.msg) : CS_MESH_MODEL_TYPE_UNKNOWN, msg.hops);
+	}
 	cs_result_t result;
 	_msgCallback(msg, result);
 }
@@ -141,38 +148,46 @@ cs_ret_code_t MeshModelMulticast::addToQueue(MeshUtil::cs_mesh_queue_item_t& ite
 	assert(item.broadcast == true, "Multicast only");
 	assert(item.reliable == false, "Unreliable only");
 
-	// Find an empty spot in the queue (transmissions == 0).
+	// Find an empty spot in the queue.
 	// Start looking at _queueIndexNext, then reverse iterate over the queue.
 	// Then set the new _queueIndexNext at the newly added item, so that it will be sent next.
 	// We do the reverse iterate, so that the chance is higher that
 	// the old _queueIndexNext will be sent quickly after this newly added item.
-	uint8_t index;
-	for (int i = _queueIndexNext + _queueSize; i > _queueIndexNext; --i) {
-		index = i % _queueSize;
-		cs_multicast_queue_item_t* it = &(_queue[index]);
-		if (it->metaData.transmissionsOrTimeout == 0) {
-			if (!MeshUtil::setMeshMessage((cs_mesh_model_msg_type_t)item.metaData.type, item.msgPayload.data, item.msgPayload.len, it->msg, sizeof(it->msg))) {
-				return ERR_WRONG_PAYLOAD_LENGTH;
-			}
-			memcpy(&(it->metaData), &(item.metaData), sizeof(item.metaData));
-			it->msgSize = msgSize;
-			LOGMeshModelVerbose("added to ind=%u", index);
-			_queueIndexNext = index;
-
-			// TODO: immediately start sending from queue.
-			// sendMsgFromQueue can keep up how many msgs have been sent this tick, so it knows how many can still be sent.
-			return ERR_SUCCESS;
+	int16_t index = _readySet.getFree(_queueIndexNext);
+	if (index < 0) {
+		LOGw("queue is full");
+		if (_telemetry != nullptr) {
+			_telemetry->onDropped(MESH_TELEMETRY_MODEL_MULTICAST);
 		}
+		return ERR_BUSY;
+	}
+	cs_multicast_queue_item_t* it = &(_queue[index]);
+	if (!MeshUtil::setMeshMessage((cs_mesh_model_msg_type_t)item.metaData.type, item.msgPayload.data, item.msgPayload.len, it->msg, sizeof(it->msg))) {
+		return ERR_WRONG_PAYLOAD_LENGTH;
+	}
+	memcpy(&(it->metaData), &(item.metaData), sizeof(item.metaData));
+	it->msgSize = msgSize;
+	if (_telemetry != nullptr) {
+		it->metaData.queuedTick = _telemetry->getTick();
+		_telemetry->onQueued(MESH_TELEMETRY_MODEL_MULTICAST, item.metaData.type);
 	}
-	LOGw("queue is full");
-	return ERR_BUSY;
+	if (it->metaData.transmissionsOrTimeout != 0) {
+		_readySet.setReady(index, it->metaData.priority);
+	}
+	LOGMeshModelVerbose("added to ind=%u", index);
+	_queueIndexNext = index;
+
+	// TODO: immediately start sending from queue.
+	// sendMsgFromQueue can keep up how many msgs have been sent this tick, so it knows how many can still be sent.
+	return ERR_SUCCESS;
 }
 
 cs_ret_code_t MeshModelMulticast::remFromQueue(cs_mesh_model_msg_type_t type, uint16_t id) {
 	cs_ret_code_t retCode = ERR_NOT_FOUND;
 	for (int i = 0; i < _queueSize; ++i) {
-		if (_queue[i].metaData.id == id && _queue[i].metaData.type == type && _queue[i].metaData.transmissionsOrTimeout != 0) {
+		if (_readySet.isReady(i) && _queue[i].metaData.id == id && _queue[i].metaData.type == type) {
 			_queue[i].metaData.transmissionsOrTimeout = 0;
+			_readySet.release(i);
 			LOGMeshModelVerbose("removed from queue: ind=%u", i);
 			retCode = ERR_SUCCESS;
 		}
@@ -180,21 +195,10 @@ cs_ret_code_t MeshModelMulticast::remFromQueue(cs_mesh_model_msg_type_t type, ui
 	return retCode;
 }
 
-int MeshModelMulticast::getNextItemInQueue(bool priority) {
-	int index;
-	for (int i = _queueIndexNext; i < _queueIndexNext + _queueSize; i++) {
-		index = i % _queueSize;
-		if ((!priority || _queue[index].metaData.priority) && _queue[index].metaData.transmissionsOrTimeout > 0) {
-			return index;
-		}
-	}
-	return -1;
-}
-
 bool MeshModelMulticast::sendMsgFromQueue() {
-	int index = getNextItemInQueue(true);
+	int16_t index = _readySet.getNext(_queueIndexNext, true);
 	if (index == -1) {
-		index = getNextItemInQueue(false);
+		index = _readySet.getNext(_queueIndexNext, false);
 	}
 	if (index == -1) {
 		return false;
@@ -215,7 +219,17 @@ bool MeshModelMulticast::sendMsgFromQueue() {
 //	}
 	sendMsg(item->msg, item->msgSize);
 	// TOOD: check return code, maybe retry again later.
+	if (_telemetry != nullptr) {
+		_telemetry->onSent(MESH_TELEMETRY_MODEL_MULTICAST);
+		if (!item->metaData.sent) {
+			_telemetry->onFirstSent(item->metaData.queuedTick);
+		}
+	}
+	item->metaData.sent = true;
 	--(item->metaData.transmissionsOrTimeout);
+	if (item->metaData.transmissionsOrTimeout == 0) {
+		_readySet.release(index);
+	}
 	LOGMeshModelInfo("sent ind=%u transmissions_left=%u type=%u id=%u", index, item->metaData.transmissionsOrTimeout, item->metaData.type, item->metaData.id);
 
 	// Next item will be sent next, so that items are sent interleaved.
@@ -231,6 +245,16 @@ void MeshModelMulticast::processQueue() {
 	}
 }
 
+uint8_t MeshModelMulticast::getNumQueued() {
+	uint8_t count = 0;
+	for (uint16_t i = 0; i < _queueSize; ++i) {
+		if (_readySet.isReady(i)) {
+			count++;
+		}
+	}
+	return count;
+}
+
 void MeshModelMulticast::tick(uint32_t tickCount) {
 	if (tickCount % (MESH_MODEL_QUEUE_PROCESS_INTERVAL_MS / TICK_INTERVAL_MS) == 0) {
 		processQueue();
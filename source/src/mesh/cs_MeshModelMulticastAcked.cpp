@@ -35,6 +35,10 @@ void MeshModelMulticastAcked::registerMsgHandler(const callback_msg_t& closure)
 	_msgCallback = closure;
 }
 
+void MeshModelMulticastAcked::setTelemetry(MeshTelemetry* telemetry) {
+	_telemetry = telemetry;
+}
+
 void MeshModelMulticastAcked::init(uint16_t modelId) {
 	assert(_msgCallback != nullptr, "Callback not set");
 	uint32_t retVal;
@@ -52,6 +56,7 @@ void MeshModelMulticastAcked::init(uint16_t modelId) {
 	APP_ERROR_CHECK(retVal);
 
 	State::getInstance().get(CS_TYPE::CONFIG_CROWNSTONE_ID, &_ownStoneId, sizeof(_ownStoneId));
+	_queue.setOwnStoneId(_ownStoneId);
 }
 
 void MeshModelMulticastAcked::configureSelf(dsm_handle_t appkeyHandle) {
@@ -112,6 +117,9 @@ void MeshModelMulticastAcked::handleMsg(const access_message_rx_t * accessMsg) {
 	msg.msgSize = accessMsg->length;
 	msg.rssi = MeshUtil::getRssi(accessMsg->meta_data.p_core_metadata);
 	msg.hops = ACCESS_DEFAULT_TTL - accessMsg->meta_data.ttl;
+	if (_telemetry != nullptr) {
+		_telemetry->onReceived(MESH_TELEMETRY_MODEL_MULTICAST_ACKED, (msg.msgSize >= MESH_HEADER_SIZE) ? MeshUtil::getType(msg.msg) : CS_MESH_MODEL_TYPE_UNKNOWN, msg.hops);
+	}
 
 	switch (msg.opCode) {
 		case CS_MESH_MODEL_OPCODE_MULTICAST_REPLY: {
@@ -206,28 +214,28 @@ void MeshModelMulticastAcked::sendReply(const access_message_rx_t* accessMsg, co
 }
 
 void MeshModelMulticastAcked::handleReply(MeshUtil::cs_mesh_received_msg_t & msg) {
-	if (_queueIndexInProgress == queue_index_none) {
+	if (_queue.getNumInFlight() == 0) {
 		return;
 	}
 
 	stone_id_t srcId = msg.srcAddress;
 
-	// Find stone ID in list of stone IDs.
-	auto item = _queue[_queueIndexInProgress];
-	uint16_t stoneIndex = 0xFFFF;
-	for (uint8_t i = 0; i < item.numIds; ++i) {
-		if (item.stoneIdsPtr[i] == srcId) {
-			stoneIndex = i;
-			break;
-		}
+	// Find the item in flight this is a reply to, by the message type it's a result of.
+	if (msg.msgSize < MESH_HEADER_SIZE + sizeof(cs_mesh_model_msg_result_header_t) || MeshUtil::getType(msg.msg) != CS_MESH_MODEL_TYPE_RESULT) {
+		LOGw("Invalid reply:");
+		BLEutil::printArray(msg.msg, msg.msgSize);
+		return;
 	}
-	if (stoneIndex == 0xFFFF) {
+	cs_mesh_model_msg_result_header_t* resultHeader = (cs_mesh_model_msg_result_header_t*)(msg.msg + MESH_HEADER_SIZE);
+	uint8_t stoneIndex;
+	int16_t index = _queue.findInFlight(srcId, resultHeader->msgType, stoneIndex);
+	if (index == -1) {
 		LOGMeshModelInfo("Stone id %u not in list", srcId);
 		return;
 	}
 
 	// Check if stone ID has already been marked as acked, and thus already been handled.
-	if (_ackedStonesBitmask.isSet(stoneIndex)) {
+	if (_queue.get(index).ackedStonesBitmask.isSet(stoneIndex)) {
 		LOGMeshModelVerbose("Already received ack from id %u", srcId);
 		return;
 	}
@@ -235,15 +243,15 @@ void MeshModelMulticastAcked::handleReply(MeshUtil::cs_mesh_received_msg_t & msg
 	// Handle reply message.
 	cs_result_t result;
 	_msgCallback(msg, result);
-	if (result.returnCode != ERR_SUCCESS || MeshUtil::getType(msg.msg) != CS_MESH_MODEL_TYPE_RESULT) {
+	if (result.returnCode != ERR_SUCCESS) {
 		LOGw("Invalid reply:");
 		BLEutil::printArray(msg.msg, msg.msgSize);
 		return;
 	}
 
 	// Mark id as acked.
-	LOGMeshModelDebug("Set acked bit %u", stoneIndex);
-	_ackedStonesBitmask.setBit(stoneIndex);
+	LOGMeshModelDebug("Set acked bit %u of ind=%u", stoneIndex, index);
+	_queue.setAcked(index, stoneIndex);
 }
 
 cs_ret_code_t MeshModelMulticastAcked::addToQueue(MeshUtil::cs_mesh_queue_item_t& item) {
@@ -260,150 +268,51 @@ cs_ret_code_t MeshModelMulticastAcked::addToQueue(MeshUtil::cs_mesh_queue_item_t
 	assert(item.broadcast == true, "Multicast only");
 	assert(item.reliable == true, "Reliable only");
 
-	// Find an empty spot in the queue (transmissions == 0).
-	// Start looking at _queueIndexNext, then reverse iterate over the queue.
-	// Then set the new _queueIndexNext at the newly added item, so that it will be sent next.
-	// We do the reverse iterate, so that the chance is higher that
-	// the old _queueIndexNext will be sent quickly after this newly added item.
-	uint8_t index;
-	for (int i = _queueIndexNext; i < _queueIndexNext + queue_size; ++i) {
-		index = i % queue_size;
-		cs_multicast_acked_queue_item_t* it = &(_queue[index]);
-		if (it->metaData.transmissionsOrTimeout == 0) {
-
-			// Allocate and copy msg.
-			it->msgPtr = (uint8_t*)malloc(msgSize);
-			LOGMeshModelVerbose("msg alloc %p size=%u", it->msgPtr, msgSize);
-			if (it->msgPtr == NULL) {
-				return ERR_NO_SPACE;
-			}
-			if (!MeshUtil::setMeshMessage((cs_mesh_model_msg_type_t)item.metaData.type, item.msgPayload.data, item.msgPayload.len, it->msgPtr, msgSize)) {
-				LOGMeshModelVerbose("msg free %p", it->msgPtr);
-				free(it->msgPtr);
-				return ERR_WRONG_PAYLOAD_LENGTH;
-			}
-
-			// Allocate and copy stone ids.
-			it->stoneIdsPtr = (stone_id_t*)malloc(item.numIds * sizeof(stone_id_t));
-			LOGMeshModelVerbose("ids alloc %p size=%u", it->stoneIdsPtr, item.numIds * sizeof(stone_id_t));
-			if (it->stoneIdsPtr == NULL) {
-				LOGMeshModelVerbose("msg free %p", it->msgPtr);
-				free(it->msgPtr);
-				return ERR_NO_SPACE;
-			}
-			memcpy(it->stoneIdsPtr, item.stoneIdsPtr, item.numIds * sizeof(stone_id_t));
-
-			// Copy meta data.
-			memcpy(&(it->metaData), &(item.metaData), sizeof(item.metaData));
-			it->numIds = item.numIds;
-			it->msgSize = msgSize;
-
-			LOGMeshModelVerbose("added to ind=%u", index);
-			BLEutil::printArray(it->msgPtr, it->msgSize);
-
-			// If queue was empty, we can start sending this item.
-			sendMsgFromQueue();
-			return ERR_SUCCESS;
-		}
+	if (_telemetry != nullptr) {
+		item.metaData.queuedTick = _telemetry->getTick();
 	}
-	LOGw("queue is full");
-	return ERR_BUSY;
-}
-
-cs_ret_code_t MeshModelMulticastAcked::remFromQueue(cs_mesh_model_msg_type_t type, uint16_t id) {
-	cs_ret_code_t retCode = ERR_NOT_FOUND;
-	for (int i = 0; i < queue_size; ++i) {
-		if (_queue[i].metaData.id == id && _queue[i].metaData.type == type && _queue[i].metaData.transmissionsOrTimeout != 0) {
-			cancelQueueItem(i);
-			remQueueItem(i);
-			retCode = ERR_SUCCESS;
+	cs_ret_code_t retCode = _queue.add(item);
+	if (retCode != ERR_SUCCESS) {
+		if (retCode == ERR_BUSY && _telemetry != nullptr) {
+			_telemetry->onDropped(MESH_TELEMETRY_MODEL_MULTICAST_ACKED);
 		}
+		return retCode;
 	}
-	return retCode;
-}
-
-void MeshModelMulticastAcked::cancelQueueItem(uint8_t index) {
-	if (_queueIndexInProgress == index) {
-		LOGe("TODO: Cancel progress");
-		_queueIndexInProgress = queue_index_none;
+	if (_telemetry != nullptr) {
+		_telemetry->onQueued(MESH_TELEMETRY_MODEL_MULTICAST_ACKED, item.metaData.type);
 	}
-}
 
-void MeshModelMulticastAcked::remQueueItem(uint8_t index) {
-	_queue[index].metaData.transmissionsOrTimeout = 0;
-	LOGMeshModelVerbose("msg free %p", _queue[index].msgPtr);
-	free(_queue[index].msgPtr);
-	LOGMeshModelVerbose("ids free %p", _queue[index].stoneIdsPtr);
-	free(_queue[index].stoneIdsPtr);
-	_ackedStonesBitmask.setNumBits(0);
-	LOGMeshModelVerbose("removed from queue: ind=%u", index);
-}
-
-int MeshModelMulticastAcked::getNextItemInQueue(bool priority) {
-	int index;
-	for (int i = _queueIndexNext; i < _queueIndexNext + queue_size; i++) {
-		index = i % queue_size;
-		if ((!priority || _queue[index].metaData.priority) && _queue[index].metaData.transmissionsOrTimeout > 0) {
-			return index;
-		}
-	}
-	return -1;
+	// If there is room, we can start sending this item.
+	sendMsgsFromQueue();
+	return ERR_SUCCESS;
 }
 
-bool MeshModelMulticastAcked::sendMsgFromQueue() {
-	if (_queueIndexInProgress != queue_index_none) {
-		return false;
-	}
-	int index = getNextItemInQueue(true);
-	if (index == -1) {
-		index = getNextItemInQueue(false);
-	}
-	if (index == -1) {
-		return false;
-	}
-
-	cs_multicast_acked_queue_item_t* item = &(_queue[index]);
-	if (!prepareForMsg(item)) {
-		return false;
-	}
-
-	cs_ret_code_t retCode = sendMsg(item->msgPtr, item->msgSize);
-	if (retCode != ERR_SUCCESS) {
-		return false;
-	}
-	_queueIndexInProgress = index;
-	LOGMeshModelInfo("sent ind=%u timeout=%u type=%u id=%u", index, item->metaData.transmissionsOrTimeout, item->metaData.type, item->metaData.id);
-
-	// Next item will be sent next, so that items are sent interleaved.
-	_queueIndexNext = (index + 1) % queue_size;
-	return true;
+cs_ret_code_t MeshModelMulticastAcked::remFromQueue(cs_mesh_model_msg_type_t type, uint16_t id) {
+	return _queue.remove(type, id);
 }
 
-bool MeshModelMulticastAcked::prepareForMsg(cs_multicast_acked_queue_item_t* item) {
-	_processCallsLeft = item->metaData.transmissionsOrTimeout * 1000 / MESH_MODEL_ACKED_RETRY_INTERVAL_MS;
-	if (!_ackedStonesBitmask.setNumBits(item->numIds)) {
-		return false;
-	}
-//	_handledSelf = false;
-
-	// Mark own stone ID as acked.
-	for (uint8_t i=0; i < item->numIds; ++i) {
-		if (item->stoneIdsPtr[i] == _ownStoneId) {
-			_ackedStonesBitmask.setBit(i);
-			break;
+void MeshModelMulticastAcked::sendMsgsFromQueue() {
+	int16_t index;
+	while ((index = _queue.startNext()) != -1) {
+		auto& item = _queue.get(index);
+		cs_ret_code_t retCode = sendMsg(item.msgPtr, item.msgSize);
+		if (retCode != ERR_SUCCESS) {
+			// Will be retried at the next interval.
+			LOGw("Failed to send ind=%u", index);
+		}
+		if (_telemetry != nullptr) {
+			_telemetry->onSent(MESH_TELEMETRY_MODEL_MULTICAST_ACKED);
+			_telemetry->onFirstSent(item.metaData.queuedTick);
 		}
+		LOGMeshModelInfo("sent ind=%u timeout=%u type=%u id=%u", index, item.metaData.transmissionsOrTimeout, item.metaData.type, item.metaData.id);
 	}
-	return true;
 }
 
-void MeshModelMulticastAcked::checkDone() {
-	if (_queueIndexInProgress == queue_index_none) {
-		return;
-	}
-	auto item = _queue[_queueIndexInProgress];
+bool MeshModelMulticastAcked::checkDone(uint8_t index) {
+	auto& item = _queue.get(index);
 
 	// Check acks.
-	if (_ackedStonesBitmask.isAllBitsSet()) {
+	if (_queue.isAllAcked(index)) {
 		LOGi("Received ack from all stones.");
 		MeshUtil::printQueueItem(" ", item.metaData);
 
@@ -413,12 +322,15 @@ void MeshModelMulticastAcked::checkDone() {
 		UartProtocol::getInstance().writeMsg(UART_OPCODE_TX_MESH_ACK_ALL_RESULT, (uint8_t*)&ackResult, sizeof(ackResult));
 		LOGMeshModelDebug("all success");
 
-		remQueueItem(_queueIndexInProgress);
-		_queueIndexInProgress = queue_index_none;
+		if (_telemetry != nullptr) {
+			_telemetry->onAcked(item.metaData.queuedTick);
+		}
+		_queue.remove(index);
+		return true;
 	}
 
 	// Check for timeout.
-	if (_processCallsLeft == 0) {
+	if (_queue.retry(index)) {
 		LOGi("Timeout.")
 		MeshUtil::printQueueItem(" ", item.metaData);
 
@@ -429,7 +341,7 @@ void MeshModelMulticastAcked::checkDone() {
 		resultHeader.resultHeader.commandType = cmdType;
 		resultHeader.resultHeader.returnCode = ERR_TIMEOUT;
 		for (uint8_t i = 0; i < item.numIds; ++i) {
-			if (!_ackedStonesBitmask.isSet(i)) {
+			if (!item.ackedStonesBitmask.isSet(i)) {
 				resultHeader.stoneId = item.stoneIdsPtr[i];
 				UartProtocol::getInstance().writeMsg(UART_OPCODE_TX_MESH_RESULT, (uint8_t*)&resultHeader, sizeof(resultHeader));
 				LOGMeshModelDebug("timeout id=%u", resultHeader.stoneId);
@@ -440,26 +352,35 @@ void MeshModelMulticastAcked::checkDone() {
 		UartProtocol::getInstance().writeMsg(UART_OPCODE_TX_MESH_ACK_ALL_RESULT, (uint8_t*)&ackResult, sizeof(ackResult));
 		LOGMeshModelDebug("all timeout");
 
-		remQueueItem(_queueIndexInProgress);
-		_queueIndexInProgress = queue_index_none;
-	}
-	else {
-		--_processCallsLeft;
+		if (_telemetry != nullptr) {
+			_telemetry->onAckTimeout(MESH_TELEMETRY_MODEL_MULTICAST_ACKED);
+		}
+		_queue.remove(index);
+		return true;
 	}
+	return false;
 }
 
-void MeshModelMulticastAcked::retryMsg() {
-	if (_queueIndexInProgress == queue_index_none) {
-		return;
+void MeshModelMulticastAcked::processQueue() {
+	for (uint8_t i = 0; i < MeshMulticastAckedQueue::QUEUE_SIZE; ++i) {
+		if (!_queue.isInProgress(i)) {
+			continue;
+		}
+		if (!checkDone(i)) {
+			// Retry sending the message.
+			auto& item = _queue.get(i);
+			sendMsg(item.msgPtr, item.msgSize);
+			if (_telemetry != nullptr) {
+				_telemetry->onSent(MESH_TELEMETRY_MODEL_MULTICAST_ACKED);
+				_telemetry->onRetry(MESH_TELEMETRY_MODEL_MULTICAST_ACKED);
+			}
+		}
 	}
-	auto item = _queue[_queueIndexInProgress];
-	sendMsg(item.msgPtr, item.msgSize);
+	sendMsgsFromQueue();
 }
 
-void MeshModelMulticastAcked::processQueue() {
-	checkDone();
-	retryMsg();
-	sendMsgFromQueue();
+uint8_t MeshModelMulticastAcked::getNumQueued() {
+	return _queue.getNumQueued();
 }
 
 void MeshModelMulticastAcked::tick(uint32_t tickCount) {
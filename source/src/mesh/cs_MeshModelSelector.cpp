@@ -35,7 +35,12 @@ cs_ret_code_t MeshModelSelector::addToQueue(MeshUtil::cs_mesh_queue_item_t& item
 			}
 		}
 		else {
-			return ERR_NOT_IMPLEMENTED;
+			if (item.numIds == 1) {
+				return _unicastModel->sendUnacked(item);
+			}
+			else {
+				return ERR_NOT_IMPLEMENTED;
+			}
 		}
 	}
 }
@@ -35,12 +35,17 @@ static void staticReliableStatusHandler(access_model_handle_t model_handle, void
 static const access_opcode_handler_t opcodeHandlers[] = {
 		{ACCESS_OPCODE_VENDOR(CS_MESH_MODEL_OPCODE_UNICAST_RELIABLE_MSG, CROWNSTONE_COMPANY_ID), staticMsgHandler},
 		{ACCESS_OPCODE_VENDOR(CS_MESH_MODEL_OPCODE_UNICAST_REPLY, CROWNSTONE_COMPANY_ID), staticMsgHandler},
+		{ACCESS_OPCODE_VENDOR(CS_MESH_MODEL_OPCODE_UNICAST_MSG, CROWNSTONE_COMPANY_ID), staticMsgHandler},
 };
 
 void MeshModelUnicast::registerMsgHandler(const callback_msg_t& closure) {
 	_msgCallback = closure;
 }
 
+void MeshModelUnicast::setTelemetry(MeshTelemetry* telemetry) {
+	_telemetry = telemetry;
+}
+
 void MeshModelUnicast::init(uint16_t modelId) {
 	assert(_msgCallback != nullptr, "Callback not set");
 	uint32_t retVal;
@@ -128,6 +133,9 @@ void MeshModelUnicast::handleMsg(const access_message_rx_t * accessMsg) {
 	msg.msgSize = accessMsg->length;
 	msg.rssi = MeshUtil::getRssi(accessMsg->meta_data.p_core_metadata);
 	msg.hops = ACCESS_DEFAULT_TTL - accessMsg->meta_data.ttl;
+	if (_telemetry != nullptr) {
+		_telemetry->onReceived(MESH_TELEMETRY_MODEL_UNICAST, (msg.msgSize >= MESH_HEADER_SIZE) ? MeshUtil::getType(msg.msg) : CS_MESH_MODEL_TYPE_UNKNOWN, msg.hops);
+	}
 
 	if (msg.opCode == CS_MESH_MODEL_OPCODE_UNICAST_REPLY) {
 		// Handle the message, don't send a reply.
@@ -138,6 +146,13 @@ void MeshModelUnicast::handleMsg(const access_message_rx_t * accessMsg) {
 		return;
 	}
 
+	if (msg.opCode == CS_MESH_MODEL_OPCODE_UNICAST_MSG) {
+		// Unacked message: handle it, don't send a reply.
+		cs_result_t result;
+		_msgCallback(msg, result);
+		return;
+	}
+
 	// Prepare a reply message, to send the result back.
 	uint8_t replyMsg[MAX_MESH_MSG_NON_SEGMENTED_SIZE];
 	replyMsg[0] = CS_MESH_MODEL_TYPE_RESULT;
@@ -236,9 +251,16 @@ void MeshModelUnicast::handleReliableStatus(access_reliable_status_t status) {
 }
 
 void MeshModelUnicast::checkDone() {
+	if (_queueIndexInProgress == queue_index_none) {
+		// For example when a retransmitted reply is received after the item is done.
+		return;
+	}
 	bool done = false;
 	switch (_reliableStatus) {
 		case ACCESS_RELIABLE_TRANSFER_TIMEOUT:
+			if (_telemetry != nullptr) {
+				_telemetry->onAckTimeout(MESH_TELEMETRY_MODEL_UNICAST);
+			}
 			sendFailedResultToUart(
 					_queue[_queueIndexInProgress].targetId,
 					(cs_mesh_model_msg_type_t)_queue[_queueIndexInProgress].metaData.type,
@@ -261,6 +283,9 @@ void MeshModelUnicast::checkDone() {
 				result_packet_header_t ackResult(cmdType, ERR_SUCCESS);
 				UartProtocol::getInstance().writeMsg(UART_OPCODE_TX_MESH_ACK_ALL_RESULT, (uint8_t*)&ackResult, sizeof(ackResult));
 				LOGMeshModelDebug("all success");
+				if (_telemetry != nullptr) {
+					_telemetry->onAcked(_queue[_queueIndexInProgress].metaData.queuedTick);
+				}
 				done = true;
 			}
 			break;
@@ -325,6 +350,10 @@ cs_ret_code_t MeshModelUnicast::addToQueue(MeshUtil::cs_mesh_queue_item_t& item)
 			memcpy(&(it->metaData), &(item.metaData), sizeof(item.metaData));
 			it->targetId = item.stoneIdsPtr[0];
 			it->msgSize = msgSize;
+			if (_telemetry != nullptr) {
+				it->metaData.queuedTick = _telemetry->getTick();
+				_telemetry->onQueued(MESH_TELEMETRY_MODEL_UNICAST, item.metaData.type);
+			}
 			LOGMeshModelVerbose("added to ind=%u", index);
 			BLEutil::printArray(it->msgPtr, it->msgSize);
 
@@ -334,9 +363,58 @@ cs_ret_code_t MeshModelUnicast::addToQueue(MeshUtil::cs_mesh_queue_item_t& item)
 		}
 	}
 	LOGw("queue is full");
+	if (_telemetry != nullptr) {
+		_telemetry->onDropped(MESH_TELEMETRY_MODEL_UNICAST);
+	}
 	return ERR_BUSY;
 }
 
+cs_ret_code_t MeshModelUnicast::sendUnacked(MeshUtil::cs_mesh_queue_item_t& item) {
+	size16_t msgSize = MeshUtil::getMeshMessageSize(item.msgPayload.len);
+	assert(item.msgPayload.data != nullptr || item.msgPayload.len == 0, "Null pointer");
+	assert(msgSize <= MAX_MESH_MSG_SIZE, "Message too large");
+	assert(item.numIds == 1, "Single ID only");
+	assert(item.broadcast == false, "Unicast only");
+
+	// The publish address is also used by the acked msg in progress.
+	stone_id_t targetId = item.stoneIdsPtr[0];
+	if (_queueIndexInProgress != queue_index_none && _queue[_queueIndexInProgress].targetId != targetId) {
+		return ERR_BUSY;
+	}
+
+	uint8_t msg[MAX_MESH_MSG_SIZE];
+	if (!MeshUtil::setMeshMessage((cs_mesh_model_msg_type_t)item.metaData.type, item.msgPayload.data, item.msgPayload.len, msg, msgSize)) {
+		return ERR_WRONG_PAYLOAD_LENGTH;
+	}
+	if (setPublishAddress(targetId) != ERR_SUCCESS) {
+		return ERR_UNSPECIFIED;
+	}
+
+	access_message_tx_t accessMsg;
+	accessMsg.opcode.company_id = CROWNSTONE_COMPANY_ID;
+	accessMsg.opcode.opcode = CS_MESH_MODEL_OPCODE_UNICAST_MSG;
+	accessMsg.p_buffer = msg;
+	accessMsg.length = msgSize;
+	accessMsg.force_segmented = false;
+	accessMsg.transmic_size = NRF_MESH_TRANSMIC_SIZE_SMALL;
+	accessMsg.access_token = nrf_mesh_unique_token_get();
+	uint32_t retVal = access_model_publish(_accessModelHandle, &accessMsg);
+	LOGMeshModelVerbose("send unacked targetId=%u type=%u ret=%u", targetId, item.metaData.type, retVal);
+	switch (retVal) {
+		case NRF_SUCCESS:
+			if (_telemetry != nullptr) {
+				_telemetry->onQueued(MESH_TELEMETRY_MODEL_UNICAST, item.metaData.type);
+				_telemetry->onSent(MESH_TELEMETRY_MODEL_UNICAST);
+			}
+			return ERR_SUCCESS;
+		case NRF_ERROR_NO_MEM:
+		case NRF_ERROR_FORBIDDEN:
+			return ERR_BUSY;
+		default:
+			return ERR_UNSPECIFIED;
+	}
+}
+
 cs_ret_code_t MeshModelUnicast::remFromQueue(cs_mesh_model_msg_type_t type, uint16_t id) {
 	cs_ret_code_t retCode = ERR_NOT_FOUND;
 	for (int i = 0; i < queue_size; ++i) {
@@ -396,6 +474,13 @@ bool MeshModelUnicast::sendMsgFromQueue() {
 		return false;
 	}
 	_queueIndexInProgress = index;
+	if (_telemetry != nullptr) {
+		_telemetry->onSent(MESH_TELEMETRY_MODEL_UNICAST);
+		if (!item->metaData.sent) {
+			_telemetry->onFirstSent(item->metaData.queuedTick);
+		}
+	}
+	item->metaData.sent = true;
 	LOGMeshModelInfo("sent ind=%u timeout=%u type=%u id=%u targetId=%u", index, item->metaData.transmissionsOrTimeout, item->metaData.type, item->metaData.id, item->targetId);
 
 	// Next item will be sent next.
@@ -408,6 +493,16 @@ void MeshModelUnicast::processQueue() {
 	sendMsgFromQueue();
 }
 
+uint8_t MeshModelUnicast::getNumQueued() {
+	uint8_t count = 0;
+	for (uint8_t i = 0; i < queue_size; ++i) {
+		if (_queue[i].metaData.transmissionsOrTimeout != 0) {
+			count++;
+		}
+	}
+	return count;
+}
+
 void MeshModelUnicast::tick(uint32_t tickCount) {
 	if (tickCount % (MESH_MODEL_QUEUE_PROCESS_INTERVAL_MS / TICK_INTERVAL_MS) == 0) {
 		processQueue();
@@ -0,0 +1,167 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <cfg/cs_Config.h>
+#include <drivers/cs_Serial.h>
+#include <mesh/cs_MeshMsgAggregator.h>
+#include <protocol/mesh/cs_MeshModelPacketHelper.h>
+#include <cstring>
+
+bool MeshMsgAggregator::isAggregatable(const MeshUtil::cs_mesh_queue_item_t& item) {
+	if (item.reliable || !item.broadcast) {
+		return false;
+	}
+	switch (item.metaData.type) {
+		case CS_MESH_MODEL_TYPE_TEST:
+		case CS_MESH_MODEL_TYPE_AGGREGATE:
+		case CS_MESH_MODEL_TYPE_UNKNOWN:
+			return false;
+		default:
+			break;
+	}
+	return item.metaData.type < (1 << 5) && item.msgPayload.len <= MESH_MODEL_AGGREGATE_MAX_ENTRY_SIZE;
+}
+
+cs_ret_code_t MeshMsgAggregator::add(const MeshUtil::cs_mesh_queue_item_t& item) {
+	if (!isAggregatable(item)) {
+		return ERR_WRONG_PARAMETER;
+	}
+	remove(item.metaData);
+	clearNext();
+	if (_numPending >= MESH_MODEL_AGGREGATION_MAX_PENDING) {
+		return ERR_BUSY;
+	}
+	if (_numPending == 0) {
+		_waitedTicks = 0;
+	}
+	cs_mesh_aggregator_item_t* pending = &(_pending[_numPending]);
+	pending->metaData = item.metaData;
+	pending->size = item.msgPayload.len;
+	if (item.msgPayload.len) {
+		memcpy(pending->payload, item.msgPayload.data, item.msgPayload.len);
+	}
+	_numPending++;
+	return ERR_SUCCESS;
+}
+
+bool MeshMsgAggregator::remove(const MeshUtil::cs_mesh_queue_item_meta_data_t& metaData) {
+	for (uint8_t i = 0; i < _numPending; ++i) {
+		if (_pending[i].metaData.type == metaData.type && _pending[i].metaData.id == metaData.id) {
+			removeIndex(i);
+			clearNext();
+			return true;
+		}
+	}
+	return false;
+}
+
+void MeshMsgAggregator::removeIndex(uint8_t index) {
+	// Keep the order, so that items are sent in the order they were added.
+	for (uint8_t i = index + 1; i < _numPending; ++i) {
+		_pending[i - 1] = _pending[i];
+	}
+	_numPending--;
+}
+
+void MeshMsgAggregator::tick() {
+	if (_numPending != 0 && _waitedTicks < 0xFF) {
+		_waitedTicks++;
+	}
+}
+
+bool MeshMsgAggregator::isReady() {
+	if (_numPending == 0) {
+		return false;
+	}
+	if (_waitedTicks >= MESH_MODEL_AGGREGATION_DELAY_MS / TICK_INTERVAL_MS) {
+		return true;
+	}
+	size16_t totalSize = 0;
+	for (uint8_t i = 0; i < _numPending; ++i) {
+		if (_pending[i].metaData.priority) {
+			return true;
+		}
+		totalSize += sizeof(cs_mesh_model_msg_aggregate_entry_header_t) + _pending[i].size;
+	}
+	return totalSize >= MESH_MODEL_AGGREGATE_PAYLOAD_SIZE;
+}
+
+bool MeshMsgAggregator::getNext(MeshUtil::cs_mesh_queue_item_t& item) {
+	clearNext();
+	if (_numPending == 0) {
+		return false;
+	}
+
+	// Start with the first item with priority, else with the first item.
+	uint8_t first = 0;
+	for (uint8_t i = 0; i < _numPending; ++i) {
+		if (_pending[i].metaData.priority) {
+			first = i;
+			break;
+		}
+	}
+	MeshUtil::cs_mesh_queue_item_meta_data_t metaData = _pending[first].metaData;
+
+	item.reliable = false;
+	item.broadcast = true;
+	item.numIds = 0;
+	item.stoneIdsPtr = nullptr;
+
+	// Pack all compatible items that fit.
+	// An entry that fails to pack stays pending, together with the entries after it.
+	size16_t offset = 0;
+	for (uint8_t i = first; i < _numPending; ++i) {
+		if (_pending[i].metaData.priority != metaData.priority
+				|| _pending[i].metaData.transmissionsOrTimeout != metaData.transmissionsOrTimeout) {
+			continue;
+		}
+		size16_t entrySize = sizeof(cs_mesh_model_msg_aggregate_entry_header_t) + _pending[i].size;
+		if (offset + entrySize > MESH_MODEL_AGGREGATE_PAYLOAD_SIZE) {
+			continue;
+		}
+		if (!MeshUtil::addAggregateEntry((cs_mesh_model_msg_type_t)_pending[i].metaData.type, _pending[i].payload, _pending[i].size, _payload, sizeof(_payload), offset)) {
+			LOGw("Failed to pack type=%u size=%u", _pending[i].metaData.type, _pending[i].size);
+			break;
+		}
+		_nextSelected[i] = true;
+		_numNext++;
+	}
+
+	if (_numNext <= 1) {
+		// Nothing to combine with: send it as a regular message.
+		clearNext();
+		_nextSelected[first] = true;
+		_numNext = 1;
+		item.metaData = metaData;
+		item.msgPayload.len = _pending[first].size;
+		memcpy(_payload, _pending[first].payload, _pending[first].size);
+		item.msgPayload.data = _payload;
+		return true;
+	}
+
+	item.metaData.id = 0;
+	item.metaData.type = CS_MESH_MODEL_TYPE_AGGREGATE;
+	item.metaData.transmissionsOrTimeout = metaData.transmissionsOrTimeout;
+	item.metaData.priority = metaData.priority;
+	item.msgPayload.len = offset;
+	item.msgPayload.data = _payload;
+	return true;
+}
+
+void MeshMsgAggregator::removeNext() {
+	for (int16_t i = _numPending - 1; i >= 0; --i) {
+		if (_nextSelected[i]) {
+			removeIndex(i);
+		}
+	}
+	clearNext();
+}
+
+void MeshMsgAggregator::clearNext() {
+	memset(_nextSelected, 0, sizeof(_nextSelected));
+	_numNext = 0;
+}
@@ -0,0 +1,67 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <cfg/cs_Config.h>
+#include <mesh/cs_MeshMsgDedupCache.h>
+#include <util/cs_Hash.h>
+
+static_assert(MESH_MSG_DEDUP_CACHE_SIZE % MESH_MSG_DEDUP_CACHE_WAYS == 0, "Cache size should be a multiple of the number of ways.");
+
+MeshMsgDedupCache::MeshMsgDedupCache() {
+	clear();
+}
+
+void MeshMsgDedupCache::clear() {
+	for (uint16_t i = 0; i < MESH_MSG_DEDUP_CACHE_SIZE; ++i) {
+		_entries[i].valid = false;
+	}
+}
+
+void MeshMsgDedupCache::tick() {
+	_tickCount++;
+}
+
+bool MeshMsgDedupCache::isExpired(const cs_mesh_dedup_entry_t& entry) {
+	return _tickCount - entry.receivedTick >= MESH_MSG_DEDUP_TIMEOUT_MS / TICK_INTERVAL_MS;
+}
+
+bool MeshMsgDedupCache::isDuplicate(uint16_t srcAddress, uint8_t type, const uint8_t* payload, size16_t payloadSize) {
+	uint32_t payloadHash = Fletcher(payload, payloadSize);
+
+	// Mix in the source and type, so that messages of different sources end up in different sets.
+	uint32_t setHash = payloadHash ^ (srcAddress * 2654435761u) ^ (type << 24);
+	cs_mesh_dedup_entry_t* set = &(_entries[(setHash % NUM_SETS) * MESH_MSG_DEDUP_CACHE_WAYS]);
+
+	cs_mesh_dedup_entry_t* oldest = &(set[0]);
+	for (uint16_t i = 0; i < MESH_MSG_DEDUP_CACHE_WAYS; ++i) {
+		cs_mesh_dedup_entry_t* entry = &(set[i]);
+		if (!entry->valid || isExpired(*entry)) {
+			entry->valid = false;
+			oldest = entry;
+			continue;
+		}
+		if (entry->payloadHash == payloadHash
+				&& entry->srcAddress == srcAddress
+				&& entry->type == type
+				&& entry->payloadSize == payloadSize) {
+			_hits++;
+			return true;
+		}
+		if (oldest->valid && entry->receivedTick < oldest->receivedTick) {
+			oldest = entry;
+		}
+	}
+
+	_misses++;
+	oldest->payloadHash = payloadHash;
+	oldest->receivedTick = _tickCount;
+	oldest->srcAddress = srcAddress;
+	oldest->type = type;
+	oldest->payloadSize = payloadSize;
+	oldest->valid = true;
+	return false;
+}
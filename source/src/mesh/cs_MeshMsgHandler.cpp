@@ -16,10 +16,19 @@
 #include <storage/cs_State.h>
 #include <util/cs_Utils.h>
 
-void MeshMsgHandler::init() {
+void MeshMsgHandler::init(MeshLinkQuality* linkQuality, MeshBulkTransfer* bulkTransfer) {
+	_linkQuality = linkQuality;
+	_bulkTransfer = bulkTransfer;
 	State::getInstance().get(CS_TYPE::CONFIG_CROWNSTONE_ID, &_ownId, sizeof(_ownId));
 }
 
+void MeshMsgHandler::tick(uint32_t tickCount) {
+	_dedupCache.tick();
+	if (tickCount % (MESH_MSG_DEDUP_LOG_INTERVAL_MS / TICK_INTERVAL_MS) == 0) {
+		LOGi("Dedup cache: hits=%u misses=%u", _dedupCache.getHits(), _dedupCache.getMisses());
+	}
+}
+
 void MeshMsgHandler::handleMsg(const MeshUtil::cs_mesh_received_msg_t& msg, cs_result_t& result) {
 //	BLEutil::printArray(msg.msg, msg.msgSize);
 //	if (msg.opCode == CS_MESH_MODEL_OPCODE_RELIABLE_MSG) {
@@ -32,6 +41,29 @@ void MeshMsgHandler::handleMsg(const MeshUtil::cs_mesh_received_msg_t& msg, cs_r
 		result.returnCode = ERR_INVALID_MESSAGE;
 		return;
 	}
+	// Retransmissions say something about the link as well, so update before ignoring them.
+	if (_linkQuality != nullptr) {
+		_linkQuality->onReceived(msg.srcAddress, msg.rssi, msg.hops);
+	}
+	switch (msg.opCode) {
+		case CS_MESH_MODEL_OPCODE_UNICAST_RELIABLE_MSG:
+		case CS_MESH_MODEL_OPCODE_MULTICAST_RELIABLE_MSG:
+			// A retransmission means the sender did not receive the reply, so it has to be handled again.
+			break;
+		default: {
+			cs_data_t payload = MeshUtil::getPayload(msg.msg, msg.msgSize);
+			if (_dedupCache.isDuplicate(msg.srcAddress, MeshUtil::getType(msg.msg), payload.data, payload.len)) {
+				LOGMeshModelVerbose("ignore retransmission src=%u type=%u", msg.srcAddress, MeshUtil::getType(msg.msg));
+				result.returnCode = ERR_SUCCESS;
+				return;
+			}
+			break;
+		}
+	}
+	dispatchMsg(msg, result);
+}
+
+void MeshMsgHandler::dispatchMsg(const MeshUtil::cs_mesh_received_msg_t& msg, cs_result_t& result) {
 	stone_id_t srcId = msg.srcAddress;
 	cs_mesh_model_msg_type_t msgType = MeshUtil::getType(msg.msg);
 	uint8_t* payload;
@@ -107,6 +139,26 @@ void MeshMsgHandler::handleMsg(const MeshUtil::cs_mesh_received_msg_t& msg, cs_r
 			result.returnCode = handleSetIbeaconConfigId(payload, payloadSize);
 			return;
 		}
+		case CS_MESH_MODEL_TYPE_AGGREGATE: {
+			result.returnCode = handleAggregate(msg, payload, payloadSize);
+			return;
+		}
+		case CS_MESH_MODEL_TYPE_BULK_ACK_REQUEST: {
+			if (_bulkTransfer == nullptr) {
+				result.returnCode = ERR_NOT_AVAILABLE;
+				return;
+			}
+			_bulkTransfer->handleAckRequest(srcId, payload, payloadSize, result);
+			return;
+		}
+		case CS_MESH_MODEL_TYPE_BULK_CHUNK: {
+			if (_bulkTransfer == nullptr) {
+				result.returnCode = ERR_NOT_AVAILABLE;
+				return;
+			}
+			result.returnCode = _bulkTransfer->handleChunk(srcId, payload, payloadSize);
+			return;
+		}
 		case CS_MESH_MODEL_TYPE_UNKNOWN: {
 			result.returnCode = ERR_INVALID_MESSAGE;
 			return;
@@ -363,6 +415,29 @@ cs_ret_code_t MeshMsgHandler::handleSetIbeaconConfigId(uint8_t* payload, size16_
 	return event.result.returnCode;
 }
 
+cs_ret_code_t MeshMsgHandler::handleAggregate(const MeshUtil::cs_mesh_received_msg_t& msg, uint8_t* payload, size16_t payloadSize) {
+	LOGMeshModelDebug("handleAggregate");
+	// Handle each entry as if it was received as separate message.
+	// The entries are dispatched directly, not via handleMsg(): only the aggregate itself counts as a reception
+	// for the link quality, and it already went by the dedup cache.
+	uint8_t entryMsg[MAX_MESH_MSG_NON_SEGMENTED_SIZE];
+	MeshUtil::cs_mesh_received_msg_t entryReceivedMsg = msg;
+	entryReceivedMsg.msg = entryMsg;
+	size16_t offset = 0;
+	cs_mesh_model_msg_type_t type;
+	uint8_t* entryPayload;
+	size16_t entrySize;
+	while (MeshUtil::getNextAggregateEntry(payload, payloadSize, offset, type, entryPayload, entrySize)) {
+		if (!MeshUtil::setMeshMessage(type, entryPayload, entrySize, entryMsg, sizeof(entryMsg))) {
+			return ERR_WRONG_PAYLOAD_LENGTH;
+		}
+		entryReceivedMsg.msgSize = MeshUtil::getMeshMessageSize(entrySize);
+		cs_result_t entryResult;
+		dispatchMsg(entryReceivedMsg, entryResult);
+	}
+	return ERR_SUCCESS;
+}
+
 void MeshMsgHandler::handleStateSet(uint8_t* payload, size16_t payloadSize, cs_result_t& result) {
 	auto meshStateHeader = reinterpret_cast<cs_mesh_model_msg_state_header_ext_t*>(payload);
 	uint8_t stateDataSize = payloadSize - sizeof(*meshStateHeader);
@@ -419,6 +494,14 @@ void MeshMsgHandler::handleStateSet(uint8_t* payload, size16_t payloadSize, cs_r
 cs_ret_code_t MeshMsgHandler::handleResult(uint8_t* payload, size16_t payloadSize, stone_id_t srcId) {
 	auto header = reinterpret_cast<cs_mesh_model_msg_result_header_t*>(payload);
 	cs_data_t resultData(payload + sizeof(*header), payloadSize - sizeof(*header));
+
+	if (header->msgType == CS_MESH_MODEL_TYPE_BULK_ACK_REQUEST) {
+		// Internal protocol, not of interest to the UART.
+		if (_bulkTransfer != nullptr) {
+			_bulkTransfer->handleAck(srcId, MeshUtil::getInflatedRetCode(header->retCode), resultData);
+		}
+		return ERR_SUCCESS;
+	}
 //	uint8_t resultDataSize = payloadSize - sizeof(*header);
 //	uint8_t* resultData = payload + sizeof(*header);
 
@@ -14,8 +14,16 @@
 #include <protocol/mesh/cs_MeshModelPacketHelper.h>
 #include <util/cs_BleError.h>
 
-void MeshMsgSender::init(MeshModelSelector* selector) {
+void MeshMsgSender::init(MeshModelSelector* selector, MeshLinkQuality* linkQuality) {
 	_selector = selector;
+	_linkQuality = linkQuality;
+}
+
+uint8_t MeshMsgSender::getDefaultTransmissions(cs_mesh_msg_reliability reliability) {
+	if (_linkQuality == nullptr) {
+		return reliability;
+	}
+	return _linkQuality->getTransmissions(reliability);
 }
 
 cs_ret_code_t MeshMsgSender::sendMsg(cs_mesh_msg_t *meshMsg) {
@@ -82,7 +90,7 @@ cs_ret_code_t MeshMsgSender::sendSetTime(const cs_mesh_model_msg_time_t* packet,
 	MeshUtil::cs_mesh_queue_item_t item;
 	item.metaData.id = 0;
 	item.metaData.type = CS_MESH_MODEL_TYPE_CMD_TIME;
-	item.metaData.transmissionsOrTimeout = (transmissions == 0) ? CS_MESH_RELIABILITY_LOW : transmissions;
+	item.metaData.transmissionsOrTimeout = (transmissions == 0) ? getDefaultTransmissions(CS_MESH_RELIABILITY_LOW) : transmissions;
 	item.metaData.priority = true;
 	item.reliable = false;
 	item.broadcast = true;
@@ -100,7 +108,7 @@ cs_ret_code_t MeshMsgSender::sendNoop(uint8_t transmissions) {
 	MeshUtil::cs_mesh_queue_item_t item;
 	item.metaData.id = 0;
 	item.metaData.type = CS_MESH_MODEL_TYPE_CMD_NOOP;
-	item.metaData.transmissionsOrTimeout = (transmissions == 0) ? CS_MESH_RELIABILITY_LOW : transmissions;
+	item.metaData.transmissionsOrTimeout = (transmissions == 0) ? getDefaultTransmissions(CS_MESH_RELIABILITY_LOW) : transmissions;
 	item.metaData.priority = false;
 	item.reliable = false;
 	item.broadcast = true;
@@ -120,7 +128,7 @@ cs_ret_code_t MeshMsgSender::sendMultiSwitchItem(const internal_multi_switch_ite
 	MeshUtil::cs_mesh_queue_item_t item;
 	item.metaData.id = switchItem->id;
 	item.metaData.type = CS_MESH_MODEL_TYPE_CMD_MULTI_SWITCH;
-	item.metaData.transmissionsOrTimeout = (transmissions == 0) ? CS_MESH_RELIABILITY_LOW : transmissions;
+	item.metaData.transmissionsOrTimeout = (transmissions == 0) ? getDefaultTransmissions(CS_MESH_RELIABILITY_LOW) : transmissions;
 	item.metaData.priority = true;
 	item.reliable = false;
 	item.broadcast = true;
@@ -160,7 +168,7 @@ cs_ret_code_t MeshMsgSender::sendTime(const cs_mesh_model_msg_time_t* packet, ui
 	MeshUtil::cs_mesh_queue_item_t item;
 	item.metaData.id = 0;
 	item.metaData.type = CS_MESH_MODEL_TYPE_STATE_TIME;
-	item.metaData.transmissionsOrTimeout = (transmissions == 0) ? CS_MESH_RELIABILITY_LOWEST : transmissions;
+	item.metaData.transmissionsOrTimeout = (transmissions == 0) ? getDefaultTransmissions(CS_MESH_RELIABILITY_LOWEST) : transmissions;
 	item.metaData.priority = true;
 	item.reliable = false;
 	item.broadcast = true;
@@ -178,7 +186,7 @@ cs_ret_code_t MeshMsgSender::sendBehaviourSettings(const behaviour_settings_t* p
 	MeshUtil::cs_mesh_queue_item_t item;
 	item.metaData.id = 0;
 	item.metaData.type = CS_MESH_MODEL_TYPE_SET_BEHAVIOUR_SETTINGS;
-	item.metaData.transmissionsOrTimeout = (transmissions == 0) ? CS_MESH_RELIABILITY_LOWEST : transmissions;
+	item.metaData.transmissionsOrTimeout = (transmissions == 0) ? getDefaultTransmissions(CS_MESH_RELIABILITY_LOWEST) : transmissions;
 	item.metaData.priority = false;
 	item.reliable = false;
 	item.broadcast = true;
@@ -198,7 +206,7 @@ cs_ret_code_t MeshMsgSender::sendProfileLocation(const cs_mesh_model_msg_profile
 	MeshUtil::cs_mesh_queue_item_t item;
 	item.metaData.id = id;
 	item.metaData.type = CS_MESH_MODEL_TYPE_PROFILE_LOCATION;
-	item.metaData.transmissionsOrTimeout = (transmissions == 0) ? CS_MESH_RELIABILITY_LOWEST : transmissions;
+	item.metaData.transmissionsOrTimeout = (transmissions == 0) ? getDefaultTransmissions(CS_MESH_RELIABILITY_LOWEST) : transmissions;
 	item.metaData.priority = false;
 	item.reliable = false;
 	item.broadcast = true;
@@ -216,7 +224,7 @@ cs_ret_code_t MeshMsgSender::sendTrackedDeviceRegister(const cs_mesh_model_msg_d
 	MeshUtil::cs_mesh_queue_item_t item;
 	item.metaData.id = packet->deviceId;
 	item.metaData.type = CS_MESH_MODEL_TYPE_TRACKED_DEVICE_REGISTER;
-	item.metaData.transmissionsOrTimeout = (transmissions == 0) ? CS_MESH_RELIABILITY_LOW : transmissions;
+	item.metaData.transmissionsOrTimeout = (transmissions == 0) ? getDefaultTransmissions(CS_MESH_RELIABILITY_LOW) : transmissions;
 	item.metaData.priority = false;
 	item.reliable = false;
 	item.broadcast = true;
@@ -234,7 +242,7 @@ cs_ret_code_t MeshMsgSender::sendTrackedDeviceToken(const cs_mesh_model_msg_devi
 	MeshUtil::cs_mesh_queue_item_t item;
 	item.metaData.id = packet->deviceId;
 	item.metaData.type = CS_MESH_MODEL_TYPE_TRACKED_DEVICE_TOKEN;
-	item.metaData.transmissionsOrTimeout = (transmissions == 0) ? CS_MESH_RELIABILITY_LOW : transmissions;
+	item.metaData.transmissionsOrTimeout = (transmissions == 0) ? getDefaultTransmissions(CS_MESH_RELIABILITY_LOW) : transmissions;
 	item.metaData.priority = false;
 	item.reliable = false;
 	item.broadcast = true;
@@ -252,7 +260,7 @@ cs_ret_code_t MeshMsgSender::sendTrackedDeviceListSize(const cs_mesh_model_msg_d
 	MeshUtil::cs_mesh_queue_item_t item;
 	item.metaData.id = 0;
 	item.metaData.type = CS_MESH_MODEL_TYPE_TRACKED_DEVICE_LIST_SIZE;
-	item.metaData.transmissionsOrTimeout = (transmissions == 0) ? CS_MESH_RELIABILITY_LOW : transmissions;
+	item.metaData.transmissionsOrTimeout = (transmissions == 0) ? getDefaultTransmissions(CS_MESH_RELIABILITY_LOW) : transmissions;
 	item.metaData.priority = false;
 	item.reliable = false;
 	item.broadcast = true;
@@ -286,14 +294,43 @@ cs_ret_code_t MeshMsgSender::addToQueue(MeshUtil::cs_mesh_queue_item_t & item) {
 			item.metaData.transmissionsOrTimeout = MESH_MODEL_TRANSMISSIONS_MAX;
 		}
 	}
+#if MESH_MODEL_AGGREGATION == 1
+	// Small messages wait a bit, to be packed together.
+	if (MeshMsgAggregator::isAggregatable(item) && _aggregator.add(item) == ERR_SUCCESS) {
+		return ERR_SUCCESS;
+	}
+#endif
 	return _selector->addToQueue(item);
 }
 
 cs_ret_code_t MeshMsgSender::remFromQueue(MeshUtil::cs_mesh_queue_item_t & item) {
 	assert(_selector != nullptr, "No model selector set.");
+#if MESH_MODEL_AGGREGATION == 1
+	_aggregator.remove(item.metaData);
+#endif
 	return _selector->remFromQueue(item);
 }
 
+void MeshMsgSender::flushAggregator() {
+#if MESH_MODEL_AGGREGATION == 1
+	_aggregator.tick();
+	if (!_aggregator.isReady()) {
+		return;
+	}
+	MeshUtil::cs_mesh_queue_item_t item;
+	while (_aggregator.getNext(item)) {
+		LOGMeshModelVerbose("flush aggregator type=%u size=%u", item.metaData.type, item.msgPayload.len);
+		cs_ret_code_t retCode = _selector->addToQueue(item);
+		if (retCode != ERR_SUCCESS) {
+			// Keep the items in the aggregator, and retry next tick.
+			LOGw("Failed to queue aggregated msg: retCode=%u numPending=%u", retCode, _aggregator.getNumPending());
+			return;
+		}
+		_aggregator.removeNext();
+	}
+#endif
+}
+
 
 
 cs_ret_code_t MeshMsgSender::handleSendMeshCommand(mesh_control_command_packet_t* command, const cmd_source_with_counter_t& source) {
@@ -347,7 +384,7 @@ cs_ret_code_t MeshMsgSender::handleSendMeshCommand(mesh_control_command_packet_t
 
 			uint8_t transmissions = command->header.timeoutOrTransmissions;
 			if (transmissions == 0) {
-				transmissions = CS_MESH_RELIABILITY_MEDIUM;
+				transmissions = getDefaultTransmissions(CS_MESH_RELIABILITY_MEDIUM);
 			}
 			return sendSetTime(&packet, transmissions);
 		}
@@ -438,6 +475,10 @@ cs_ret_code_t MeshMsgSender::handleSendMeshCommand(mesh_control_command_packet_t
 
 void MeshMsgSender::handleEvent(event_t & event) {
 	switch (event.type) {
+		case CS_TYPE::EVT_TICK: {
+			flushAggregator();
+			break;
+		}
 		case CS_TYPE::CMD_SEND_MESH_MSG: {
 			TYPIFY(CMD_SEND_MESH_MSG)* msg = (TYPIFY(CMD_SEND_MESH_MSG)*)event.data;
 			sendMsg(msg);
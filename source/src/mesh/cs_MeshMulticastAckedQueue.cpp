@@ -0,0 +1,203 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <cfg/cs_Config.h>
+#include <drivers/cs_Serial.h>
+#include <mesh/cs_MeshMulticastAckedQueue.h>
+#include <protocol/mesh/cs_MeshModelPacketHelper.h>
+
+#include <cstdlib>
+#include <cstring>
+
+MeshMulticastAckedQueue::~MeshMulticastAckedQueue() {
+	for (uint8_t i = 0; i < QUEUE_SIZE; ++i) {
+		if (_queue[i].metaData.transmissionsOrTimeout != 0) {
+			remove(i);
+		}
+	}
+}
+
+void MeshMulticastAckedQueue::setOwnStoneId(stone_id_t stoneId) {
+	_ownStoneId = stoneId;
+}
+
+void MeshMulticastAckedQueue::setMaxInFlight(uint8_t maxInFlight) {
+	_maxInFlight = (maxInFlight == 0) ? 1 : maxInFlight;
+}
+
+cs_ret_code_t MeshMulticastAckedQueue::add(const MeshUtil::cs_mesh_queue_item_t& item) {
+	size16_t msgSize = MeshUtil::getMeshMessageSize(item.msgPayload.len);
+	for (uint8_t i = _queueIndexNext; i < _queueIndexNext + QUEUE_SIZE; ++i) {
+		uint8_t index = i % QUEUE_SIZE;
+		cs_multicast_acked_queue_item_t* it = &(_queue[index]);
+		if (it->metaData.transmissionsOrTimeout != 0) {
+			continue;
+		}
+
+		// Allocate and copy msg.
+		it->msgPtr = (uint8_t*)malloc(msgSize);
+		LOGMeshModelVerbose("msg alloc %p size=%u", it->msgPtr, msgSize);
+		if (it->msgPtr == nullptr) {
+			return ERR_NO_SPACE;
+		}
+		if (!MeshUtil::setMeshMessage((cs_mesh_model_msg_type_t)item.metaData.type, item.msgPayload.data, item.msgPayload.len, it->msgPtr, msgSize)) {
+			free(it->msgPtr);
+			it->msgPtr = nullptr;
+			return ERR_WRONG_PAYLOAD_LENGTH;
+		}
+
+		// Allocate and copy stone ids.
+		it->stoneIdsPtr = (stone_id_t*)malloc(item.numIds * sizeof(stone_id_t));
+		LOGMeshModelVerbose("ids alloc %p size=%u", it->stoneIdsPtr, item.numIds * sizeof(stone_id_t));
+		if (it->stoneIdsPtr == nullptr && item.numIds != 0) {
+			free(it->msgPtr);
+			it->msgPtr = nullptr;
+			return ERR_NO_SPACE;
+		}
+		memcpy(it->stoneIdsPtr, item.stoneIdsPtr, item.numIds * sizeof(stone_id_t));
+
+		// Copy meta data.
+		memcpy(&(it->metaData), &(item.metaData), sizeof(item.metaData));
+		it->numIds = item.numIds;
+		it->msgSize = msgSize;
+		it->inProgress = false;
+		LOGMeshModelVerbose("added to ind=%u", index);
+		return ERR_SUCCESS;
+	}
+	LOGw("queue is full");
+	return ERR_BUSY;
+}
+
+cs_ret_code_t MeshMulticastAckedQueue::remove(cs_mesh_model_msg_type_t type, uint16_t id) {
+	cs_ret_code_t retCode = ERR_NOT_FOUND;
+	for (uint8_t i = 0; i < QUEUE_SIZE; ++i) {
+		if (_queue[i].metaData.id == id && _queue[i].metaData.type == type && _queue[i].metaData.transmissionsOrTimeout != 0) {
+			remove(i);
+			retCode = ERR_SUCCESS;
+		}
+	}
+	return retCode;
+}
+
+void MeshMulticastAckedQueue::remove(uint8_t index) {
+	cs_multicast_acked_queue_item_t* it = &(_queue[index]);
+	if (it->inProgress) {
+		it->inProgress = false;
+		_numInFlight--;
+	}
+	it->metaData.transmissionsOrTimeout = 0;
+	LOGMeshModelVerbose("msg free %p", it->msgPtr);
+	free(it->msgPtr);
+	it->msgPtr = nullptr;
+	LOGMeshModelVerbose("ids free %p", it->stoneIdsPtr);
+	free(it->stoneIdsPtr);
+	it->stoneIdsPtr = nullptr;
+	it->ackedStonesBitmask.setNumBits(0);
+	LOGMeshModelVerbose("removed from queue: ind=%u", index);
+}
+
+bool MeshMulticastAckedQueue::canStart(uint8_t index) {
+	cs_multicast_acked_queue_item_t* it = &(_queue[index]);
+	for (uint8_t i = 0; i < QUEUE_SIZE; ++i) {
+		if (!isInProgress(i) || _queue[i].metaData.type != it->metaData.type) {
+			continue;
+		}
+		for (uint8_t j = 0; j < _queue[i].numIds; ++j) {
+			for (uint8_t k = 0; k < it->numIds; ++k) {
+				if (_queue[i].stoneIdsPtr[j] == it->stoneIdsPtr[k]) {
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+int16_t MeshMulticastAckedQueue::getNextItemInQueue(bool priority) {
+	for (uint8_t i = _queueIndexNext; i < _queueIndexNext + QUEUE_SIZE; ++i) {
+		uint8_t index = i % QUEUE_SIZE;
+		cs_multicast_acked_queue_item_t* it = &(_queue[index]);
+		if ((!priority || it->metaData.priority) && it->metaData.transmissionsOrTimeout > 0 && !it->inProgress && canStart(index)) {
+			return index;
+		}
+	}
+	return -1;
+}
+
+int16_t MeshMulticastAckedQueue::startNext() {
+	if (_numInFlight >= _maxInFlight) {
+		return -1;
+	}
+	int16_t index = getNextItemInQueue(true);
+	if (index == -1) {
+		index = getNextItemInQueue(false);
+	}
+	if (index == -1) {
+		return -1;
+	}
+
+	cs_multicast_acked_queue_item_t* it = &(_queue[index]);
+	if (!it->ackedStonesBitmask.setNumBits(it->numIds)) {
+		return -1;
+	}
+	it->retriesLeft = it->metaData.transmissionsOrTimeout * 1000 / MESH_MODEL_ACKED_RETRY_INTERVAL_MS;
+
+	// Mark own stone ID as acked.
+	for (uint8_t i = 0; i < it->numIds; ++i) {
+		if (it->stoneIdsPtr[i] == _ownStoneId) {
+			it->ackedStonesBitmask.setBit(i);
+			break;
+		}
+	}
+	it->inProgress = true;
+	_numInFlight++;
+
+	// Next item will be started next, so that items are handled in turn.
+	_queueIndexNext = (index + 1) % QUEUE_SIZE;
+	return index;
+}
+
+int16_t MeshMulticastAckedQueue::findInFlight(stone_id_t srcId, uint8_t msgType, uint8_t& stoneIndex) {
+	for (uint8_t i = 0; i < QUEUE_SIZE; ++i) {
+		if (!isInProgress(i) || _queue[i].metaData.type != msgType) {
+			continue;
+		}
+		for (uint8_t j = 0; j < _queue[i].numIds; ++j) {
+			if (_queue[i].stoneIdsPtr[j] == srcId) {
+				stoneIndex = j;
+				return i;
+			}
+		}
+	}
+	return -1;
+}
+
+void MeshMulticastAckedQueue::setAcked(uint8_t index, uint8_t stoneIndex) {
+	_queue[index].ackedStonesBitmask.setBit(stoneIndex);
+}
+
+bool MeshMulticastAckedQueue::isAllAcked(uint8_t index) {
+	return _queue[index].ackedStonesBitmask.isAllBitsSet();
+}
+
+bool MeshMulticastAckedQueue::retry(uint8_t index) {
+	if (_queue[index].retriesLeft == 0) {
+		return true;
+	}
+	_queue[index].retriesLeft--;
+	return false;
+}
+
+uint8_t MeshMulticastAckedQueue::getNumQueued() {
+	uint8_t count = 0;
+	for (uint8_t i = 0; i < QUEUE_SIZE; ++i) {
+		if (_queue[i].metaData.transmissionsOrTimeout != 0) {
+			count++;
+		}
+	}
+	return count;
+}
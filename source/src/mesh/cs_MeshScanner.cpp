@@ -8,7 +8,10 @@
 #include <common/cs_Types.h>
 #include <events/cs_Event.h>
 #include <mesh/cs_MeshScanner.h>
+#include <processing/cs_ScanAggregator.h>
+#include <processing/cs_ScanPrefilter.h>
 #include <structs/cs_PacketsInternal.h>
+#include <util/cs_Utils.h>
 
 #include <cstring>
 
@@ -37,8 +40,16 @@ void MeshScanner::onScan(const nrf_mesh_adv_packet_rx_data_t *scanData) {
 		_scannedDevice.channel = scanData->p_metadata->params.scanner.channel;
 		_scannedDevice.dataSize = scanData->length;
 		_scannedDevice.data = (uint8_t*)(scanData->p_payload);
+		BLEutil::indexAdvData(_scannedDevice.data, _scannedDevice.dataSize, &_scannedDevice.advIndex);
+		if (!ScanPrefilter::getInstance().accept(&_scannedDevice)) {
+			break;
+		}
+#if SCAN_BATCH_ENABLED == 1
+		ScanAggregator::getInstance().add(&_scannedDevice);
+#else
 		event_t event(CS_TYPE::EVT_DEVICE_SCANNED, (void*)&_scannedDevice, sizeof(_scannedDevice));
 		event.dispatch();
+#endif
 
 //#if CS_SERIAL_NRF_LOG_ENABLED == 1
 //		const uint8_t* addr = p_rx_data->p_metadata->params.scanner.adv_addr.addr;
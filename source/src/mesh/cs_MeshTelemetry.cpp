@@ -0,0 +1,100 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <cfg/cs_Config.h>
+#include <mesh/cs_MeshTelemetry.h>
+
+#include <cstring>
+
+MeshTelemetry::MeshTelemetry() {
+	reset();
+}
+
+void MeshTelemetry::reset() {
+	memset(&_stats, 0, sizeof(_stats));
+	_ticksInSecond = 0;
+}
+
+void MeshTelemetry::tick(uint32_t tickCount) {
+	_tick = tickCount;
+	if (++_ticksInSecond >= 1000 / TICK_INTERVAL_MS) {
+		_ticksInSecond = 0;
+		_stats.durationSeconds++;
+	}
+}
+
+void MeshTelemetry::onQueued(MeshTelemetryModel model, uint8_t type) {
+	_stats.models[model].queued++;
+	if (type >= MESH_TELEMETRY_NUM_TYPES) {
+		type = MESH_TELEMETRY_NUM_TYPES - 1;
+	}
+	_stats.types[type].queued++;
+}
+
+void MeshTelemetry::onDropped(MeshTelemetryModel model) {
+	_stats.models[model].dropped++;
+}
+
+void MeshTelemetry::onSent(MeshTelemetryModel model) {
+	_stats.models[model].sent++;
+}
+
+void MeshTelemetry::onReceived(MeshTelemetryModel model, uint8_t type, uint8_t hops) {
+	_stats.models[model].received++;
+	if (hops != 0) {
+		_stats.models[model].receivedRelayed++;
+	}
+	if (type >= MESH_TELEMETRY_NUM_TYPES) {
+		type = MESH_TELEMETRY_NUM_TYPES - 1;
+	}
+	_stats.types[type].received++;
+}
+
+void MeshTelemetry::onRetry(MeshTelemetryModel model) {
+	_stats.models[model].retries++;
+}
+
+void MeshTelemetry::onAckTimeout(MeshTelemetryModel model) {
+	_stats.models[model].ackTimeouts++;
+}
+
+void MeshTelemetry::onFirstSent(uint16_t queuedTick) {
+	uint8_t bucket = getBucket(_tick - queuedTick);
+	_stats.queueWaitHistogram[bucket] = incrementCount(_stats.queueWaitHistogram[bucket]);
+}
+
+void MeshTelemetry::onAcked(uint16_t queuedTick) {
+	uint8_t bucket = getBucket(_tick - queuedTick);
+	_stats.ackedLatencyHistogram[bucket] = incrementCount(_stats.ackedLatencyHistogram[bucket]);
+}
+
+uint8_t MeshTelemetry::getBucket(uint16_t ticks) {
+	uint8_t bucket = 0;
+	while (ticks != 0 && bucket < MESH_TELEMETRY_HISTOGRAM_SIZE - 1) {
+		ticks >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
+
+uint16_t MeshTelemetry::incrementCount(uint16_t count) {
+	return (count == 0xFFFF) ? count : count + 1;
+}
+
+cs_mesh_telemetry_t& MeshTelemetry::getStats() {
+	return _stats;
+}
+
+void MeshTelemetry::getStats(cs_result_t& result) {
+	if (result.buf.len < sizeof(_stats)) {
+		result.returnCode = ERR_BUFFER_TOO_SMALL;
+		return;
+	}
+	memcpy(result.buf.data, &_stats, sizeof(_stats));
+	result.dataSize = sizeof(_stats);
+	result.returnCode = ERR_SUCCESS;
+}
@@ -17,7 +17,7 @@
 
 //#define PRESENCE_HANDLER_TESTING_CODE
 
-std::list<PresenceHandler::PresenceRecord> PresenceHandler::WhenWhoWhere;
+PresenceMatrix PresenceHandler::WhenWhoWhere;
 
 void PresenceHandler::init() {
     State::getInstance().get(CS_TYPE::CONFIG_CROWNSTONE_ID, &_ownId, sizeof(_ownId));
@@ -75,13 +75,13 @@ void PresenceHandler::handleEvent(event_t& evt){
 }
 
 PresenceHandler::MutationType PresenceHandler::handleProfileLocationAdministration(uint8_t profile, uint8_t location, bool fromMesh) {
-    auto prevdescription = getCurrentPresenceDescription();
+    uint64_t prevOccupiedRooms = WhenWhoWhere.getOccupiedLocations();
 
 #ifdef PRESENCE_HANDLER_TESTING_CODE
     if(profile == 0xff && location == 0xff){
         LOGw("DEBUG: clear presence record data");
         
-        if(prevdescription.value_or(0) != 0){
+        if(getCurrentPresenceDescription().value_or(0) != 0){
             // sphere exit
             WhenWhoWhere.clear();
             return MutationType::LastUserExitSphere;
@@ -91,37 +91,18 @@ PresenceHandler::MutationType PresenceHandler::handleProfileLocationAdministrati
     }
 #endif
 
-    // purge whowhenwhere of old entries and add a new entry
-    if (WhenWhoWhere.size() >= max_records) {
-    	LOGw("Reached max number of records");
-        WhenWhoWhere.pop_back();
+    LOGPresenceHandler("update profile(%u) location(%u)", profile, location);
+    // When profile location is new, or the mesh send countdown was 0: send profile location over the mesh.
+    bool sendToMesh = WhenWhoWhere.update(profile, location, presence_time_out_s, presence_mesh_send_throttle_seconds);
+    if (sendToMesh && !fromMesh) {
+    	propagateMeshMessage(profile, location);
     }
-    uint8_t meshCountdown = 0;
-    for (auto iter = WhenWhoWhere.begin(); iter != WhenWhoWhere.end();) {
-		if (iter->timeoutCountdownSeconds == 0) {
-			// Should not happen, record should've been removed.
-			LOGw("timed out record");
-		}
-    	if (iter->who == profile && iter->where == location) {
-    		LOGPresenceHandler("erasing old record profile(%u) location(%u)", profile, location);
-    		meshCountdown = iter->meshSendCountdownSeconds;
-    		WhenWhoWhere.erase(iter);
-    		break;
-    	}
-    	++iter;
-    }
-    // When record is new, or the old record mesh send countdown was 0: send profile location over the mesh.
-    if (meshCountdown == 0) {
-    	if (!fromMesh) {
-    		propagateMeshMessage(profile, location);
-    	}
-    	meshCountdown = presence_mesh_send_throttle_seconds;
-    }
-    LOGPresenceHandler("add record profile(%u) location(%u)", profile, location);
-    WhenWhoWhere.push_front(PresenceRecord(profile, location, presence_time_out_s, meshCountdown));
 
-    auto nextdescription = getCurrentPresenceDescription();
-    return getMutationType(prevdescription,nextdescription);
+    uint64_t nextOccupiedRooms = WhenWhoWhere.getOccupiedLocations();
+    if (nextOccupiedRooms == prevOccupiedRooms) {
+        return MutationType::NothingChanged;
+    }
+    return getMutationType(getPresenceDescription(prevOccupiedRooms), getPresenceDescription(nextOccupiedRooms));
 }
 
 PresenceHandler::MutationType PresenceHandler::getMutationType(
@@ -157,18 +138,6 @@ PresenceHandler::MutationType PresenceHandler::getMutationType(
     return MutationType::NothingChanged;
 }
 
-void PresenceHandler::removeOldRecords() {
-     WhenWhoWhere.remove_if( 
-        [&] (PresenceRecord www) {
-			if (www.timeoutCountdownSeconds == 0) {
-				LOGPresenceHandler("erasing timed out record profile=%u location=%u", www.who, www.where);
-				return true;
-			}
-			return false;
-        }
-    );
-}
-
 void PresenceHandler::triggerPresenceMutation(MutationType mutationtype){
     event_t presence_event(CS_TYPE::EVT_PRESENCE_MUTATION,&mutationtype,sizeof(mutationtype));
     presence_event.dispatch();
@@ -183,48 +152,23 @@ void PresenceHandler::propagateMeshMessage(uint8_t profile, uint8_t location){
 }
 
 std::optional<PresenceStateDescription> PresenceHandler::getCurrentPresenceDescription() {
+    return getPresenceDescription(WhenWhoWhere.getOccupiedLocations());
+}
+
+std::optional<PresenceStateDescription> PresenceHandler::getPresenceDescription(uint64_t occupiedRooms) {
     if (SystemTime::up() < presence_uncertain_due_reboot_time_out_s) {
         LOGPresenceHandler("presence_uncertain_due_reboot_time_out_s hasn't expired");
         return {};
     }
-    PresenceStateDescription p;
-    for (auto iter = WhenWhoWhere.begin(); iter != WhenWhoWhere.end(); ++iter) {
-    	if (iter->timeoutCountdownSeconds == 0) {
-    		// Should not happen, record should've been removed.
-    		LOGw("timed out record");
-    	}
-    	else {
-    		// appearently iter is valid, so the .where field describes an occupied room.
-			p.setRoom(iter->where);
-			// LOGPresenceHandler("adding room %d to currentPresenceDescription", iter->where);
-    	}
-    }
-    return p;
+    return PresenceStateDescription(occupiedRooms);
 }
 
 void PresenceHandler::tickSecond() {
-	for (auto iter = WhenWhoWhere.begin(); iter != WhenWhoWhere.end();) {
-		if (iter->timeoutCountdownSeconds) {
-			iter->timeoutCountdownSeconds--;
-		}
-		if (iter->timeoutCountdownSeconds == 0) {
-			iter = WhenWhoWhere.erase(iter);
-			// 8-1-2020 TODO Bart: send event?
-		}
-		else {
-			if (iter->meshSendCountdownSeconds) {
-				iter->meshSendCountdownSeconds--;
-			}
-			++iter;
-		}
-	}
+	// 8-1-2020 TODO Bart: send event when a profile location times out?
+	WhenWhoWhere.tickSecond();
 }
 
 void PresenceHandler::print(){
-    // for(auto iter = WhenWhoWhere.begin(); iter != WhenWhoWhere.end(); iter++){
-    //     LOGd("at %d seconds after startup user #%d was found in room %d", iter->when, iter->who, iter->where);
-    // }
-    
     std::optional<PresenceStateDescription> desc = getCurrentPresenceDescription();
     if(desc){
         // desc->print();
@@ -0,0 +1,82 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <presence/cs_PresenceMatrix.h>
+
+#include <cstring>
+
+PresenceMatrix::PresenceMatrix() {
+	clear();
+}
+
+void PresenceMatrix::clear() {
+	memset(_presence, 0, sizeof(_presence));
+	memset(_timeoutCountdown, 0, sizeof(_timeoutCountdown));
+	memset(_meshSendCountdown, 0, sizeof(_meshSendCountdown));
+	_occupiedLocations = 0;
+	_numPresent = 0;
+}
+
+bool PresenceMatrix::update(uint8_t profile, uint8_t location, uint8_t timeoutSeconds, uint8_t meshThrottleSeconds) {
+	uint64_t bit = 1ULL << location;
+	if (!(_presence[profile] & bit)) {
+		_presence[profile] |= bit;
+		_occupiedLocations |= bit;
+		_numPresent++;
+		_meshSendCountdown[profile][location] = 0;
+	}
+	_timeoutCountdown[profile][location] = timeoutSeconds;
+
+	if (_meshSendCountdown[profile][location] == 0) {
+		_meshSendCountdown[profile][location] = meshThrottleSeconds;
+		return true;
+	}
+	return false;
+}
+
+bool PresenceMatrix::isPresent(uint8_t profile, uint8_t location) {
+	return _presence[profile] & (1ULL << location);
+}
+
+uint64_t PresenceMatrix::getOccupiedLocations() {
+	return _occupiedLocations;
+}
+
+uint16_t PresenceMatrix::getNumPresent() {
+	return _numPresent;
+}
+
+void PresenceMatrix::remove(uint8_t profile, uint8_t location) {
+	uint64_t bit = 1ULL << location;
+	_presence[profile] &= ~bit;
+	_numPresent--;
+	for (uint8_t p = 0; p <= max_profile_id; ++p) {
+		if (_presence[p] & bit) {
+			return;
+		}
+	}
+	_occupiedLocations &= ~bit;
+}
+
+void PresenceMatrix::tickSecond() {
+	for (uint8_t profile = 0; profile <= max_profile_id; ++profile) {
+		uint64_t locations = _presence[profile];
+		while (locations) {
+			uint8_t location = __builtin_ctzll(locations);
+			locations &= locations - 1;
+			if (_timeoutCountdown[profile][location]) {
+				_timeoutCountdown[profile][location]--;
+			}
+			if (_timeoutCountdown[profile][location] == 0) {
+				remove(profile, location);
+			}
+			else if (_meshSendCountdown[profile][location]) {
+				_meshSendCountdown[profile][location]--;
+			}
+		}
+	}
+}
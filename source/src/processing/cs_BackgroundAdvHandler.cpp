@@ -14,6 +14,8 @@
 #include "ble/cs_Nordic.h"
 #include "processing/cs_EncryptionHandler.h"
 #include "processing/cs_CommandHandler.h"
+#include "processing/cs_ScanAggregator.h"
+#include "processing/cs_ScanPrefilter.h"
 #include "storage/cs_State.h"
 #include "time/cs_SystemTime.h"
 
@@ -36,26 +38,36 @@
 BackgroundAdvertisementHandler::BackgroundAdvertisementHandler() {
 	State::getInstance().get(CS_TYPE::CONFIG_SPHERE_ID, &_sphereId, sizeof(_sphereId));
 	EventDispatcher::getInstance().addListener(this);
+
+	// Only let background advertisements through: apple manufacturer data with a services mask.
+	scan_prefilter_rule_t rule;
+	rule.adType = BLE_GAP_AD_TYPE_MANUFACTURER_SPECIFIC_DATA;
+	rule.companyId = COMPANY_ID_APPLE;
+	rule.patternOffset = 2;
+	rule.patternLen = 1;
+	rule.pattern[0] = BACKGROUND_SERVICES_MASK_TYPE;
+	rule.mask[0] = 0xFF;
+	ScanPrefilter::getInstance().addRule(rule);
 }
 
-void BackgroundAdvertisementHandler::parseAdvertisement(scanned_device_t* scannedDevice) {
+bool BackgroundAdvertisementHandler::parseAdvertisement(scanned_device_t* scannedDevice, adv_background_t& backgroundAdvertisement, uint16_t encryptedPayload[2]) {
 	uint32_t errCode;
 	cs_data_t manufacturerData;
-	errCode = BLEutil::findAdvType(BLE_GAP_AD_TYPE_MANUFACTURER_SPECIFIC_DATA, scannedDevice->data, scannedDevice->dataSize, &manufacturerData);
+	errCode = BLEutil::findAdvType(BLE_GAP_AD_TYPE_MANUFACTURER_SPECIFIC_DATA, scannedDevice, &manufacturerData);
 	if (errCode != ERR_SUCCESS) {
-		return;
+		return false;
 	}
 	if (manufacturerData.len != BACKGROUND_SERVICES_MASK_HEADER_LEN + BACKGROUND_SERVICES_MASK_LEN) {
-		return;
+		return false;
 	}
 
 	uint16_t companyId = *((uint16_t*)(manufacturerData.data));
 	if (companyId != COMPANY_ID_APPLE) {
-		return;
+		return false;
 	}
 	uint8_t appleAdvType = manufacturerData.data[2];
 	if (appleAdvType != BACKGROUND_SERVICES_MASK_TYPE) {
-		return;
+		return false;
 	}
 
 	uint8_t* servicesMask; // This is a mask of 128 bits.
@@ -115,15 +127,13 @@ void BackgroundAdvertisementHandler::parseAdvertisement(scanned_device_t* scanne
 		LOGBackgroundAdvDebug("v1 token=[%u %u %u]", parsed.deviceToken[0], parsed.deviceToken[1], parsed.deviceToken[2]);
 		event_t event(CS_TYPE::EVT_ADV_BACKGROUND_PARSED_V1, &parsed, sizeof(parsed));
 		EventDispatcher::getInstance().dispatch(event);
-		return;
+		return false;
 	}
 
 	// For protocol 0:
 	//	uint8_t protocol : 2;
 	//	uint8_t sphereId : 8;
 	//	uint16_t encryptedData[2];
-	adv_background_t backgroundAdvertisement;
-	uint16_t encryptedPayload[2];
 	backgroundAdvertisement.protocol = protocol;
 	backgroundAdvertisement.sphereId = (result >> (42-2-8)) & 0xFF;
 	encryptedPayload[0] = (result >> (42-2-8-16)) & 0xFFFF;
@@ -133,39 +143,67 @@ void BackgroundAdvertisementHandler::parseAdvertisement(scanned_device_t* scanne
 
 	if (backgroundAdvertisement.protocol != 0 || backgroundAdvertisement.sphereId != _sphereId) {
 		LOGBackgroundAdvVerbose("wrong protocol (%u) or sphereId (%u vs %u)", backgroundAdvertisement.protocol, backgroundAdvertisement.sphereId, _sphereId);
-		return;
+		return false;
 	}
-
 	LOGBackgroundAdvVerbose("encrypted=[%u %u]", encryptedPayload[0], encryptedPayload[1]);
-	// TODO: can decrypt to same buffer?
-	uint16_t decryptedPayload[2];
-	bool success = EncryptionHandler::getInstance().RC5Decrypt(encryptedPayload, sizeof(encryptedPayload), decryptedPayload, sizeof(decryptedPayload));
-	if (!success) {
+	return true;
+}
+
+void BackgroundAdvertisementHandler::handleEncryptedAdvertisements(adv_background_t* backgroundAdvertisements, uint16_t* encryptedPayloads, uint8_t count) {
+	if (count > SCAN_BATCH_SIZE) {
 		return;
 	}
-	LOGBackgroundAdvVerbose("decrypted=[%u %u]", decryptedPayload[0], decryptedPayload[1]);
-
-	// Validate
 	uint32_t timestamp = SystemTime::posix();
 	uint16_t timestampRounded = (timestamp >> 7) & 0x0000FFFF;
-	LOGBackgroundAdvVerbose("validation=%u time=%u rounded=%u", decryptedPayload[0], timestamp, timestampRounded);
 
-	// For now, we also allow CAFE as validation.
-	bool validated = false;
-	if (decryptedPayload[0] == 0xCAFE) {
-		validated = true;
-	}
-	if (timestampRounded - 1 < decryptedPayload[0] && decryptedPayload[0] < timestampRounded + 1) {
-		validated = true;
-	}
-	if (!validated) {
-		return;
+	// Look up the cached results, and gather the payloads that have to be decrypted.
+	uint16_t decryptedPayloads[SCAN_BATCH_SIZE * 2];
+	bool validated[SCAN_BATCH_SIZE];
+	uint16_t missedPayloads[SCAN_BATCH_SIZE * 2];
+	uint8_t missedIndices[SCAN_BATCH_SIZE];
+	uint8_t numMissed = 0;
+	for (uint8_t i = 0; i < count; ++i) {
+		if (!_validationCache.get(encryptedPayloads + 2 * i, timestampRounded, decryptedPayloads + 2 * i, validated[i])) {
+			missedPayloads[2 * numMissed]     = encryptedPayloads[2 * i];
+			missedPayloads[2 * numMissed + 1] = encryptedPayloads[2 * i + 1];
+			missedIndices[numMissed] = i;
+			numMissed++;
+		}
 	}
 
-	backgroundAdvertisement.data = (uint8_t*)decryptedPayload;
-	backgroundAdvertisement.dataSize = sizeof(decryptedPayload);
+	if (numMissed) {
+		if (!EncryptionHandler::getInstance().RC5DecryptBatch(missedPayloads, missedPayloads, numMissed)) {
+			return;
+		}
+		for (uint8_t m = 0; m < numMissed; ++m) {
+			uint8_t i = missedIndices[m];
+			uint16_t* decryptedPayload = decryptedPayloads + 2 * i;
+			decryptedPayload[0] = missedPayloads[2 * m];
+			decryptedPayload[1] = missedPayloads[2 * m + 1];
+			LOGBackgroundAdvVerbose("decrypted=[%u %u]", decryptedPayload[0], decryptedPayload[1]);
+
+			// Validate
+			LOGBackgroundAdvVerbose("validation=%u time=%u rounded=%u", decryptedPayload[0], timestamp, timestampRounded);
+			// For now, we also allow CAFE as validation.
+			validated[i] = false;
+			if (decryptedPayload[0] == 0xCAFE) {
+				validated[i] = true;
+			}
+			if (timestampRounded - 1 < decryptedPayload[0] && decryptedPayload[0] < timestampRounded + 1) {
+				validated[i] = true;
+			}
+			_validationCache.set(encryptedPayloads + 2 * i, timestampRounded, decryptedPayload, validated[i]);
+		}
+	}
 
-	handleBackgroundAdvertisement(&backgroundAdvertisement);
+	for (uint8_t i = 0; i < count; ++i) {
+		if (!validated[i]) {
+			continue;
+		}
+		backgroundAdvertisements[i].data = (uint8_t*)(decryptedPayloads + 2 * i);
+		backgroundAdvertisements[i].dataSize = sizeof(uint16_t) * 2;
+		handleBackgroundAdvertisement(&backgroundAdvertisements[i]);
+	}
 }
 
 void BackgroundAdvertisementHandler::handleBackgroundAdvertisement(adv_background_t* backgroundAdvertisement) {
@@ -215,7 +253,30 @@ void BackgroundAdvertisementHandler::handleEvent(event_t & event) {
 	switch(event.type) {
 	case CS_TYPE::EVT_DEVICE_SCANNED: {
 		TYPIFY(EVT_DEVICE_SCANNED)* scannedDevice = (TYPIFY(EVT_DEVICE_SCANNED)*)event.data;
-		parseAdvertisement(scannedDevice);
+		adv_background_t backgroundAdvertisement;
+		uint16_t encryptedPayload[2];
+		if (parseAdvertisement(scannedDevice, backgroundAdvertisement, encryptedPayload)) {
+			handleEncryptedAdvertisements(&backgroundAdvertisement, encryptedPayload, 1);
+		}
+		break;
+	}
+	case CS_TYPE::EVT_DEVICE_SCANNED_BATCH: {
+		TYPIFY(EVT_DEVICE_SCANNED_BATCH)* batch = (TYPIFY(EVT_DEVICE_SCANNED_BATCH)*)event.data;
+		adv_background_t backgroundAdvertisements[SCAN_BATCH_SIZE];
+		uint16_t encryptedPayloads[SCAN_BATCH_SIZE * 2];
+		uint8_t count = 0;
+		for (uint8_t i = 0; i < batch->size && i < SCAN_BATCH_SIZE; ++i) {
+			if (parseAdvertisement(&(batch->records[i].device), backgroundAdvertisements[count], encryptedPayloads + 2 * count)) {
+				count++;
+			}
+		}
+		if (count) {
+			handleEncryptedAdvertisements(backgroundAdvertisements, encryptedPayloads, count);
+		}
+		break;
+	}
+	case CS_TYPE::CONFIG_KEY_LOCALIZATION: {
+		_validationCache.clear();
 		break;
 	}
 	case CS_TYPE::EVT_ADV_BACKGROUND: {
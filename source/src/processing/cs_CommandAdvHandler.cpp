@@ -11,6 +11,8 @@
 #include "events/cs_EventDispatcher.h"
 #include "common/cs_Types.h"
 #include "processing/cs_EncryptionHandler.h"
+#include "processing/cs_ScanPrefilter.h"
+#include "processing/cs_Scanner.h"
 #include "storage/cs_State.h"
 #include "time/cs_SystemTime.h"
 #include "util/cs_BleError.h"
@@ -43,6 +45,13 @@ CommandAdvHandler::CommandAdvHandler() {
 void CommandAdvHandler::init() {
 	State::getInstance().get(CS_TYPE::CONFIG_SPHERE_ID, &_sphereId, sizeof(_sphereId));
 	EventDispatcher::getInstance().addListener(this);
+
+	// Only let command advertisements through: a list of at least CMD_ADV_NUM_SERVICES_16BIT service UUIDs.
+	// The pattern is empty, it's only used to require a minimum length.
+	scan_prefilter_rule_t rule;
+	rule.adType = BLE_GAP_AD_TYPE_16BIT_SERVICE_UUID_COMPLETE;
+	rule.patternOffset = CMD_ADV_NUM_SERVICES_16BIT * sizeof(uint16_t);
+	ScanPrefilter::getInstance().addRule(rule);
 }
 
 void CommandAdvHandler::parseAdvertisement(scanned_device_t* scannedDevice) {
@@ -68,12 +77,12 @@ void CommandAdvHandler::parseAdvertisement(scanned_device_t* scannedDevice) {
 
 	uint32_t errCode;
 	cs_data_t services16bit;
-	errCode = BLEutil::findAdvType(BLE_GAP_AD_TYPE_16BIT_SERVICE_UUID_COMPLETE, scannedDevice->data, scannedDevice->dataSize, &services16bit);
+	errCode = BLEutil::findAdvType(BLE_GAP_AD_TYPE_16BIT_SERVICE_UUID_COMPLETE, scannedDevice, &services16bit);
 	if (errCode != ERR_SUCCESS) {
 		return;
 	}
 	cs_data_t services128bit;
-	errCode = BLEutil::findAdvType(BLE_GAP_AD_TYPE_128BIT_SERVICE_UUID_COMPLETE, scannedDevice->data, scannedDevice->dataSize, &services128bit);
+	errCode = BLEutil::findAdvType(BLE_GAP_AD_TYPE_128BIT_SERVICE_UUID_COMPLETE, scannedDevice, &services128bit);
 	if (errCode != ERR_SUCCESS) {
 		return;
 	}
@@ -146,6 +155,9 @@ void CommandAdvHandler::parseAdvertisement(scanned_device_t* scannedDevice) {
 		return;
 	}
 
+	// A phone repeats a command advertisement for a while, make sure the repeats are heard.
+	Scanner::getInstance().addCommandHit();
+
 	cs_data_t nonceData;
 	nonceData.data = nonce;
 	nonceData.len = sizeof(nonce);
@@ -157,61 +169,36 @@ void CommandAdvHandler::parseAdvertisement(scanned_device_t* scannedDevice) {
 	}
 }
 
-int CommandAdvHandler::checkSimilarCommand(uint8_t deviceToken, cs_data_t& encryptedData, uint16_t encryptedRC5, uint16_t& decryptedRC5) {
-	assert(encryptedData.len == CMD_ADC_ENCRYPTED_DATA_SIZE, "Invalid size");
-	int index = -1;
-	for (int i=0; i<CMD_ADV_MAX_CLAIM_COUNT; ++i) {
-		if (_claims[i].deviceToken == deviceToken) {
-			if (_claims[i].timeoutCounter && _claims[i].encryptedRC5 == encryptedRC5 && memcmp(_claims[i].encryptedData, encryptedData.data, CMD_ADC_ENCRYPTED_DATA_SIZE) == 0) {
-				LOGCommandAdvVerbose("Ignore similar payload");
-				// Since all encrypted data is similar: set cached decrypted RC5.
-				// The RC5 data does not use access level, so changing access level does not do anything.
-				decryptedRC5 = _claims[i].decryptedRC5;
-				return -2;
-			}
-			index = i;
-			break;
-		}
-	}
-	return index;
-}
-
-bool CommandAdvHandler::claim(uint8_t deviceToken, cs_data_t& encryptedData, uint16_t encryptedRC5, uint16_t decryptedRC5, int index) {
+bool CommandAdvHandler::checkSimilarCommand(uint8_t deviceToken, cs_data_t& encryptedData, uint16_t encryptedRC5, uint16_t decryptedRC5[2]) {
 	assert(encryptedData.len == CMD_ADC_ENCRYPTED_DATA_SIZE, "Invalid size");
-	assert(index > -2 && index < CMD_ADV_MAX_CLAIM_COUNT, "Invalid index");
-	if (index == -1) {
-		// Check if there's a spot to claim.
-		for (int i=0; i<CMD_ADV_MAX_CLAIM_COUNT; ++i) {
-			if (!_claims[i].timeoutCounter) {
-				index = i;
-				break;
-			}
-		}
-	}
-	if (index != -1) {
-		// Claim the spot
-		_claims[index].deviceToken = deviceToken;
-		_claims[index].timeoutCounter = CMD_ADV_CLAIM_TIME_MS / TICK_INTERVAL_MS;
-		memcpy(_claims[index].encryptedData, encryptedData.data, CMD_ADC_ENCRYPTED_DATA_SIZE);
-		_claims[index].encryptedRC5 = encryptedRC5;
-		_claims[index].decryptedRC5 = decryptedRC5;
+	command_adv_claim_t* claim = _claims.find(deviceToken);
+	if (claim != nullptr && claim->encryptedRC5 == encryptedRC5 && memcmp(claim->encryptedData, encryptedData.data, CMD_ADC_ENCRYPTED_DATA_SIZE) == 0) {
+		LOGCommandAdvVerbose("Ignore similar payload");
+		// Since all encrypted data is similar: set cached decrypted RC5.
+		// The RC5 data does not use access level, so changing access level does not do anything.
+		decryptedRC5[0] = claim->decryptedRC5[0];
+		decryptedRC5[1] = claim->decryptedRC5[1];
 		return true;
 	}
-	LOGCommandAdvDebug("No more claim spots");
 	return false;
 }
 
-void CommandAdvHandler::tickClaims() {
-	for (int i=0; i<CMD_ADV_MAX_CLAIM_COUNT; ++i) {
-		if (_claims[i].timeoutCounter) {
-			--_claims[i].timeoutCounter;
-		}
+bool CommandAdvHandler::claim(uint8_t deviceToken, cs_data_t& encryptedData, uint16_t encryptedRC5, uint16_t decryptedRC5[2]) {
+	assert(encryptedData.len == CMD_ADC_ENCRYPTED_DATA_SIZE, "Invalid size");
+	command_adv_claim_t* claim = _claims.claim(deviceToken);
+	if (claim == nullptr) {
+		LOGCommandAdvDebug("No more claim spots, dropped=%u", _claims.getDroppedCount());
+		return false;
 	}
+	memcpy(claim->encryptedData, encryptedData.data, CMD_ADC_ENCRYPTED_DATA_SIZE);
+	claim->encryptedRC5 = encryptedRC5;
+	claim->decryptedRC5[0] = decryptedRC5[0];
+	claim->decryptedRC5[1] = decryptedRC5[1];
+	return true;
 }
 
 bool CommandAdvHandler::handleEncryptedCommandPayload(scanned_device_t* scannedDevice, const command_adv_header_t& header, const cs_data_t& nonce, cs_data_t& encryptedPayload, uint16_t encryptedPayloadRC5[2], uint16_t decryptedPayloadRC5[2]) {
-	int claimIndex = checkSimilarCommand(header.deviceToken, encryptedPayload, encryptedPayloadRC5[1], decryptedPayloadRC5[1]);
-	if (claimIndex == -2) {
+	if (checkSimilarCommand(header.deviceToken, encryptedPayload, encryptedPayloadRC5[1], decryptedPayloadRC5)) {
 		LOGCommandAdvVerbose("Ignore already handled command");
 		// Command was already validated previous time.
 		// Since the RC5 data does not use the access level, it can safely be handled.
@@ -279,7 +266,7 @@ bool CommandAdvHandler::handleEncryptedCommandPayload(scanned_device_t* scannedD
 	// Validated, so from here on, return true.
 
 	// Claim only after validation
-	if (!claim(header.deviceToken, encryptedPayload, encryptedPayloadRC5[1], decryptedPayloadRC5[1], claimIndex)) {
+	if (!claim(header.deviceToken, encryptedPayload, encryptedPayloadRC5[1], decryptedPayloadRC5)) {
 		return true;
 	}
 
@@ -424,8 +411,15 @@ void CommandAdvHandler::handleEvent(event_t & event) {
 		parseAdvertisement(scannedDevice);
 		break;
 	}
+	case CS_TYPE::EVT_DEVICE_SCANNED_BATCH: {
+		TYPIFY(EVT_DEVICE_SCANNED_BATCH)* batch = (TYPIFY(EVT_DEVICE_SCANNED_BATCH)*)event.data;
+		for (uint8_t i = 0; i < batch->size; ++i) {
+			parseAdvertisement(&(batch->records[i].device));
+		}
+		break;
+	}
 	case CS_TYPE::EVT_TICK: {
-		tickClaims();
+		_claims.tick();
 		break;
 	}
 	default:
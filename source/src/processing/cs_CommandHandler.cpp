@@ -109,6 +109,8 @@ void CommandHandler::handleCommand(
 		case CTRL_CMD_UART_MSG:
 		case CTRL_CMD_STATE_GET:
 		case CTRL_CMD_STATE_SET:
+		case CTRL_CMD_STATE_SNAPSHOT_GET:
+		case CTRL_CMD_STATE_SNAPSHOT_SET:
 		case CTRL_CMD_SAVE_BEHAVIOUR:
 		case CTRL_CMD_REPLACE_BEHAVIOUR:
 		case CTRL_CMD_REMOVE_BEHAVIOUR:
@@ -120,6 +122,13 @@ void CommandHandler::handleCommand(
 		case CTRL_CMD_GET_ADC_RESTARTS:
 		case CTRL_CMD_GET_SWITCH_HISTORY:
 		case CTRL_CMD_GET_POWER_SAMPLES:
+		case CTRL_CMD_GET_MESH_LINK_QUALITY:
+		case CTRL_CMD_GET_MESH_TELEMETRY:
+		case CTRL_CMD_RESET_MESH_TELEMETRY:
+		case CTRL_CMD_GET_SCAN_PREFILTER_STATS:
+		case CTRL_CMD_GET_SCAN_DUTY_STATS:
+		case CTRL_CMD_GET_EXTERNAL_STATE_STATS:
+		case CTRL_CMD_GET_STORAGE_GC_STATS:
 		case CTRL_CMD_MICROAPP_UPLOAD:
 			LOGd("cmd=%u lvl=%u", type, accessLevel);
 			break;
@@ -180,6 +189,10 @@ void CommandHandler::handleCommand(
 		return handleCmdStateGet(commandData, accessLevel, result);
 	case CTRL_CMD_STATE_SET:
 		return handleCmdStateSet(commandData, accessLevel, result);
+	case CTRL_CMD_STATE_SNAPSHOT_GET:
+		return handleCmdStateSnapshotGet(commandData, accessLevel, result);
+	case CTRL_CMD_STATE_SNAPSHOT_SET:
+		return handleCmdStateSnapshotSet(commandData, accessLevel, result);
 	case CTRL_CMD_SAVE_BEHAVIOUR:
 		return dispatchEventForCommand(CS_TYPE::CMD_ADD_BEHAVIOUR, commandData, source, result);
 	case CTRL_CMD_REPLACE_BEHAVIOUR:
@@ -204,6 +217,20 @@ void CommandHandler::handleCommand(
 		return dispatchEventForCommand(CS_TYPE::CMD_GET_SWITCH_HISTORY, commandData, source, result);
 	case CTRL_CMD_GET_POWER_SAMPLES:
 		return dispatchEventForCommand(CS_TYPE::CMD_GET_POWER_SAMPLES, commandData, source, result);
+	case CTRL_CMD_GET_MESH_LINK_QUALITY:
+		return dispatchEventForCommand(CS_TYPE::CMD_GET_MESH_LINK_QUALITY, commandData, source, result);
+	case CTRL_CMD_GET_MESH_TELEMETRY:
+		return dispatchEventForCommand(CS_TYPE::CMD_GET_MESH_TELEMETRY, commandData, source, result);
+	case CTRL_CMD_RESET_MESH_TELEMETRY:
+		return dispatchEventForCommand(CS_TYPE::CMD_RESET_MESH_TELEMETRY, commandData, source, result);
+	case CTRL_CMD_GET_SCAN_PREFILTER_STATS:
+		return dispatchEventForCommand(CS_TYPE::CMD_GET_SCAN_PREFILTER_STATS, commandData, source, result);
+	case CTRL_CMD_GET_SCAN_DUTY_STATS:
+		return dispatchEventForCommand(CS_TYPE::CMD_GET_SCAN_DUTY_STATS, commandData, source, result);
+	case CTRL_CMD_GET_EXTERNAL_STATE_STATS:
+		return dispatchEventForCommand(CS_TYPE::CMD_GET_EXTERNAL_STATE_STATS, commandData, source, result);
+	case CTRL_CMD_GET_STORAGE_GC_STATS:
+		return dispatchEventForCommand(CS_TYPE::CMD_GET_STORAGE_GC_STATS, commandData, source, result);
 	case CTRL_CMD_MICROAPP_UPLOAD:
 		return handleMicroAppUpload(commandData, accessLevel, result);
 	case CTRL_CMD_UNKNOWN:
@@ -443,6 +470,16 @@ void CommandHandler::handleCmdStateSet(cs_data_t commandData, const EncryptionAc
 	}
 }
 
+void CommandHandler::handleCmdStateSnapshotGet(cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t & result) {
+	LOGi(STR_HANDLE_COMMAND, "state snapshot get");
+	_stateSnapshotHandler.handleGet(commandData, accessLevel, result);
+}
+
+void CommandHandler::handleCmdStateSnapshotSet(cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t & result) {
+	LOGi(STR_HANDLE_COMMAND, "state snapshot set");
+	_stateSnapshotHandler.handleSet(commandData, accessLevel, result);
+}
+
 void CommandHandler::handleCmdSetTime(cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t & result) {
 	LOGCommandHandlerDebug(STR_HANDLE_COMMAND, "set time:");
 	if (commandData.len != sizeof(uint32_t)) {
@@ -900,7 +937,16 @@ EncryptionAccessLevel CommandHandler::getRequiredAccessLevel(const CommandHandle
 		case CTRL_CMD_GET_ADC_RESTARTS:
 		case CTRL_CMD_GET_SWITCH_HISTORY:
 		case CTRL_CMD_GET_POWER_SAMPLES:
+		case CTRL_CMD_GET_MESH_LINK_QUALITY:
+		case CTRL_CMD_GET_MESH_TELEMETRY:
+		case CTRL_CMD_RESET_MESH_TELEMETRY:
+		case CTRL_CMD_GET_SCAN_PREFILTER_STATS:
+		case CTRL_CMD_GET_SCAN_DUTY_STATS:
+		case CTRL_CMD_GET_EXTERNAL_STATE_STATS:
+		case CTRL_CMD_GET_STORAGE_GC_STATS:
 		case CTRL_CMD_MICROAPP_UPLOAD:
+		case CTRL_CMD_STATE_SNAPSHOT_GET:
+		case CTRL_CMD_STATE_SNAPSHOT_SET:
 			return ADMIN;
 		case CTRL_CMD_UNKNOWN:
 			return NOT_SET;
@@ -944,6 +990,11 @@ void CommandHandler::handleEvent(event_t & event) {
 			);
 			break;
 		}
+		case CS_TYPE::EVT_BLE_DISCONNECT: {
+			// Don't keep an unfinished snapshot transfer in memory.
+			_stateSnapshotHandler.clear();
+			break;
+		}
 		default: {}
 	}
 }
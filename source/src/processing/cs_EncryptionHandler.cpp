@@ -14,14 +14,6 @@
 //#define TESTING_ENCRYPTION
 #define LOGEncryption LOGnone
 
-// Rotate functions for 16 bit integers
-#define ROTL_16BIT(x, shift) ((x)<<(shift) | (x)>>(16-(shift)))
-#define ROTR_16BIT(x, shift) ((x)>>(shift) | (x)<<(16-(shift)))
-
-// Magic numbers for RC5 with 16 bit words.
-#define RC5_16BIT_P 0xB7E1
-#define RC5_16BIT_Q 0x9E37
-
 void EncryptionHandler::init() {
 	_defaultValidationKey.b = DEFAULT_SESSION_KEY;
 	EventDispatcher::getInstance().addListener(this);
@@ -68,6 +60,20 @@ void EncryptionHandler::handleEvent(event_t & event) {
 			_generateSessionData();
 		}
 		break;
+	case CS_TYPE::CONFIG_KEY_ADMIN:
+	case CS_TYPE::CONFIG_KEY_MEMBER:
+	case CS_TYPE::CONFIG_KEY_BASIC:
+	case CS_TYPE::CONFIG_KEY_SERVICE_DATA:
+	case CS_TYPE::CONFIG_KEY_LOCALIZATION: {
+		EncryptionAccessLevel accessLevels[] = {ADMIN, MEMBER, BASIC, SERVICE_DATA, LOCALIZATION};
+		for (auto accessLevel: accessLevels) {
+			uint8_t index = _getRC5Index(accessLevel);
+			if (_rc5Initialized & (1 << index)) {
+				RC5InitKey(accessLevel);
+			}
+		}
+		break;
+	}
 	default: {}
 	}
 }
@@ -390,78 +396,48 @@ bool EncryptionHandler::decryptBlockCTR(uint8_t* encryptedData, uint16_t encrypt
 }
 
 bool EncryptionHandler::RC5InitKey(EncryptionAccessLevel accessLevel) {
+	uint8_t index = _getRC5Index(accessLevel);
+	if (index == RC5_NUM_ACCESS_LEVELS) {
+		return false;
+	}
 	// Sets the key in _block.
 	if (!_checkAndSetKey(accessLevel)) {
 		return false;
 	}
-	return _RC5PrepareKey(_block.key, SOC_ECB_KEY_LENGTH);
+	if (!_rc5[index].prepareKey(_block.key, SOC_ECB_KEY_LENGTH)) {
+		return false;
+	}
+	_rc5Initialized |= (1 << index);
+	return true;
 }
 
-// See https://en.wikipedia.org/wiki/RC5
-bool EncryptionHandler::RC5Decrypt(uint16_t* encryptedData, uint16_t encryptedDataLength, uint16_t* target, uint16_t targetLength) {
+bool EncryptionHandler::RC5Decrypt(uint16_t* encryptedData, uint16_t encryptedDataLength, uint16_t* target, uint16_t targetLength, EncryptionAccessLevel accessLevel) {
 	if (encryptedDataLength != 4 || targetLength != 4) {
 		return false;
 	}
-	uint16_t a = encryptedData[0];
-	uint16_t b = encryptedData[1];
-	uint16_t sum;
-	for (uint16_t i=RC5_ROUNDS; i>0; --i) {
-		sum = b - _rc5SubKeys[2*i + 1];
-		b = ROTR_16BIT(sum, a % 16) ^ a;
-		sum = a - _rc5SubKeys[2*i];
-		a = ROTR_16BIT(sum, b % 16) ^ b;
-	}
-	target[0] = a - _rc5SubKeys[0];
-	target[1] = b - _rc5SubKeys[1];
-	return true;
+	return RC5DecryptBatch(encryptedData, target, 1, accessLevel);
 }
 
-// See https://en.wikipedia.org/wiki/RC5
-bool EncryptionHandler::_RC5PrepareKey(uint8_t* key, uint8_t keyLength) {
-	if (keyLength != RC5_KEYLEN) {
+bool EncryptionHandler::RC5DecryptBatch(const uint16_t* encryptedData, uint16_t* target, uint8_t numBlocks, EncryptionAccessLevel accessLevel) {
+	uint8_t index = _getRC5Index(accessLevel);
+	if (index == RC5_NUM_ACCESS_LEVELS || !(_rc5Initialized & (1 << index))) {
 		return false;
 	}
-	int keyLenWords = ((RC5_KEYLEN-1)/sizeof(uint16_t))+1; // c - The length of the key in words (or 1, if keyLength = 0).
-	int loops = 3 * (RC5_NUM_SUBKEYS > keyLenWords ? RC5_NUM_SUBKEYS : keyLenWords);
-	uint16_t L[keyLenWords] = {0}; // L[] - A temporary working array used during key scheduling. initialized to the key in words.
-
-	for (int i = 0; i<keyLenWords; ++i) {
-		L[i] = (key[2*i+1] << 8) + key[2*i];
-//		LOGd("L[i]=%u", L[i]);
-	}
-
-	_rc5SubKeys[0] = RC5_16BIT_P;
-	for (int i = 1; i < RC5_NUM_SUBKEYS; ++i) {
-		_rc5SubKeys[i] = _rc5SubKeys[i-1] + RC5_16BIT_Q;
-	}
-
-	uint16_t i = 0;
-	uint16_t j = 0;
-	uint16_t a = 0;
-	uint16_t b = 0;
-	uint16_t sum;
-	for (int k=0; k<loops; ++k) {
-//		LOGd("i=%u j=%u a=%u b=%u L[j]=%u key[i]=%u", i, j, a, b, L[j], _rc5SubKeys[i]);
-		sum = _rc5SubKeys[i] + a + b;
-		a = ROTL_16BIT(sum, 3);
-		_rc5SubKeys[i] = a;
-		sum = L[j] + a + b;
-		b = ROTL_16BIT(sum, (a+b) % 16);
-		L[j] = b;
-//		LOGd("  i=%u j=%u a=%u b=%u L[j]=%u key[i]=%u", i, j, a, b, L[j], _rc5SubKeys[i]);
-		++i;
-		++j;
-		i %= RC5_NUM_SUBKEYS;
-		j %= keyLenWords;
-	}
-//	LOGi("key=");
-//	BLEutil::printArray(key, keyLength);
-//	for (int i=0; i<RC5_NUM_SUBKEYS; ++i) {
-//		LOGi("RC5 key[%i] = %u", i, _rc5SubKeys[i]);
-//	}
+	_rc5[index].decrypt(encryptedData, target, numBlocks);
 	return true;
 }
 
+uint8_t EncryptionHandler::_getRC5Index(EncryptionAccessLevel accessLevel) {
+	switch (accessLevel) {
+		case ADMIN:        return 0;
+		case MEMBER:       return 1;
+		case BASIC:        return 2;
+		case SERVICE_DATA: return 3;
+		case LOCALIZATION: return 4;
+		default:           return RC5_NUM_ACCESS_LEVELS;
+	}
+}
+
 
 /**
  * This is where the magic happens. There are a few things that have to be done before this method is called:
@@ -6,9 +6,8 @@
  */
 
 #include "processing/cs_ExternalStates.h"
-#include "util/cs_BleError.h"
 #include "util/cs_Utils.h"
-//#include <cstring> // For calloc
+#include <cstring>
 
 /**
  * Interval at which the timeout counter is decreased.
@@ -28,13 +27,15 @@
 #error "EXTERNAL_STATE_TIMEOUT_MS / EXTERNAL_STATE_COUNT_INTERVAL_MS must fit in a uint16_t"
 #endif
 
+#if EXTERNAL_STATE_LIST_COUNT >= 0xFF
+#error "EXTERNAL_STATE_LIST_COUNT must be smaller than 255"
+#endif
+
 #define LOGExternalStatesDebug LOGnone
 
 void ExternalStates::init() {
-	_states = (cs_external_state_item_t*) calloc(EXTERNAL_STATE_LIST_COUNT, sizeof(cs_external_state_item_t));
-	if (_states == NULL) {
-		APP_ERROR_CHECK(ERR_NO_SPACE);
-	}
+	memset(_states, 0, sizeof(_states));
+	memset(_indexOfId, INDEX_NONE, sizeof(_indexOfId));
 }
 
 void ExternalStates::receivedState(state_external_stone_t* state) {
@@ -51,11 +52,12 @@ void ExternalStates::receivedState(state_external_stone_t* state) {
 	stone_id_t id = service_data_encrypted_get_id(&(state->data));
 
 	// Overwrite item with same id
-	for (int i=0; i<EXTERNAL_STATE_LIST_COUNT; ++i) {
-		if (_states[i].id == id) {
-			addToList(i, id, state);
-			return;
-		}
+	int index = _indexOfId[id];
+	if (index != INDEX_NONE) {
+		bool changed = _states[index].changed || isChanged(&(_states[index].state), state);
+		addToList(index, id, state);
+		_states[index].changed = changed;
+		return;
 	}
 
 	// Else, write at oldest item
@@ -67,36 +69,90 @@ void ExternalStates::receivedState(state_external_stone_t* state) {
 			oldestInd = i;
 		}
 	}
+	if (_states[oldestInd].timeoutCount) {
+		removeFromList(oldestInd);
+	}
 	addToList(oldestInd, id, state);
+	_states[oldestInd].broadcastWait = 0;
+	_states[oldestInd].changed = true;
 }
 
-void ExternalStates::removeFromList(stone_id_t id) {
-	for (int i=0; i<EXTERNAL_STATE_LIST_COUNT; ++i) {
-		if (_states[i].id == id) {
-			_states[i].timeoutCount = 0;
-			break;
-		}
+bool ExternalStates::isChanged(state_external_stone_t* stored, state_external_stone_t* state) {
+	// The stored state may have been converted to an external state, but the compared fields are at the same place.
+	bool storedIsError = (stored->data.type == SERVICE_DATA_TYPE_ERROR || stored->data.type == SERVICE_DATA_TYPE_EXT_ERROR);
+	bool isError = (state->data.type == SERVICE_DATA_TYPE_ERROR || state->data.type == SERVICE_DATA_TYPE_EXT_ERROR);
+	if (storedIsError != isError) {
+		return true;
 	}
+	if (isError) {
+		return stored->data.error.errors != state->data.error.errors;
+	}
+	return stored->data.state.switchState != state->data.state.switchState
+			|| stored->data.state.flags != state->data.state.flags;
+}
+
+void ExternalStates::removeFromList(int index) {
+	_indexOfId[_states[index].id] = INDEX_NONE;
+	_states[index].timeoutCount = 0;
 }
 
 void ExternalStates::addToList(int index, stone_id_t id, state_external_stone_t* state) {
 	_states[index].id = id;
 	_states[index].timeoutCount = EXTERNAL_STATE_TIMEOUT_COUNT_START;
 	memcpy(&(_states[index].state), state, sizeof(*state));
+	_indexOfId[id] = index;
 	LOGExternalStatesDebug("added id=%u to ind=%u", id, index);
 }
 
 service_data_encrypted_t* ExternalStates::getNextState() {
+	// Pick the state with the highest priority, starting at the broadcast index, so that ties are handled in turn.
+	int picked = -1;
+	uint16_t pickedPriority = 0;
 	for (int i = _broadcastIndex; i < _broadcastIndex + EXTERNAL_STATE_LIST_COUNT; ++i) {
 		int index = i % EXTERNAL_STATE_LIST_COUNT;
-		if (_states[index].timeoutCount != 0) {
-			_broadcastIndex = (index + 1) % EXTERNAL_STATE_LIST_COUNT;
-			LOGExternalStatesDebug("picked ind=%u id=%u timeout=%u", index, _states[index].id, _states[index].timeoutCount);
-			fixState(&(_states[index].state));
-			return &(_states[index].state.data);
+		if (_states[index].timeoutCount == 0) {
+			continue;
+		}
+		uint16_t priority = _states[index].broadcastWait + (_states[index].changed ? EXTERNAL_STATE_CHANGED_PRIORITY : 0);
+		if (picked == -1 || priority > pickedPriority) {
+			picked = index;
+			pickedPriority = priority;
 		}
 	}
-	return NULL;
+	if (picked == -1) {
+		return NULL;
+	}
+
+	for (int i = 0; i < EXTERNAL_STATE_LIST_COUNT; ++i) {
+		if (_states[i].timeoutCount != 0 && _states[i].broadcastWait < 0xFF) {
+			_states[i].broadcastWait++;
+		}
+	}
+	_states[picked].broadcastWait = 0;
+	_states[picked].changed = false;
+	_broadcastIndex = (picked + 1) % EXTERNAL_STATE_LIST_COUNT;
+
+	uint16_t staleness = EXTERNAL_STATE_TIMEOUT_COUNT_START - _states[picked].timeoutCount;
+	_stalenessSum += staleness;
+	_stalenessCount++;
+	LOGExternalStatesDebug("picked ind=%u id=%u timeout=%u staleness=%u", picked, _states[picked].id, _states[picked].timeoutCount, staleness);
+	fixState(&(_states[picked].state));
+	return &(_states[picked].state.data);
+}
+
+void ExternalStates::getStats(cs_result_t& result) {
+	cs_external_state_stats_t stats;
+	stats.averageStaleness = (_stalenessCount == 0) ? 0 : _stalenessSum / _stalenessCount;
+	stats.numBroadcasted = _stalenessCount;
+	if (result.buf.len < sizeof(stats)) {
+		result.returnCode = ERR_BUFFER_TOO_SMALL;
+		return;
+	}
+	memcpy(result.buf.data, &stats, sizeof(stats));
+	result.dataSize = sizeof(stats);
+	result.returnCode = ERR_SUCCESS;
+	_stalenessSum = 0;
+	_stalenessCount = 0;
 }
 
 /**
@@ -126,6 +182,9 @@ void ExternalStates::tick(TYPIFY(EVT_TICK) tickCount) {
 		for (int i=0; i<EXTERNAL_STATE_LIST_COUNT; ++i) {
 			if (_states[i].timeoutCount) {
 				_states[i].timeoutCount--;
+				if (_states[i].timeoutCount == 0) {
+					removeFromList(i);
+				}
 			}
 		}
 	}
@@ -0,0 +1,93 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <processing/cs_MeshStatePublisher.h>
+
+#include <cstdlib>
+
+#define MS_TO_TICK_COUNT(ms) ((ms) / TICK_INTERVAL_MS)
+
+#if MESH_SEND_STATE_INTERVAL_MAX_MS < MESH_SEND_STATE_INTERVAL_MS
+#error "MESH_SEND_STATE_INTERVAL_MAX_MS must not be smaller than MESH_SEND_STATE_INTERVAL_MS"
+#endif
+
+void MeshStatePublisher::init(const cs_mesh_state_sample_t& sample, uint32_t seed) {
+	_random = (seed == 0) ? 1 : seed;
+	_keepAliveIntervalMs = MESH_SEND_STATE_INTERVAL_MS;
+	onSent(sample);
+}
+
+MeshStatePublishType MeshStatePublisher::tick(const cs_mesh_state_sample_t& sample) {
+	_ticksSinceSent++;
+
+	if (_changeTicks == 0 && isSignificantChange(sample)) {
+		_changeTicks = _ticksSinceSent + MS_TO_TICK_COUNT(MESH_SEND_STATE_CHANGE_DELAY_MS);
+		if (_changeTicks < MS_TO_TICK_COUNT(MESH_SEND_STATE_MIN_INTERVAL_MS)) {
+			_changeTicks = MS_TO_TICK_COUNT(MESH_SEND_STATE_MIN_INTERVAL_MS);
+		}
+	}
+
+	if (_changeTicks != 0 && _ticksSinceSent >= _changeTicks) {
+		// Check again, as the change might have been undone in the meantime, like a short power peak.
+		if (isSignificantChange(sample)) {
+			_numChangeSends++;
+			_keepAliveIntervalMs = MESH_SEND_STATE_INTERVAL_MS;
+			onSent(sample);
+			return MESH_STATE_PUBLISH_CHANGE;
+		}
+		_changeTicks = 0;
+	}
+
+	if (_ticksSinceSent >= _keepAliveTicks) {
+		_numKeepAliveSends++;
+		_keepAliveIntervalMs *= 2;
+		if (_keepAliveIntervalMs > MESH_SEND_STATE_INTERVAL_MAX_MS) {
+			_keepAliveIntervalMs = MESH_SEND_STATE_INTERVAL_MAX_MS;
+		}
+		onSent(sample);
+		return MESH_STATE_PUBLISH_KEEP_ALIVE;
+	}
+	return MESH_STATE_PUBLISH_NONE;
+}
+
+bool MeshStatePublisher::isSignificantChange(const cs_mesh_state_sample_t& sample) {
+	if (sample.switchState != _lastSent.switchState
+			|| sample.flags != _lastSent.flags
+			|| sample.errors != _lastSent.errors) {
+		return true;
+	}
+	int32_t diff = abs(sample.powerUsageMilliWatt - _lastSent.powerUsageMilliWatt);
+	int32_t relativeThreshold = (int64_t)abs(_lastSent.powerUsageMilliWatt) * MESH_SEND_STATE_POWER_THRESHOLD_PERCENTAGE / 100;
+	return diff >= MESH_SEND_STATE_POWER_THRESHOLD_MW && diff >= relativeThreshold;
+}
+
+void MeshStatePublisher::onSent(const cs_mesh_state_sample_t& sample) {
+	_lastSent = sample;
+	_ticksSinceSent = 0;
+	_changeTicks = 0;
+	_keepAliveTicks = MS_TO_TICK_COUNT(_keepAliveIntervalMs + getRandomVariationMs());
+}
+
+uint32_t MeshStatePublisher::getRandomVariationMs() {
+	// Xorshift, so that stones that booted at the same time don't keep sending at the same time.
+	_random ^= _random << 13;
+	_random ^= _random >> 17;
+	_random ^= _random << 5;
+	return _random % (MESH_SEND_STATE_INTERVAL_MS_VARIATION + 1);
+}
+
+uint32_t MeshStatePublisher::getKeepAliveIntervalMs() {
+	return _keepAliveIntervalMs;
+}
+
+uint32_t MeshStatePublisher::getNumChangeSends() {
+	return _numChangeSends;
+}
+
+uint32_t MeshStatePublisher::getNumKeepAliveSends() {
+	return _numKeepAliveSends;
+}
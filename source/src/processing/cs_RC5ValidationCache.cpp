@@ -0,0 +1,58 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <processing/cs_RC5ValidationCache.h>
+
+#include <cstring>
+
+RC5ValidationCache::RC5ValidationCache() {
+	clear();
+}
+
+void RC5ValidationCache::clear() {
+	memset(_entries, 0, sizeof(_entries));
+	_next = 0;
+	_hits = 0;
+	_misses = 0;
+}
+
+uint8_t RC5ValidationCache::find(uint32_t encrypted) {
+	for (uint8_t i = 0; i < RC5_VALIDATION_CACHE_SIZE; ++i) {
+		if (_entries[i].used && _entries[i].encrypted == encrypted) {
+			return i;
+		}
+	}
+	return RC5_VALIDATION_CACHE_SIZE;
+}
+
+bool RC5ValidationCache::get(const uint16_t* encrypted, uint16_t timeWindow, uint16_t* decrypted, bool& valid) {
+	uint8_t index = find(toWord(encrypted));
+	if (index == RC5_VALIDATION_CACHE_SIZE || _entries[index].timeWindow != timeWindow) {
+		_misses++;
+		return false;
+	}
+	_hits++;
+	decrypted[0] = _entries[index].decrypted & 0xFFFF;
+	decrypted[1] = _entries[index].decrypted >> 16;
+	valid = _entries[index].valid;
+	return true;
+}
+
+void RC5ValidationCache::set(const uint16_t* encrypted, uint16_t timeWindow, const uint16_t* decrypted, bool valid) {
+	uint32_t key = toWord(encrypted);
+	uint8_t index = find(key);
+	if (index == RC5_VALIDATION_CACHE_SIZE) {
+		index = _next;
+		_next = (_next + 1) % RC5_VALIDATION_CACHE_SIZE;
+	}
+	entry_t& entry = _entries[index];
+	entry.encrypted = key;
+	entry.decrypted = toWord(decrypted);
+	entry.timeWindow = timeWindow;
+	entry.used = 1;
+	entry.valid = valid;
+}
@@ -0,0 +1,104 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <cfg/cs_Config.h>
+#include <processing/cs_ScanAggregator.h>
+
+#include <cstring>
+
+#define SCAN_BATCH_TIMEOUT_TICKS ((SCAN_BATCH_TIMEOUT_MS + TICK_INTERVAL_MS - 1) / TICK_INTERVAL_MS)
+
+ScanAggregator::ScanAggregator() {
+	memset(_records, 0, sizeof(_records));
+	memset(_rssiSum, 0, sizeof(_rssiSum));
+}
+
+void ScanAggregator::setCallback(callback_scan_batch_t callback) {
+	_callback = callback;
+}
+
+void ScanAggregator::setCollapseDuplicates(bool collapse) {
+	_collapseDuplicates = collapse;
+}
+
+cs_ret_code_t ScanAggregator::add(scanned_device_t* scannedDevice) {
+	if (scannedDevice->dataSize > ADVERTISEMENT_DATA_MAX_SIZE) {
+		return ERR_WRONG_PAYLOAD_LENGTH;
+	}
+
+	if (_collapseDuplicates) {
+		int16_t index = findDuplicate(scannedDevice);
+		if (index >= 0) {
+			scanned_device_record_t& record = _records[index];
+			_rssiSum[index] += scannedDevice->rssi;
+			if (scannedDevice->rssi > record.rssiMax) {
+				record.rssiMax = scannedDevice->rssi;
+			}
+			record.count++;
+			return ERR_SUCCESS;
+		}
+	}
+
+	if (_size == 0) {
+		_ticksLeft = SCAN_BATCH_TIMEOUT_TICKS;
+	}
+	scanned_device_record_t& record = _records[_size];
+	record.device = *scannedDevice;
+	memcpy(record.data, scannedDevice->data, scannedDevice->dataSize);
+	record.device.data = record.data;
+	record.rssiMax = scannedDevice->rssi;
+	record.count = 1;
+	_rssiSum[_size] = scannedDevice->rssi;
+	_size++;
+
+	if (_size == SCAN_BATCH_SIZE) {
+		flush();
+	}
+	return ERR_SUCCESS;
+}
+
+int16_t ScanAggregator::findDuplicate(scanned_device_t* scannedDevice) {
+	for (uint8_t i = 0; i < _size; ++i) {
+		scanned_device_t& device = _records[i].device;
+		if (device.dataSize == scannedDevice->dataSize
+				&& _records[i].count < 0xFF
+				&& memcmp(device.address, scannedDevice->address, MAC_ADDRESS_LEN) == 0
+				&& memcmp(device.data, scannedDevice->data, device.dataSize) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+void ScanAggregator::flush() {
+	if (_size == 0) {
+		return;
+	}
+	for (uint8_t i = 0; i < _size; ++i) {
+		if (_records[i].count > 1) {
+			_records[i].device.rssi = _rssiSum[i] / _records[i].count;
+		}
+	}
+	scanned_device_batch_t batch;
+	batch.size = _size;
+	batch.records = _records;
+	if (_callback != nullptr) {
+		_callback(batch);
+	}
+	_size = 0;
+}
+
+void ScanAggregator::tick() {
+	if (_size == 0) {
+		return;
+	}
+	if (_ticksLeft > 1) {
+		_ticksLeft--;
+		return;
+	}
+	flush();
+}
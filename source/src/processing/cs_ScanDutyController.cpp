@@ -0,0 +1,104 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <processing/cs_ScanDutyController.h>
+
+#include <cstring>
+
+#if SCAN_DUTY_MIN_PERCENT < 1 || SCAN_DUTY_MIN_PERCENT > SCAN_DUTY_MAX_PERCENT || SCAN_DUTY_MAX_PERCENT > 99
+#error "Invalid scan duty bounds"
+#endif
+
+ScanDutyController::ScanDutyController() {
+}
+
+cs_ret_code_t ScanDutyController::setBounds(uint8_t minPercent, uint8_t maxPercent) {
+	if (minPercent < 1 || minPercent > maxPercent || maxPercent > 99) {
+		return ERR_WRONG_PARAMETER;
+	}
+	_minPercent = minPercent;
+	_maxPercent = maxPercent;
+	if (_dutyPercent < _minPercent) {
+		_dutyPercent = _minPercent;
+	}
+	if (_dutyPercent > _maxPercent) {
+		_dutyPercent = _maxPercent;
+	}
+	return ERR_SUCCESS;
+}
+
+void ScanDutyController::addHit() {
+	if (_hitsThisSecond < 0xFFFF) {
+		_hitsThisSecond++;
+	}
+	_totalHits++;
+}
+
+void ScanDutyController::addCommandHit() {
+	addHit();
+	_boostSeconds = SCAN_DUTY_COMMAND_BOOST_SECONDS;
+}
+
+void ScanDutyController::tickSecond() {
+	if (_boostSeconds) {
+		_boostSeconds--;
+	}
+	_hitRateCenti = (_hitRateCenti * (SCAN_DUTY_HIT_RATE_FACTOR - 1) + _hitsThisSecond * 100 + SCAN_DUTY_HIT_RATE_FACTOR / 2) / SCAN_DUTY_HIT_RATE_FACTOR;
+
+	if (_hitsThisSecond) {
+		_hitsThisSecond = 0;
+		_secondsSinceHit = 0;
+		uint16_t duty = _dutyPercent + SCAN_DUTY_RISE_PERCENT;
+		_dutyPercent = (duty > _maxPercent) ? _maxPercent : duty;
+		return;
+	}
+
+	if (_secondsSinceHit < SCAN_DUTY_HOLD_SECONDS) {
+		_secondsSinceHit++;
+		return;
+	}
+	_dutyPercent = _minPercent + (_dutyPercent - _minPercent) * (SCAN_DUTY_DECAY_FACTOR - 1) / SCAN_DUTY_DECAY_FACTOR;
+}
+
+uint8_t ScanDutyController::getDutyPercent() {
+	return _boostSeconds ? _maxPercent : _dutyPercent;
+}
+
+uint16_t ScanDutyController::getHitsPerSecondCenti() {
+	return (_hitRateCenti > 0xFFFF) ? 0xFFFF : _hitRateCenti;
+}
+
+uint16_t ScanDutyController::getScanDuration(uint32_t periodMs) {
+	return clampDuration(periodMs * getDutyPercent() / 100);
+}
+
+uint16_t ScanDutyController::getScanBreakDuration(uint32_t periodMs) {
+	return clampDuration(periodMs - periodMs * getDutyPercent() / 100);
+}
+
+uint16_t ScanDutyController::clampDuration(uint32_t durationMs) {
+	if (durationMs < SCAN_DUTY_MIN_PHASE_MS) {
+		return SCAN_DUTY_MIN_PHASE_MS;
+	}
+	return (durationMs > 0xFFFF) ? 0xFFFF : durationMs;
+}
+
+void ScanDutyController::getStats(cs_result_t& result) {
+	cs_scan_duty_stats_t stats;
+	stats.dutyPercent = getDutyPercent();
+	stats.minPercent = _minPercent;
+	stats.maxPercent = _maxPercent;
+	stats.hitsPerSecondCenti = getHitsPerSecondCenti();
+	stats.totalHits = _totalHits;
+	if (result.buf.len < sizeof(stats)) {
+		result.returnCode = ERR_BUFFER_TOO_SMALL;
+		return;
+	}
+	memcpy(result.buf.data, &stats, sizeof(stats));
+	result.dataSize = sizeof(stats);
+	result.returnCode = ERR_SUCCESS;
+}
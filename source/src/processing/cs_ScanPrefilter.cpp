@@ -0,0 +1,128 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <processing/cs_ScanPrefilter.h>
+#include <util/cs_Utils.h>
+
+#include <cstring>
+
+ScanPrefilter::ScanPrefilter() {
+	memset(_bloom, 0, sizeof(_bloom));
+	memset(&_stats, 0, sizeof(_stats));
+}
+
+cs_ret_code_t ScanPrefilter::addRule(const scan_prefilter_rule_t& rule) {
+	if (rule.patternLen > SCAN_PREFILTER_PATTERN_SIZE) {
+		return ERR_WRONG_PARAMETER;
+	}
+	if (_numRules >= SCAN_PREFILTER_MAX_RULES) {
+		return ERR_NO_SPACE;
+	}
+	_rules[_numRules++] = rule;
+	return ERR_SUCCESS;
+}
+
+void ScanPrefilter::setEnabled(bool enable) {
+	_enabled = enable;
+}
+
+bool ScanPrefilter::accept(scanned_device_t* scannedDevice) {
+	if (!_enabled) {
+		_stats.accepted++;
+		return true;
+	}
+	for (uint8_t i = 0; i < _numRules; ++i) {
+		if (matches(_rules[i], scannedDevice)) {
+			_stats.accepted++;
+			return true;
+		}
+	}
+	if (isAddressAccepted(scannedDevice->address)) {
+		_stats.accepted++;
+		_stats.acceptedByAddress++;
+		return true;
+	}
+	_stats.rejected++;
+	return false;
+}
+
+bool ScanPrefilter::matches(const scan_prefilter_rule_t& rule, scanned_device_t* scannedDevice) {
+	cs_data_t data;
+	if (BLEutil::findAdvType(rule.adType, scannedDevice, &data) != ERR_SUCCESS) {
+		return false;
+	}
+	if (rule.companyId != SCAN_PREFILTER_COMPANY_ID_ANY) {
+		if (data.len < sizeof(uint16_t)) {
+			return false;
+		}
+		uint16_t companyId = data.data[0] | (data.data[1] << 8);
+		if (companyId != rule.companyId) {
+			return false;
+		}
+	}
+	if (data.len < rule.patternOffset + rule.patternLen) {
+		return false;
+	}
+	for (uint8_t i = 0; i < rule.patternLen; ++i) {
+		if ((data.data[rule.patternOffset + i] & rule.mask[i]) != (rule.pattern[i] & rule.mask[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+uint16_t ScanPrefilter::getBloomIndex(const uint8_t* address, uint8_t hashIndex) {
+	// Double hashing: the second hash is made odd, so that it never is 0.
+	uint16_t hash1 = BLEutil::calcHash(address, MAC_ADDRESS_LEN);
+	uint16_t hash2 = ((address[0] << 8) | address[MAC_ADDRESS_LEN - 1]) | 1;
+	return (uint16_t)(hash1 + hashIndex * hash2) % (SCAN_PREFILTER_BLOOM_SIZE * 8);
+}
+
+void ScanPrefilter::addAddress(ScanPrefilterAddressSource source, const uint8_t* address) {
+	for (uint8_t i = 0; i < SCAN_PREFILTER_BLOOM_HASHES; ++i) {
+		uint16_t bit = getBloomIndex(address, i);
+		_bloom[source][bit / 8] |= (1 << (bit % 8));
+	}
+}
+
+void ScanPrefilter::clearAddresses(ScanPrefilterAddressSource source) {
+	memset(_bloom[source], 0, sizeof(_bloom[source]));
+}
+
+bool ScanPrefilter::isAddressAccepted(const uint8_t* address) {
+	uint16_t bits[SCAN_PREFILTER_BLOOM_HASHES];
+	for (uint8_t i = 0; i < SCAN_PREFILTER_BLOOM_HASHES; ++i) {
+		bits[i] = getBloomIndex(address, i);
+	}
+	for (uint8_t source = 0; source < SCAN_PREFILTER_SOURCE_COUNT; ++source) {
+		bool found = true;
+		for (uint8_t i = 0; i < SCAN_PREFILTER_BLOOM_HASHES; ++i) {
+			if ((_bloom[source][bits[i] / 8] & (1 << (bits[i] % 8))) == 0) {
+				found = false;
+				break;
+			}
+		}
+		if (found) {
+			return true;
+		}
+	}
+	return false;
+}
+
+cs_scan_prefilter_stats_t& ScanPrefilter::getStats() {
+	return _stats;
+}
+
+void ScanPrefilter::getStats(cs_result_t& result) {
+	if (result.buf.len < sizeof(_stats)) {
+		result.returnCode = ERR_BUFFER_TOO_SMALL;
+		return;
+	}
+	memcpy(result.buf.data, &_stats, sizeof(_stats));
+	result.dataSize = sizeof(_stats);
+	result.returnCode = ERR_SUCCESS;
+}
@@ -5,6 +5,8 @@
  * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
  */
 #include "processing/cs_Scanner.h"
+#include <processing/cs_ScanAggregator.h>
+#include <processing/cs_ScanPrefilter.h>
 
 #include <storage/cs_State.h>
 #include <cfg/cs_DeviceTypes.h>
@@ -35,6 +37,12 @@ void Scanner::init() {
 
 	EventDispatcher::getInstance().addListener(this);
 	Timer::getInstance().createSingleShot(_appTimerId, (app_timer_timeout_handler_t)Scanner::staticTick);
+	ScanAggregator::getInstance().setCallback(Scanner::onScanBatch);
+}
+
+void Scanner::onScanBatch(scanned_device_batch_t& batch) {
+	event_t event(CS_TYPE::EVT_DEVICE_SCANNED_BATCH, &batch, sizeof(batch));
+	event.dispatch();
 }
 
 void Scanner::setStack(Stack* stack) {
@@ -144,8 +152,9 @@ void Scanner::executeScan() {
 		// start scanning
 		manualStartScan();
 
-		// set timer to trigger in SCAN_DURATION sec, then stop again
-		Timer::getInstance().start(_appTimerId, MS_TO_TICKS(_scanDuration), this);
+		// set timer to trigger after the scan duration, then stop again
+		// The configured scan and break duration only set the period, the duty controller decides how much of it is spent scanning.
+		Timer::getInstance().start(_appTimerId, MS_TO_TICKS(_dutyController.getScanDuration(_scanDuration + _scanBreakDuration)), this);
 
 		_opCode = SCAN_STOP;
 		break;
@@ -160,7 +169,7 @@ void Scanner::executeScan() {
 #endif
 
 		// Wait SCAN_SEND_WAIT ms before sending the results, so that it can listen to the mesh before sending
-		Timer::getInstance().start(_appTimerId, MS_TO_TICKS(_scanBreakDuration), this);
+		Timer::getInstance().start(_appTimerId, MS_TO_TICKS(_dutyController.getScanBreakDuration(_scanDuration + _scanBreakDuration)), this);
 
 		_opCode = SCAN_START;
 		break;
@@ -169,6 +178,10 @@ void Scanner::executeScan() {
 
 }
 
+void Scanner::addCommandHit() {
+	_dutyController.addCommandHit();
+}
+
 void Scanner::handleEvent(event_t & event) {
 	switch (event.type) {
 		case CS_TYPE::CONFIG_SCAN_DURATION: {
@@ -179,6 +192,29 @@ void Scanner::handleEvent(event_t & event) {
 			_scanBreakDuration = *(TYPIFY(CONFIG_SCAN_BREAK_DURATION)*)event.data;
 			break;
 		}
+		case CS_TYPE::EVT_TICK: {
+			ScanAggregator::getInstance().tick();
+			if (*(TYPIFY(EVT_TICK)*)event.data % (1000 / TICK_INTERVAL_MS) == 0) {
+				_dutyController.tickSecond();
+			}
+			break;
+		}
+		case CS_TYPE::EVT_ADV_BACKGROUND_PARSED:
+		case CS_TYPE::EVT_ADV_BACKGROUND_PARSED_V1: {
+			// Background advertisements of tracked devices and tap to toggle.
+			// Command advertisements are counted via addCommandHit(). The background payload of a command advertisement is counted
+			// again here, which only raises the hit rate: the duty rises per second with hits, not per hit.
+			_dutyController.addHit();
+			break;
+		}
+		case CS_TYPE::CMD_GET_SCAN_PREFILTER_STATS: {
+			ScanPrefilter::getInstance().getStats(event.result);
+			break;
+		}
+		case CS_TYPE::CMD_GET_SCAN_DUTY_STATS: {
+			_dutyController.getStats(event.result);
+			break;
+		}
 		default:
 			// no other types should be handled
 			break;
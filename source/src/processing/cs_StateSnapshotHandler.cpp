@@ -0,0 +1,248 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <cfg/cs_Config.h>
+#include <drivers/cs_Serial.h>
+#include <processing/cs_EncryptionHandler.h>
+#include <processing/cs_StateSnapshotHandler.h>
+#include <storage/cs_State.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#define LOGStateSnapshotDebug LOGnone
+
+void StateSnapshotHandler::clear() {
+	free(_exportBuf);
+	_exportBuf = nullptr;
+	_exportSize = 0;
+	free(_importBuf);
+	_importBuf = nullptr;
+	_importSize = 0;
+	_importReceived = 0;
+}
+
+bool StateSnapshotHandler::isSnapshotType(CS_TYPE type, const EncryptionAccessLevel accessLevel) {
+	if (type == CS_TYPE::CONFIG_DO_NOT_USE) {
+		return false;
+	}
+	switch (DefaultLocation(type)) {
+		case PersistenceMode::FLASH:
+		case PersistenceMode::FLASH_CACHED:
+			break;
+		default:
+			return false;
+	}
+	EncryptionHandler& encryptionHandler = EncryptionHandler::getInstance();
+	return encryptionHandler.allowAccess(getUserAccessLevelGet(type), accessLevel)
+			&& encryptionHandler.allowAccess(getUserAccessLevelSet(type), accessLevel);
+}
+
+void StateSnapshotHandler::handleGet(cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t & result) {
+	if (commandData.len != sizeof(state_snapshot_get_packet_t)) {
+		LOGe(FMT_WRONG_PAYLOAD_LENGTH, commandData.len);
+		result.returnCode = ERR_WRONG_PAYLOAD_LENGTH;
+		return;
+	}
+	state_snapshot_get_packet_t* packet = (state_snapshot_get_packet_t*) commandData.data;
+	if (packet->offset == 0) {
+		result.returnCode = createExport(accessLevel);
+		if (FAILURE(result.returnCode)) {
+			return;
+		}
+	}
+	if (_exportBuf == nullptr || packet->offset >= _exportSize) {
+		result.returnCode = ERR_WRONG_STATE;
+		return;
+	}
+	if (result.buf.len <= sizeof(state_snapshot_chunk_header_t)) {
+		result.returnCode = ERR_BUFFER_TOO_SMALL;
+		return;
+	}
+	cs_buffer_size_t chunkSize = std::min<cs_buffer_size_t>(_exportSize - packet->offset, result.buf.len - sizeof(state_snapshot_chunk_header_t));
+	state_snapshot_chunk_header_t* chunkHeader = (state_snapshot_chunk_header_t*) result.buf.data;
+	chunkHeader->offset = packet->offset;
+	chunkHeader->totalSize = _exportSize;
+	memcpy(result.buf.data + sizeof(state_snapshot_chunk_header_t), _exportBuf + packet->offset, chunkSize);
+	result.dataSize = sizeof(state_snapshot_chunk_header_t) + chunkSize;
+	result.returnCode = ERR_SUCCESS;
+	LOGStateSnapshotDebug("Export chunk offset=%u size=%u total=%u", packet->offset, chunkSize, _exportSize);
+
+	if (packet->offset + chunkSize == _exportSize) {
+		// Last chunk has been read.
+		free(_exportBuf);
+		_exportBuf = nullptr;
+		_exportSize = 0;
+	}
+}
+
+cs_ret_code_t StateSnapshotHandler::createExport(const EncryptionAccessLevel accessLevel) {
+	free(_exportBuf);
+	_exportSize = 0;
+	_exportBuf = (buffer_ptr_t) malloc(STATE_SNAPSHOT_MAX_SIZE);
+	if (_exportBuf == nullptr) {
+		return ERR_NO_SPACE;
+	}
+	StateSnapshotWriter writer(_exportBuf, STATE_SNAPSHOT_MAX_SIZE);
+	cs_ret_code_t retCode = ERR_SUCCESS;
+	for (uint16_t rawType = 1; rawType < InternalBase; ++rawType) {
+		CS_TYPE type = toCsType(rawType);
+		if (!isSnapshotType(type, accessLevel)) {
+			continue;
+		}
+		retCode = addToExport(writer, type);
+		if (FAILURE(retCode)) {
+			break;
+		}
+	}
+	if (SUCCESS(retCode)) {
+		retCode = writer.finalize();
+	}
+	if (FAILURE(retCode)) {
+		LOGw("Failed to create snapshot: %u", retCode);
+		free(_exportBuf);
+		_exportBuf = nullptr;
+		return retCode;
+	}
+	_exportSize = writer.getSize();
+	LOGi("Created state snapshot of %u bytes", _exportSize);
+	return ERR_SUCCESS;
+}
+
+cs_ret_code_t StateSnapshotHandler::addToExport(StateSnapshotWriter & writer, CS_TYPE type) {
+	std::vector<cs_state_id_t> singleId = {0};
+	std::vector<cs_state_id_t>* ids = &singleId;
+	if (hasMultipleIds(type)) {
+		cs_ret_code_t retCode = State::getInstance().getIds(type, ids);
+		if (FAILURE(retCode)) {
+			return retCode;
+		}
+	}
+	size16_t typeSize = TypeSize(type);
+	buffer_ptr_t value = (buffer_ptr_t) malloc(typeSize);
+	if (value == nullptr) {
+		return ERR_NO_SPACE;
+	}
+	cs_ret_code_t retCode = ERR_SUCCESS;
+	for (auto id: *ids) {
+		cs_state_data_t stateData(type, id, value, typeSize);
+		retCode = State::getInstance().get(stateData, PersistenceMode::STRATEGY1);
+		if (FAILURE(retCode)) {
+			break;
+		}
+		retCode = writer.add(to_underlying_type(type), id, stateData.value, stateData.size);
+		if (FAILURE(retCode)) {
+			break;
+		}
+	}
+	free(value);
+	return retCode;
+}
+
+void StateSnapshotHandler::handleSet(cs_data_t commandData, const EncryptionAccessLevel accessLevel, cs_result_t & result) {
+	if (commandData.len < sizeof(state_snapshot_chunk_header_t)) {
+		LOGe(FMT_WRONG_PAYLOAD_LENGTH, commandData.len);
+		result.returnCode = ERR_WRONG_PAYLOAD_LENGTH;
+		return;
+	}
+	state_snapshot_chunk_header_t* chunkHeader = (state_snapshot_chunk_header_t*) commandData.data;
+	cs_buffer_size_t chunkSize = commandData.len - sizeof(state_snapshot_chunk_header_t);
+	buffer_ptr_t chunk = commandData.data + sizeof(state_snapshot_chunk_header_t);
+
+	if (chunkHeader->offset == 0) {
+		free(_importBuf);
+		_importBuf = nullptr;
+		_importReceived = 0;
+		_importSize = 0;
+		if (chunkHeader->totalSize > STATE_SNAPSHOT_MAX_SIZE) {
+			result.returnCode = ERR_NO_SPACE;
+			return;
+		}
+		_importBuf = (buffer_ptr_t) malloc(chunkHeader->totalSize);
+		if (_importBuf == nullptr) {
+			result.returnCode = ERR_NO_SPACE;
+			return;
+		}
+		_importSize = chunkHeader->totalSize;
+	}
+
+	// Chunks have to be sent in order.
+	if (_importBuf == nullptr || chunkHeader->offset != _importReceived || chunkHeader->totalSize != _importSize) {
+		LOGw("Unexpected chunk offset=%u total=%u", chunkHeader->offset, chunkHeader->totalSize);
+		result.returnCode = ERR_WRONG_STATE;
+		return;
+	}
+	if ((uint32_t)_importReceived + chunkSize > _importSize) {
+		result.returnCode = ERR_WRONG_PAYLOAD_LENGTH;
+		return;
+	}
+	memcpy(_importBuf + _importReceived, chunk, chunkSize);
+	_importReceived += chunkSize;
+	LOGStateSnapshotDebug("Import chunk offset=%u size=%u total=%u", chunkHeader->offset, chunkSize, _importSize);
+
+	if (_importReceived < _importSize) {
+		result.returnCode = ERR_WAIT_FOR_SUCCESS;
+		return;
+	}
+
+	result.returnCode = applyImport(accessLevel);
+	free(_importBuf);
+	_importBuf = nullptr;
+	_importSize = 0;
+	_importReceived = 0;
+}
+
+cs_ret_code_t StateSnapshotHandler::applyImport(const EncryptionAccessLevel accessLevel) {
+	StateSnapshotReader reader(_importBuf, _importSize);
+	cs_ret_code_t retCode = reader.validate();
+	if (FAILURE(retCode)) {
+		LOGw("Invalid snapshot: %u", retCode);
+		return retCode;
+	}
+
+	// First check all entries, so that nothing is set when one of them is invalid.
+	state_snapshot_entry_t entry;
+	while (reader.getNext(entry) == ERR_SUCCESS) {
+		CS_TYPE type = toCsType(entry.type);
+		if (type == CS_TYPE::CONFIG_DO_NOT_USE) {
+			LOGw("Unknown type %u", entry.type);
+			return ERR_UNKNOWN_TYPE;
+		}
+		if (!isSnapshotType(type, accessLevel)) {
+			LOGw("Type %u not allowed", entry.type);
+			return ERR_NO_ACCESS;
+		}
+		if (entry.id > 0xFF || (entry.id != 0 && !hasMultipleIds(type))) {
+			return ERR_WRONG_PARAMETER;
+		}
+		cs_state_data_t stateData(type, entry.id, entry.value, entry.size);
+		retCode = State::getInstance().verifySizeForSet(stateData);
+		if (FAILURE(retCode)) {
+			LOGw("Wrong size for type %u", entry.type);
+			return retCode;
+		}
+	}
+
+	// All entries are valid: set them in RAM now, and write them to flash together later.
+	reader.rewind();
+	while (reader.getNext(entry) == ERR_SUCCESS) {
+		cs_state_data_t stateData(toCsType(entry.type), entry.id, entry.value, entry.size);
+		retCode = State::getInstance().setDelayed(stateData, STATE_SNAPSHOT_COMMIT_DELAY_SECONDS);
+		switch (retCode) {
+			case ERR_SUCCESS:
+			case ERR_SUCCESS_NO_CHANGE:
+				break;
+			default:
+				LOGe("Failed to set type %u: %u", entry.type, retCode);
+				return retCode;
+		}
+	}
+	LOGi("Imported state snapshot of %u values", reader.getNumEntries());
+	return ERR_SUCCESS;
+}
@@ -10,6 +10,7 @@
 #include "drivers/cs_RTC.h"
 #include "drivers/cs_Serial.h"
 #include "processing/cs_CommandHandler.h"
+#include "processing/cs_ScanPrefilter.h"
 #include "util/cs_Utils.h"
 #include "storage/cs_State.h"
 
@@ -43,24 +44,11 @@ void TapToToggle::handleBackgroundAdvertisement(adv_background_parsed_t* adv) {
 		LOGT2Td("t2t flag not set");
 		return;
 	}
-	// Use index of entry with matching address, or else with lowest score.
-	uint8_t index = -1; // Index to use
-	bool foundAddress = false;
-	uint8_t lowestScore = 255;
-	for (uint8_t i=0; i<T2T_LIST_COUNT; ++i) {
-		if (memcmp(list[i].address, adv->macAddress, BLE_GAP_ADDR_LEN) == 0) {
-			index = i;
-			foundAddress = true;
-			break;
-		}
-		if (list[i].score < lowestScore) {
-			lowestScore = list[i].score;
-			index = i;
-		}
-	}
-	if (!foundAddress) {
-		memcpy(list[index].address, adv->macAddress, BLE_GAP_ADDR_LEN);
-		list[index].score = 0;
+	// Use slot of entry with matching address, or else a new entry.
+	bool added;
+	uint8_t index = table.getOrAdd(adv->macAddress, tickCount, added);
+	if (added) {
+		updateScanPrefilter();
 	}
 
 	// By placing this check here, the score will drop, which will make it more likely to trigger again when phone is kept close.
@@ -69,14 +57,11 @@ void TapToToggle::handleBackgroundAdvertisement(adv_background_parsed_t* adv) {
 		return;
 	}
 
-	uint8_t prevScore = list[index].score;
-	list[index].score += scoreIncrement;
-	if (list[index].score > scoreMax) {
-		list[index].score = scoreMax;
-	}
+	uint16_t prevScore = table.increaseScore(index, scoreIncrement, scoreMax, tickCount);
+	uint16_t score = table.getScore(index, tickCount);
 
-	LOGT2Td("rssi=%i ind=%u prevScore=%u score=%u", adv->adjustedRssi, index, prevScore, list[index].score);
-	if (prevScore <= scoreThreshold && list[index].score > scoreThreshold) {
+	LOGT2Td("rssi=%i ind=%u prevScore=%u score=%u", adv->adjustedRssi, index, prevScore, score);
+	if (prevScore <= scoreThreshold && score > scoreThreshold) {
 		LOGi("Tap to toggle triggered");
 		timeoutCounter = timeoutTicks;
 		event_t event(CS_TYPE::CMD_SWITCH_TOGGLE, nullptr, 0, cmd_source_t(CS_CMD_SOURCE_TAP_TO_TOGLE));
@@ -84,16 +69,20 @@ void TapToToggle::handleBackgroundAdvertisement(adv_background_parsed_t* adv) {
 	}
 }
 
-void TapToToggle::tick() {
-	for (uint8_t i=0; i<T2T_LIST_COUNT; ++i) {
-		if (list[i].score) {
-			list[i].score--;
+void TapToToggle::updateScanPrefilter() {
+	ScanPrefilter::getInstance().clearAddresses(SCAN_PREFILTER_SOURCE_TAP_TO_TOGGLE);
+	for (uint8_t i=0; i<T2T_TABLE_CAPACITY; ++i) {
+		if (table.isInUse(i)) {
+			ScanPrefilter::getInstance().addAddress(SCAN_PREFILTER_SOURCE_TAP_TO_TOGGLE, table.getAddress(i));
 		}
 	}
+}
+
+void TapToToggle::tick() {
+	tickCount++;
 	if (timeoutCounter) {
 		timeoutCounter--;
 	}
-	LOGT2Tv("scores=%u %u %u", list[0].score, list[1].score, list[2].score)
 }
 
 void TapToToggle::handleEvent(event_t & event) {
@@ -67,6 +67,12 @@ bool isValidMeshPayload(cs_mesh_model_msg_type_t type, uint8_t* payload, size16_
 			return payloadSize >= sizeof(cs_mesh_model_msg_result_header_t);
 		case CS_MESH_MODEL_TYPE_SET_IBEACON_CONFIG_ID:
 			return payloadSize >= sizeof(set_ibeacon_config_id_packet_t);
+		case CS_MESH_MODEL_TYPE_AGGREGATE:
+			return aggregateIsValid(payload, payloadSize);
+		case CS_MESH_MODEL_TYPE_BULK_ACK_REQUEST:
+			return payloadSize == sizeof(cs_mesh_model_msg_bulk_ack_request_t);
+		case CS_MESH_MODEL_TYPE_BULK_CHUNK:
+			return payloadSize > sizeof(cs_mesh_model_msg_bulk_chunk_header_t);
 		case CS_MESH_MODEL_TYPE_UNKNOWN:
 			return false;
 	}
@@ -110,6 +116,55 @@ bool setBehaviourSettingsIsValid(const behaviour_settings_t* packet, size16_t si
 	return size == sizeof(behaviour_settings_t);
 }
 
+bool aggregateIsValid(uint8_t* packet, size16_t size) {
+	size16_t offset = 0;
+	size16_t numEntries = 0;
+	cs_mesh_model_msg_type_t type;
+	uint8_t* entryPayload;
+	size16_t entrySize;
+	while (getNextAggregateEntry(packet, size, offset, type, entryPayload, entrySize)) {
+		if (type == CS_MESH_MODEL_TYPE_AGGREGATE || !isValidMeshPayload(type, entryPayload, entrySize)) {
+			return false;
+		}
+		numEntries++;
+	}
+	// All entries should exactly fill up the payload.
+	return numEntries > 0 && offset == size;
+}
+
+bool getNextAggregateEntry(uint8_t* payload, size16_t payloadSize, size16_t& offset, cs_mesh_model_msg_type_t& type, uint8_t*& entryPayload, size16_t& entrySize) {
+	if (offset + sizeof(cs_mesh_model_msg_aggregate_entry_header_t) > payloadSize) {
+		return false;
+	}
+	cs_mesh_model_msg_aggregate_entry_header_t* header = (cs_mesh_model_msg_aggregate_entry_header_t*)(payload + offset);
+	size16_t nextOffset = offset + sizeof(*header) + header->size;
+	if (nextOffset > payloadSize) {
+		return false;
+	}
+	type = (cs_mesh_model_msg_type_t)header->type;
+	entryPayload = payload + offset + sizeof(*header);
+	entrySize = header->size;
+	offset = nextOffset;
+	return true;
+}
+
+bool addAggregateEntry(cs_mesh_model_msg_type_t type, const uint8_t* entryPayload, size16_t entrySize, uint8_t* payload, size16_t payloadSize, size16_t& offset) {
+	if (type >= (1 << 5) || entrySize >= (1 << 3)) {
+		return false;
+	}
+	if (offset + sizeof(cs_mesh_model_msg_aggregate_entry_header_t) + entrySize > payloadSize) {
+		return false;
+	}
+	cs_mesh_model_msg_aggregate_entry_header_t* header = (cs_mesh_model_msg_aggregate_entry_header_t*)(payload + offset);
+	header->type = type;
+	header->size = entrySize;
+	if (entrySize) {
+		memcpy(payload + offset + sizeof(*header), entryPayload, entrySize);
+	}
+	offset += sizeof(*header) + entrySize;
+	return true;
+}
+
 cs_mesh_model_msg_type_t getType(const uint8_t* meshMsg) {
 	return (cs_mesh_model_msg_type_t)meshMsg[0];
 }
@@ -12,10 +12,12 @@
 #include <ble/cs_UUID.h>
 #include <cfg/cs_Config.h>
 #include <common/cs_Types.h>
+#include <drivers/cs_RTC.h>
 #include <drivers/cs_Serial.h>
 #include <drivers/cs_Storage.h>
 #include <events/cs_EventDispatcher.h>
 #include <storage/cs_State.h>
+#include <util/cs_BootProfiler.h>
 #include <util/cs_Error.h>
 #include <util/cs_Utils.h>
 
@@ -36,7 +38,7 @@ void storageErrorCallback(cs_storage_operation_t operation, CS_TYPE type, cs_sta
 	State::getInstance().handleStorageError(operation, type, id);
 }
 
-State::State() : _storage(NULL), _boardsConfig(NULL) {
+State::State() : _storage(NULL), _boardsConfig(NULL), _cache(STATE_CACHE_MAX_SIZE) {
 }
 
 State::~State() {
@@ -113,6 +115,18 @@ cs_ret_code_t State::remove(const CS_TYPE & type, cs_state_id_t id, const Persis
 	// 31-10-2019 TODO: send event?
 }
 
+cs_ret_code_t State::subscribe(CS_TYPE type, StateSubscriber* subscriber) {
+	cs_ret_code_t retCode = _subscriptions.subscribe(type, subscriber);
+	if (FAILURE(retCode)) {
+		LOGe("Failed to subscribe to type=%u err=%u", to_underlying_type(type), retCode);
+	}
+	return retCode;
+}
+
+cs_ret_code_t State::unsubscribe(CS_TYPE type, StateSubscriber* subscriber) {
+	return _subscriptions.unsubscribe(type, subscriber);
+}
+
 cs_ret_code_t State::get(cs_state_data_t & data, const PersistenceMode mode) {
 	ret_code_t ret_code = ERR_NOT_FOUND;
 	CS_TYPE type = data.type;
@@ -134,6 +148,7 @@ cs_ret_code_t State::get(cs_state_data_t & data, const PersistenceMode mode) {
 
 	switch(mode) {
 		case PersistenceMode::NEITHER_RAM_NOR_FLASH:
+		case PersistenceMode::FLASH_CACHED:
 			return ERR_NOT_AVAILABLE;
 		case PersistenceMode::FIRMWARE_DEFAULT:
 			return getDefaultValue(data);
@@ -147,8 +162,15 @@ cs_ret_code_t State::get(cs_state_data_t & data, const PersistenceMode mode) {
 			ret_code = loadFromRam(data);
 			if (ret_code == ERR_SUCCESS) {
 //				LOGStateDebug("Loaded from RAM: %s", TypeName(data.type));
+				if (DefaultLocation(type) == PersistenceMode::FLASH_CACHED) {
+					_cache.touch(type, id, data.size);
+					_cache.addHit();
+				}
 				return ERR_SUCCESS;
 			}
+			if (DefaultLocation(type) == PersistenceMode::FLASH_CACHED) {
+				return loadFromFlashCached(data);
+			}
 			// Else we're going to add a new type to the ram data.
 			cs_state_data_t & ram_data = addToRam(type, id, typeSize);
 
@@ -161,6 +183,7 @@ cs_ret_code_t State::get(cs_state_data_t & data, const PersistenceMode mode) {
 				}
 			}
 			else {
+				uint32_t readStartTicks = RTC::getCount();
 				ret_code = _storage->read(ram_data);
 
 				// Temp code, to retain old reset counter.
@@ -168,6 +191,7 @@ cs_ret_code_t State::get(cs_state_data_t & data, const PersistenceMode mode) {
 					LOGi("Load old reset counter");
 					ret_code = _storage->readV3ResetCounter(ram_data);
 				}
+				BootProfiler::getInstance().addStateRead(type, RTC::difference(RTC::getCount(), readStartTicks));
 
 				switch(ret_code) {
 					case ERR_SUCCESS: {
@@ -222,6 +246,7 @@ cs_ret_code_t State::setInternal(const cs_state_data_t & data, const Persistence
 	}
 	switch(mode) {
 		case PersistenceMode::NEITHER_RAM_NOR_FLASH:
+		case PersistenceMode::FLASH_CACHED:
 			return ERR_NOT_AVAILABLE;
 		case PersistenceMode::RAM: {
 			ret_code = storeInRam(data);
@@ -257,6 +282,7 @@ cs_ret_code_t State::setInternal(const cs_state_data_t & data, const Persistence
 					return ret_code;
 					break;
 				case PersistenceMode::FLASH:
+				case PersistenceMode::FLASH_CACHED:
 					// fall-through
 					break;
 				default:
@@ -299,6 +325,7 @@ cs_ret_code_t State::removeInternal(const CS_TYPE & type, cs_state_id_t id, cons
 	cs_ret_code_t ret_code = ERR_UNSPECIFIED;
 	switch(mode) {
 	case PersistenceMode::NEITHER_RAM_NOR_FLASH:
+	case PersistenceMode::FLASH_CACHED:
 			return ERR_NOT_AVAILABLE;
 	case PersistenceMode::RAM: {
 		// Can we remove from ram, while not from flash?
@@ -312,6 +339,7 @@ cs_ret_code_t State::removeInternal(const CS_TYPE & type, cs_state_id_t id, cons
 		case PersistenceMode::RAM:
 			return removeFromRam(type, id);
 		case PersistenceMode::FLASH:
+		case PersistenceMode::FLASH_CACHED:
 			// continue after this switch
 			break;
 		default:
@@ -370,6 +398,19 @@ cs_ret_code_t State::storeInRam(const cs_state_data_t & data, size16_t & index_i
 	// TODO: Check if enough RAM is available
 	LOGStateDebug("storeInRam type=%u id=%u size=%u", to_underlying_type(data.type), data.id, data.size);
 	cs_ret_code_t ret_code = findInRam(data.type, data.id, index_in_ram);
+	bool subscribed = _subscriptions.isSubscribed(data.type);
+	bool cached = (DefaultLocation(data.type) == PersistenceMode::FLASH_CACHED);
+	if ((subscribed || cached) && ret_code != ERR_SUCCESS) {
+		// Load the current value (from flash or default) first, so that only real changes are notified and written.
+		buffer_ptr_t currentValue = (buffer_ptr_t) malloc(data.size);
+		if (currentValue != nullptr) {
+			cs_state_data_t currentData(data.type, data.id, currentValue, data.size);
+			get(currentData, PersistenceMode::STRATEGY1);
+			free(currentValue);
+		}
+		ret_code = findInRam(data.type, data.id, index_in_ram);
+	}
+	buffer_ptr_t oldValue = nullptr;
 	if (ret_code == ERR_SUCCESS) {
 		LOGStateDebug("Update in RAM");
 		cs_state_data_t & ram_data = _ram_data_register[index_in_ram];
@@ -383,8 +424,17 @@ cs_ret_code_t State::storeInRam(const cs_state_data_t & data, size16_t & index_i
 		}
 		if (memcmp(ram_data.value, data.value, data.size) == 0) {
 			LOGStateDebug("No change");
+			if (cached) {
+				_cache.touch(data.type, data.id, data.size);
+			}
 			return ERR_SUCCESS_NO_CHANGE;
 		}
+		if (subscribed) {
+			oldValue = (buffer_ptr_t) malloc(data.size);
+			if (oldValue != nullptr) {
+				memcpy(oldValue, ram_data.value, data.size);
+			}
+		}
 		memcpy(ram_data.value, data.value, data.size);
 	}
 	else {
@@ -393,6 +443,24 @@ cs_ret_code_t State::storeInRam(const cs_state_data_t & data, size16_t & index_i
 		memcpy(ram_data.value, data.value, data.size);
 		index_in_ram = _ram_data_register.size() - 1;
 	}
+	if (cached) {
+		// The value in RAM differs from flash now, so it can't be evicted until it has been written.
+		_cache.touch(data.type, data.id, data.size);
+		_cache.setPinned(data.type, data.id, true);
+	}
+	if (subscribed) {
+		// Don't use ram_data from here: subscribers may set other values, which can reallocate the register.
+		state_change_t change;
+		change.type = data.type;
+		change.id = data.id;
+		change.oldValue = oldValue;
+		change.newValue = data.value;
+		change.size = data.size;
+		_subscriptions.notify(change);
+		free(oldValue);
+		// Subscribers may have caused values to be added or evicted.
+		findInRam(data.type, data.id, index_in_ram);
+	}
 	return ERR_SUCCESS;
 }
 
@@ -415,10 +483,62 @@ cs_ret_code_t State::removeFromRam(const CS_TYPE & type, cs_state_id_t id) {
 		free(ram_data->value);
 		_ram_data_register.erase(_ram_data_register.begin() + index_in_ram);
 	}
+	_cache.remove(type, id);
 	remId(type, id);
 	return ERR_SUCCESS;
 }
 
+cs_ret_code_t State::loadFromFlashCached(cs_state_data_t & data) {
+	_cache.addMiss();
+	// Copy from the flash record straight to the user data, without allocating a temporary copy.
+	data.size = TypeSize(data.type);
+	uint32_t readStartTicks = RTC::getCount();
+	cs_ret_code_t retCode = _storage->read(data);
+	BootProfiler::getInstance().addStateRead(data.type, RTC::difference(RTC::getCount(), readStartTicks));
+	if (retCode != ERR_SUCCESS) {
+		LOGd("Load default: %s", TypeName(data.type));
+		retCode = getDefaultValue(data);
+		if (retCode != ERR_SUCCESS) {
+			return retCode;
+		}
+	}
+	// Add to the working set.
+	cs_state_data_t & ram_data = addToRam(data.type, data.id, data.size);
+	memcpy(ram_data.value, data.value, data.size);
+	_cache.touch(data.type, data.id, data.size);
+	evictFromCache();
+	return ERR_SUCCESS;
+}
+
+void State::evictFromCache() {
+	CS_TYPE type;
+	cs_state_id_t id;
+	while (_cache.getEvictionCandidate(type, id)) {
+		LOGStateDebug("Evict type=%u id=%u", to_underlying_type(type), id);
+		size16_t index_in_ram;
+		if (findInRam(type, id, index_in_ram) == ERR_SUCCESS) {
+			// Don't use removeFromRam(), as the id still exists in flash.
+			free(_ram_data_register[index_in_ram].value);
+			_ram_data_register.erase(_ram_data_register.begin() + index_in_ram);
+		}
+		_cache.evicted(type, id);
+	}
+}
+
+void State::handleWriteDone(const cs_type_and_id_t & typeAndId) {
+	if (DefaultLocation(typeAndId.type) != PersistenceMode::FLASH_CACHED) {
+		return;
+	}
+	for (auto & item: _store_queue) {
+		if (item.operation == CS_STATE_QUEUE_OP_WRITE && item.type == typeAndId.type && item.id == typeAndId.id) {
+			// Another write is pending, which uses the value in RAM.
+			return;
+		}
+	}
+	_cache.setPinned(typeAndId.type, typeAndId.id, false);
+	evictFromCache();
+}
+
 /**
  * Let storage do the allocation, so that it's of the correct size and alignment.
  */
@@ -902,9 +1022,20 @@ void State::handleStorageError(cs_storage_operation_t operation, CS_TYPE type, c
 
 void State::handleEvent(event_t & event) {
 	switch (event.type) {
-	case CS_TYPE::EVT_TICK:
+	case CS_TYPE::EVT_TICK: {
 		delayedStoreTick();
+		TYPIFY(EVT_TICK) tickCount = *(TYPIFY(EVT_TICK)*)event.data;
+		if (tickCount % (STATE_CACHE_LOG_INTERVAL_MS / TICK_INTERVAL_MS) == 0 && tickCount != 0) {
+			const state_cache_stats_t & stats = _cache.getStats();
+			LOGi("Cache hitRate=%u%% hits=%u misses=%u evictions=%u size=%u maxSize=%u",
+					_cache.getHitRatePercent(), stats.hits, stats.misses, stats.evictions, stats.size, stats.maxSize);
+		}
+		break;
+	}
+	case CS_TYPE::EVT_STORAGE_WRITE_DONE: {
+		handleWriteDone(*(TYPIFY(EVT_STORAGE_WRITE_DONE)*)event.data);
 		break;
+	}
 	case CS_TYPE::CMD_FACTORY_RESET: {
 		factoryReset();
 		break;
@@ -0,0 +1,95 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <storage/cs_StateCache.h>
+
+StateCache::StateCache(uint32_t maxSize):
+	_maxSize(maxSize)
+{}
+
+StateCache::state_cache_entry_t* StateCache::find(CS_TYPE type, cs_state_id_t id) {
+	for (auto & entry: _entries) {
+		if (entry.type == type && entry.id == id) {
+			return &entry;
+		}
+	}
+	return nullptr;
+}
+
+void StateCache::touch(CS_TYPE type, cs_state_id_t id, size16_t size) {
+	_useCounter++;
+	state_cache_entry_t* entry = find(type, id);
+	if (entry != nullptr) {
+		_stats.size = _stats.size - entry->size + size;
+		entry->size = size;
+		entry->lastUsed = _useCounter;
+	}
+	else {
+		state_cache_entry_t newEntry;
+		newEntry.type = type;
+		newEntry.id = id;
+		newEntry.size = size;
+		newEntry.pinned = false;
+		newEntry.lastUsed = _useCounter;
+		_entries.push_back(newEntry);
+		_stats.size += size;
+	}
+	if (_stats.size > _stats.maxSize) {
+		_stats.maxSize = _stats.size;
+	}
+}
+
+void StateCache::setPinned(CS_TYPE type, cs_state_id_t id, bool pinned) {
+	state_cache_entry_t* entry = find(type, id);
+	if (entry != nullptr) {
+		entry->pinned = pinned;
+	}
+}
+
+void StateCache::remove(CS_TYPE type, cs_state_id_t id) {
+	for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+		if (it->type == type && it->id == id) {
+			_stats.size -= it->size;
+			_entries.erase(it);
+			return;
+		}
+	}
+}
+
+bool StateCache::getEvictionCandidate(CS_TYPE & type, cs_state_id_t & id) {
+	if (_stats.size <= _maxSize) {
+		return false;
+	}
+	state_cache_entry_t* leastRecentlyUsed = nullptr;
+	for (auto & entry: _entries) {
+		if (entry.pinned) {
+			continue;
+		}
+		if (leastRecentlyUsed == nullptr || entry.lastUsed < leastRecentlyUsed->lastUsed) {
+			leastRecentlyUsed = &entry;
+		}
+	}
+	if (leastRecentlyUsed == nullptr) {
+		return false;
+	}
+	type = leastRecentlyUsed->type;
+	id = leastRecentlyUsed->id;
+	return true;
+}
+
+void StateCache::evicted(CS_TYPE type, cs_state_id_t id) {
+	remove(type, id);
+	_stats.evictions++;
+}
+
+uint8_t StateCache::getHitRatePercent() {
+	uint32_t total = _stats.hits + _stats.misses;
+	if (total == 0) {
+		return 0;
+	}
+	return (uint64_t)_stats.hits * 100 / total;
+}
@@ -11,6 +11,8 @@
 #include <storage/cs_StateData.h>
 #include <util/cs_UuidParser.h>
 
+#include <string>
+
 cs_ret_code_t getDefault(cs_state_data_t & data, const boards_config_t& boardsConfig)  {
 
 	// for all non-string types we already know the to-be expected size
@@ -273,6 +275,7 @@ cs_ret_code_t getDefault(cs_state_data_t & data, const boards_config_t& boardsCo
 	case CS_TYPE::EVT_CURRENT_USAGE_ABOVE_THRESHOLD_DIMMER:
 	case CS_TYPE::EVT_CURRENT_USAGE_ABOVE_THRESHOLD:
 	case CS_TYPE::EVT_DEVICE_SCANNED:
+	case CS_TYPE::EVT_DEVICE_SCANNED_BATCH:
 	case CS_TYPE::EVT_DIMMER_FORCED_OFF:
 	case CS_TYPE::EVT_DIMMER_OFF_FAILURE_DETECTED:
 	case CS_TYPE::EVT_DIMMER_ON_FAILURE_DETECTED:
@@ -329,12 +332,22 @@ cs_ret_code_t getDefault(cs_state_data_t & data, const boards_config_t& boardsCo
 	case CS_TYPE::EVT_MESH_PAGES_ERASED:
 	case CS_TYPE::EVT_MESH_EXT_STATE_0:
 	case CS_TYPE::EVT_MESH_EXT_STATE_1:
+	case CS_TYPE::CMD_SEND_MESH_BULK_TRANSFER:
+	case CS_TYPE::EVT_MESH_BULK_TRANSFER_RECEIVED:
+	case CS_TYPE::EVT_MESH_BULK_TRANSFER_RESULT:
 	case CS_TYPE::CMD_SEND_MESH_MSG_SET_TIME:
 	case CS_TYPE::CMD_SET_IBEACON_CONFIG_ID:
 	case CS_TYPE::CMD_SEND_MESH_MSG_NOOP:
 	case CS_TYPE::CMD_GET_ADC_RESTARTS:
 	case CS_TYPE::CMD_GET_SWITCH_HISTORY:
 	case CS_TYPE::CMD_GET_POWER_SAMPLES:
+	case CS_TYPE::CMD_GET_MESH_LINK_QUALITY:
+	case CS_TYPE::CMD_GET_MESH_TELEMETRY:
+	case CS_TYPE::CMD_RESET_MESH_TELEMETRY:
+	case CS_TYPE::CMD_GET_SCAN_PREFILTER_STATS:
+	case CS_TYPE::CMD_GET_SCAN_DUTY_STATS:
+	case CS_TYPE::CMD_GET_EXTERNAL_STATE_STATS:
+	case CS_TYPE::CMD_GET_STORAGE_GC_STATS:
 	case CS_TYPE::EVT_GENERIC_TEST:
 	case CS_TYPE::CMD_MICROAPP_UPLOAD:
 	case CS_TYPE::EVT_MICROAPP:
@@ -396,17 +409,18 @@ PersistenceMode DefaultLocation(CS_TYPE const & type) {
 	case CS_TYPE::STATE_RESET_COUNTER:
 	case CS_TYPE::STATE_OPERATION_MODE:
 	case CS_TYPE::STATE_SWITCH_STATE:
-	case CS_TYPE::STATE_BEHAVIOUR_RULE:
-	case CS_TYPE::STATE_TWILIGHT_RULE:
-	case CS_TYPE::STATE_EXTENDED_BEHAVIOUR_RULE:
 	case CS_TYPE::STATE_BEHAVIOUR_SETTINGS:
 	case CS_TYPE::STATE_SUN_TIME:
 	case CS_TYPE::STATE_MESH_IV_INDEX:
 	case CS_TYPE::STATE_MESH_SEQ_NUMBER:
 	case CS_TYPE::STATE_IBEACON_CONFIG_ID:
-	case CS_TYPE::STATE_MICROAPP:
 	case CS_TYPE::STATE_SOFT_ON_SPEED:
 		return PersistenceMode::FLASH;
+	case CS_TYPE::STATE_BEHAVIOUR_RULE:
+	case CS_TYPE::STATE_TWILIGHT_RULE:
+	case CS_TYPE::STATE_EXTENDED_BEHAVIOUR_RULE:
+	case CS_TYPE::STATE_MICROAPP:
+		return PersistenceMode::FLASH_CACHED;
 	case CS_TYPE::STATE_ACCUMULATED_ENERGY:
 	case CS_TYPE::STATE_POWER_USAGE:
 	case CS_TYPE::STATE_TEMPERATURE:
@@ -428,6 +442,7 @@ PersistenceMode DefaultLocation(CS_TYPE const & type) {
 	case CS_TYPE::EVT_SCAN_STARTED:
 	case CS_TYPE::EVT_SCAN_STOPPED:
 	case CS_TYPE::EVT_DEVICE_SCANNED:
+	case CS_TYPE::EVT_DEVICE_SCANNED_BATCH:
 	case CS_TYPE::EVT_CURRENT_USAGE_ABOVE_THRESHOLD_DIMMER:
 	case CS_TYPE::EVT_CURRENT_USAGE_ABOVE_THRESHOLD:
 	case CS_TYPE::EVT_DIMMER_ON_FAILURE_DETECTED:
@@ -511,12 +526,22 @@ PersistenceMode DefaultLocation(CS_TYPE const & type) {
 	case CS_TYPE::EVT_MESH_PAGES_ERASED:
 	case CS_TYPE::EVT_MESH_EXT_STATE_0:
 	case CS_TYPE::EVT_MESH_EXT_STATE_1:
+	case CS_TYPE::CMD_SEND_MESH_BULK_TRANSFER:
+	case CS_TYPE::EVT_MESH_BULK_TRANSFER_RECEIVED:
+	case CS_TYPE::EVT_MESH_BULK_TRANSFER_RESULT:
 	case CS_TYPE::CMD_SEND_MESH_MSG_SET_TIME:
 	case CS_TYPE::CMD_SET_IBEACON_CONFIG_ID:
 	case CS_TYPE::CMD_SEND_MESH_MSG_NOOP:
 	case CS_TYPE::CMD_GET_ADC_RESTARTS:
 	case CS_TYPE::CMD_GET_SWITCH_HISTORY:
 	case CS_TYPE::CMD_GET_POWER_SAMPLES:
+	case CS_TYPE::CMD_GET_MESH_LINK_QUALITY:
+	case CS_TYPE::CMD_GET_MESH_TELEMETRY:
+	case CS_TYPE::CMD_RESET_MESH_TELEMETRY:
+	case CS_TYPE::CMD_GET_SCAN_PREFILTER_STATS:
+	case CS_TYPE::CMD_GET_SCAN_DUTY_STATS:
+	case CS_TYPE::CMD_GET_EXTERNAL_STATE_STATS:
+	case CS_TYPE::CMD_GET_STORAGE_GC_STATS:
 	case CS_TYPE::EVT_GENERIC_TEST:
 	case CS_TYPE::CMD_MICROAPP_UPLOAD:
 	case CS_TYPE::EVT_MICROAPP:
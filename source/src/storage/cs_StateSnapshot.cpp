@@ -0,0 +1,126 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <storage/cs_StateSnapshot.h>
+#include <util/cs_Hash.h>
+#include <cstring>
+
+typedef uint32_t state_snapshot_checksum_t;
+
+StateSnapshotWriter::StateSnapshotWriter(buffer_ptr_t buf, cs_buffer_size_t size):
+	_buf(buf),
+	_bufSize(size),
+	_size(sizeof(state_snapshot_header_t))
+{}
+
+cs_ret_code_t StateSnapshotWriter::add(uint16_t type, uint16_t id, const uint8_t* value, uint16_t size) {
+	if (_finalized) {
+		return ERR_WRONG_STATE;
+	}
+	uint32_t requiredSize = (uint32_t)_size + sizeof(state_snapshot_entry_header_t) + size + sizeof(state_snapshot_checksum_t);
+	if (requiredSize > _bufSize) {
+		return ERR_BUFFER_TOO_SMALL;
+	}
+	state_snapshot_entry_header_t entryHeader;
+	entryHeader.type = type;
+	entryHeader.id = id;
+	entryHeader.size = size;
+	memcpy(_buf + _size, &entryHeader, sizeof(entryHeader));
+	_size += sizeof(entryHeader);
+	memcpy(_buf + _size, value, size);
+	_size += size;
+	_numEntries++;
+	return ERR_SUCCESS;
+}
+
+cs_ret_code_t StateSnapshotWriter::finalize() {
+	if (_finalized) {
+		return ERR_SUCCESS;
+	}
+	if ((uint32_t)_size + sizeof(state_snapshot_checksum_t) > _bufSize) {
+		return ERR_BUFFER_TOO_SMALL;
+	}
+	state_snapshot_header_t header;
+	header.protocol = STATE_SNAPSHOT_PROTOCOL_VERSION;
+	header.numEntries = _numEntries;
+	memcpy(_buf, &header, sizeof(header));
+	state_snapshot_checksum_t checksum = Fletcher(_buf, _size);
+	memcpy(_buf + _size, &checksum, sizeof(checksum));
+	_size += sizeof(checksum);
+	_finalized = true;
+	return ERR_SUCCESS;
+}
+
+StateSnapshotReader::StateSnapshotReader(buffer_ptr_t buf, cs_buffer_size_t size):
+	_buf(buf),
+	_size(size)
+{}
+
+cs_ret_code_t StateSnapshotReader::validate() {
+	_valid = false;
+	if (_size < sizeof(state_snapshot_header_t) + sizeof(state_snapshot_checksum_t)) {
+		return ERR_WRONG_PAYLOAD_LENGTH;
+	}
+	state_snapshot_header_t header;
+	memcpy(&header, _buf, sizeof(header));
+	if (header.protocol != STATE_SNAPSHOT_PROTOCOL_VERSION) {
+		return ERR_PROTOCOL_UNSUPPORTED;
+	}
+	cs_buffer_size_t dataSize = _size - sizeof(state_snapshot_checksum_t);
+
+	state_snapshot_checksum_t checksum;
+	memcpy(&checksum, _buf + dataSize, sizeof(checksum));
+	if (checksum != Fletcher(_buf, dataSize)) {
+		return ERR_INVALID_MESSAGE;
+	}
+
+	// Walk over all entries, to check if they exactly fill up the data.
+	uint32_t index = sizeof(state_snapshot_header_t);
+	for (uint16_t i = 0; i < header.numEntries; ++i) {
+		if (index + sizeof(state_snapshot_entry_header_t) > dataSize) {
+			return ERR_WRONG_PAYLOAD_LENGTH;
+		}
+		state_snapshot_entry_header_t entryHeader;
+		memcpy(&entryHeader, _buf + index, sizeof(entryHeader));
+		index += sizeof(entryHeader) + entryHeader.size;
+		if (index > dataSize) {
+			return ERR_WRONG_PAYLOAD_LENGTH;
+		}
+	}
+	if (index != dataSize) {
+		return ERR_WRONG_PAYLOAD_LENGTH;
+	}
+
+	_numEntries = header.numEntries;
+	_valid = true;
+	rewind();
+	return ERR_SUCCESS;
+}
+
+cs_ret_code_t StateSnapshotReader::getNext(state_snapshot_entry_t & entry) {
+	if (!_valid) {
+		return ERR_WRONG_STATE;
+	}
+	if (_readEntries >= _numEntries) {
+		return ERR_NOT_FOUND;
+	}
+	state_snapshot_entry_header_t entryHeader;
+	memcpy(&entryHeader, _buf + _readIndex, sizeof(entryHeader));
+	_readIndex += sizeof(entryHeader);
+	entry.type = entryHeader.type;
+	entry.id = entryHeader.id;
+	entry.size = entryHeader.size;
+	entry.value = _buf + _readIndex;
+	_readIndex += entryHeader.size;
+	_readEntries++;
+	return ERR_SUCCESS;
+}
+
+void StateSnapshotReader::rewind() {
+	_readIndex = sizeof(state_snapshot_header_t);
+	_readEntries = 0;
+}
@@ -0,0 +1,53 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <storage/cs_StateSubscriptions.h>
+
+cs_ret_code_t StateSubscriptions::subscribe(CS_TYPE type, StateSubscriber* subscriber) {
+	for (uint8_t i = 0; i < _numSubscriptions; ++i) {
+		if (_subscriptions[i].type == type && _subscriptions[i].subscriber == subscriber) {
+			return ERR_SUCCESS;
+		}
+	}
+	if (_numSubscriptions >= STATE_MAX_SUBSCRIPTIONS) {
+		return ERR_NO_SPACE;
+	}
+	_subscriptions[_numSubscriptions].type = type;
+	_subscriptions[_numSubscriptions].subscriber = subscriber;
+	_numSubscriptions++;
+	return ERR_SUCCESS;
+}
+
+cs_ret_code_t StateSubscriptions::unsubscribe(CS_TYPE type, StateSubscriber* subscriber) {
+	for (uint8_t i = 0; i < _numSubscriptions; ++i) {
+		if (_subscriptions[i].type == type && _subscriptions[i].subscriber == subscriber) {
+			// Move last subscription to this index.
+			_numSubscriptions--;
+			_subscriptions[i] = _subscriptions[_numSubscriptions];
+			return ERR_SUCCESS;
+		}
+	}
+	return ERR_NOT_FOUND;
+}
+
+bool StateSubscriptions::isSubscribed(CS_TYPE type) {
+	for (uint8_t i = 0; i < _numSubscriptions; ++i) {
+		if (_subscriptions[i].type == type) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void StateSubscriptions::notify(const state_change_t & change) {
+	// Subscribers may unsubscribe during the call, so iterate backwards.
+	for (int16_t i = _numSubscriptions - 1; i >= 0; --i) {
+		if (i < _numSubscriptions && _subscriptions[i].type == change.type) {
+			_subscriptions[i].subscriber->handleStateChange(change);
+		}
+	}
+}
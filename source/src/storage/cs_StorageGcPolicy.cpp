@@ -0,0 +1,120 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <storage/cs_StorageGcPolicy.h>
+
+#include <cstring>
+
+void StorageGcPolicy::setConfig(const storage_gc_config_t & config) {
+	_config = config;
+}
+
+void StorageGcPolicy::onWrite(uint32_t nowMs) {
+	onActivity(nowMs);
+}
+
+void StorageGcPolicy::onMeshActivity(uint32_t nowMs) {
+	onActivity(nowMs);
+}
+
+void StorageGcPolicy::setConnected(bool connected, uint32_t nowMs) {
+	_connected = connected;
+	onActivity(nowMs);
+}
+
+void StorageGcPolicy::onActivity(uint32_t nowMs) {
+	_lastActivityMs = nowMs;
+}
+
+bool StorageGcPolicy::isIdle(uint16_t schedulerQueueUse, uint32_t nowMs) {
+	if (_connected) {
+		return false;
+	}
+	if (schedulerQueueUse > _config.maxSchedulerQueueUse) {
+		return false;
+	}
+	return (nowMs - _lastActivityMs >= _config.idleTimeMs);
+}
+
+StorageGcReason StorageGcPolicy::check(const storage_gc_flash_stats_t & stats, uint16_t schedulerQueueUse, uint32_t nowMs) {
+	if (_running) {
+		return StorageGcReason::NONE;
+	}
+	if (stats.freeableWords < _config.minFreeableWords || stats.freeableWords == 0) {
+		_pending = false;
+		return StorageGcReason::NONE;
+	}
+	if (stats.largestContiguousWords < _config.reserveWords) {
+		return StorageGcReason::URGENT;
+	}
+
+	// Use 64 bit to prevent overflow.
+	uint64_t dirtyPercent = (uint64_t)stats.freeableWords * 100 / stats.usedWords;
+	if (dirtyPercent < _config.dirtyRatioPercent) {
+		_pending = false;
+		return StorageGcReason::NONE;
+	}
+	if (!_pending) {
+		_pending = true;
+		_pendingSinceMs = nowMs;
+	}
+	if (isIdle(schedulerQueueUse, nowMs)) {
+		return StorageGcReason::IDLE;
+	}
+	if (nowMs - _pendingSinceMs >= _config.maxDeferMs) {
+		return StorageGcReason::DEFERRED;
+	}
+	return StorageGcReason::NONE;
+}
+
+void StorageGcPolicy::onStarted(StorageGcReason reason, const storage_gc_flash_stats_t & stats, uint32_t nowMs) {
+	_running = true;
+	_pending = false;
+	_startedMs = nowMs;
+	_startFreeableWords = stats.freeableWords;
+	_telemetry.runs++;
+	switch (reason) {
+		case StorageGcReason::IDLE:
+			_telemetry.idleRuns++;
+			break;
+		case StorageGcReason::URGENT:
+			_telemetry.urgentRuns++;
+			break;
+		case StorageGcReason::DEFERRED:
+			_telemetry.deferredRuns++;
+			break;
+		case StorageGcReason::REACTIVE:
+			_telemetry.reactiveRuns++;
+			break;
+		case StorageGcReason::NONE:
+			break;
+	}
+}
+
+void StorageGcPolicy::onDone(const storage_gc_flash_stats_t & stats, uint32_t nowMs) {
+	if (!_running) {
+		return;
+	}
+	_running = false;
+	if (_startFreeableWords > stats.freeableWords) {
+		_telemetry.reclaimedWords += _startFreeableWords - stats.freeableWords;
+	}
+	_telemetry.lastDurationMs = nowMs - _startedMs;
+	if (_telemetry.lastDurationMs > _telemetry.maxDurationMs) {
+		_telemetry.maxDurationMs = _telemetry.lastDurationMs;
+	}
+}
+
+void StorageGcPolicy::getStats(cs_result_t& result) {
+	if (result.buf.len < sizeof(_telemetry)) {
+		result.returnCode = ERR_BUFFER_TOO_SMALL;
+		return;
+	}
+	memcpy(result.buf.data, &_telemetry, sizeof(_telemetry));
+	result.dataSize = sizeof(_telemetry);
+	result.returnCode = ERR_SUCCESS;
+}
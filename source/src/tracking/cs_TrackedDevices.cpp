@@ -7,6 +7,7 @@
 
 #include <events/cs_EventDispatcher.h>
 #include <processing/cs_EncryptionHandler.h>
+#include <processing/cs_ScanPrefilter.h>
 #include <tracking/cs_TrackedDevices.h>
 #include <util/cs_BleError.h>
 #include <util/cs_Utils.h>
@@ -41,6 +42,7 @@ cs_ret_code_t TrackedDevices::handleRegister(internal_register_tracked_device_pa
 	setFlags(      *device, packet.data.flags.asInt);
 	setDevicetoken(*device, packet.data.deviceToken, sizeof(packet.data.deviceToken));
 	setTTL(        *device, packet.data.timeToLiveMinutes);
+	devices.touch(device);
 	sendRegisterToMesh(*device);
 	sendTokenToMesh(*device);
 	print(*device);
@@ -64,6 +66,7 @@ void TrackedDevices::handleMeshRegister(TYPIFY(EVT_MESH_TRACKED_DEVICE_REGISTER)
 	setRssiOffset(*device, packet.rssiOffset);
 	setFlags(*device, packet.flags);
 	setAccessLevel(*device, packet.accessLevel);
+	devices.touch(device);
 	print(*device);
 	checkSynced();
 }
@@ -81,6 +84,7 @@ void TrackedDevices::handleMeshToken(TYPIFY(EVT_MESH_TRACKED_DEVICE_TOKEN)& pack
 	}
 	setDevicetoken(*device, packet.deviceToken, sizeof(packet.deviceToken));
 	setTTL(*device, packet.ttlMinutes);
+	devices.touch(device);
 	print(*device);
 	checkSynced();
 }
@@ -105,81 +109,44 @@ void TrackedDevices::handleScannedDevice(adv_background_parsed_v1_t& packet) {
 		return;
 	}
 	device->locationIdTimeout = LOCATION_ID_TIMEOUT_MINUTES;
+	devices.touch(device);
+	ScanPrefilter::getInstance().addAddress(SCAN_PREFILTER_SOURCE_TRACKED_DEVICES, packet.macAddress);
 //	if (!device->data.data.flags.flags.ignoreForBehaviour) {
 //		sendLocation(*device);
 //	}
 	sendBackgroundAdv(*device, packet.macAddress, packet.rssi);
 }
 
-TrackedDevices::TrackedDevice* TrackedDevices::findOrAdd(device_id_t deviceId) {
+TrackedDevice* TrackedDevices::findOrAdd(device_id_t deviceId) {
 	TrackedDevice* device = find(deviceId);
 	if (device == nullptr) {
-		device = add();
-		device->data.data.deviceId = deviceId;
+		device = add(deviceId);
 	}
 	return device;
 }
 
-TrackedDevices::TrackedDevice* TrackedDevices::find(device_id_t deviceId) {
-	for (auto iter = devices.begin(); iter != devices.end(); ++iter) {
-		if (iter->data.data.deviceId == deviceId) {
-			LOGTrackedDevicesVerbose("found device");
-			return &(*iter);
-		}
+TrackedDevice* TrackedDevices::find(device_id_t deviceId) {
+	TrackedDevice* device = devices.find(deviceId);
+	if (device != nullptr) {
+		LOGTrackedDevicesVerbose("found device");
 	}
-	return nullptr;
+	return device;
 }
 
-TrackedDevices::TrackedDevice* TrackedDevices::findToken(uint8_t* deviceToken, uint8_t size) {
+TrackedDevice* TrackedDevices::findToken(uint8_t* deviceToken, uint8_t size) {
 	assert(size == TRACKED_DEVICE_TOKEN_SIZE, "Wrong device token size");
-	for (auto iter = devices.begin(); iter != devices.end(); ++iter) {
-		if (memcmp(iter->data.data.deviceToken, deviceToken, size) == 0) {
-			LOGTrackedDevicesVerbose("found token id=%u", iter->data.data.deviceId);
-			return &(*iter);
-		}
+	TrackedDevice* device = devices.findToken(deviceToken);
+	if (device != nullptr) {
+		LOGTrackedDevicesVerbose("found token id=%u", device->data.data.deviceId);
 	}
-	return nullptr;
+	return device;
 }
 
-TrackedDevices::TrackedDevice* TrackedDevices::add() {
-	// Check number of devices.
-	if (deviceListSize >= MAX_TRACKED_DEVICES) {
-		cs_ret_code_t retCode = removeDevice();
-		if (retCode != ERR_SUCCESS) {
-			LOGTrackedDevicesDebug("no space to add");
-			return nullptr;
-		}
-	}
-	LOGTrackedDevicesDebug("add device");
-	TrackedDevice device;
-	devices.push_front(device);
-	++deviceListSize;
-	return &(devices.front());
-}
-
-cs_ret_code_t TrackedDevices::removeDevice() {
-	uint16_t lowestTTL = 0xFFFF;
-	auto iterToRemove = devices.end();
-	auto prevIter = devices.before_begin();
-	for (auto iter = devices.begin(); iter != devices.end(); ++iter) {
-		if (iter->fieldsSet != ALL_FIELDS_SET) {
-			iterToRemove = prevIter;
-			break;
-		}
-		if (iter->data.data.timeToLiveMinutes <= lowestTTL) {
-			lowestTTL = iter->data.data.timeToLiveMinutes;
-			iterToRemove = prevIter;
-		}
-		prevIter = iter;
-	}
-	[[maybe_unused]] auto removedIter = iterToRemove;
-	LOGTrackedDevicesDebug("remove device id=%u", (++removedIter)->data.data.deviceId);
-//	if (lowestTTL == 0xFFFF) {
-//		return ERR_NOT_AVAILABLE;
-//	}
-	devices.erase_after(iterToRemove);
-	--deviceListSize;
-	return ERR_SUCCESS;
+TrackedDevice* TrackedDevices::add(device_id_t deviceId) {
+	LOGTrackedDevicesDebug("add device id=%u size=%u", deviceId, devices.size());
+	TrackedDevice* device = devices.add(deviceId);
+	device->locationIdTimeout = LOCATION_ID_TIMEOUT_MINUTES;
+	return device;
 }
 
 
@@ -215,15 +182,19 @@ void TrackedDevices::checkSynced() {
 	if (deviceListIsSynced) {
 		return;
 	}
-	if (deviceListSize < expectedDeviceListSize) {
-		LOGTrackedDevicesDebug("Expecting more devices, current=%u expected=%u", deviceListSize, expectedDeviceListSize);
+	if (devices.size() < expectedDeviceListSize) {
+		LOGTrackedDevicesDebug("Expecting more devices, current=%u expected=%u", devices.size(), expectedDeviceListSize);
 		return;
 	}
-	for (auto iter = devices.begin(); iter != devices.end(); ++iter) {
-		if (!allFieldsSet(*iter)) {
-			LOGTrackedDevicesDebug("Not all fields set for id=%u", iter->data.data.deviceId);
-			return;
+	bool synced = true;
+	devices.forEach([&](TrackedDevice& device) {
+		if (synced && !allFieldsSet(device)) {
+			LOGTrackedDevicesDebug("Not all fields set for id=%u", device.data.data.deviceId);
+			synced = false;
 		}
+	});
+	if (!synced) {
+		return;
 	}
 	LOGi("Synced");
 	deviceListIsSynced = true;
@@ -259,7 +230,7 @@ void TrackedDevices::setFlags(TrackedDevice& device, uint8_t flags) {
 
 void TrackedDevices::setDevicetoken(TrackedDevice& device, uint8_t* deviceToken, uint8_t size) {
 	assert(size == TRACKED_DEVICE_TOKEN_SIZE, "Wrong device token size");
-	memcpy(device.data.data.deviceToken, deviceToken, sizeof(device.data.data.deviceToken));
+	devices.setToken(&device, deviceToken);
 	BLEutil::setBit(device.fieldsSet, BIT_POS_DEVICE_TOKEN);
 }
 
@@ -294,20 +265,22 @@ void TrackedDevices::print(TrackedDevice& device) {
 
 void TrackedDevices::tickMinute() {
 	LOGTrackedDevicesDebug("tickMinute");
-	for (auto iter = devices.begin(); iter != devices.end(); ++iter) {
-		if (iter->locationIdTimeout != 0) {
-			iter->locationIdTimeout--;
-			if (iter->locationIdTimeout == 0) {
-				iter->data.data.locationId = 0;
+	// Addresses change over time, so only keep the addresses of the last minute.
+	ScanPrefilter::getInstance().clearAddresses(SCAN_PREFILTER_SOURCE_TRACKED_DEVICES);
+	devices.forEach([&](TrackedDevice& device) {
+		if (device.locationIdTimeout != 0) {
+			device.locationIdTimeout--;
+			if (device.locationIdTimeout == 0) {
+				device.data.data.locationId = 0;
 			}
 		}
-		if (iter->data.data.timeToLiveMinutes != 0) {
-			iter->data.data.timeToLiveMinutes--;
+		if (device.data.data.timeToLiveMinutes != 0) {
+			device.data.data.timeToLiveMinutes--;
 		}
-		print(*iter);
-	}
+		print(device);
+	});
 	// Removed timed out devices.
-	devices.remove_if([](const TrackedDevice& device) { return device.data.data.timeToLiveMinutes == 0; });
+	devices.removeIf([](const TrackedDevice& device) { return device.data.data.timeToLiveMinutes == 0; });
 }
 
 
@@ -365,19 +338,20 @@ void TrackedDevices::sendTokenToMesh(TrackedDevice& device) {
 }
 
 void TrackedDevices::sendListSizeToMesh() {
-	LOGTrackedDevicesDebug("sendListSizeToMesh size=%u", deviceListSize);
+	LOGTrackedDevicesDebug("sendListSizeToMesh size=%u", devices.size());
 	TYPIFY(CMD_SEND_MESH_MSG_TRACKED_DEVICE_LIST_SIZE) eventData;
-	eventData.listSize = deviceListSize;
+	// The list size is a single byte, and 0xFF means unknown.
+	eventData.listSize = (devices.size() < 0xFF) ? devices.size() : 0xFE;
 	event_t event(CS_TYPE::CMD_SEND_MESH_MSG_TRACKED_DEVICE_LIST_SIZE, &eventData, sizeof(eventData));
 	event.dispatch();
 }
 
 void TrackedDevices::sendDeviceList() {
-	LOGd("sendDeviceList %u devices", deviceListSize);
-	for (auto iter = devices.begin(); iter != devices.end(); ++iter) {
-		sendRegisterToMesh(*iter);
-		sendTokenToMesh(*iter);
-	}
+	LOGd("sendDeviceList %u devices", devices.size());
+	devices.forEach([&](TrackedDevice& device) {
+		sendRegisterToMesh(device);
+		sendTokenToMesh(device);
+	});
 	sendListSizeToMesh();
 }
 
@@ -0,0 +1,88 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <drivers/cs_RTC.h>
+#include <drivers/cs_Serial.h>
+#include <util/cs_BootProfiler.h>
+
+/**
+ * Converts RTC ticks to microseconds, as ms are too coarse for single reads.
+ */
+static uint32_t ticksToUs(uint32_t ticks) {
+	return (uint64_t)ticks * 1000000 * (NRF_RTC0->PRESCALER + 1) / RTC_CLOCK_FREQ;
+}
+
+BootProfiler::BootProfiler() {
+	_startTicks = RTC::getCount();
+	_stageStartTicks = _startTicks;
+}
+
+void BootProfiler::endStage(uint32_t now) {
+	if (_numStages == 0) {
+		return;
+	}
+	_stages[_numStages - 1].ticks = RTC::difference(now, _stageStartTicks);
+}
+
+void BootProfiler::stage(const char* name) {
+	if (!_recording) {
+		return;
+	}
+	uint32_t now = RTC::getCount();
+	endStage(now);
+	_stageStartTicks = now;
+	if (_numStages >= BOOT_PROFILER_MAX_STAGES) {
+		LOGw("Too many boot stages");
+		return;
+	}
+	_stages[_numStages].name = name;
+	_stages[_numStages].ticks = 0;
+	++_numStages;
+}
+
+void BootProfiler::addStateRead(CS_TYPE type, uint32_t ticks) {
+	if (!_recording) {
+		return;
+	}
+	for (uint8_t i = 0; i < _numStateTypes; ++i) {
+		if (_stateReads[i].type == type) {
+			_stateReads[i].count++;
+			_stateReads[i].ticks += ticks;
+			return;
+		}
+	}
+	if (_numStateTypes >= BOOT_PROFILER_MAX_STATE_TYPES) {
+		return;
+	}
+	_stateReads[_numStateTypes].type = type;
+	_stateReads[_numStateTypes].count = 1;
+	_stateReads[_numStateTypes].ticks = ticks;
+	++_numStateTypes;
+}
+
+void BootProfiler::finish() {
+	if (!_recording) {
+		return;
+	}
+	uint32_t now = RTC::getCount();
+	endStage(now);
+	_recording = false;
+
+	LOGi("Boot took %u ms", RTC::ticksToMs(RTC::difference(now, _startTicks)));
+	for (uint8_t i = 0; i < _numStages; ++i) {
+		LOGi("  %s: %u ms", _stages[i].name, RTC::ticksToMs(_stages[i].ticks));
+	}
+
+	uint32_t totalReadTicks = 0;
+	uint16_t totalReads = 0;
+	for (uint8_t i = 0; i < _numStateTypes; ++i) {
+		totalReadTicks += _stateReads[i].ticks;
+		totalReads += _stateReads[i].count;
+		LOGd("  read %s x%u: %u us", TypeName(_stateReads[i].type), _stateReads[i].count, ticksToUs(_stateReads[i].ticks));
+	}
+	LOGi("State reads from flash: %u types, %u reads, %u us", _numStateTypes, totalReads, ticksToUs(totalReadTicks));
+}
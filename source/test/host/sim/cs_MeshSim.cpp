@@ -0,0 +1,956 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#include <cs_MeshSim.h>
+
+extern "C" {
+#include <access.h>
+#include <access_config.h>
+#include <access_reliable.h>
+#include <device_state_manager.h>
+}
+#include <events/cs_EventDispatcher.h>
+#include <events/cs_EventListener.h>
+#include <mesh/cs_MeshBulkTransfer.h>
+#include <mesh/cs_MeshLinkQuality.h>
+#include <mesh/cs_MeshModelMulticast.h>
+#include <mesh/cs_MeshModelMulticastAcked.h>
+#include <mesh/cs_MeshModelSelector.h>
+#include <mesh/cs_MeshModelUnicast.h>
+#include <mesh/cs_MeshMsgHandler.h>
+#include <mesh/cs_MeshMsgSender.h>
+#include <mesh/cs_MeshTelemetry.h>
+#include <protocol/cs_UartProtocol.h>
+#include <storage/cs_State.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <set>
+
+/**
+ * Number of bytes on air for a mesh packet, on top of the access payload:
+ * preamble, access address, PDU header, CRC, advertiser address, AD header, network header, and MIC.
+ */
+#define MESH_SIM_PACKET_OVERHEAD (1 + 4 + 2 + 3 + 6 + 2 + 9 + 4)
+
+/**
+ * Number of advertising channels each packet is sent on.
+ */
+#define MESH_SIM_NUM_CHANNELS 3
+
+class MeshSimModel {
+public:
+	uint16_t node;
+	access_model_id_t modelId;
+	const access_opcode_handler_t* handlers;
+	uint32_t numHandlers;
+	void* args;
+	dsm_handle_t publishAddressHandle = DSM_HANDLE_INVALID;
+
+	//! State of the reliable message in progress.
+	bool reliableActive = false;
+	access_reliable_t reliable;
+	std::vector<uint8_t> reliableData;
+	uint16_t reliableDstAddress;
+	uint32_t reliableDeadlineMs;
+	uint32_t reliableNextRetryMs;
+
+	const access_opcode_handler_t* findHandler(uint16_t opcode) {
+		for (uint32_t i = 0; i < numHandlers; ++i) {
+			if (handlers[i].opcode.opcode == opcode) {
+				return &(handlers[i]);
+			}
+		}
+		return nullptr;
+	}
+};
+
+class MeshSimNode {
+public:
+	stone_id_t id;
+	uint32_t tickCount = 0;
+	uint32_t tickPhaseMs;
+
+	MeshModelMulticast modelMulticast;
+	MeshModelMulticastAcked modelMulticastAcked;
+	MeshModelUnicast modelUnicast;
+	MeshModelSelector modelSelector;
+	MeshLinkQuality linkQuality;
+	MeshBulkTransfer bulkTransfer;
+	MeshTelemetry telemetry;
+	MeshMsgSender msgSender;
+	MeshMsgHandler msgHandler;
+
+	std::deque<mesh_sim_packet_t> radioQueue;
+	uint32_t nextTxMs = 0;
+	//! Time of the last transmission, during which the node can't receive.
+	int64_t lastTxMs = -1;
+	//! IDs of the packets that have been received, or sent, by this node.
+	std::set<uint32_t> seenPackets;
+
+	mesh_sim_node_stats_t stats;
+
+	uint8_t getNumQueued() {
+		return modelMulticast.getNumQueued() + modelMulticastAcked.getNumQueued() + modelUnicast.getNumQueued();
+	}
+};
+
+/**
+ * Makes the mesh code run as the given node, for as long as this object exists.
+ */
+class MeshSimCurrentNode {
+public:
+	MeshSimCurrentNode(MeshSim* sim, uint16_t node): _sim(sim), _prevNode(sim->_currentNode) {
+		_sim->_currentNode = node;
+	}
+	~MeshSimCurrentNode() {
+		_sim->_currentNode = _prevNode;
+	}
+private:
+	MeshSim* _sim;
+	int32_t _prevNode;
+};
+
+/**
+ * Handles the commands that the mesh msg handler dispatches, like the firmware would.
+ */
+class MeshSimEventListener: public EventListener {
+public:
+	void handleEvent(event_t & event) {
+		MeshSim* sim = MeshSim::getInstance();
+		if (sim != nullptr && sim->onEvent(to_underlying_type(event.type), event.data, event.size)) {
+			event.result.returnCode = ERR_SUCCESS;
+		}
+	}
+};
+
+static MeshSimEventListener _eventListener;
+
+MeshSim* MeshSim::_instance = nullptr;
+
+MeshSimHistogram::MeshSimHistogram(uint32_t bucketWidthMs, uint16_t numBuckets):
+	_bucketWidthMs(bucketWidthMs),
+	_buckets(numBuckets, 0)
+{}
+
+void MeshSimHistogram::add(uint32_t valueMs) {
+	uint32_t bucket = valueMs / _bucketWidthMs;
+	if (bucket >= _buckets.size()) {
+		bucket = _buckets.size() - 1;
+	}
+	_buckets[bucket]++;
+	_count++;
+	if (valueMs > _max) {
+		_max = valueMs;
+	}
+}
+
+uint32_t MeshSimHistogram::getPercentile(uint8_t percentile) {
+	if (_count == 0) {
+		return 0;
+	}
+	uint64_t threshold = ((uint64_t)_count * percentile + 99) / 100;
+	uint64_t sum = 0;
+	for (uint32_t i = 0; i < _buckets.size(); ++i) {
+		sum += _buckets[i];
+		if (sum >= threshold) {
+			return (i + 1) * _bucketWidthMs;
+		}
+	}
+	return _max;
+}
+
+void MeshSimHistogram::print(const char* name) {
+	printf("  %-16s n=%-6u p50=%-6u p90=%-6u p99=%-6u max=%u ms\n", name, _count, getPercentile(50), getPercentile(90), getPercentile(99), _max);
+}
+
+MeshSim::MeshSim(uint16_t numNodes, uint32_t seed):
+	_randomState(seed == 0 ? 1 : seed)
+{
+	static bool listenerAdded = false;
+	if (!listenerAdded) {
+		EventDispatcher::getInstance().addListener(&_eventListener);
+		listenerAdded = true;
+	}
+	_instance = this;
+	_links.resize(numNodes);
+	for (uint16_t i = 0; i < numNodes; ++i) {
+		_nodes.emplace_back(new MeshSimNode());
+	}
+	for (uint16_t i = 0; i < numNodes; ++i) {
+		MeshSimNode& node = *_nodes[i];
+		node.id = i + 1;
+		node.tickPhaseMs = random(TICK_INTERVAL_MS);
+		node.nextTxMs = random(MESH_SIM_TX_INTERVAL_MS);
+
+		// Same as Mesh::init().
+		MeshSimCurrentNode currentNode(this, i);
+		node.msgHandler.init(&node.linkQuality, &node.bulkTransfer);
+		node.modelMulticast.registerMsgHandler([&node](const MeshUtil::cs_mesh_received_msg_t& msg, cs_result_t& result) -> void {
+			node.msgHandler.handleMsg(msg, result);
+		});
+		node.modelMulticast.init(0);
+		node.modelMulticastAcked.registerMsgHandler([&node](const MeshUtil::cs_mesh_received_msg_t& msg, cs_result_t& result) -> void {
+			node.msgHandler.handleMsg(msg, result);
+		});
+		node.modelMulticastAcked.init(1);
+		node.modelUnicast.registerMsgHandler([&node](const MeshUtil::cs_mesh_received_msg_t& msg, cs_result_t& result) -> void {
+			node.msgHandler.handleMsg(msg, result);
+		});
+		node.modelUnicast.init(2);
+		dsm_handle_t appkeyHandle = 0;
+		node.modelMulticast.configureSelf(appkeyHandle);
+		node.modelMulticastAcked.configureSelf(appkeyHandle);
+		node.modelUnicast.configureSelf(appkeyHandle);
+		node.modelMulticast.setTelemetry(&node.telemetry);
+		node.modelMulticastAcked.setTelemetry(&node.telemetry);
+		node.modelUnicast.setTelemetry(&node.telemetry);
+		node.modelSelector.init(&node.modelMulticast, &node.modelMulticastAcked, &node.modelUnicast);
+		node.msgSender.init(&node.modelSelector, &node.linkQuality);
+		node.bulkTransfer.init(&node.modelSelector, random(0x100));
+	}
+}
+
+MeshSim::~MeshSim() {
+	_nodes.clear();
+	_instance = nullptr;
+}
+
+uint32_t MeshSim::random(uint32_t max) {
+	// Xorshift, so that results don't depend on the standard library.
+	_randomState ^= _randomState << 13;
+	_randomState ^= _randomState >> 17;
+	_randomState ^= _randomState << 5;
+	return max == 0 ? 0 : _randomState % max;
+}
+
+bool MeshSim::randomPercentage(uint8_t percentage) {
+	return random(100) < percentage;
+}
+
+void MeshSim::setLink(uint16_t nodeA, uint16_t nodeB, uint8_t lossPercentage, uint16_t latencyMs, int8_t rssi) {
+	if (latencyMs == 0) {
+		latencyMs = 1;
+	}
+	setDirectedLink(nodeA, {nodeB, lossPercentage, latencyMs, rssi});
+	setDirectedLink(nodeB, {nodeA, lossPercentage, latencyMs, rssi});
+}
+
+void MeshSim::setDirectedLink(uint16_t node, const link_t& link) {
+	for (auto& existing: _links[node]) {
+		if (existing.to == link.to) {
+			existing = link;
+			return;
+		}
+	}
+	_links[node].push_back(link);
+}
+
+void MeshSim::setGridTopology(uint16_t columns, float range, uint8_t minLossPercentage, uint8_t maxLossPercentage) {
+	for (auto& links: _links) {
+		links.clear();
+	}
+	for (uint16_t a = 0; a < _nodes.size(); ++a) {
+		for (uint16_t b = a + 1; b < _nodes.size(); ++b) {
+			float dx = (float)(a % columns) - (float)(b % columns);
+			float dy = (float)(a / columns) - (float)(b / columns);
+			float distance = sqrtf(dx * dx + dy * dy);
+			if (distance > range) {
+				continue;
+			}
+			uint8_t loss = minLossPercentage + (uint8_t)((maxLossPercentage - minLossPercentage) * distance / range);
+			int8_t rssi = -50 - (int8_t)(40 * distance / range);
+			setLink(a, b, loss, 1, rssi);
+		}
+	}
+}
+
+void MeshSim::setCollisionPercentage(uint8_t collisionPercentage) {
+	_collisionPercentage = collisionPercentage;
+}
+
+void MeshSim::setAdaptiveTransmissions(bool enable) {
+	for (auto& node: _nodes) {
+		node->linkQuality.setAdaptive(enable);
+	}
+}
+
+void MeshSim::setRelaySuppression(bool enable) {
+	for (auto& node: _nodes) {
+		node->linkQuality.setRelaySuppression(enable);
+	}
+}
+
+mesh_sim_node_stats_t& MeshSim::getNodeStats(uint16_t node) {
+	return _nodes[node]->stats;
+}
+
+cs_mesh_telemetry_t& MeshSim::getTelemetry(uint16_t node) {
+	return _nodes[node]->telemetry.getStats();
+}
+
+MeshLinkQuality& MeshSim::getLinkQuality(uint16_t node) {
+	return _nodes[node]->linkQuality;
+}
+
+uint32_t MeshSim::newMsg(uint16_t node, MeshSimMsgClass msgClass, const std::vector<uint16_t>& targets) {
+	uint32_t key = _nextMsgKey++;
+	mesh_sim_msg_t& msg = _msgs[key];
+	msg.msgClass = msgClass;
+	msg.sentMs = _timeMs;
+	msg.pending.resize(_nodes.size(), false);
+	mesh_sim_msg_stats_t& stats = _msgStats[msgClass];
+	stats.sent++;
+	for (auto target: targets) {
+		if (target != node && !msg.pending[target]) {
+			msg.pending[target] = true;
+			stats.expectedDeliveries++;
+		}
+	}
+	return key;
+}
+
+void MeshSim::onDelivered(uint32_t key) {
+	auto iter = _msgs.find(key);
+	if (iter == _msgs.end() || _currentNode < 0 || !iter->second.pending[_currentNode]) {
+		return;
+	}
+	iter->second.pending[_currentNode] = false;
+	mesh_sim_msg_stats_t& stats = _msgStats[iter->second.msgClass];
+	stats.deliveries++;
+	stats.latency.add(_timeMs - iter->second.sentMs);
+}
+
+void MeshSim::sendMulticast(uint16_t node) {
+	// The key is the queue ID of a profile location message, so it should fit in 16 bits.
+	uint32_t key = _nextMsgKey;
+	cs_mesh_model_msg_profile_location_t packet;
+	packet.profile = key & 0xFF;
+	packet.location = (key >> 8) & 0xFF;
+
+	MeshSimCurrentNode currentNode(this, node);
+	cs_ret_code_t retCode = _nodes[node]->msgSender.sendProfileLocation(&packet);
+	if (retCode != ERR_SUCCESS) {
+		_nodes[node]->stats.rejected++;
+		return;
+	}
+	std::vector<uint16_t> targets;
+	for (uint16_t i = 0; i < _nodes.size(); ++i) {
+		targets.push_back(i);
+	}
+	newMsg(node, MESH_SIM_MSG_MULTICAST, targets);
+}
+
+void MeshSim::sendSetTime(uint16_t node) {
+	uint32_t key = _nextMsgKey;
+	cs_mesh_model_msg_time_t packet;
+	packet.timestamp = key;
+
+	MeshSimCurrentNode currentNode(this, node);
+	cs_ret_code_t retCode = _nodes[node]->msgSender.sendSetTime(&packet);
+	if (retCode != ERR_SUCCESS) {
+		_nodes[node]->stats.rejected++;
+		return;
+	}
+	std::vector<uint16_t> targets;
+	for (uint16_t i = 0; i < _nodes.size(); ++i) {
+		targets.push_back(i);
+	}
+	newMsg(node, MESH_SIM_MSG_MULTICAST, targets);
+}
+
+void MeshSim::sendMulticastAcked(uint16_t node, const std::vector<uint16_t>& targets) {
+	uint32_t key = _nextMsgKey;
+	set_ibeacon_config_id_packet_t payload;
+	payload.ibeaconConfigId = 0;
+	payload.config.timestamp = key;
+	payload.config.interval = 0;
+
+	std::vector<stone_id_t> stoneIds;
+	for (auto target: targets) {
+		stoneIds.push_back(_nodes[target]->id);
+	}
+
+	TYPIFY(CMD_SEND_MESH_CONTROL_COMMAND) meshCommand;
+	meshCommand.header.type = 0;
+	meshCommand.header.flags.asInt = 0;
+	meshCommand.header.flags.flags.broadcast = true;
+	meshCommand.header.flags.flags.reliable = true;
+	meshCommand.header.timeoutOrTransmissions = 0;
+	meshCommand.header.idCount = stoneIds.size();
+	meshCommand.targetIds = stoneIds.data();
+	meshCommand.controlCommand.type = CTRL_CMD_SET_IBEACON_CONFIG_ID;
+	meshCommand.controlCommand.data = (buffer_ptr_t)&payload;
+	meshCommand.controlCommand.size = sizeof(payload);
+	meshCommand.controlCommand.accessLevel = ADMIN;
+
+	MeshSimCurrentNode currentNode(this, node);
+	event_t event(CS_TYPE::CMD_SEND_MESH_CONTROL_COMMAND, &meshCommand, sizeof(meshCommand), cmd_source_with_counter_t(CS_CMD_SOURCE_UART));
+	_nodes[node]->msgSender.handleEvent(event);
+	if (event.result.returnCode != ERR_SUCCESS) {
+		_nodes[node]->stats.rejected++;
+		return;
+	}
+	newMsg(node, MESH_SIM_MSG_MULTICAST_ACKED, targets);
+}
+
+void MeshSim::sendUnicast(uint16_t node, uint16_t target) {
+	uint32_t key = _nextMsgKey;
+	uint8_t payload[sizeof(state_packet_header_t) + sizeof(key)];
+	state_packet_header_t* stateHeader = (state_packet_header_t*)payload;
+	stateHeader->stateType = to_underlying_type(CS_TYPE::STATE_SWITCH_STATE);
+	stateHeader->stateId = 0;
+	stateHeader->persistenceMode = 0;
+	stateHeader->reserved = 0;
+	memcpy(payload + sizeof(state_packet_header_t), &key, sizeof(key));
+
+	stone_id_t stoneId = _nodes[target]->id;
+	TYPIFY(CMD_SEND_MESH_CONTROL_COMMAND) meshCommand;
+	meshCommand.header.type = 0;
+	meshCommand.header.flags.asInt = 0;
+	meshCommand.header.flags.flags.broadcast = false;
+	meshCommand.header.flags.flags.reliable = true;
+	meshCommand.header.timeoutOrTransmissions = 0;
+	meshCommand.header.idCount = 1;
+	meshCommand.targetIds = &stoneId;
+	meshCommand.controlCommand.type = CTRL_CMD_STATE_SET;
+	meshCommand.controlCommand.data = payload;
+	meshCommand.controlCommand.size = sizeof(payload);
+	meshCommand.controlCommand.accessLevel = ADMIN;
+
+	MeshSimCurrentNode currentNode(this, node);
+	event_t event(CS_TYPE::CMD_SEND_MESH_CONTROL_COMMAND, &meshCommand, sizeof(meshCommand), cmd_source_with_counter_t(CS_CMD_SOURCE_UART));
+	_nodes[node]->msgSender.handleEvent(event);
+	if (event.result.returnCode != ERR_SUCCESS) {
+		_nodes[node]->stats.rejected++;
+		return;
+	}
+	newMsg(node, MESH_SIM_MSG_UNICAST, {target});
+}
+
+uint8_t MeshSim::getBulkByte(uint16_t node, uint16_t index) {
+	return (uint8_t)(node * 31 + index * 7 + (index >> 8));
+}
+
+uint16_t MeshSim::sendBulk(uint16_t node, uint16_t target, uint16_t size) {
+	std::vector<uint8_t> data(size);
+	for (uint16_t i = 0; i < size; ++i) {
+		data[i] = getBulkByte(node, i);
+	}
+	MeshSimCurrentNode currentNode(this, node);
+	cs_ret_code_t retCode = _nodes[node]->bulkTransfer.send(_nodes[target]->id, 0, cs_data_t(data.data(), size));
+	if (retCode != ERR_SUCCESS) {
+		_nodes[node]->stats.rejected++;
+		return retCode;
+	}
+	mesh_sim_bulk_transfer_t& transfer = _bulkTransfers[node];
+	transfer = mesh_sim_bulk_transfer_t();
+	transfer.target = target;
+	transfer.size = size;
+	transfer.startMs = _timeMs;
+	return retCode;
+}
+
+void MeshSim::rebootBulkTransfer(uint16_t node, uint8_t firstTransferId) {
+	MeshSimNode& simNode = *_nodes[node];
+	simNode.bulkTransfer = MeshBulkTransfer();
+	simNode.bulkTransfer.init(&simNode.modelSelector, firstTransferId);
+	_bulkTransfers.erase(node);
+}
+
+void MeshSim::run(uint32_t durationMs) {
+	uint32_t endMs = _timeMs + durationMs;
+	for (; _timeMs < endMs; ++_timeMs) {
+		for (uint16_t i = 0; i < _nodes.size(); ++i) {
+			if ((_timeMs + _nodes[i]->tickPhaseMs) % TICK_INTERVAL_MS == 0) {
+				tickNode(i);
+			}
+		}
+		for (auto& model: _models) {
+			if (model->reliableActive) {
+				checkReliable(*model);
+			}
+		}
+		for (uint16_t i = 0; i < _nodes.size(); ++i) {
+			MeshSimNode& node = *_nodes[i];
+			if (!node.radioQueue.empty() && _timeMs >= node.nextTxMs) {
+				transmit(i);
+			}
+		}
+		receiveAll(_timeMs);
+	}
+}
+
+void MeshSim::tickNode(uint16_t nodeIndex) {
+	MeshSimNode& node = *_nodes[nodeIndex];
+	MeshSimCurrentNode currentNode(this, nodeIndex);
+	TYPIFY(EVT_TICK) tickCount = node.tickCount++;
+	event_t event(CS_TYPE::EVT_TICK, &tickCount, sizeof(tickCount));
+	node.msgSender.handleEvent(event);
+	node.modelMulticast.tick(tickCount);
+	node.modelMulticastAcked.tick(tickCount);
+	node.modelUnicast.tick(tickCount);
+	node.msgHandler.tick(tickCount);
+	node.linkQuality.tick(tickCount);
+	node.bulkTransfer.tick(tickCount);
+	node.telemetry.tick(tickCount);
+
+	uint8_t numQueued = node.getNumQueued();
+	node.stats.queueSum += numQueued;
+	node.stats.queueSamples++;
+	if (numQueued > node.stats.queueMax) {
+		node.stats.queueMax = numQueued;
+	}
+	uint16_t radioQueueSize = node.radioQueue.size();
+	node.stats.radioQueueSum += radioQueueSize;
+	node.stats.radioQueueSamples++;
+	if (radioQueueSize > node.stats.radioQueueMax) {
+		node.stats.radioQueueMax = radioQueueSize;
+	}
+}
+
+void MeshSim::enqueue(uint16_t nodeIndex, const mesh_sim_packet_t& packet) {
+	MeshSimNode& node = *_nodes[nodeIndex];
+	if (node.radioQueue.size() >= MESH_SIM_RADIO_QUEUE_SIZE) {
+		node.stats.radioDropped++;
+		return;
+	}
+	node.radioQueue.push_back(packet);
+}
+
+void MeshSim::transmit(uint16_t nodeIndex) {
+	MeshSimNode& node = *_nodes[nodeIndex];
+	mesh_sim_packet_t packet = node.radioQueue.front();
+	node.radioQueue.pop_front();
+	node.nextTxMs = _timeMs + MESH_SIM_TX_INTERVAL_MS + random(MESH_SIM_TX_JITTER_MS + 1);
+	node.lastTxMs = _timeMs;
+	uint32_t numBytes = MESH_SIM_PACKET_OVERHEAD + 3 + packet.data.size();
+	node.stats.airtimeUs += numBytes * 8 * MESH_SIM_NUM_CHANNELS;
+
+	for (auto& link: _links[nodeIndex]) {
+		if (randomPercentage(link.lossPercentage)) {
+			continue;
+		}
+		_receptions[_timeMs + link.latencyMs].push_back({link.to, link.rssi, packet});
+	}
+}
+
+void MeshSim::receiveAll(uint32_t timeMs) {
+	auto iter = _receptions.find(timeMs);
+	if (iter == _receptions.end()) {
+		return;
+	}
+	std::vector<mesh_sim_reception_t> receptions;
+	receptions.swap(iter->second);
+	_receptions.erase(iter);
+
+	std::vector<uint16_t> numReceptions(_nodes.size(), 0);
+	for (auto& reception: receptions) {
+		numReceptions[reception.node]++;
+	}
+	for (auto& reception: receptions) {
+		MeshSimNode& node = *_nodes[reception.node];
+		if (node.lastTxMs == (int64_t)timeMs) {
+			continue;
+		}
+		if (numReceptions[reception.node] > 1 && randomPercentage(_collisionPercentage)) {
+			continue;
+		}
+		receive(reception.node, reception.rssi, reception.packet);
+	}
+}
+
+void MeshSim::receive(uint16_t nodeIndex, int8_t rssi, const mesh_sim_packet_t& packet) {
+	MeshSimNode& node = *_nodes[nodeIndex];
+	if (!node.seenPackets.insert(packet.id).second) {
+		return;
+	}
+	if (packet.ttl > 1 && packet.dstAddress != node.id) {
+		if (node.linkQuality.shouldRelay(packet.srcAddress, ACCESS_DEFAULT_TTL - packet.ttl, random(256))) {
+			mesh_sim_packet_t relayed = packet;
+			relayed.ttl--;
+			node.stats.relayedPackets++;
+			enqueue(nodeIndex, relayed);
+		}
+		else {
+			node.stats.suppressedRelays++;
+		}
+	}
+	deliver(nodeIndex, rssi, packet);
+}
+
+void MeshSim::deliver(uint16_t nodeIndex, int8_t rssi, const mesh_sim_packet_t& packet) {
+	MeshSimNode& node = *_nodes[nodeIndex];
+	bool isGroup = packet.dstAddress >= 0xC000;
+	if (!isGroup && packet.dstAddress != node.id) {
+		return;
+	}
+	MeshSimCurrentNode currentNode(this, nodeIndex);
+	for (uint16_t handle = 0; handle < _models.size(); ++handle) {
+		MeshSimModel& model = *_models[handle];
+		if (model.node != nodeIndex || model.modelId.model_id != packet.modelId) {
+			continue;
+		}
+		const access_opcode_handler_t* handler = model.findHandler(packet.opcode);
+		if (handler == nullptr) {
+			continue;
+		}
+		nrf_mesh_rx_metadata_t coreMetaData;
+		coreMetaData.source = NRF_MESH_RX_SOURCE_SCANNER;
+		coreMetaData.params.scanner.rssi = rssi;
+
+		access_message_rx_t msg;
+		msg.opcode = handler->opcode;
+		msg.p_data = packet.data.data();
+		msg.length = packet.data.size();
+		msg.meta_data.src = {NRF_MESH_ADDRESS_TYPE_UNICAST, packet.srcAddress, nullptr};
+		msg.meta_data.dst = {isGroup ? NRF_MESH_ADDRESS_TYPE_GROUP : NRF_MESH_ADDRESS_TYPE_UNICAST, packet.dstAddress, nullptr};
+		msg.meta_data.ttl = packet.ttl;
+		msg.meta_data.appkey_handle = 0;
+		msg.meta_data.subnet_handle = 0;
+		msg.meta_data.p_core_metadata = &coreMetaData;
+		handler->handler(handle, &msg, model.args);
+
+		if (model.reliableActive
+				&& model.reliable.reply_opcode.opcode == packet.opcode
+				&& model.reliableDstAddress == packet.srcAddress) {
+			model.reliableActive = false;
+			model.reliable.status_cb(handle, model.args, ACCESS_RELIABLE_TRANSFER_SUCCESS);
+		}
+	}
+}
+
+void MeshSim::checkReliable(MeshSimModel& model) {
+	uint16_t handle = model.reliable.model_handle;
+	if (_timeMs >= model.reliableDeadlineMs) {
+		MeshSimCurrentNode currentNode(this, model.node);
+		model.reliableActive = false;
+		model.reliable.status_cb(handle, model.args, ACCESS_RELIABLE_TRANSFER_TIMEOUT);
+		return;
+	}
+	if (_timeMs >= model.reliableNextRetryMs) {
+		model.reliableNextRetryMs += MESH_SIM_RELIABLE_RETRY_INTERVAL_MS;
+		publish(handle, model.reliableDstAddress, model.reliable.message.opcode.opcode, model.reliableData.data(), model.reliableData.size());
+	}
+}
+
+uint16_t MeshSim::addModel(MeshSimModel* model) {
+	_models.emplace_back(model);
+	return _models.size() - 1;
+}
+
+MeshSimModel* MeshSim::getModel(uint16_t handle) {
+	if (handle >= _models.size()) {
+		return nullptr;
+	}
+	return _models[handle].get();
+}
+
+uint16_t MeshSim::addAddress(uint16_t address) {
+	for (uint16_t i = 0; i < _addresses.size(); ++i) {
+		if (_addresses[i] == address) {
+			return i;
+		}
+	}
+	_addresses.push_back(address);
+	return _addresses.size() - 1;
+}
+
+uint16_t MeshSim::getAddress(uint16_t handle) {
+	return _addresses[handle];
+}
+
+void MeshSim::publish(uint16_t handle, uint16_t dstAddress, uint16_t opcode, const uint8_t* data, uint16_t size) {
+	MeshSimModel& model = *_models[handle];
+	MeshSimNode& node = *_nodes[model.node];
+	mesh_sim_packet_t packet;
+	packet.id = _nextPacketId++;
+	packet.srcAddress = node.id;
+	packet.dstAddress = dstAddress;
+	packet.ttl = ACCESS_DEFAULT_TTL;
+	packet.modelId = model.modelId.model_id;
+	packet.opcode = opcode;
+	packet.data.assign(data, data + size);
+	node.seenPackets.insert(packet.id);
+	node.stats.txPackets++;
+	enqueue(model.node, packet);
+}
+
+uint16_t MeshSim::getCurrentStoneId() {
+	if (_currentNode < 0) {
+		return 0;
+	}
+	return _nodes[_currentNode]->id;
+}
+
+void MeshSim::onUartMsg(uint16_t opCode, const uint8_t* data, uint16_t size) {
+	if (opCode != UART_OPCODE_TX_MESH_ACK_ALL_RESULT || _currentNode < 0 || size < sizeof(result_packet_header_t)) {
+		return;
+	}
+	const result_packet_header_t* result = (const result_packet_header_t*)data;
+	if (result->returnCode == ERR_SUCCESS) {
+		_nodes[_currentNode]->stats.ackedSuccess++;
+	}
+	else {
+		_nodes[_currentNode]->stats.ackedTimeout++;
+	}
+}
+
+bool MeshSim::onEvent(uint16_t type, const void* data, uint16_t size) {
+	switch ((CS_TYPE)type) {
+		case CS_TYPE::EVT_PROFILE_LOCATION: {
+			const TYPIFY(EVT_PROFILE_LOCATION)* packet = (const TYPIFY(EVT_PROFILE_LOCATION)*)data;
+			onDelivered((packet->locationId << 8) + packet->profileId);
+			return false;
+		}
+		case CS_TYPE::CMD_SET_TIME: {
+			onDelivered(*(const TYPIFY(CMD_SET_TIME)*)data);
+			return false;
+		}
+		case CS_TYPE::CMD_SET_IBEACON_CONFIG_ID: {
+			const TYPIFY(CMD_SET_IBEACON_CONFIG_ID)* packet = (const TYPIFY(CMD_SET_IBEACON_CONFIG_ID)*)data;
+			onDelivered(packet->config.timestamp);
+			return true;
+		}
+		case CS_TYPE::CMD_CONTROL_CMD: {
+			const TYPIFY(CMD_CONTROL_CMD)* packet = (const TYPIFY(CMD_CONTROL_CMD)*)data;
+			if (packet->type == CTRL_CMD_STATE_SET && packet->size >= sizeof(state_packet_header_t) + sizeof(uint32_t)) {
+				uint32_t key;
+				memcpy(&key, packet->data + sizeof(state_packet_header_t), sizeof(key));
+				onDelivered(key);
+			}
+			return true;
+		}
+		case CS_TYPE::EVT_MESH_BULK_TRANSFER_RECEIVED: {
+			const TYPIFY(EVT_MESH_BULK_TRANSFER_RECEIVED)* received = (const TYPIFY(EVT_MESH_BULK_TRANSFER_RECEIVED)*)data;
+			uint16_t node = received->stoneId - 1;
+			auto iter = _bulkTransfers.find(node);
+			if (iter == _bulkTransfers.end() || iter->second.target != _currentNode) {
+				return false;
+			}
+			mesh_sim_bulk_transfer_t& transfer = iter->second;
+			transfer.received = true;
+			transfer.receivedMs = _timeMs;
+			transfer.receivedCorrect = (received->data.len == transfer.size);
+			for (uint16_t i = 0; transfer.receivedCorrect && i < transfer.size; ++i) {
+				transfer.receivedCorrect = (received->data.data[i] == getBulkByte(node, i));
+			}
+			return false;
+		}
+		case CS_TYPE::EVT_MESH_BULK_TRANSFER_RESULT: {
+			const TYPIFY(EVT_MESH_BULK_TRANSFER_RESULT)* result = (const TYPIFY(EVT_MESH_BULK_TRANSFER_RESULT)*)data;
+			mesh_sim_bulk_transfer_t& transfer = _bulkTransfers[_currentNode];
+			transfer.done = true;
+			transfer.returnCode = result->returnCode;
+			transfer.doneMs = _timeMs;
+			MeshBulkTransfer::cs_mesh_bulk_transfer_stats_t& stats = _nodes[_currentNode]->bulkTransfer.getStats();
+			transfer.chunksSent = stats.chunksSent;
+			transfer.chunksResent = stats.chunksResent;
+			transfer.ackRequests = stats.ackRequests;
+			transfer.ackTimeouts = stats.ackTimeouts;
+			return false;
+		}
+		default:
+			return false;
+	}
+}
+
+void MeshSim::printReport(const char* name) {
+	printf("%s: %u nodes, %u ms\n", name, (unsigned)_nodes.size(), _timeMs);
+	const char* classNames[MESH_SIM_MSG_CLASS_COUNT] = {"multicast", "multicast acked", "unicast"};
+	for (int i = 0; i < MESH_SIM_MSG_CLASS_COUNT; ++i) {
+		mesh_sim_msg_stats_t& stats = _msgStats[i];
+		printf("  %-16s sent=%-5u delivered=%u/%u (%.1f%%)\n", classNames[i], stats.sent, stats.deliveries, stats.expectedDeliveries, stats.getDeliveryRatio() * 100);
+		stats.latency.print("  latency");
+	}
+
+	uint64_t airtimeSum = 0;
+	uint64_t airtimeMax = 0;
+	uint32_t txSum = 0;
+	uint32_t relayedSum = 0;
+	uint32_t suppressedSum = 0;
+	uint32_t rejectedSum = 0;
+	uint32_t droppedSum = 0;
+	uint32_t ackedSuccess = 0;
+	uint32_t ackedTimeout = 0;
+	uint64_t queueSum = 0;
+	uint64_t queueSamples = 0;
+	uint8_t queueMax = 0;
+	uint64_t radioQueueSum = 0;
+	uint64_t radioQueueSamples = 0;
+	uint16_t radioQueueMax = 0;
+	for (auto& node: _nodes) {
+		mesh_sim_node_stats_t& stats = node->stats;
+		airtimeSum += stats.airtimeUs;
+		airtimeMax = std::max(airtimeMax, stats.airtimeUs);
+		txSum += stats.txPackets;
+		relayedSum += stats.relayedPackets;
+		suppressedSum += stats.suppressedRelays;
+		rejectedSum += stats.rejected;
+		droppedSum += stats.radioDropped;
+		ackedSuccess += stats.ackedSuccess;
+		ackedTimeout += stats.ackedTimeout;
+		queueSum += stats.queueSum;
+		queueSamples += stats.queueSamples;
+		queueMax = std::max(queueMax, stats.queueMax);
+		radioQueueSum += stats.radioQueueSum;
+		radioQueueSamples += stats.radioQueueSamples;
+		radioQueueMax = std::max(radioQueueMax, stats.radioQueueMax);
+	}
+	float durationUs = _timeMs * 1000.0f;
+	printf("  packets: originated=%u relayed=%u suppressed=%u radio dropped=%u rejected msgs=%u\n", txSum, relayedSum, suppressedSum, droppedSum, rejectedSum);
+	printf("  acked results: success=%u timeout=%u\n", ackedSuccess, ackedTimeout);
+	printf("  model queue: avg=%.2f max=%u\n", queueSamples ? (float)queueSum / queueSamples : 0.0f, queueMax);
+	printf("  radio queue: avg=%.2f max=%u\n", radioQueueSamples ? (float)radioQueueSum / radioQueueSamples : 0.0f, radioQueueMax);
+	printf("  airtime per node: avg=%.2f%% max=%.2f%%\n", airtimeSum * 100.0f / _nodes.size() / durationUs, airtimeMax * 100.0f / durationUs);
+}
+
+/*
+ * Stub of the mesh SDK access layer.
+ */
+
+uint32_t access_model_add(const access_model_add_params_t* p_model_params, access_model_handle_t* p_model_handle) {
+	MeshSim* sim = MeshSim::getInstance();
+	MeshSimModel* model = new MeshSimModel();
+	model->node = sim->getCurrentStoneId() - 1;
+	model->modelId = p_model_params->model_id;
+	model->handlers = p_model_params->p_opcode_handlers;
+	model->numHandlers = p_model_params->opcode_count;
+	model->args = p_model_params->p_args;
+	*p_model_handle = sim->addModel(model);
+	return NRF_SUCCESS;
+}
+
+uint32_t access_model_subscription_list_alloc(access_model_handle_t handle) {
+	return NRF_SUCCESS;
+}
+
+uint32_t access_model_application_bind(access_model_handle_t handle, dsm_handle_t appkey_handle) {
+	return NRF_SUCCESS;
+}
+
+uint32_t access_model_publish_application_set(access_model_handle_t handle, dsm_handle_t appkey_handle) {
+	return NRF_SUCCESS;
+}
+
+uint32_t access_model_publish_address_set(access_model_handle_t handle, dsm_handle_t address_handle) {
+	MeshSimModel* model = MeshSim::getInstance()->getModel(handle);
+	if (model == nullptr) {
+		return NRF_ERROR_NOT_FOUND;
+	}
+	model->publishAddressHandle = address_handle;
+	return NRF_SUCCESS;
+}
+
+uint32_t access_model_subscription_add(access_model_handle_t handle, dsm_handle_t address_handle) {
+	// Every node receives every group address.
+	return NRF_SUCCESS;
+}
+
+uint32_t access_model_publish(access_model_handle_t handle, const access_message_tx_t* p_message) {
+	MeshSim* sim = MeshSim::getInstance();
+	MeshSimModel* model = sim->getModel(handle);
+	if (model == nullptr) {
+		return NRF_ERROR_NOT_FOUND;
+	}
+	if (model->publishAddressHandle == DSM_HANDLE_INVALID) {
+		return NRF_ERROR_INVALID_STATE;
+	}
+	sim->publish(handle, sim->getAddress(model->publishAddressHandle), p_message->opcode.opcode, p_message->p_buffer, p_message->length);
+	return NRF_SUCCESS;
+}
+
+uint32_t access_model_reply(access_model_handle_t handle, const access_message_rx_t* p_message, const access_message_tx_t* p_reply) {
+	MeshSim* sim = MeshSim::getInstance();
+	if (sim->getModel(handle) == nullptr) {
+		return NRF_ERROR_NOT_FOUND;
+	}
+	sim->publish(handle, p_message->meta_data.src.value, p_reply->opcode.opcode, p_reply->p_buffer, p_reply->length);
+	return NRF_SUCCESS;
+}
+
+bool access_reliable_model_is_free(access_model_handle_t model_handle) {
+	MeshSimModel* model = MeshSim::getInstance()->getModel(model_handle);
+	return model != nullptr && !model->reliableActive;
+}
+
+uint32_t access_model_reliable_publish(const access_reliable_t* p_reliable) {
+	MeshSim* sim = MeshSim::getInstance();
+	MeshSimModel* model = sim->getModel(p_reliable->model_handle);
+	if (model == nullptr) {
+		return NRF_ERROR_NOT_FOUND;
+	}
+	if (model->reliableActive) {
+		return NRF_ERROR_INVALID_STATE;
+	}
+	if (model->publishAddressHandle == DSM_HANDLE_INVALID) {
+		return NRF_ERROR_INVALID_STATE;
+	}
+	if (p_reliable->timeout < ACCESS_RELIABLE_TIMEOUT_MIN || p_reliable->timeout > ACCESS_RELIABLE_TIMEOUT_MAX) {
+		return NRF_ERROR_INVALID_PARAM;
+	}
+	model->reliableActive = true;
+	model->reliable = *p_reliable;
+	model->reliableData.assign(p_reliable->message.p_buffer, p_reliable->message.p_buffer + p_reliable->message.length);
+	model->reliable.message.p_buffer = model->reliableData.data();
+	model->reliableDstAddress = sim->getAddress(model->publishAddressHandle);
+	model->reliableDeadlineMs = sim->getTime() + p_reliable->timeout / 1000;
+	model->reliableNextRetryMs = sim->getTime() + MESH_SIM_RELIABLE_RETRY_INTERVAL_MS;
+	sim->publish(p_reliable->model_handle, model->reliableDstAddress, p_reliable->message.opcode.opcode, model->reliableData.data(), model->reliableData.size());
+	return NRF_SUCCESS;
+}
+
+uint32_t dsm_address_publish_add(uint16_t raw_address, dsm_handle_t* p_address_handle) {
+	*p_address_handle = MeshSim::getInstance()->addAddress(raw_address);
+	return NRF_SUCCESS;
+}
+
+uint32_t dsm_address_publish_remove(dsm_handle_t address_handle) {
+	// Address handles are shared between nodes, so they're never removed.
+	return NRF_SUCCESS;
+}
+
+uint32_t dsm_address_subscription_add_handle(dsm_handle_t address_handle) {
+	return NRF_SUCCESS;
+}
+
+nrf_mesh_tx_token_t nrf_mesh_unique_token_get(void) {
+	static nrf_mesh_tx_token_t token = 0;
+	return ++token;
+}
+
+/*
+ * Stub of State and UartProtocol.
+ */
+
+cs_ret_code_t State::get(const CS_TYPE type, void *value, const size16_t size) {
+	memset(value, 0, size);
+	if (type == CS_TYPE::CONFIG_CROWNSTONE_ID && size >= sizeof(TYPIFY(CONFIG_CROWNSTONE_ID))) {
+		*((TYPIFY(CONFIG_CROWNSTONE_ID)*)value) = MeshSim::getInstance()->getCurrentStoneId();
+	}
+	return ERR_SUCCESS;
+}
+
+cs_ret_code_t State::set(const CS_TYPE type, void *value, const size16_t size) {
+	return ERR_SUCCESS;
+}
+
+void UartProtocol::writeMsg(UartOpcodeTx opCode, uint8_t * data, uint16_t size) {
+	MeshSim::getInstance()->onUartMsg(opCode, data, size);
+}
+
+void UartProtocol::writeMsgStart(UartOpcodeTx opCode, uint16_t size) {
+}
+
+void UartProtocol::writeMsgPart(UartOpcodeTx opCode, uint8_t * data, uint16_t size) {
+}
+
+void UartProtocol::writeMsgEnd(UartOpcodeTx opCode) {
+}
@@ -0,0 +1,385 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+/**
+ * Interval at which a node transmits the next packet of its radio queue, like the advertiser of the mesh SDK.
+ */
+#define MESH_SIM_TX_INTERVAL_MS 20
+
+/**
+ * Max random delay added to each transmission.
+ */
+#define MESH_SIM_TX_JITTER_MS 10
+
+/**
+ * Number of packets that fit in the radio queue of a node.
+ */
+#define MESH_SIM_RADIO_QUEUE_SIZE 32
+
+/**
+ * RSSI of links that are set without RSSI.
+ */
+#define MESH_SIM_RSSI_DEFAULT -70
+
+/**
+ * Interval at which the stub access layer retransmits a reliable message, until it's replied to.
+ */
+#define MESH_SIM_RELIABLE_RETRY_INTERVAL_MS 500
+
+/**
+ * Histogram of latencies, with buckets of fixed width.
+ */
+class MeshSimHistogram {
+public:
+	MeshSimHistogram(uint32_t bucketWidthMs = 50, uint16_t numBuckets = 400);
+
+	void add(uint32_t valueMs);
+
+	uint32_t getCount() {
+		return _count;
+	}
+
+	uint32_t getMax() {
+		return _max;
+	}
+
+	/**
+	 * Get the upper bound of the bucket that contains the given percentile.
+	 */
+	uint32_t getPercentile(uint8_t percentile);
+
+	void print(const char* name);
+
+private:
+	uint32_t _bucketWidthMs;
+	std::vector<uint32_t> _buckets;
+	uint32_t _count = 0;
+	uint32_t _max = 0;
+};
+
+/**
+ * Statistics of a single simulated node.
+ */
+struct mesh_sim_node_stats_t {
+	//! Number of packets this node originated.
+	uint32_t txPackets = 0;
+	//! Number of packets this node relayed.
+	uint32_t relayedPackets = 0;
+	//! Number of packets this node did not relay, because of relay suppression.
+	uint32_t suppressedRelays = 0;
+	//! Time spent transmitting, in us.
+	uint64_t airtimeUs = 0;
+	//! Number of messages the mesh queues did not accept.
+	uint32_t rejected = 0;
+	//! Sum, number of samples, and max of the number of messages in the mesh model queues.
+	uint32_t queueSum = 0;
+	uint32_t queueSamples = 0;
+	uint8_t queueMax = 0;
+	//! Sum, number of samples, and max of the number of packets waiting for the radio.
+	uint32_t radioQueueSum = 0;
+	uint32_t radioQueueSamples = 0;
+	uint16_t radioQueueMax = 0;
+	//! Number of packets dropped, because the radio queue was full.
+	uint32_t radioDropped = 0;
+	//! Number of acked messages that were acked by all targets, or timed out.
+	uint32_t ackedSuccess = 0;
+	uint32_t ackedTimeout = 0;
+};
+
+/**
+ * Classes of messages that the simulator sends and keeps up statistics of.
+ */
+enum MeshSimMsgClass {
+	//! Unacked multicast: a profile location or set time message, expected to be received by all other nodes.
+	MESH_SIM_MSG_MULTICAST = 0,
+	//! Acked multicast: a set ibeacon config command, expected to be received by the targets.
+	MESH_SIM_MSG_MULTICAST_ACKED,
+	//! Acked unicast: a state set command, expected to be received by the target.
+	MESH_SIM_MSG_UNICAST,
+	MESH_SIM_MSG_CLASS_COUNT
+};
+
+/**
+ * Statistics of a class of messages.
+ */
+struct mesh_sim_msg_stats_t {
+	uint32_t sent = 0;
+	uint32_t expectedDeliveries = 0;
+	uint32_t deliveries = 0;
+	MeshSimHistogram latency;
+
+	float getDeliveryRatio() {
+		return expectedDeliveries == 0 ? 1.0f : (float)deliveries / expectedDeliveries;
+	}
+};
+
+/**
+ * Packet on the simulated radio: a mesh network packet with an access message.
+ */
+struct mesh_sim_packet_t {
+	//! Unique ID, used by nodes to only relay a packet once.
+	uint32_t id;
+	uint16_t srcAddress;
+	uint16_t dstAddress;
+	uint8_t ttl;
+	uint16_t modelId;
+	uint16_t opcode;
+	std::vector<uint8_t> data;
+};
+
+struct mesh_sim_reception_t {
+	uint16_t node;
+	int8_t rssi;
+	mesh_sim_packet_t packet;
+};
+
+/**
+ * Message sent by the simulator, of which the deliveries are tracked.
+ */
+struct mesh_sim_msg_t {
+	MeshSimMsgClass msgClass;
+	uint32_t sentMs;
+	//! Per node: whether it's a target that did not receive the message yet.
+	std::vector<bool> pending;
+};
+
+/**
+ * Bulk transfer sent by the simulator, see MeshBulkTransfer.
+ */
+struct mesh_sim_bulk_transfer_t {
+	uint16_t target;
+	uint16_t size;
+	uint32_t startMs;
+	//! Whether the target received all data.
+	bool received = false;
+	//! Whether the received data equals the sent data.
+	bool receivedCorrect = false;
+	uint32_t receivedMs;
+	//! Whether the sender got the result.
+	bool done = false;
+	uint16_t returnCode;
+	uint32_t doneMs;
+	//! Statistics of the sender, at the time of the result.
+	uint32_t chunksSent;
+	uint32_t chunksResent;
+	uint32_t ackRequests;
+	uint32_t ackTimeouts;
+};
+
+class MeshSimNode;
+class MeshSimModel;
+struct cs_mesh_telemetry_t;
+class MeshLinkQuality;
+
+/**
+ * Host simulation of a mesh of Crownstones.
+ *
+ * Each virtual node runs the actual MeshMsgSender, MeshModelSelector, MeshModelMulticast,
+ * MeshModelMulticastAcked, MeshModelUnicast, and MeshMsgHandler, on top of a stub of the
+ * mesh SDK access layer (see test/host/sim/include).
+ *
+ * The radio is modelled on a virtual clock with 1 ms resolution:
+ * - Each node has a single radio queue, and transmits a packet every MESH_SIM_TX_INTERVAL_MS (plus jitter).
+ * - Links between nodes have a loss percentage and a latency.
+ * - When a node receives multiple packets in the same ms, each is lost with the collision percentage.
+ *   A node can't receive while it transmits.
+ * - Each node relays every packet it receives for the first time, while the TTL allows it,
+ *   unless relay suppression decides otherwise, see MeshLinkQuality::shouldRelay().
+ *   Relay suppression follows MESH_RELAY_SUPPRESSION, unless set with setRelaySuppression().
+ *
+ * Only one simulation can exist at a time, as the stub access layer has no context.
+ */
+class MeshSim {
+public:
+	MeshSim(uint16_t numNodes, uint32_t seed = 1);
+	~MeshSim();
+
+	/**
+	 * Set a bidirectional link between two nodes, replaces the link when it was set before.
+	 */
+	void setLink(uint16_t nodeA, uint16_t nodeB, uint8_t lossPercentage, uint16_t latencyMs = 1, int8_t rssi = MESH_SIM_RSSI_DEFAULT);
+
+	/**
+	 * Place the nodes on a grid, with a spacing of 1, and link all nodes within range.
+	 *
+	 * The loss percentage increases linearly with distance, from minLossPercentage to maxLossPercentage at range.
+	 * The RSSI decreases linearly with distance, from -50 to -90 at range.
+	 */
+	void setGridTopology(uint16_t columns, float range, uint8_t minLossPercentage, uint8_t maxLossPercentage);
+
+	/**
+	 * Set the probability that a packet is lost, when multiple packets arrive at a node at the same time.
+	 */
+	void setCollisionPercentage(uint8_t collisionPercentage);
+
+	/**
+	 * Enable or disable the adaptive number of transmissions of all nodes, see MeshLinkQuality.
+	 */
+	void setAdaptiveTransmissions(bool enable);
+
+	/**
+	 * Enable or disable relay suppression of all nodes, see MeshLinkQuality.
+	 */
+	void setRelaySuppression(bool enable);
+
+	/**
+	 * Send an unacked multicast message from a node, with the default number of transmissions of a profile location (1).
+	 */
+	void sendMulticast(uint16_t node);
+
+	/**
+	 * Send an unacked multicast message from a node, with the default number of transmissions of a set time (3).
+	 */
+	void sendSetTime(uint16_t node);
+
+	/**
+	 * Send an acked multicast message from a node to a list of target nodes.
+	 */
+	void sendMulticastAcked(uint16_t node, const std::vector<uint16_t>& targets);
+
+	/**
+	 * Send an acked unicast message from a node to a target node.
+	 */
+	void sendUnicast(uint16_t node, uint16_t target);
+
+	/**
+	 * Start a bulk transfer of generated data from a node to a target node.
+	 *
+	 * @return                              Return code of MeshBulkTransfer::send().
+	 */
+	uint16_t sendBulk(uint16_t node, uint16_t target, uint16_t size);
+
+	/**
+	 * Get the last bulk transfer started by a node.
+	 */
+	mesh_sim_bulk_transfer_t& getBulkTransfer(uint16_t node) {
+		return _bulkTransfers[node];
+	}
+
+	/**
+	 * Reset the bulk transfer state of a node, as if it rebooted. The node should not be sending.
+	 *
+	 * @param[in] firstTransferId           Transfer ID the node starts counting from after the reboot.
+	 */
+	void rebootBulkTransfer(uint16_t node, uint8_t firstTransferId);
+
+	/**
+	 * Run the simulation for a given time.
+	 */
+	void run(uint32_t durationMs);
+
+	uint32_t getTime() {
+		return _timeMs;
+	}
+
+	uint16_t getNumNodes() {
+		return _nodes.size();
+	}
+
+	mesh_sim_msg_stats_t& getMsgStats(MeshSimMsgClass msgClass) {
+		return _msgStats[msgClass];
+	}
+
+	mesh_sim_node_stats_t& getNodeStats(uint16_t node);
+
+	/**
+	 * Get the telemetry that the mesh code of a node keeps up, see MeshTelemetry.
+	 */
+	cs_mesh_telemetry_t& getTelemetry(uint16_t node);
+
+	/**
+	 * Get the link quality that the mesh code of a node keeps up, see MeshLinkQuality.
+	 */
+	MeshLinkQuality& getLinkQuality(uint16_t node);
+
+	/**
+	 * Print delivery ratio, latency, queue occupancy, and airtime.
+	 */
+	void printReport(const char* name);
+
+	/**
+	 * Interface for the stub access layer, State, and UartProtocol.
+	 */
+	static MeshSim* getInstance() {
+		return _instance;
+	}
+	uint16_t addModel(MeshSimModel* model);
+	MeshSimModel* getModel(uint16_t handle);
+	uint16_t addAddress(uint16_t address);
+	uint16_t getAddress(uint16_t handle);
+	void publish(uint16_t handle, uint16_t dstAddress, uint16_t opcode, const uint8_t* data, uint16_t size);
+	uint16_t getCurrentStoneId();
+	void onUartMsg(uint16_t opCode, const uint8_t* data, uint16_t size);
+	/**
+	 * Called on events dispatched by the mesh code.
+	 *
+	 * @return                              True when the event is a command that has been handled.
+	 */
+	bool onEvent(uint16_t type, const void* data, uint16_t size);
+
+private:
+	static MeshSim* _instance;
+
+	struct link_t {
+		uint16_t to;
+		uint8_t lossPercentage;
+		uint16_t latencyMs;
+		int8_t rssi;
+	};
+
+	uint32_t _timeMs = 0;
+	uint8_t _collisionPercentage = 0;
+	uint32_t _nextPacketId = 1;
+	uint32_t _nextMsgKey = 1;
+	uint32_t _randomState;
+
+	std::vector<std::unique_ptr<MeshSimNode>> _nodes;
+	std::vector<std::vector<link_t>> _links;
+
+	void setDirectedLink(uint16_t node, const link_t& link);
+	std::vector<std::unique_ptr<MeshSimModel>> _models;
+	std::vector<uint16_t> _addresses;
+
+	//! Receptions per time.
+	std::map<uint32_t, std::vector<mesh_sim_reception_t>> _receptions;
+
+	//! Messages that are sent, by key.
+	std::map<uint32_t, mesh_sim_msg_t> _msgs;
+
+	mesh_sim_msg_stats_t _msgStats[MESH_SIM_MSG_CLASS_COUNT];
+
+	//! Last bulk transfer per sending node.
+	std::map<uint16_t, mesh_sim_bulk_transfer_t> _bulkTransfers;
+
+	//! Node that is currently running code, or -1.
+	int32_t _currentNode = -1;
+
+	uint32_t random(uint32_t max);
+	bool randomPercentage(uint8_t percentage);
+
+	static uint8_t getBulkByte(uint16_t node, uint16_t index);
+
+	uint32_t newMsg(uint16_t node, MeshSimMsgClass msgClass, const std::vector<uint16_t>& targets);
+	void onDelivered(uint32_t key);
+
+	void enqueue(uint16_t node, const mesh_sim_packet_t& packet);
+	void transmit(uint16_t node);
+	void receive(uint16_t node, int8_t rssi, const mesh_sim_packet_t& packet);
+	void receiveAll(uint32_t timeMs);
+	void deliver(uint16_t node, int8_t rssi, const mesh_sim_packet_t& packet);
+	void tickNode(uint16_t node);
+	void checkReliable(MeshSimModel& model);
+
+	friend class MeshSimCurrentNode;
+};
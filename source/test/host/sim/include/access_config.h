@@ -0,0 +1,16 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+/**
+ * Stub of the nRF mesh SDK access config, for the host mesh simulator.
+ */
+
+#include <access.h>
+
+#define ACCESS_DEFAULT_TTL 5
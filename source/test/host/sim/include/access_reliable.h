@@ -0,0 +1,40 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+/**
+ * Stub of the nRF mesh SDK reliable access layer, for the host mesh simulator.
+ */
+
+#include <access.h>
+
+/** Minimum timeout of a reliable message, in us. */
+#define ACCESS_RELIABLE_TIMEOUT_MIN (2 * 1000 * 1000)
+
+/** Maximum timeout of a reliable message, in us. */
+#define ACCESS_RELIABLE_TIMEOUT_MAX (60 * 1000 * 1000)
+
+typedef enum {
+	ACCESS_RELIABLE_TRANSFER_SUCCESS,
+	ACCESS_RELIABLE_TRANSFER_TIMEOUT,
+	ACCESS_RELIABLE_TRANSFER_CANCELLED,
+} access_reliable_status_t;
+
+typedef void (*access_reliable_cb_t)(access_model_handle_t model_handle, void* p_args, access_reliable_status_t status);
+
+typedef struct {
+	access_model_handle_t model_handle;
+	access_message_tx_t message;
+	access_opcode_t reply_opcode;
+	uint32_t timeout;
+	access_reliable_cb_t status_cb;
+} access_reliable_t;
+
+bool access_reliable_model_is_free(access_model_handle_t model_handle);
+
+uint32_t access_model_reliable_publish(const access_reliable_t* p_reliable);
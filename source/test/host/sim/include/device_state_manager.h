@@ -0,0 +1,24 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+/**
+ * Stub of the nRF mesh SDK device state manager, for the host mesh simulator.
+ */
+
+#include <stdint.h>
+
+typedef uint16_t dsm_handle_t;
+
+#define DSM_HANDLE_INVALID 0xFFFF
+
+uint32_t dsm_address_publish_add(uint16_t raw_address, dsm_handle_t* p_address_handle);
+
+uint32_t dsm_address_publish_remove(dsm_handle_t address_handle);
+
+uint32_t dsm_address_subscription_add_handle(dsm_handle_t address_handle);
@@ -0,0 +1,17 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+/**
+ * Stub of the nRF mesh SDK logging, for the host mesh simulator.
+ */
+
+#define LOG_SRC_APP 0
+#define LOG_LEVEL_INFO 0
+
+#define __LOG(source, level, ...)
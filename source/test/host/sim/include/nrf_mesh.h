@@ -0,0 +1,67 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+/**
+ * Stub of the nRF mesh SDK core, for the host mesh simulator.
+ *
+ * Only contains what the Crownstone mesh models use.
+ */
+
+#include <nrf_error.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+	NRF_MESH_ADDRESS_TYPE_INVALID,
+	NRF_MESH_ADDRESS_TYPE_UNICAST,
+	NRF_MESH_ADDRESS_TYPE_VIRTUAL,
+	NRF_MESH_ADDRESS_TYPE_GROUP,
+} nrf_mesh_address_type_t;
+
+typedef struct {
+	nrf_mesh_address_type_t type;
+	uint16_t value;
+	const uint8_t* p_virtual_uuid;
+} nrf_mesh_address_t;
+
+typedef enum {
+	NRF_MESH_RX_SOURCE_SCANNER,
+	NRF_MESH_RX_SOURCE_GATT,
+	NRF_MESH_RX_SOURCE_FRIEND,
+	NRF_MESH_RX_SOURCE_LOW_POWER,
+	NRF_MESH_RX_SOURCE_INSTABURST,
+	NRF_MESH_RX_SOURCE_LOOPBACK,
+} nrf_mesh_rx_source_t;
+
+typedef struct {
+	int8_t rssi;
+} nrf_mesh_rx_metadata_scanner_t;
+
+typedef struct {
+	int8_t rssi;
+} nrf_mesh_rx_metadata_instaburst_t;
+
+typedef struct {
+	nrf_mesh_rx_source_t source;
+	union {
+		nrf_mesh_rx_metadata_scanner_t scanner;
+		nrf_mesh_rx_metadata_instaburst_t instaburst;
+	} params;
+} nrf_mesh_rx_metadata_t;
+
+typedef enum {
+	NRF_MESH_TRANSMIC_SIZE_SMALL,
+	NRF_MESH_TRANSMIC_SIZE_LARGE,
+	NRF_MESH_TRANSMIC_SIZE_DEFAULT,
+} nrf_mesh_transmic_size_t;
+
+typedef uint32_t nrf_mesh_tx_token_t;
+
+nrf_mesh_tx_token_t nrf_mesh_unique_token_get(void);
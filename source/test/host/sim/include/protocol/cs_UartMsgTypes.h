@@ -0,0 +1,24 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+/**
+ * Replaces protocol/cs_UartMsgTypes.h for the host mesh simulator, which has no ADC.
+ *
+ * Only contains the message types used by the mesh.
+ */
+
+#include <cfg/cs_Config.h>
+#include <protocol/cs_Packets.h>
+
+#include <cstdint>
+
+struct __attribute__((__packed__)) uart_msg_mesh_result_packet_header_t {
+	stone_id_t stoneId;
+	result_packet_header_t resultHeader;
+};
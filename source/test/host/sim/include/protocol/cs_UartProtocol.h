@@ -0,0 +1,36 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+/**
+ * Replaces protocol/cs_UartProtocol.h for the host mesh simulator, which has no UART.
+ *
+ * Messages written by the node that the simulator is currently running are handed to the
+ * simulator, see MeshSim.
+ */
+
+#include <protocol/cs_UartMsgTypes.h>
+#include <protocol/cs_UartOpcodes.h>
+
+#include <cstdint>
+
+class UartProtocol {
+public:
+	static UartProtocol& getInstance() {
+		static UartProtocol instance;
+		return instance;
+	}
+
+	void writeMsg(UartOpcodeTx opCode, uint8_t * data, uint16_t size);
+
+	void writeMsgStart(UartOpcodeTx opCode, uint16_t size);
+
+	void writeMsgPart(UartOpcodeTx opCode, uint8_t * data, uint16_t size);
+
+	void writeMsgEnd(UartOpcodeTx opCode);
+};
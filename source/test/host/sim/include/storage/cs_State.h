@@ -0,0 +1,30 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+/**
+ * Replaces storage/cs_State.h for the host mesh simulator, which has no flash storage.
+ *
+ * Only the convenience get and set are available. They operate on the state of the
+ * node that the simulator is currently running, see MeshSim.
+ */
+
+#include <common/cs_Types.h>
+#include <protocol/cs_ErrorCodes.h>
+
+class State {
+public:
+	static State& getInstance() {
+		static State instance;
+		return instance;
+	}
+
+	cs_ret_code_t get(const CS_TYPE type, void *value, const size16_t size);
+
+	cs_ret_code_t set(const CS_TYPE type, void *value, const size16_t size);
+};
@@ -0,0 +1,31 @@
+/*
+ * Author: Crownstone Team
+ * Copyright: Crownstone (https://crownstone.rocks)
+ * Date: Oct 19, 2020
+ * License: LGPLv3+, Apache License 2.0, and/or MIT (triple-licensed)
+ */
+
+#pragma once
+
+/**
+ * Replaces util/cs_BleError.h for the host mesh simulator, which has no SoftDevice.
+ */
+
+#include <ble/cs_Nordic.h>
+#include <drivers/cs_Serial.h>
+#include <nrf_error.h>
+#include <util/cs_Error.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+#define APP_ERROR_CHECK(cs_ret_code_t)                                                                                 \
+		do                                                                                                             \
+		{                                                                                                              \
+			const uint32_t LOCAL_cs_ret_code_t = (cs_ret_code_t);                                                      \
+			if (LOCAL_cs_ret_code_t != NRF_SUCCESS)                                                                    \
+			{                                                                                                          \
+				fprintf(stderr, "%s:%d error: %u (0x%X)\n", __FILE__, __LINE__, LOCAL_cs_ret_code_t, LOCAL_cs_ret_code_t);  \
+				exit(1);                                                                                               \
+			}                                                                                                          \
+		} while (0)
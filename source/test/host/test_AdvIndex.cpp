@@ -0,0 +1,126 @@
+#include <util/cs_Utils.h>
+
+#include <chrono>
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Advertisements as captured by a Crownstone.
+ */
+vector<vector<uint8_t>> corpus = {
+	// Crownstone service data.
+	{0x02, 0x01, 0x06, 0x15, 0x16, 0x01, 0xC0, 0x05, 0x3A, 0x7D, 0x91, 0x0C, 0x55, 0x21, 0xE8, 0x04, 0xF1, 0x6B, 0x90, 0x12, 0x33, 0x4C, 0x0A, 0xDE, 0x77},
+	// iBeacon.
+	{0x02, 0x01, 0x06, 0x1A, 0xFF, 0x4C, 0x00, 0x02, 0x15, 0xA6, 0x43, 0x42, 0x3E, 0x12, 0x4F, 0x4D, 0x9E, 0xB7, 0x31, 0x45, 0x8F, 0x67, 0x8C, 0x0B, 0x0E, 0x00, 0x01, 0x00, 0x02, 0xC4},
+	// Apple background advertisement with a services mask.
+	{0x02, 0x01, 0x1A, 0x14, 0xFF, 0x4C, 0x00, 0x01, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x08},
+	// Phone broadcasting a command: 4 16 bit service UUIDs and a 128 bit service UUID.
+	{0x02, 0x01, 0x1A, 0x09, 0x03, 0x12, 0x04, 0x34, 0x48, 0x56, 0x8C, 0x78, 0xD0, 0x11, 0x07, 0x1B, 0x2C, 0x3D, 0x4E, 0x5F, 0x60, 0x71, 0x82, 0x93, 0xA4, 0xB5, 0xC6, 0xD7, 0xE8, 0xF9, 0x0A},
+	// Eddystone URL.
+	{0x02, 0x01, 0x06, 0x03, 0x03, 0xAA, 0xFE, 0x0E, 0x16, 0xAA, 0xFE, 0x10, 0xEB, 0x03, 'c', 'r', 'o', 'w', 'n', 's', 't', 0x07},
+	// Named device.
+	{0x02, 0x01, 0x06, 0x0B, 0x09, 'C', 'r', 'o', 'w', 'n', 's', 't', 'o', 'n', 'e'},
+	// Microsoft swift pair.
+	{0x1E, 0xFF, 0x06, 0x00, 0x03, 0x00, 0x80, 0x4D, 0x79, 0x20, 0x4D, 0x6F, 0x75, 0x73, 0x65, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+	// Truncated: the manufacturer data does not fit.
+	{0x02, 0x01, 0x06, 0x1A, 0xFF, 0x4C, 0x00, 0x02, 0x15, 0xA6, 0x43},
+	// Empty AD structure, followed by a 16 bit service UUID.
+	{0x00, 0x03, 0x03, 0x01, 0xC0},
+	// No data.
+	{},
+};
+
+const uint8_t types[] = {
+		BLE_GAP_AD_TYPE_MANUFACTURER_SPECIFIC_DATA,
+		BLE_GAP_AD_TYPE_16BIT_SERVICE_UUID_COMPLETE,
+		BLE_GAP_AD_TYPE_128BIT_SERVICE_UUID_COMPLETE,
+		BLE_GAP_AD_TYPE_SERVICE_DATA,
+		BLE_GAP_AD_TYPE_COMPLETE_LOCAL_NAME,
+		BLE_GAP_AD_TYPE_FLAGS,
+};
+
+scanned_device_t makeScannedDevice(vector<uint8_t>& adv) {
+	scanned_device_t device = {};
+	device.data = adv.data();
+	device.dataSize = adv.size();
+	BLEutil::indexAdvData(device.data, device.dataSize, &device.advIndex);
+	return device;
+}
+
+void testLookups() {
+	cout << "Test that lookups via the index equal lookups in the data." << endl;
+	for (auto& adv: corpus) {
+		scanned_device_t device = makeScannedDevice(adv);
+		for (uint8_t type: types) {
+			cs_data_t parsed;
+			cs_data_t indexed;
+			cs_ret_code_t parsedRetCode = BLEutil::findAdvType(type, adv.data(), adv.size(), &parsed);
+			cs_ret_code_t indexedRetCode = BLEutil::findAdvType(type, &device, &indexed);
+			assert(parsedRetCode == indexedRetCode);
+			assert(parsed.data == indexed.data);
+			assert(parsed.len == indexed.len);
+		}
+	}
+
+	cout << "Test the index of a command advertisement." << endl;
+	scanned_device_t device = makeScannedDevice(corpus[3]);
+	assert(device.advIndex.services16bit.offset == 5);
+	assert(device.advIndex.services16bit.len == 8);
+	assert(device.advIndex.services128bit.offset == 15);
+	assert(device.advIndex.services128bit.len == 16);
+	assert(device.advIndex.manufacturerData.offset == 0);
+	assert(device.advIndex.serviceData16bit.offset == 0);
+}
+
+/**
+ * Time the lookups that the handlers of a scanned device do: background advertisement (manufacturer data),
+ * and command advertisement (16 bit and 128 bit service UUIDs).
+ */
+void benchmark(uint32_t iterations) {
+	cout << "Benchmark " << iterations << " passes over " << corpus.size() << " advertisements." << endl;
+	uint32_t found = 0;
+	cs_data_t data;
+	auto start = chrono::steady_clock::now();
+	for (uint32_t i = 0; i < iterations; ++i) {
+		for (auto& adv: corpus) {
+			scanned_device_t device = {};
+			device.data = adv.data();
+			device.dataSize = adv.size();
+			found += BLEutil::findAdvType(BLE_GAP_AD_TYPE_MANUFACTURER_SPECIFIC_DATA, device.data, device.dataSize, &data) == ERR_SUCCESS;
+			found += BLEutil::findAdvType(BLE_GAP_AD_TYPE_16BIT_SERVICE_UUID_COMPLETE, device.data, device.dataSize, &data) == ERR_SUCCESS;
+			found += BLEutil::findAdvType(BLE_GAP_AD_TYPE_128BIT_SERVICE_UUID_COMPLETE, device.data, device.dataSize, &data) == ERR_SUCCESS;
+		}
+	}
+	auto parsedNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+
+	uint32_t foundIndexed = 0;
+	start = chrono::steady_clock::now();
+	for (uint32_t i = 0; i < iterations; ++i) {
+		for (auto& adv: corpus) {
+			scanned_device_t device = makeScannedDevice(adv);
+			foundIndexed += BLEutil::findAdvType(BLE_GAP_AD_TYPE_MANUFACTURER_SPECIFIC_DATA, &device, &data) == ERR_SUCCESS;
+			foundIndexed += BLEutil::findAdvType(BLE_GAP_AD_TYPE_16BIT_SERVICE_UUID_COMPLETE, &device, &data) == ERR_SUCCESS;
+			foundIndexed += BLEutil::findAdvType(BLE_GAP_AD_TYPE_128BIT_SERVICE_UUID_COMPLETE, &device, &data) == ERR_SUCCESS;
+		}
+	}
+	auto indexedNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+	assert(found == foundIndexed);
+
+	uint32_t numScans = iterations * corpus.size();
+	cout << "  parse per lookup: " << (float)parsedNs / numScans << " ns per advertisement" << endl;
+	cout << "  index once:       " << (float)indexedNs / numScans << " ns per advertisement" << endl;
+}
+
+int main() {
+	cout << "Test AdvIndex" << endl;
+
+	testLookups();
+	benchmark(100000);
+
+	cout << "AdvIndex SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}
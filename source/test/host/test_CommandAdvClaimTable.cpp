@@ -0,0 +1,195 @@
+#include <processing/cs_CommandAdvClaimTable.h>
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+
+using namespace std;
+
+const uint8_t timeoutTicks = 15;
+
+void testExpiry() {
+	cout << "Test that claims expire." << endl;
+	CommandAdvClaimTable<4, timeoutTicks> table;
+	assert(table.find(1) == nullptr);
+	command_adv_claim_t* claim = table.claim(1);
+	assert(claim != nullptr && claim->deviceToken == 1);
+	assert(table.find(1) == claim);
+	for (uint8_t i = 0; i < timeoutTicks - 1; ++i) {
+		table.tick();
+	}
+	assert(table.find(1) == claim);
+
+	cout << "Test that a claim is renewed." << endl;
+	assert(table.claim(1) == claim);
+	assert(table.size() == 1);
+	for (uint8_t i = 0; i < timeoutTicks - 1; ++i) {
+		table.tick();
+	}
+	assert(table.find(1) == claim);
+	table.tick();
+	assert(table.find(1) == nullptr);
+	assert(table.size() == 0);
+
+	cout << "Test that claims are dropped when full." << endl;
+	for (uint8_t token = 10; token < 14; ++token) {
+		assert(table.claim(token) != nullptr);
+	}
+	assert(table.claim(20) == nullptr);
+	assert(table.getDroppedCount() == 1);
+	// Claims of devices that have a claim are not dropped.
+	assert(table.claim(12) != nullptr);
+	assert(table.getDroppedCount() == 1);
+	for (uint8_t i = 0; i < timeoutTicks; ++i) {
+		table.tick();
+	}
+	assert(table.size() == 0);
+	assert(table.claim(20) != nullptr);
+}
+
+/**
+ * The array of claims that the command advertisement handler used to have, as reference.
+ */
+template <uint8_t Capacity>
+struct ReferenceClaims {
+	struct {
+		uint8_t deviceToken = 0;
+		uint8_t timeoutCounter = 0;
+	} claims[Capacity];
+	uint32_t dropped = 0;
+
+	int find(uint8_t deviceToken) {
+		for (int i = 0; i < Capacity; ++i) {
+			if (claims[i].deviceToken == deviceToken) {
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	bool isClaimed(uint8_t deviceToken) {
+		int index = find(deviceToken);
+		return index != -1 && claims[index].timeoutCounter;
+	}
+
+	bool claim(uint8_t deviceToken) {
+		int index = find(deviceToken);
+		if (index == -1) {
+			for (int i = 0; i < Capacity; ++i) {
+				if (!claims[i].timeoutCounter) {
+					index = i;
+					break;
+				}
+			}
+		}
+		if (index == -1) {
+			dropped++;
+			return false;
+		}
+		claims[index].deviceToken = deviceToken;
+		claims[index].timeoutCounter = timeoutTicks;
+		return true;
+	}
+
+	void tick() {
+		for (int i = 0; i < Capacity; ++i) {
+			if (claims[i].timeoutCounter) {
+				--claims[i].timeoutCounter;
+			}
+		}
+	}
+};
+
+template <uint8_t Capacity>
+void testAgainstReference(uint32_t operations) {
+	cout << "Test " << operations << " random operations with capacity " << (int)Capacity << " against the array of claims." << endl;
+	CommandAdvClaimTable<Capacity, timeoutTicks> table;
+	ReferenceClaims<Capacity> reference;
+	srand(Capacity);
+	for (uint32_t i = 0; i < operations; ++i) {
+		uint8_t deviceToken = rand() % (Capacity * 2);
+		switch (rand() % 3) {
+			case 0:
+				assert((table.claim(deviceToken) != nullptr) == reference.claim(deviceToken));
+				break;
+			case 1:
+				assert((table.find(deviceToken) != nullptr) == reference.isClaimed(deviceToken));
+				break;
+			case 2:
+				table.tick();
+				reference.tick();
+				break;
+		}
+		assert(table.getDroppedCount() == reference.dropped);
+	}
+}
+
+/**
+ * Simulate phones that all start broadcasting a command within half a second.
+ *
+ * Each phone repeats its command advertisement every tick, for a second.
+ * Like the command advertisement handler: a repeated advertisement of a claim is ignored,
+ * and a command is only handled when it can be claimed.
+ *
+ * Returns the number of handled commands.
+ */
+template <uint8_t Capacity>
+uint32_t simulateBroadcasters(uint8_t numPhones, uint32_t& dropped) {
+	CommandAdvClaimTable<Capacity, timeoutTicks> table;
+	const uint8_t startTicks = 5;
+	const uint8_t repeatTicks = 10;
+	uint8_t startTick[0xFF];
+	srand(numPhones);
+	for (uint8_t phone = 0; phone < numPhones; ++phone) {
+		startTick[phone] = rand() % startTicks;
+	}
+
+	uint32_t handled = 0;
+	for (uint8_t tick = 0; tick < startTicks + repeatTicks; ++tick) {
+		for (uint8_t phone = 0; phone < numPhones; ++phone) {
+			if (tick < startTick[phone] || tick >= startTick[phone] + repeatTicks) {
+				continue;
+			}
+			uint8_t deviceToken = 100 + phone;
+			uint16_t encryptedRC5 = 1000 + phone;
+			command_adv_claim_t* claim = table.find(deviceToken);
+			if (claim != nullptr && claim->encryptedRC5 == encryptedRC5) {
+				continue;
+			}
+			claim = table.claim(deviceToken);
+			if (claim == nullptr) {
+				continue;
+			}
+			claim->encryptedRC5 = encryptedRC5;
+			handled++;
+		}
+		table.tick();
+	}
+	dropped = table.getDroppedCount();
+	return handled;
+}
+
+int main() {
+	cout << "Test CommandAdvClaimTable" << endl;
+
+	testExpiry();
+	testAgainstReference<10>(100000);
+	testAgainstReference<64>(100000);
+	testAgainstReference<200>(100000);
+
+	const uint8_t numPhones = 50;
+	cout << "Simulate " << (int)numPhones << " phones broadcasting commands." << endl;
+	uint32_t dropped;
+	uint32_t handled = simulateBroadcasters<64>(numPhones, dropped);
+	cout << "  capacity 64: handled " << handled << " commands, dropped " << dropped << " claims" << endl;
+	assert(handled == numPhones);
+	assert(dropped == 0);
+
+	handled = simulateBroadcasters<10>(numPhones, dropped);
+	cout << "  capacity 10: handled " << handled << " commands, dropped " << dropped << " claims" << endl;
+	assert(handled < numPhones);
+	assert(dropped > 0);
+
+	cout << "CommandAdvClaimTable SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}
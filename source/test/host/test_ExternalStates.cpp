@@ -0,0 +1,224 @@
+#include <processing/cs_ExternalStates.h>
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+const uint32_t timeoutSeconds = EXTERNAL_STATE_TIMEOUT_MS / 1000;
+const uint32_t ticksPerSecond = 1000 / TICK_INTERVAL_MS;
+
+state_external_stone_t makeState(stone_id_t id, uint8_t switchState) {
+	state_external_stone_t state;
+	memset(&state, 0, sizeof(state));
+	state.rssi = -50;
+	state.data.type = SERVICE_DATA_TYPE_STATE;
+	state.data.state.id = id;
+	state.data.state.switchState = switchState;
+	return state;
+}
+
+stone_id_t getNextId(ExternalStates& states) {
+	service_data_encrypted_t* data = states.getNextState();
+	if (data == NULL) {
+		return 0;
+	}
+	assert(data->type == SERVICE_DATA_TYPE_EXT_STATE);
+	return service_data_encrypted_get_id(data);
+}
+
+cs_external_state_stats_t getStats(ExternalStates& states) {
+	cs_external_state_stats_t stats;
+	cs_result_t result(cs_data_t((uint8_t*)&stats, sizeof(stats)));
+	states.getStats(result);
+	assert(result.returnCode == ERR_SUCCESS);
+	assert(result.dataSize == sizeof(stats));
+	return stats;
+}
+
+void tickSeconds(ExternalStates& states, uint32_t& tickCount, uint32_t seconds) {
+	for (uint32_t i = 0; i < seconds * ticksPerSecond; ++i) {
+		states.tick(++tickCount);
+	}
+}
+
+void testRotation() {
+	cout << "Test that unchanged states are broadcasted in turn." << endl;
+	ExternalStates states;
+	states.init();
+	assert(states.getNextState() == NULL);
+	for (stone_id_t id = 1; id <= 4; ++id) {
+		state_external_stone_t state = makeState(id * 10, 0);
+		states.receivedState(&state);
+	}
+	for (stone_id_t id = 1; id <= 4; ++id) {
+		assert(getNextId(states) == id * 10);
+	}
+	for (stone_id_t id = 1; id <= 4; ++id) {
+		assert(getNextId(states) == id * 10);
+	}
+
+	cout << "Test that a received state with the same id is overwritten." << endl;
+	state_external_stone_t state = makeState(20, 0);
+	states.receivedState(&state);
+	for (stone_id_t id = 1; id <= 4; ++id) {
+		assert(getNextId(states) == id * 10);
+	}
+
+	cout << "Test that a changed state is broadcasted first." << endl;
+	state = makeState(30, 1);
+	states.receivedState(&state);
+	assert(getNextId(states) == 30);
+	// Then the others, in order of how long they waited.
+	assert(getNextId(states) == 10);
+	assert(getNextId(states) == 20);
+	assert(getNextId(states) == 40);
+	assert(getNextId(states) == 30);
+}
+
+void testTimeout() {
+	cout << "Test that states time out." << endl;
+	ExternalStates states;
+	states.init();
+	uint32_t tickCount = 0;
+	state_external_stone_t state = makeState(1, 0);
+	states.receivedState(&state);
+	tickSeconds(states, tickCount, timeoutSeconds / 2);
+	state = makeState(2, 0);
+	states.receivedState(&state);
+	tickSeconds(states, tickCount, timeoutSeconds - timeoutSeconds / 2);
+	assert(getNextId(states) == 2);
+	assert(getNextId(states) == 2);
+	cs_external_state_stats_t stats = getStats(states);
+	assert(stats.averageStaleness == timeoutSeconds - timeoutSeconds / 2);
+	assert(stats.numBroadcasted == 2);
+
+	cout << "Check that the stats are reset when read." << endl;
+	stats = getStats(states);
+	assert(stats.averageStaleness == 0);
+	assert(stats.numBroadcasted == 0);
+	uint8_t buf[sizeof(cs_external_state_stats_t) - 1];
+	cs_result_t result(cs_data_t(buf, sizeof(buf)));
+	states.getStats(result);
+	assert(result.returnCode == ERR_BUFFER_TOO_SMALL);
+	tickSeconds(states, tickCount, timeoutSeconds / 2);
+	assert(states.getNextState() == NULL);
+
+	cout << "Test that the oldest state is replaced when full." << endl;
+	for (stone_id_t id = 1; id <= EXTERNAL_STATE_LIST_COUNT; ++id) {
+		state = makeState(id, 0);
+		states.receivedState(&state);
+		tickSeconds(states, tickCount, 1);
+	}
+	state = makeState(200, 0);
+	states.receivedState(&state);
+	bool found[0x100] = {false};
+	for (int i = 0; i < EXTERNAL_STATE_LIST_COUNT; ++i) {
+		found[getNextId(states)] = true;
+	}
+	assert(!found[1]);
+	assert(found[2]);
+	assert(found[200]);
+}
+
+void testNoStarvation() {
+	cout << "Test that an unchanged state is broadcasted, while the others keep changing." << endl;
+	ExternalStates states;
+	states.init();
+	for (stone_id_t id = 1; id <= EXTERNAL_STATE_LIST_COUNT; ++id) {
+		state_external_stone_t state = makeState(id, 0);
+		states.receivedState(&state);
+	}
+	uint32_t maxWait = 0;
+	uint32_t wait = 0;
+	for (uint32_t i = 0; i < 1000; ++i) {
+		for (stone_id_t id = 2; id <= EXTERNAL_STATE_LIST_COUNT; ++id) {
+			state_external_stone_t state = makeState(id, i % 2);
+			states.receivedState(&state);
+		}
+		if (getNextId(states) == 1) {
+			wait = 0;
+		}
+		else {
+			wait++;
+		}
+		maxWait = max(maxWait, wait);
+	}
+	assert(maxWait <= 2 * EXTERNAL_STATE_LIST_COUNT);
+}
+
+/**
+ * Simulate stones that send their state via the mesh every minute, where the switch state changes now and then.
+ *
+ * A state is broadcasted every 2 seconds, like the service data does.
+ * Returns the average number of seconds between receiving a changed state, and broadcasting it.
+ */
+float simulate(bool roundRobin, uint32_t seconds, uint32_t& staleness) {
+	ExternalStates states;
+	states.init();
+	uint32_t tickCount = 0;
+	uint8_t switchState[EXTERNAL_STATE_LIST_COUNT + 1] = {0};
+	uint32_t changedAt[EXTERNAL_STATE_LIST_COUNT + 1] = {0};
+	bool pending[EXTERNAL_STATE_LIST_COUNT + 1] = {false};
+	uint32_t latencySum = 0;
+	uint32_t numChanges = 0;
+	int roundRobinIndex = 0;
+	srand(1);
+
+	for (uint32_t t = 0; t < seconds; ++t) {
+		for (stone_id_t id = 1; id <= EXTERNAL_STATE_LIST_COUNT; ++id) {
+			if ((t + id * 7) % 60 != 0) {
+				continue;
+			}
+			if (rand() % 3 == 0) {
+				switchState[id] = !switchState[id];
+				if (!pending[id]) {
+					changedAt[id] = t;
+					pending[id] = true;
+				}
+			}
+			state_external_stone_t state = makeState(id, switchState[id]);
+			states.receivedState(&state);
+		}
+		if (t % 2 == 0) {
+			stone_id_t id;
+			if (roundRobin) {
+				// How the states used to be picked: all states in turn.
+				id = roundRobinIndex + 1;
+				roundRobinIndex = (roundRobinIndex + 1) % EXTERNAL_STATE_LIST_COUNT;
+			}
+			else {
+				id = getNextId(states);
+			}
+			if (pending[id]) {
+				latencySum += t - changedAt[id];
+				numChanges++;
+				pending[id] = false;
+			}
+		}
+		tickSeconds(states, tickCount, 1);
+	}
+	staleness = getStats(states).averageStaleness;
+	return (float)latencySum / numChanges;
+}
+
+int main() {
+	cout << "Test ExternalStates" << endl;
+
+	testRotation();
+	testTimeout();
+	testNoStarvation();
+
+	cout << "Simulate " << EXTERNAL_STATE_LIST_COUNT << " stones." << endl;
+	uint32_t staleness;
+	float roundRobinLatency = simulate(true, 100000, staleness);
+	float latency = simulate(false, 100000, staleness);
+	cout << "  round robin: " << roundRobinLatency << " s until a change is broadcasted" << endl;
+	cout << "  priority:    " << latency << " s until a change is broadcasted, average staleness " << staleness << " s" << endl;
+	assert(latency < roundRobinLatency);
+
+	cout << "ExternalStates SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}
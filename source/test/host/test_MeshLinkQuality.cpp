@@ -0,0 +1,146 @@
+#include <mesh/cs_MeshLinkQuality.h>
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+
+using namespace std;
+
+// Ticks per second.
+#define TICKS_PER_SECOND (1000 / TICK_INTERVAL_MS)
+
+void passSeconds(MeshLinkQuality& linkQuality, uint32_t& tickCount, uint32_t seconds) {
+	for (uint32_t i = 0; i < seconds * TICKS_PER_SECOND; ++i) {
+		linkQuality.tick(++tickCount);
+	}
+}
+
+void addNeighbours(MeshLinkQuality& linkQuality, stone_id_t firstId, uint8_t count, int8_t rssi) {
+	for (uint8_t i = 0; i < count; ++i) {
+		linkQuality.onReceived(firstId + i, rssi, 0);
+	}
+}
+
+cs_mesh_link_quality_item_t* getItem(uint8_t* buf, stone_id_t stoneId) {
+	cs_mesh_link_quality_header_t* header = (cs_mesh_link_quality_header_t*)buf;
+	cs_mesh_link_quality_item_t* items = (cs_mesh_link_quality_item_t*)(buf + sizeof(cs_mesh_link_quality_header_t));
+	for (uint8_t i = 0; i < header->count; ++i) {
+		if (items[i].stoneId == stoneId) {
+			return &(items[i]);
+		}
+	}
+	return nullptr;
+}
+
+int main() {
+	cout << "Test MeshLinkQuality" << endl;
+	MeshLinkQuality linkQuality;
+	linkQuality.setAdaptive(true);
+	uint32_t tickCount = 0;
+
+	cout << "Test default without neighbours." << endl;
+	assert(linkQuality.getNumGoodLinks() == 0);
+	assert(linkQuality.getTransmissions(3) == 3);
+
+	cout << "Test that relayed messages of unknown stones are ignored." << endl;
+	linkQuality.onReceived(1, -60, 2);
+	assert(linkQuality.getTransmissions(3) == 3);
+
+	cout << "Test a single weak neighbour." << endl;
+	linkQuality.onReceived(1, -90, 0);
+	assert(linkQuality.getNumGoodLinks() == 0);
+	assert(linkQuality.getTransmissions(3) == 5);
+
+	cout << "Test the RSSI moving average." << endl;
+	for (int i = 0; i < 50; ++i) {
+		linkQuality.onReceived(1, -60, 0);
+	}
+	assert(linkQuality.getNumGoodLinks() == 1);
+	assert(linkQuality.getTransmissions(3) == 4);
+
+	cout << "Test that messages received via hops lower the reception rate." << endl;
+	for (int i = 0; i < 20; ++i) {
+		linkQuality.onReceived(1, -60, 1);
+	}
+	assert(linkQuality.getNumGoodLinks() == 0);
+	for (int i = 0; i < 20; ++i) {
+		linkQuality.onReceived(1, -60, 0);
+	}
+	assert(linkQuality.getNumGoodLinks() == 1);
+
+	cout << "Test the policy tiers." << endl;
+	addNeighbours(linkQuality, 2, 2, -60);
+	assert(linkQuality.getNumGoodLinks() == MESH_LINK_QUALITY_SPARSE_NEIGHBOURS);
+	assert(linkQuality.getTransmissions(3) == 3);
+	linkQuality.setRelaySuppression(true);
+	assert(linkQuality.getRelayPercentage() == 100);
+	linkQuality.setRelaySuppression(false);
+	addNeighbours(linkQuality, 4, MESH_LINK_QUALITY_DENSE_NEIGHBOURS - MESH_LINK_QUALITY_SPARSE_NEIGHBOURS, -60);
+	assert(linkQuality.getNumGoodLinks() == MESH_LINK_QUALITY_DENSE_NEIGHBOURS);
+	assert(linkQuality.getTransmissions(3) == 2);
+	assert(linkQuality.getTransmissions(1) == 1);
+	assert(linkQuality.getTransmissions(MESH_MODEL_TRANSMISSIONS_MAX) == (MESH_MODEL_TRANSMISSIONS_MAX + 1) / 2);
+
+	cout << "Test disabling the adaptive transmissions." << endl;
+	linkQuality.setAdaptive(false);
+	assert(linkQuality.getTransmissions(3) == 3);
+	linkQuality.setAdaptive(true);
+
+	cout << "Test relay suppression." << endl;
+	assert(linkQuality.getRelayPercentage() == 100);
+	assert(linkQuality.shouldRelay(1, 0, 255));
+	linkQuality.setRelaySuppression(true);
+	assert(linkQuality.getRelayPercentage() == MESH_RELAY_SUPPRESSION_RELAYERS * 100 / MESH_LINK_QUALITY_DENSE_NEIGHBOURS);
+	assert(linkQuality.shouldRelay(1, 0, 0));
+	assert(!linkQuality.shouldRelay(1, 0, 255));
+	assert(!linkQuality.shouldRelay(100, 2, 255));
+	// Packets received directly from a source without a good link are always relayed.
+	assert(linkQuality.shouldRelay(100, 0, 255));
+	linkQuality.setRelaySuppression(false);
+
+	cout << "Test the table." << endl;
+	uint8_t buf[sizeof(cs_mesh_link_quality_header_t) + MESH_LINK_QUALITY_TABLE_SIZE * sizeof(cs_mesh_link_quality_item_t)];
+	cs_result_t result(cs_data_t(buf, sizeof(cs_mesh_link_quality_header_t)));
+	linkQuality.getTable(result);
+	assert(result.returnCode == ERR_BUFFER_TOO_SMALL);
+	passSeconds(linkQuality, tickCount, 5);
+	linkQuality.onReceived(2, -70, 0);
+	result = cs_result_t(cs_data_t(buf, sizeof(buf)));
+	linkQuality.getTable(result);
+	assert(result.returnCode == ERR_SUCCESS);
+	cs_mesh_link_quality_header_t* header = (cs_mesh_link_quality_header_t*)buf;
+	assert(header->count == MESH_LINK_QUALITY_DENSE_NEIGHBOURS);
+	assert(header->numGoodLinks == MESH_LINK_QUALITY_DENSE_NEIGHBOURS);
+	assert(header->transmissions == (MESH_MODEL_TRANSMISSIONS_DEFAULT + 1) / 2);
+	assert(result.dataSize == sizeof(cs_mesh_link_quality_header_t) + header->count * sizeof(cs_mesh_link_quality_item_t));
+	cs_mesh_link_quality_item_t* item = getItem(buf, 1);
+	assert(item != nullptr);
+	assert(item->rssi >= -61 && item->rssi <= -59);
+	assert(item->receptionRate >= MESH_LINK_QUALITY_GOOD_RECEPTION_RATE_PERCENTAGE && item->receptionRate <= 100);
+	assert(item->lastSeenSeconds == 5);
+	item = getItem(buf, 2);
+	assert(item != nullptr);
+	assert(item->rssi < -60);
+	assert(item->lastSeenSeconds == 0);
+
+	cout << "Test that neighbours time out." << endl;
+	passSeconds(linkQuality, tickCount, MESH_LINK_QUALITY_TIMEOUT_MS / 1000 - 5);
+	assert(linkQuality.getNumGoodLinks() == 1);
+	passSeconds(linkQuality, tickCount, 5);
+	assert(linkQuality.getNumGoodLinks() == 0);
+	assert(linkQuality.getTransmissions(3) == 3);
+
+	cout << "Test that the oldest neighbour is replaced when the table is full." << endl;
+	linkQuality.clear();
+	linkQuality.onReceived(1, -60, 0);
+	passSeconds(linkQuality, tickCount, 1);
+	addNeighbours(linkQuality, 2, MESH_LINK_QUALITY_TABLE_SIZE, -60);
+	result = cs_result_t(cs_data_t(buf, sizeof(buf)));
+	linkQuality.getTable(result);
+	assert(header->count == MESH_LINK_QUALITY_TABLE_SIZE);
+	assert(getItem(buf, 1) == nullptr);
+	assert(getItem(buf, 1 + MESH_LINK_QUALITY_TABLE_SIZE) != nullptr);
+
+	cout << "MeshLinkQuality SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}
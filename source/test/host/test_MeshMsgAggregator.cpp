@@ -0,0 +1,332 @@
+#include <cfg/cs_Config.h>
+#include <mesh/cs_MeshMsgAggregator.h>
+#include <protocol/mesh/cs_MeshModelPacketHelper.h>
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+MeshUtil::cs_mesh_queue_item_t createItem(cs_mesh_model_msg_type_t type, uint16_t id, uint8_t transmissions, bool priority, uint8_t* payload, uint8_t size) {
+	MeshUtil::cs_mesh_queue_item_t item;
+	item.metaData.id = id;
+	item.metaData.type = type;
+	item.metaData.transmissionsOrTimeout = transmissions;
+	item.metaData.priority = priority;
+	item.reliable = false;
+	item.broadcast = true;
+	item.msgPayload.data = payload;
+	item.msgPayload.len = size;
+	return item;
+}
+
+/**
+ * Count the entries of an item, and check that they are valid.
+ */
+uint16_t countEntries(const MeshUtil::cs_mesh_queue_item_t& item, uint32_t* numPerType) {
+	if (item.metaData.type != CS_MESH_MODEL_TYPE_AGGREGATE) {
+		numPerType[item.metaData.type]++;
+		return 1;
+	}
+	assert(item.msgPayload.len <= MESH_MODEL_AGGREGATE_PAYLOAD_SIZE);
+	assert(MeshUtil::isValidMeshPayload(CS_MESH_MODEL_TYPE_AGGREGATE, item.msgPayload.data, item.msgPayload.len));
+	uint16_t numEntries = 0;
+	size16_t offset = 0;
+	cs_mesh_model_msg_type_t type;
+	uint8_t* entryPayload;
+	size16_t entrySize;
+	while (MeshUtil::getNextAggregateEntry(item.msgPayload.data, item.msgPayload.len, offset, type, entryPayload, entrySize)) {
+		numPerType[type]++;
+		numEntries++;
+	}
+	assert(numEntries > 1);
+	return numEntries;
+}
+
+void testSingle() {
+	cout << "Test that a single message is passed on as is." << endl;
+	MeshMsgAggregator aggregator;
+	cs_mesh_model_msg_profile_location_t profileLocation = {1, 2};
+	auto item = createItem(CS_MESH_MODEL_TYPE_PROFILE_LOCATION, 3, 3, false, (uint8_t*)&profileLocation, sizeof(profileLocation));
+	assert(MeshMsgAggregator::isAggregatable(item));
+	assert(aggregator.add(item) == ERR_SUCCESS);
+
+	MeshUtil::cs_mesh_queue_item_t out;
+	assert(aggregator.getNext(out));
+	assert(out.metaData.type == CS_MESH_MODEL_TYPE_PROFILE_LOCATION);
+	assert(out.metaData.id == 3);
+	assert(out.metaData.transmissionsOrTimeout == 3);
+	assert(out.msgPayload.len == sizeof(profileLocation));
+	assert(memcmp(out.msgPayload.data, &profileLocation, sizeof(profileLocation)) == 0);
+	aggregator.removeNext();
+	assert(!aggregator.getNext(out));
+}
+
+void testPackUnpack() {
+	cout << "Test that compatible messages are packed, and can be unpacked again." << endl;
+	MeshMsgAggregator aggregator;
+	cs_mesh_model_msg_profile_location_t profileLocation = {1, 2};
+	cs_mesh_model_msg_device_list_size_t listSize = {5};
+	cs_mesh_model_msg_time_t time = {123456};
+	aggregator.add(createItem(CS_MESH_MODEL_TYPE_PROFILE_LOCATION, 1, 3, false, (uint8_t*)&profileLocation, sizeof(profileLocation)));
+	aggregator.add(createItem(CS_MESH_MODEL_TYPE_CMD_NOOP, 0, 3, false, nullptr, 0));
+	aggregator.add(createItem(CS_MESH_MODEL_TYPE_TRACKED_DEVICE_LIST_SIZE, 0, 3, false, (uint8_t*)&listSize, sizeof(listSize)));
+	// Different transmissions and priority: can't be combined with the others.
+	aggregator.add(createItem(CS_MESH_MODEL_TYPE_STATE_TIME, 0, 1, true, (uint8_t*)&time, sizeof(time)));
+	assert(aggregator.getNumPending() == 4);
+
+	cout << "Check that the priority message comes first." << endl;
+	MeshUtil::cs_mesh_queue_item_t out;
+	assert(aggregator.getNext(out));
+	assert(out.metaData.type == CS_MESH_MODEL_TYPE_STATE_TIME);
+	assert(out.metaData.priority);
+	aggregator.removeNext();
+
+	assert(aggregator.getNext(out));
+	assert(out.metaData.type == CS_MESH_MODEL_TYPE_AGGREGATE);
+	assert(out.metaData.transmissionsOrTimeout == 3);
+	assert(!out.metaData.priority);
+	assert(out.msgPayload.len == 3 + 1 + 2);
+	aggregator.removeNext();
+	assert(!aggregator.getNext(out));
+
+	cout << "Check that entries are unpacked in order." << endl;
+	uint8_t msg[MAX_MESH_MSG_NON_SEGMENTED_SIZE];
+	assert(MeshUtil::setMeshMessage(CS_MESH_MODEL_TYPE_AGGREGATE, out.msgPayload.data, out.msgPayload.len, msg, sizeof(msg)));
+	assert(MeshUtil::isValidMeshMessage(msg, MeshUtil::getMeshMessageSize(out.msgPayload.len)));
+	size16_t offset = 0;
+	cs_mesh_model_msg_type_t type;
+	uint8_t* entryPayload;
+	size16_t entrySize;
+	assert(MeshUtil::getNextAggregateEntry(out.msgPayload.data, out.msgPayload.len, offset, type, entryPayload, entrySize));
+	assert(type == CS_MESH_MODEL_TYPE_PROFILE_LOCATION);
+	assert(entrySize == sizeof(profileLocation) && memcmp(entryPayload, &profileLocation, entrySize) == 0);
+	assert(MeshUtil::getNextAggregateEntry(out.msgPayload.data, out.msgPayload.len, offset, type, entryPayload, entrySize));
+	assert(type == CS_MESH_MODEL_TYPE_CMD_NOOP && entrySize == 0);
+	assert(MeshUtil::getNextAggregateEntry(out.msgPayload.data, out.msgPayload.len, offset, type, entryPayload, entrySize));
+	assert(type == CS_MESH_MODEL_TYPE_TRACKED_DEVICE_LIST_SIZE);
+	assert(entrySize == sizeof(listSize) && entryPayload[0] == listSize.listSize);
+	assert(!MeshUtil::getNextAggregateEntry(out.msgPayload.data, out.msgPayload.len, offset, type, entryPayload, entrySize));
+}
+
+void testReady() {
+	cout << "Test when pending messages are ready to be sent." << endl;
+	MeshMsgAggregator aggregator;
+	assert(!aggregator.isReady());
+	aggregator.add(createItem(CS_MESH_MODEL_TYPE_CMD_NOOP, 0, 3, false, nullptr, 0));
+	for (int i = 0; i < MESH_MODEL_AGGREGATION_DELAY_MS / TICK_INTERVAL_MS; ++i) {
+		assert(!aggregator.isReady());
+		aggregator.tick();
+	}
+	assert(aggregator.isReady());
+	MeshUtil::cs_mesh_queue_item_t out;
+	while (aggregator.getNext(out)) {
+		aggregator.removeNext();
+	}
+
+	cout << "Check that a message with priority is ready immediately." << endl;
+	cs_mesh_model_msg_time_t time = {123456};
+	aggregator.add(createItem(CS_MESH_MODEL_TYPE_STATE_TIME, 0, 1, true, (uint8_t*)&time, sizeof(time)));
+	assert(aggregator.isReady());
+	while (aggregator.getNext(out)) {
+		aggregator.removeNext();
+	}
+
+	cout << "Check that enough messages to fill an aggregate are ready immediately." << endl;
+	cs_mesh_model_msg_profile_location_t profileLocation = {1, 2};
+	aggregator.add(createItem(CS_MESH_MODEL_TYPE_PROFILE_LOCATION, 1, 3, false, (uint8_t*)&profileLocation, sizeof(profileLocation)));
+	aggregator.add(createItem(CS_MESH_MODEL_TYPE_PROFILE_LOCATION, 2, 3, false, (uint8_t*)&profileLocation, sizeof(profileLocation)));
+	assert(!aggregator.isReady());
+	aggregator.add(createItem(CS_MESH_MODEL_TYPE_CMD_NOOP, 0, 3, false, nullptr, 0));
+	assert(aggregator.isReady());
+}
+
+void testReplaceAndRemove() {
+	cout << "Test that messages with the same type and id are replaced." << endl;
+	MeshMsgAggregator aggregator;
+	cs_mesh_model_msg_device_list_size_t listSize = {1};
+	aggregator.add(createItem(CS_MESH_MODEL_TYPE_TRACKED_DEVICE_LIST_SIZE, 0, 3, false, (uint8_t*)&listSize, sizeof(listSize)));
+	listSize.listSize = 2;
+	aggregator.add(createItem(CS_MESH_MODEL_TYPE_TRACKED_DEVICE_LIST_SIZE, 0, 3, false, (uint8_t*)&listSize, sizeof(listSize)));
+	assert(aggregator.getNumPending() == 1);
+	MeshUtil::cs_mesh_queue_item_t out;
+	assert(aggregator.getNext(out));
+	assert(out.msgPayload.data[0] == 2);
+	aggregator.removeNext();
+
+	aggregator.add(createItem(CS_MESH_MODEL_TYPE_CMD_NOOP, 0, 3, false, nullptr, 0));
+	MeshUtil::cs_mesh_queue_item_meta_data_t metaData;
+	metaData.type = CS_MESH_MODEL_TYPE_CMD_NOOP;
+	assert(aggregator.remove(metaData));
+	assert(!aggregator.getNext(out));
+}
+
+void testRetry() {
+	cout << "Test that packed messages stay pending until they are removed." << endl;
+	MeshMsgAggregator aggregator;
+	cs_mesh_model_msg_profile_location_t profileLocation = {1, 2};
+	aggregator.add(createItem(CS_MESH_MODEL_TYPE_PROFILE_LOCATION, 1, 3, false, (uint8_t*)&profileLocation, sizeof(profileLocation)));
+	aggregator.add(createItem(CS_MESH_MODEL_TYPE_CMD_NOOP, 0, 3, false, nullptr, 0));
+	MeshUtil::cs_mesh_queue_item_t out;
+	assert(aggregator.getNext(out));
+	assert(out.metaData.type == CS_MESH_MODEL_TYPE_AGGREGATE);
+	assert(aggregator.getNumPending() == 2);
+
+	cout << "Check that the same message is packed again, when it could not be queued." << endl;
+	assert(aggregator.getNext(out));
+	assert(out.metaData.type == CS_MESH_MODEL_TYPE_AGGREGATE);
+	assert(out.msgPayload.len == 3 + 1);
+
+	cout << "Check that nothing is removed when a message was added in between." << endl;
+	cs_mesh_model_msg_device_list_size_t listSize = {5};
+	aggregator.add(createItem(CS_MESH_MODEL_TYPE_TRACKED_DEVICE_LIST_SIZE, 0, 3, false, (uint8_t*)&listSize, sizeof(listSize)));
+	aggregator.removeNext();
+	assert(aggregator.getNumPending() == 3);
+
+	assert(aggregator.getNext(out));
+	assert(out.msgPayload.len == 3 + 1 + 2);
+	aggregator.removeNext();
+	assert(aggregator.getNumPending() == 0);
+	assert(!aggregator.getNext(out));
+}
+
+void testInvalid() {
+	cout << "Test invalid messages." << endl;
+	MeshMsgAggregator aggregator;
+	cs_mesh_model_msg_state_0_t state = {};
+	auto item = createItem(CS_MESH_MODEL_TYPE_STATE_0, 0, 3, false, (uint8_t*)&state, sizeof(state));
+	assert(!MeshMsgAggregator::isAggregatable(item));
+	assert(aggregator.add(item) == ERR_WRONG_PARAMETER);
+	item = createItem(CS_MESH_MODEL_TYPE_CMD_NOOP, 0, 3, false, nullptr, 0);
+	item.reliable = true;
+	assert(!MeshMsgAggregator::isAggregatable(item));
+
+	cout << "Check that a full aggregator refuses new messages." << endl;
+	item.reliable = false;
+	for (uint16_t i = 0; i < MESH_MODEL_AGGREGATION_MAX_PENDING; ++i) {
+		item.metaData.id = i;
+		assert(aggregator.add(item) == ERR_SUCCESS);
+	}
+	item.metaData.id = MESH_MODEL_AGGREGATION_MAX_PENDING;
+	assert(aggregator.add(item) == ERR_BUSY);
+
+	cout << "Check that malformed aggregates are rejected." << endl;
+	uint8_t payload[MESH_MODEL_AGGREGATE_PAYLOAD_SIZE] = {};
+	assert(!MeshUtil::aggregateIsValid(payload, 0));
+	// Entry size larger than the payload.
+	cs_mesh_model_msg_aggregate_entry_header_t* header = (cs_mesh_model_msg_aggregate_entry_header_t*)payload;
+	header->type = CS_MESH_MODEL_TYPE_PROFILE_LOCATION;
+	header->size = 2;
+	assert(!MeshUtil::aggregateIsValid(payload, 2));
+	assert(MeshUtil::aggregateIsValid(payload, 3));
+	// Entry with wrong size for its type.
+	header->size = 1;
+	assert(!MeshUtil::aggregateIsValid(payload, 2));
+	// Nested aggregate.
+	header->type = CS_MESH_MODEL_TYPE_AGGREGATE;
+	header->size = 0;
+	assert(!MeshUtil::aggregateIsValid(payload, 1));
+}
+
+/**
+ * Simulate the small messages sent by all stones in a building, and count the number of advertisements
+ * that are sent with and without aggregation.
+ */
+void simulateBuilding() {
+	const int numStones = 150;
+	const int numTicks = 10 * 60 * 10; // 10 minutes of ticks of 100 ms.
+	cout << "Simulate " << numStones << " stones for " << numTicks << " ticks." << endl;
+
+	MeshMsgAggregator* aggregators = new MeshMsgAggregator[numStones];
+	uint64_t advertisementsWithout = 0;
+	uint64_t advertisementsWith = 0;
+	uint32_t sentPerType[256] = {0};
+	uint32_t receivedPerType[256] = {0};
+	uint16_t nextId = 0;
+	srand(1);
+
+	for (int tick = 0; tick < numTicks; ++tick) {
+		for (int stone = 0; stone < numStones; ++stone) {
+			MeshMsgAggregator& aggregator = aggregators[stone];
+			uint8_t payload[MESH_MODEL_AGGREGATE_MAX_ENTRY_SIZE] = {};
+			// Once in a while, a stone sends a burst of location updates, for example when a group of people moves.
+			if (rand() % 10000 < 20) {
+				int burstSize = 2 + rand() % 4;
+				for (int i = 0; i < burstSize; ++i) {
+					auto item = createItem(CS_MESH_MODEL_TYPE_PROFILE_LOCATION, nextId++, CS_MESH_RELIABILITY_LOW, false, payload, sizeof(cs_mesh_model_msg_profile_location_t));
+					sentPerType[item.metaData.type]++;
+					advertisementsWithout += item.metaData.transmissionsOrTimeout;
+					assert(aggregator.add(item) == ERR_SUCCESS);
+				}
+			}
+			int r = rand() % 10000;
+			MeshUtil::cs_mesh_queue_item_t item;
+			if (r < 100) {
+				item = createItem(CS_MESH_MODEL_TYPE_PROFILE_LOCATION, nextId++, CS_MESH_RELIABILITY_LOW, false, payload, sizeof(cs_mesh_model_msg_profile_location_t));
+			}
+			else if (r < 150) {
+				item = createItem(CS_MESH_MODEL_TYPE_CMD_NOOP, nextId++, CS_MESH_RELIABILITY_LOW, false, payload, 0);
+			}
+			else if (r < 170) {
+				item = createItem(CS_MESH_MODEL_TYPE_TRACKED_DEVICE_LIST_SIZE, nextId++, CS_MESH_RELIABILITY_LOW, false, payload, sizeof(cs_mesh_model_msg_device_list_size_t));
+			}
+			else if (r < 180) {
+				item = createItem(CS_MESH_MODEL_TYPE_STATE_TIME, nextId++, CS_MESH_RELIABILITY_LOWEST, true, payload, sizeof(cs_mesh_model_msg_time_t));
+			}
+			else {
+				item.metaData.type = CS_MESH_MODEL_TYPE_UNKNOWN;
+			}
+			if (item.metaData.type != CS_MESH_MODEL_TYPE_UNKNOWN) {
+				sentPerType[item.metaData.type]++;
+				advertisementsWithout += item.metaData.transmissionsOrTimeout;
+				assert(aggregator.add(item) == ERR_SUCCESS);
+			}
+
+			// Like the mesh msg sender does every tick.
+			aggregator.tick();
+			if (!aggregator.isReady()) {
+				continue;
+			}
+			MeshUtil::cs_mesh_queue_item_t out;
+			while (aggregator.getNext(out)) {
+				countEntries(out, receivedPerType);
+				advertisementsWith += out.metaData.transmissionsOrTimeout;
+				aggregator.removeNext();
+			}
+		}
+	}
+	for (int stone = 0; stone < numStones; ++stone) {
+		MeshUtil::cs_mesh_queue_item_t out;
+		while (aggregators[stone].getNext(out)) {
+			countEntries(out, receivedPerType);
+			advertisementsWith += out.metaData.transmissionsOrTimeout;
+			aggregators[stone].removeNext();
+		}
+	}
+	delete[] aggregators;
+
+	for (int i = 0; i < 256; ++i) {
+		assert(sentPerType[i] == receivedPerType[i]);
+	}
+	cout << "Advertisements without aggregation: " << advertisementsWithout << endl;
+	cout << "Advertisements with aggregation:    " << advertisementsWith << endl;
+	cout << "Airtime reduction: " << 100 - advertisementsWith * 100 / advertisementsWithout << "%" << endl;
+	assert(advertisementsWith < advertisementsWithout);
+}
+
+int main() {
+	cout << "Test MeshMsgAggregator implementation" << endl;
+
+	testSingle();
+	testPackUnpack();
+	testReady();
+	testReplaceAndRemove();
+	testRetry();
+	testInvalid();
+	simulateBuilding();
+
+	cout << "MeshMsgAggregator SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}
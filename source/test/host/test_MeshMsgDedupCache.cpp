@@ -0,0 +1,143 @@
+#include <cfg/cs_Config.h>
+#include <mesh/cs_MeshMsgDedupCache.h>
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+
+const uint32_t TIMEOUT_TICKS = MESH_MSG_DEDUP_TIMEOUT_MS / TICK_INTERVAL_MS;
+
+void testRetransmission() {
+	cout << "Test that a retransmission is recognized." << endl;
+	MeshMsgDedupCache cache;
+	uint8_t payload[] = {1, 2};
+	assert(!cache.isDuplicate(1, 10, payload, sizeof(payload)));
+	assert(cache.isDuplicate(1, 10, payload, sizeof(payload)));
+
+	cout << "Check that other source, type, or payload is not a retransmission." << endl;
+	assert(!cache.isDuplicate(2, 10, payload, sizeof(payload)));
+	assert(!cache.isDuplicate(1, 11, payload, sizeof(payload)));
+	uint8_t otherPayload[] = {1, 3};
+	assert(!cache.isDuplicate(1, 10, otherPayload, sizeof(otherPayload)));
+	assert(!cache.isDuplicate(1, 10, payload, 1));
+	assert(!cache.isDuplicate(1, 10, nullptr, 0));
+	assert(cache.isDuplicate(1, 10, nullptr, 0));
+	assert(cache.getHits() == 2);
+	assert(cache.getMisses() == 6);
+}
+
+void testExpiry() {
+	cout << "Test that a message is handled again after the timeout." << endl;
+	MeshMsgDedupCache cache;
+	uint8_t payload[] = {1, 2};
+	assert(!cache.isDuplicate(1, 10, payload, sizeof(payload)));
+	for (uint32_t i = 0; i < TIMEOUT_TICKS - 1; ++i) {
+		cache.tick();
+		assert(cache.isDuplicate(1, 10, payload, sizeof(payload)));
+	}
+	cache.tick();
+	assert(!cache.isDuplicate(1, 10, payload, sizeof(payload)));
+
+	cout << "Check that clear forgets all messages." << endl;
+	cache.clear();
+	assert(!cache.isDuplicate(1, 10, payload, sizeof(payload)));
+}
+
+struct sent_msg_t {
+	uint16_t src;
+	uint8_t type;
+	uint8_t payload[7];
+	uint8_t size;
+	int transmissionsLeft;
+	int handled;
+};
+
+/**
+ * Simulate stones that each send messages with several transmissions, interleaved like the multicast queue does.
+ * Every message should be handled once, unless the cache is too small to hold all messages in flight.
+ *
+ * @param[in] maxHandledTwicePercent   Max percentage of messages that may be handled more than once.
+ */
+void testBursts(uint16_t numSources, int maxInFlight, int maxHandledTwicePercent) {
+	cout << "Test retransmission bursts of " << numSources << " sources with " << maxInFlight << " messages in flight each." << endl;
+	MeshMsgDedupCache cache;
+	vector<sent_msg_t> msgs;
+	int falseHits = 0;
+	uint32_t totalReceived = 0;
+	for (int round = 0; round < 20; ++round) {
+		// Each source queues a few messages.
+		size_t first = msgs.size();
+		for (uint16_t src = 1; src <= numSources; ++src) {
+			for (int i = 0; i < maxInFlight; ++i) {
+				sent_msg_t msg;
+				msg.src = src;
+				msg.type = 8 + rand() % 10;
+				msg.size = 1 + rand() % 7;
+				for (int j = 0; j < 7; ++j) {
+					msg.payload[j] = rand();
+				}
+				msg.transmissionsLeft = 3 + rand() % 8;
+				msg.handled = 0;
+				msgs.push_back(msg);
+			}
+		}
+		// Send them interleaved: each tick, one transmission of each message.
+		bool anyLeft = true;
+		while (anyLeft) {
+			anyLeft = false;
+			for (size_t i = first; i < msgs.size(); ++i) {
+				if (msgs[i].transmissionsLeft == 0) {
+					continue;
+				}
+				anyLeft = true;
+				msgs[i].transmissionsLeft--;
+				totalReceived++;
+				if (!cache.isDuplicate(msgs[i].src, msgs[i].type, msgs[i].payload, msgs[i].size)) {
+					msgs[i].handled++;
+				}
+				else if (msgs[i].handled == 0) {
+					falseHits++;
+				}
+			}
+			cache.tick();
+		}
+		// Let all messages expire.
+		for (uint32_t t = 0; t < TIMEOUT_TICKS; ++t) {
+			cache.tick();
+		}
+	}
+
+	int handledTwice = 0;
+	for (auto& msg: msgs) {
+		assert(msg.handled >= 1);
+		if (msg.handled > 1) {
+			handledTwice++;
+		}
+	}
+	cout << "received=" << totalReceived << " unique=" << msgs.size() << " hits=" << cache.getHits() << " misses=" << cache.getMisses() << " handled more than once=" << handledTwice << endl;
+	assert(falseHits == 0);
+	assert(cache.getHits() + cache.getMisses() == totalReceived);
+	assert(cache.getHits() > 0);
+	assert(handledTwice * 100 <= maxHandledTwicePercent * (int)msgs.size());
+}
+
+int main() {
+	cout << "Test MeshMsgDedupCache implementation" << endl;
+	srand(1);
+
+	testRetransmission();
+	testExpiry();
+	testBursts(1, 4, 0);
+	testBursts(4, 2, 0);
+	testBursts(20, 3, 0);
+	// The target network size, with the default cache size.
+	testBursts(150, 1, 1);
+	// More messages in flight than the cache can hold.
+	testBursts(150, 3, 100);
+
+	cout << "MeshMsgDedupCache SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,211 @@
+#include <cfg/cs_Config.h>
+#include <mesh/cs_MeshMulticastAckedQueue.h>
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+const uint8_t OWN_STONE_ID = 1;
+
+cs_ret_code_t addItem(MeshMulticastAckedQueue& queue, uint8_t type, uint16_t id, vector<stone_id_t>& stoneIds, uint16_t timeoutSeconds = 10) {
+	uint8_t payload[4] = {1, 2, 3, 4};
+	MeshUtil::cs_mesh_queue_item_t item;
+	item.metaData.id = id;
+	item.metaData.type = type;
+	item.metaData.priority = false;
+	item.metaData.transmissionsOrTimeout = timeoutSeconds;
+	item.reliable = true;
+	item.broadcast = true;
+	item.numIds = stoneIds.size();
+	item.stoneIdsPtr = stoneIds.data();
+	item.msgPayload.data = payload;
+	item.msgPayload.len = sizeof(payload);
+	return queue.add(item);
+}
+
+/**
+ * Ack all stones of an item, except for own ID, which should already be acked.
+ */
+void ackAll(MeshMulticastAckedQueue& queue, uint8_t type, vector<stone_id_t>& stoneIds) {
+	for (auto stoneId: stoneIds) {
+		uint8_t stoneIndex;
+		int16_t index = queue.findInFlight(stoneId, type, stoneIndex);
+		assert(index != -1);
+		if (stoneId == OWN_STONE_ID) {
+			assert(queue.get(index).ackedStonesBitmask.isSet(stoneIndex));
+		}
+		queue.setAcked(index, stoneIndex);
+	}
+}
+
+void testConflicts() {
+	cout << "Test that items of the same type with common stone IDs are not in flight at the same time." << endl;
+	MeshMulticastAckedQueue queue;
+	queue.setOwnStoneId(OWN_STONE_ID);
+	queue.setMaxInFlight(3);
+	vector<stone_id_t> idsA = {1, 2, 3};
+	vector<stone_id_t> idsB = {3, 4};
+	vector<stone_id_t> idsC = {5, 6};
+	assert(addItem(queue, CS_MESH_MODEL_TYPE_STATE_SET, 1, idsA) == ERR_SUCCESS);
+	assert(addItem(queue, CS_MESH_MODEL_TYPE_STATE_SET, 2, idsB) == ERR_SUCCESS);
+	assert(addItem(queue, CS_MESH_MODEL_TYPE_STATE_SET, 3, idsC) == ERR_SUCCESS);
+	assert(addItem(queue, CS_MESH_MODEL_TYPE_CMD_TIME, 4, idsB) == ERR_SUCCESS);
+
+	int16_t indexA = queue.startNext();
+	int16_t indexC = queue.startNext();
+	int16_t indexTime = queue.startNext();
+	assert(indexA == 0);
+	assert(indexC == 2);
+	assert(indexTime == 3);
+	assert(queue.getNumInFlight() == 3);
+	assert(queue.startNext() == -1);
+
+	cout << "Check that replies map to the right item." << endl;
+	uint8_t stoneIndex;
+	assert(queue.findInFlight(3, CS_MESH_MODEL_TYPE_STATE_SET, stoneIndex) == indexA && stoneIndex == 2);
+	assert(queue.findInFlight(3, CS_MESH_MODEL_TYPE_CMD_TIME, stoneIndex) == indexTime && stoneIndex == 0);
+	assert(queue.findInFlight(6, CS_MESH_MODEL_TYPE_STATE_SET, stoneIndex) == indexC && stoneIndex == 1);
+	assert(queue.findInFlight(7, CS_MESH_MODEL_TYPE_STATE_SET, stoneIndex) == -1);
+
+	cout << "Check that the conflicting item starts once the other is done." << endl;
+	ackAll(queue, CS_MESH_MODEL_TYPE_STATE_SET, idsA);
+	assert(queue.isAllAcked(indexA));
+	queue.remove(indexA);
+	assert(queue.startNext() == 1);
+	assert(queue.startNext() == -1);
+
+	cout << "Check that removing by type and id works." << endl;
+	assert(queue.remove(CS_MESH_MODEL_TYPE_CMD_TIME, 4) == ERR_SUCCESS);
+	assert(queue.remove(CS_MESH_MODEL_TYPE_CMD_TIME, 4) == ERR_NOT_FOUND);
+	assert(queue.getNumInFlight() == 2);
+}
+
+void testTimeout() {
+	cout << "Test that an item times out." << endl;
+	MeshMulticastAckedQueue queue;
+	queue.setOwnStoneId(OWN_STONE_ID);
+	vector<stone_id_t> ids = {2, 3};
+	assert(addItem(queue, CS_MESH_MODEL_TYPE_STATE_SET, 1, ids, 1) == ERR_SUCCESS);
+	int16_t index = queue.startNext();
+	assert(index != -1);
+	uint16_t retries = 1000 / MESH_MODEL_ACKED_RETRY_INTERVAL_MS;
+	for (uint16_t i = 0; i < retries; ++i) {
+		assert(!queue.retry(index));
+	}
+	assert(queue.retry(index));
+	assert(!queue.isAllAcked(index));
+	queue.remove(index);
+	assert(queue.getNumInFlight() == 0);
+	assert(!queue.isInProgress(index));
+}
+
+void testQueueFull() {
+	cout << "Test that adding to a full queue fails." << endl;
+	MeshMulticastAckedQueue queue;
+	vector<stone_id_t> ids = {2};
+	for (uint8_t i = 0; i < MeshMulticastAckedQueue::QUEUE_SIZE; ++i) {
+		assert(addItem(queue, CS_MESH_MODEL_TYPE_STATE_SET, i, ids) == ERR_SUCCESS);
+	}
+	assert(addItem(queue, CS_MESH_MODEL_TYPE_STATE_SET, 100, ids) == ERR_BUSY);
+}
+
+/**
+ * Simulate a scene: a hub sends a number of commands, each to a group of stones.
+ *
+ * Every retry interval, each item in flight is (re)sent. Each message and each reply is lost with given probability.
+ * Returns the latency of each command in retry intervals, from the start of the scene until all stones acked.
+ */
+vector<uint32_t> simulateScene(uint8_t maxInFlight, int lossPercentage) {
+	const int numCommands = 8;
+	const int numStonesPerCommand = 5;
+	MeshMulticastAckedQueue queue;
+	queue.setOwnStoneId(OWN_STONE_ID);
+	queue.setMaxInFlight(maxInFlight);
+
+	// 40 stones, each command targets another group.
+	vector<vector<stone_id_t>> groups(numCommands);
+	for (int i = 0; i < numCommands; ++i) {
+		for (int j = 0; j < numStonesPerCommand; ++j) {
+			groups[i].push_back(2 + i * numStonesPerCommand + j);
+		}
+	}
+
+	vector<uint32_t> latencies;
+	uint32_t interval = 0;
+	int added = 0;
+	while (latencies.size() < (size_t)numCommands) {
+		// Add commands as long as the queue has room.
+		while (added < numCommands && added - latencies.size() < MeshMulticastAckedQueue::QUEUE_SIZE) {
+			assert(addItem(queue, CS_MESH_MODEL_TYPE_STATE_SET, added, groups[added], 60) == ERR_SUCCESS);
+			added++;
+		}
+		while (queue.startNext() != -1) {}
+
+		interval++;
+		for (uint8_t i = 0; i < MeshMulticastAckedQueue::QUEUE_SIZE; ++i) {
+			if (!queue.isInProgress(i)) {
+				continue;
+			}
+			auto& item = queue.get(i);
+			// Each stone that receives the message, replies.
+			for (uint8_t j = 0; j < item.numIds; ++j) {
+				if (rand() % 100 < lossPercentage || rand() % 100 < lossPercentage) {
+					continue;
+				}
+				uint8_t stoneIndex;
+				int16_t index = queue.findInFlight(item.stoneIdsPtr[j], item.metaData.type, stoneIndex);
+				assert(index == i);
+				queue.setAcked(index, stoneIndex);
+			}
+			if (queue.isAllAcked(i)) {
+				latencies.push_back(interval);
+				queue.remove(i);
+			}
+			else {
+				assert(!queue.retry(i));
+			}
+		}
+	}
+	return latencies;
+}
+
+void printLatencies(uint8_t maxInFlight, vector<uint32_t> latencies) {
+	sort(latencies.begin(), latencies.end());
+	cout << "  max in flight=" << (int)maxInFlight
+			<< " p50=" << latencies[latencies.size() / 2] * MESH_MODEL_ACKED_RETRY_INTERVAL_MS << "ms"
+			<< " p90=" << latencies[latencies.size() * 9 / 10] * MESH_MODEL_ACKED_RETRY_INTERVAL_MS << "ms"
+			<< " max=" << latencies.back() * MESH_MODEL_ACKED_RETRY_INTERVAL_MS << "ms" << endl;
+}
+
+void testSceneLatency() {
+	cout << "Test latency of a scene of 8 commands to 40 stones, with 20% loss." << endl;
+	const int numRuns = 50;
+	vector<uint32_t> serial;
+	vector<uint32_t> pipelined;
+	for (int run = 0; run < numRuns; ++run) {
+		vector<uint32_t> latencies = simulateScene(1, 20);
+		serial.insert(serial.end(), latencies.begin(), latencies.end());
+		latencies = simulateScene(MESH_MODEL_MULTICAST_ACKED_MAX_IN_FLIGHT, 20);
+		pipelined.insert(pipelined.end(), latencies.begin(), latencies.end());
+	}
+	printLatencies(1, serial);
+	printLatencies(MESH_MODEL_MULTICAST_ACKED_MAX_IN_FLIGHT, pipelined);
+	assert(*max_element(pipelined.begin(), pipelined.end()) < *max_element(serial.begin(), serial.end()));
+}
+
+int main() {
+	cout << "Test MeshMulticastAckedQueue implementation" << endl;
+	srand(1);
+
+	testConflicts();
+	testTimeout();
+	testQueueFull();
+	testSceneLatency();
+
+	cout << "MeshMulticastAckedQueue SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,370 @@
+#include <cs_MeshSim.h>
+#include <mesh/cs_MeshBulkTransfer.h>
+#include <mesh/cs_MeshLinkQuality.h>
+#include <mesh/cs_MeshTelemetry.h>
+
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Run a mixed workload on a grid of nodes:
+ * - Every node sends a multicast message every few seconds, like profile location updates.
+ * - Node 0, the hub, regularly sends an acked multicast to a group of nodes, like a scene.
+ * - Node 0 regularly sends an acked unicast to a random node.
+ */
+MeshSim* runBenchmark(uint16_t numNodes, uint16_t columns, uint32_t durationMs, bool relaySuppression = false) {
+	MeshSim* sim = new MeshSim(numNodes, numNodes);
+	sim->setGridTopology(columns, 2.5f, 5, 40);
+	sim->setCollisionPercentage(30);
+	sim->setRelaySuppression(relaySuppression);
+
+	const uint32_t stepMs = 100;
+	const uint32_t multicastIntervalMs = 10000;
+	const uint32_t ackedIntervalMs = 10000;
+	const uint32_t unicastIntervalMs = 5000;
+	const uint32_t settleMs = 15000;
+	for (uint32_t t = 0; t < durationMs; t += stepMs) {
+		for (uint16_t node = 0; node < numNodes; ++node) {
+			if ((t + node * stepMs) % multicastIntervalMs == 0) {
+				sim->sendMulticast(node);
+			}
+		}
+		if (t % ackedIntervalMs == 0) {
+			vector<uint16_t> targets;
+			for (uint16_t i = 0; i < 5 && i < numNodes - 1; ++i) {
+				targets.push_back(1 + rand() % (numNodes - 1));
+			}
+			sim->sendMulticastAcked(0, targets);
+		}
+		if (t % unicastIntervalMs == 2500) {
+			sim->sendUnicast(0, 1 + rand() % (numNodes - 1));
+		}
+		sim->run(stepMs);
+	}
+	// Let all messages arrive, or time out.
+	sim->run(settleMs);
+	return sim;
+}
+
+uint32_t sumQueueWaitHistogram(const cs_mesh_telemetry_t& telemetry) {
+	uint32_t sum = 0;
+	for (int i = 0; i < MESH_TELEMETRY_HISTOGRAM_SIZE; ++i) {
+		sum += telemetry.queueWaitHistogram[i];
+	}
+	return sum;
+}
+
+uint32_t sumAckedLatencyHistogram(const cs_mesh_telemetry_t& telemetry) {
+	uint32_t sum = 0;
+	for (int i = 0; i < MESH_TELEMETRY_HISTOGRAM_SIZE; ++i) {
+		sum += telemetry.ackedLatencyHistogram[i];
+	}
+	return sum;
+}
+
+void testLine() {
+	cout << "Test that messages are relayed over a line of nodes without loss." << endl;
+	MeshSim sim(4);
+	sim.setLink(0, 1, 0);
+	sim.setLink(1, 2, 0);
+	sim.setLink(2, 3, 0);
+	sim.sendMulticast(0);
+	sim.sendUnicast(0, 3);
+	sim.sendMulticastAcked(0, {1, 2, 3});
+	sim.run(5000);
+	for (int i = 0; i < MESH_SIM_MSG_CLASS_COUNT; ++i) {
+		mesh_sim_msg_stats_t& stats = sim.getMsgStats((MeshSimMsgClass)i);
+		assert(stats.sent == 1);
+		assert(stats.deliveries == stats.expectedDeliveries);
+	}
+	assert(sim.getNodeStats(0).ackedSuccess == 2);
+	assert(sim.getNodeStats(0).ackedTimeout == 0);
+	assert(sim.getNodeStats(1).relayedPackets > 0);
+	assert(sim.getNodeStats(3).relayedPackets > 0);
+
+	cs_mesh_telemetry_t& telemetry = sim.getTelemetry(0);
+	for (int i = 0; i < MESH_TELEMETRY_NUM_MODELS; ++i) {
+		assert(telemetry.models[i].queued == 1);
+		assert(telemetry.models[i].sent >= 1);
+		assert(telemetry.models[i].dropped == 0);
+		assert(telemetry.models[i].ackTimeouts == 0);
+	}
+	assert(sumQueueWaitHistogram(telemetry) == 3);
+	assert(sumAckedLatencyHistogram(telemetry) == 2);
+	cs_mesh_telemetry_t& farTelemetry = sim.getTelemetry(3);
+	assert(farTelemetry.models[MESH_TELEMETRY_MODEL_MULTICAST].received == 1);
+	assert(farTelemetry.models[MESH_TELEMETRY_MODEL_MULTICAST].receivedRelayed == 1);
+	assert(farTelemetry.types[CS_MESH_MODEL_TYPE_STATE_SET].received == 1);
+}
+
+void testUnreachable() {
+	cout << "Test that acked messages to an unreachable node time out." << endl;
+	MeshSim sim(3);
+	sim.setLink(0, 1, 0);
+	sim.sendUnicast(0, 2);
+	sim.sendMulticastAcked(0, {1, 2});
+	// Longer than the default timeout of acked messages.
+	sim.run(20000);
+	assert(sim.getMsgStats(MESH_SIM_MSG_UNICAST).deliveries == 0);
+	assert(sim.getMsgStats(MESH_SIM_MSG_MULTICAST_ACKED).deliveries == 1);
+	assert(sim.getNodeStats(0).ackedSuccess == 0);
+	assert(sim.getNodeStats(0).ackedTimeout == 2);
+	assert(sim.getTelemetry(0).models[MESH_TELEMETRY_MODEL_UNICAST].ackTimeouts == 1);
+	assert(sim.getTelemetry(0).models[MESH_TELEMETRY_MODEL_MULTICAST_ACKED].ackTimeouts == 1);
+	assert(sim.getTelemetry(0).models[MESH_TELEMETRY_MODEL_MULTICAST_ACKED].retries > 0);
+}
+
+/**
+ * Run multicast messages from every node on a dense grid, with a sparse tail of weak links hanging from a corner.
+ */
+MeshSim* runAdaptive(bool adaptive, uint32_t durationMs) {
+	const uint16_t gridNodes = 36;
+	const uint16_t tailNodes = 3;
+	MeshSim* sim = new MeshSim(gridNodes + tailNodes, 1);
+	sim->setGridTopology(6, 2.5f, 5, 40);
+	sim->setLink(0, gridNodes, 30, 1, -88);
+	for (uint16_t i = 1; i < tailNodes; ++i) {
+		sim->setLink(gridNodes + i - 1, gridNodes + i, 30, 1, -88);
+	}
+	sim->setCollisionPercentage(30);
+	sim->setAdaptiveTransmissions(adaptive);
+
+	const uint32_t stepMs = 100;
+	const uint32_t intervalMs = 10000;
+	for (uint32_t t = 0; t < durationMs; t += stepMs) {
+		for (uint16_t node = 0; node < gridNodes + tailNodes; ++node) {
+			if ((t + node * stepMs) % intervalMs == 0) {
+				sim->sendSetTime(node);
+			}
+			if ((t + node * stepMs) % intervalMs == intervalMs / 2) {
+				sim->sendMulticast(node);
+			}
+		}
+		sim->run(stepMs);
+	}
+	sim->run(5000);
+	return sim;
+}
+
+uint64_t getTotalAirtimeUs(MeshSim* sim, uint16_t numNodes) {
+	uint64_t airtimeUs = 0;
+	for (uint16_t i = 0; i < numNodes; ++i) {
+		airtimeUs += sim->getNodeStats(i).airtimeUs;
+	}
+	return airtimeUs;
+}
+
+void testAdaptiveTransmissions() {
+	cout << "Test that adapting the number of transmissions to the link quality saves airtime, without losing messages." << endl;
+	const uint16_t numNodes = 39;
+	MeshSim* fixed = runAdaptive(false, 120000);
+	MeshSim* adaptive = runAdaptive(true, 120000);
+	fixed->printReport("fixed transmissions");
+	adaptive->printReport("adaptive transmissions");
+	uint64_t fixedAirtimeUs = getTotalAirtimeUs(fixed, numNodes);
+	uint64_t adaptiveAirtimeUs = getTotalAirtimeUs(adaptive, numNodes);
+	float fixedRatio = fixed->getMsgStats(MESH_SIM_MSG_MULTICAST).getDeliveryRatio();
+	float adaptiveRatio = adaptive->getMsgStats(MESH_SIM_MSG_MULTICAST).getDeliveryRatio();
+	cout << "  airtime fixed=" << fixedAirtimeUs / 1000 << " ms adaptive=" << adaptiveAirtimeUs / 1000 << " ms" << endl;
+	cout << "  delivery fixed=" << fixedRatio << " adaptive=" << adaptiveRatio << endl;
+	assert(adaptiveAirtimeUs < fixedAirtimeUs);
+	assert(adaptiveRatio >= fixedRatio - 0.02f);
+	delete fixed;
+	delete adaptive;
+}
+
+uint32_t getTotalRelayed(MeshSim* sim) {
+	uint32_t relayed = 0;
+	for (uint16_t i = 0; i < sim->getNumNodes(); ++i) {
+		relayed += sim->getNodeStats(i).relayedPackets;
+	}
+	return relayed;
+}
+
+void testRelaySuppression() {
+	cout << "Test that relay suppression saves relays on a dense grid, without losing many messages." << endl;
+	srand(2);
+	MeshSim* relayAll = runBenchmark(100, 10, 60000, false);
+	srand(2);
+	MeshSim* suppressed = runBenchmark(100, 10, 60000, true);
+	relayAll->printReport("relay all");
+	suppressed->printReport("relay suppression");
+	uint32_t relayAllRelayed = getTotalRelayed(relayAll);
+	uint32_t suppressedRelayed = getTotalRelayed(suppressed);
+	cout << "  relayed all=" << relayAllRelayed << " suppressed=" << suppressedRelayed << endl;
+	for (int i = 0; i < MESH_SIM_MSG_CLASS_COUNT; ++i) {
+		float relayAllRatio = relayAll->getMsgStats((MeshSimMsgClass)i).getDeliveryRatio();
+		float suppressedRatio = suppressed->getMsgStats((MeshSimMsgClass)i).getDeliveryRatio();
+		cout << "  delivery class " << i << ": all=" << relayAllRatio << " suppressed=" << suppressedRatio << endl;
+		assert(suppressedRatio >= relayAllRatio - 0.05f);
+	}
+	assert(suppressedRelayed < relayAllRelayed);
+	delete relayAll;
+	delete suppressed;
+}
+
+/**
+ * Send a bulk transfer over a line of nodes, and run until it's done.
+ */
+mesh_sim_bulk_transfer_t runBulkTransfer(uint8_t lossPercentage, uint16_t size) {
+	MeshSim sim(3, lossPercentage + 1);
+	sim.setLink(0, 1, lossPercentage);
+	sim.setLink(1, 2, lossPercentage);
+	assert(sim.sendBulk(0, 2, size) == ERR_SUCCESS);
+	for (uint32_t t = 0; t < 300000 && !sim.getBulkTransfer(0).done; t += 100) {
+		sim.run(100);
+	}
+	return sim.getBulkTransfer(0);
+}
+
+void testBulkTransfer() {
+	cout << "Test bulk transfers over a lossy line of nodes, and report throughput and retry overhead." << endl;
+	const uint16_t size = MESH_BULK_TRANSFER_MAX_SIZE;
+	const uint8_t lossPercentages[] = {0, 10, 20, 30};
+	for (uint8_t loss: lossPercentages) {
+		mesh_sim_bulk_transfer_t transfer = runBulkTransfer(loss, size);
+		assert(transfer.done);
+		assert(transfer.returnCode == ERR_SUCCESS);
+		assert(transfer.received);
+		assert(transfer.receivedCorrect);
+		uint32_t durationMs = transfer.doneMs - transfer.startMs;
+		uint32_t numChunks = (size + MESH_BULK_TRANSFER_CHUNK_SIZE - 1) / MESH_BULK_TRANSFER_CHUNK_SIZE;
+		printf("  loss=%2u%% duration=%-6u ms throughput=%-5u B/s chunks sent=%u/%u resent=%u ack requests=%u timeouts=%u\n",
+				loss, durationMs, size * 1000 / durationMs, transfer.chunksSent, numChunks, transfer.chunksResent, transfer.ackRequests, transfer.ackTimeouts);
+		assert(transfer.chunksSent - transfer.chunksResent == numChunks);
+		if (loss == 0) {
+			assert(transfer.chunksResent == 0);
+		}
+	}
+
+	cout << "Test that a bulk transfer to an unreachable node times out." << endl;
+	MeshSim sim(3);
+	sim.setLink(0, 1, 0);
+	assert(sim.sendBulk(0, 2, 100) == ERR_SUCCESS);
+	assert(sim.sendBulk(0, 1, 100) == ERR_BUSY);
+	sim.run(120000);
+	mesh_sim_bulk_transfer_t& transfer = sim.getBulkTransfer(0);
+	assert(transfer.done);
+	assert(transfer.returnCode == ERR_TIMEOUT);
+	assert(!transfer.received);
+}
+
+/**
+ * Run until the last bulk transfer of a node is done.
+ */
+mesh_sim_bulk_transfer_t& runUntilBulkDone(MeshSim& sim, uint16_t node) {
+	for (uint32_t t = 0; t < 60000 && !sim.getBulkTransfer(node).done; t += 100) {
+		sim.run(100);
+	}
+	return sim.getBulkTransfer(node);
+}
+
+void testBulkTransferSenderReboot() {
+	cout << "Test that a bulk transfer after a sender reboot is received, even when the transfer ID is reused." << endl;
+	MeshSim sim(2);
+	sim.setLink(0, 1, 0);
+	sim.rebootBulkTransfer(0, 5);
+	assert(sim.sendBulk(0, 1, 100) == ERR_SUCCESS);
+	mesh_sim_bulk_transfer_t* transfer = &runUntilBulkDone(sim, 0);
+	assert(transfer->returnCode == ERR_SUCCESS);
+	assert(transfer->received && transfer->receivedCorrect);
+
+	// Same transfer ID, different data: the receiver should not answer with the previous transfer.
+	sim.rebootBulkTransfer(0, 5);
+	assert(sim.sendBulk(0, 1, 150) == ERR_SUCCESS);
+	transfer = &runUntilBulkDone(sim, 0);
+	assert(transfer->returnCode == ERR_SUCCESS);
+	assert(transfer->received && transfer->receivedCorrect);
+
+	// Same transfer ID and data: only received again once the receiver forgot the previous transfer.
+	sim.run(MESH_BULK_TRANSFER_RECEIVE_TIMEOUT_MS);
+	sim.rebootBulkTransfer(0, 5);
+	assert(sim.sendBulk(0, 1, 150) == ERR_SUCCESS);
+	transfer = &runUntilBulkDone(sim, 0);
+	assert(transfer->returnCode == ERR_SUCCESS);
+	assert(transfer->received && transfer->receivedCorrect);
+}
+
+/**
+ * Get the reception rate that a node keeps up of a neighbour, or -1 when the neighbour is not in its table.
+ */
+int getReceptionRate(MeshSim& sim, uint16_t node, uint16_t neighbour) {
+	uint8_t buf[sizeof(cs_mesh_link_quality_header_t) + MESH_LINK_QUALITY_TABLE_SIZE * sizeof(cs_mesh_link_quality_item_t)];
+	cs_result_t result(cs_data_t(buf, sizeof(buf)));
+	sim.getLinkQuality(node).getTable(result);
+	assert(result.returnCode == ERR_SUCCESS);
+	cs_mesh_link_quality_header_t* header = (cs_mesh_link_quality_header_t*)buf;
+	cs_mesh_link_quality_item_t* items = (cs_mesh_link_quality_item_t*)(buf + sizeof(*header));
+	for (uint8_t i = 0; i < header->count; ++i) {
+		if (items[i].stoneId == neighbour + 1) {
+			return items[i].receptionRate;
+		}
+	}
+	return -1;
+}
+
+void testAggregateLinkQuality() {
+	cout << "Test that an aggregated message counts as a single reception for the link quality." << endl;
+	MeshSim sim(3);
+	sim.setLink(0, 1, 0);
+	sim.setLink(1, 2, 0);
+	sim.setLink(0, 2, 0);
+	sim.sendMulticast(0);
+	sim.run(2000);
+	assert(getReceptionRate(sim, 2, 0) == 100);
+
+	// Node 2 can now only receive messages of node 0 via node 1.
+	sim.setLink(0, 2, 100);
+	uint32_t sent = sim.getTelemetry(0).models[MESH_TELEMETRY_MODEL_MULTICAST].sent;
+	for (int i = 0; i < 4; ++i) {
+		sim.sendMulticast(0);
+	}
+	sim.run(2000);
+	assert(sim.getMsgStats(MESH_SIM_MSG_MULTICAST).deliveries == sim.getMsgStats(MESH_SIM_MSG_MULTICAST).expectedDeliveries);
+	uint32_t sentMessages = sim.getTelemetry(0).models[MESH_TELEMETRY_MODEL_MULTICAST].sent - sent;
+	assert(sentMessages < 4);
+
+	// Each missed direct reception lowers the rate by 1/8, so the entries of an aggregate should not count.
+	uint32_t rate = 0xFFFF;
+	for (uint32_t i = 0; i < sentMessages; ++i) {
+		rate -= rate >> MESH_LINK_QUALITY_EWMA_SHIFT;
+	}
+	assert(getReceptionRate(sim, 2, 0) == (int)(rate * 100 / 0xFFFF));
+}
+
+void testBenchmark(uint16_t numNodes, uint16_t columns, float minDeliveryRatio) {
+	cout << "Benchmark " << numNodes << " nodes." << endl;
+	MeshSim* sim = runBenchmark(numNodes, columns, 60000);
+	string name = to_string(numNodes) + " nodes";
+	sim->printReport(name.c_str());
+	for (int i = 0; i < MESH_SIM_MSG_CLASS_COUNT; ++i) {
+		mesh_sim_msg_stats_t& stats = sim->getMsgStats((MeshSimMsgClass)i);
+		assert(stats.sent > 0);
+		assert(stats.getDeliveryRatio() >= minDeliveryRatio);
+	}
+	delete sim;
+}
+
+int main() {
+	cout << "Test mesh simulator" << endl;
+	srand(1);
+
+	testLine();
+	testUnreachable();
+	testAdaptiveTransmissions();
+	testRelaySuppression();
+	testBulkTransfer();
+	testBulkTransferSenderReboot();
+	testAggregateLinkQuality();
+	testBenchmark(10, 4, 0.75f);
+	testBenchmark(50, 8, 0.75f);
+	testBenchmark(200, 15, 0.25f);
+
+	cout << "MeshSim SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,215 @@
+#include <processing/cs_MeshStatePublisher.h>
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <functional>
+
+using namespace std;
+
+#define TICKS_PER_SECOND (1000 / TICK_INTERVAL_MS)
+#define TICKS_PER_HOUR (3600 * TICKS_PER_SECOND)
+
+// Number of mesh messages each time the state is sent: state 0 and state 1.
+#define MESSAGES_PER_SEND 2
+
+/**
+ * Returns the state at a given tick.
+ */
+typedef function<cs_mesh_state_sample_t(uint32_t tick)> LoadProfile;
+
+int32_t noise(int32_t amplitude) {
+	return (rand() % (2 * amplitude + 1)) - amplitude;
+}
+
+/**
+ * Count the number of times the state is sent in an hour, like it was before: at a fixed interval,
+ * and shortly after a switch state change.
+ */
+uint32_t runFixed(LoadProfile profile) {
+	uint32_t sends = 0;
+	uint32_t countdown = MESH_SEND_STATE_INTERVAL_MS / TICK_INTERVAL_MS;
+	uint8_t lastSwitchState = profile(0).switchState;
+	for (uint32_t tick = 1; tick <= TICKS_PER_HOUR; ++tick) {
+		cs_mesh_state_sample_t sample = profile(tick);
+		if (sample.switchState != lastSwitchState) {
+			lastSwitchState = sample.switchState;
+			countdown = 300 / TICK_INTERVAL_MS;
+		}
+		if (countdown-- == 0) {
+			uint32_t randMs = MESH_SEND_STATE_INTERVAL_MS + (rand() % 256) * MESH_SEND_STATE_INTERVAL_MS_VARIATION / 255;
+			countdown = randMs / TICK_INTERVAL_MS;
+			sends++;
+		}
+	}
+	return sends;
+}
+
+/**
+ * Count the number of times the state is sent in an hour by the publisher.
+ *
+ * @param[out] maxChangeLatencyMs   Max time between a switch state change and the next send.
+ */
+uint32_t runPublisher(LoadProfile profile, uint32_t& maxChangeLatencyMs) {
+	MeshStatePublisher publisher;
+	publisher.init(profile(0), 1234);
+	uint32_t sends = 0;
+	uint8_t lastSwitchState = profile(0).switchState;
+	uint32_t changeTick = 0;
+	maxChangeLatencyMs = 0;
+	for (uint32_t tick = 1; tick <= TICKS_PER_HOUR; ++tick) {
+		cs_mesh_state_sample_t sample = profile(tick);
+		if (sample.switchState != lastSwitchState) {
+			lastSwitchState = sample.switchState;
+			changeTick = tick;
+		}
+		if (publisher.tick(sample) != MESH_STATE_PUBLISH_NONE) {
+			sends++;
+			if (changeTick != 0) {
+				uint32_t latencyMs = (tick - changeTick) * TICK_INTERVAL_MS;
+				if (latencyMs > maxChangeLatencyMs) {
+					maxChangeLatencyMs = latencyMs;
+				}
+				changeTick = 0;
+			}
+		}
+	}
+	assert(sends == publisher.getNumChangeSends() + publisher.getNumKeepAliveSends());
+	return sends;
+}
+
+void testProfile(const char* name, LoadProfile profile) {
+	uint32_t fixedSends = runFixed(profile);
+	uint32_t maxChangeLatencyMs;
+	uint32_t publisherSends = runPublisher(profile, maxChangeLatencyMs);
+	int32_t saved = ((int32_t)fixedSends - (int32_t)publisherSends) * MESSAGES_PER_SEND;
+	cout << "  " << name << ": messages per hour fixed=" << fixedSends * MESSAGES_PER_SEND
+			<< " publisher=" << publisherSends * MESSAGES_PER_SEND
+			<< " saved=" << saved
+			<< " max switch latency=" << maxChangeLatencyMs << " ms" << endl;
+	assert(maxChangeLatencyMs <= MESH_SEND_STATE_MIN_INTERVAL_MS);
+}
+
+cs_mesh_state_sample_t makeSample(uint8_t switchState, int32_t powerUsageMilliWatt) {
+	cs_mesh_state_sample_t sample;
+	sample.switchState = switchState;
+	sample.powerUsageMilliWatt = powerUsageMilliWatt;
+	return sample;
+}
+
+void testSignificance() {
+	cout << "Test significant changes." << endl;
+	MeshStatePublisher publisher;
+	publisher.init(makeSample(100, 100000), 1);
+	assert(!publisher.isSignificantChange(makeSample(100, 100000)));
+	// Relative threshold applies to large loads.
+	assert(!publisher.isSignificantChange(makeSample(100, 119000)));
+	assert(publisher.isSignificantChange(makeSample(100, 121000)));
+	assert(publisher.isSignificantChange(makeSample(100, 79000)));
+	assert(publisher.isSignificantChange(makeSample(0, 100000)));
+	cs_mesh_state_sample_t sample = makeSample(100, 100000);
+	sample.errors = 1;
+	assert(publisher.isSignificantChange(sample));
+	sample = makeSample(100, 100000);
+	sample.flags = 1;
+	assert(publisher.isSignificantChange(sample));
+
+	// Absolute threshold applies to small loads.
+	publisher.init(makeSample(0, 1000), 1);
+	assert(!publisher.isSignificantChange(makeSample(0, 5000)));
+	assert(publisher.isSignificantChange(makeSample(0, 6000)));
+	assert(!publisher.isSignificantChange(makeSample(0, -3000)));
+}
+
+void testTiming() {
+	cout << "Test send timing." << endl;
+	MeshStatePublisher publisher;
+	cs_mesh_state_sample_t sample = makeSample(0, 0);
+	publisher.init(sample, 1);
+	uint32_t tick = 0;
+
+	// Keep alive interval backs off while the state doesn't change.
+	uint32_t expectedIntervalMs = MESH_SEND_STATE_INTERVAL_MS;
+	for (int i = 0; i < 5; ++i) {
+		uint32_t lastTick = tick;
+		MeshStatePublishType type;
+		do {
+			type = publisher.tick(sample);
+			tick++;
+		} while (type == MESH_STATE_PUBLISH_NONE);
+		assert(type == MESH_STATE_PUBLISH_KEEP_ALIVE);
+		uint32_t intervalMs = (tick - lastTick) * TICK_INTERVAL_MS;
+		assert(intervalMs >= expectedIntervalMs);
+		assert(intervalMs <= expectedIntervalMs + MESH_SEND_STATE_INTERVAL_MS_VARIATION);
+		expectedIntervalMs = min(expectedIntervalMs * 2, (uint32_t)MESH_SEND_STATE_INTERVAL_MAX_MS);
+		assert(publisher.getKeepAliveIntervalMs() == expectedIntervalMs);
+	}
+
+	// A change is sent after a short delay, and resets the keep alive interval.
+	for (uint32_t i = 0; i < 10 * TICKS_PER_SECOND; ++i) {
+		publisher.tick(sample);
+	}
+	sample.switchState = 100;
+	uint32_t ticks = 0;
+	while (publisher.tick(sample) == MESH_STATE_PUBLISH_NONE) {
+		ticks++;
+	}
+	assert(ticks == MESH_SEND_STATE_CHANGE_DELAY_MS / TICK_INTERVAL_MS);
+	assert(publisher.getKeepAliveIntervalMs() == MESH_SEND_STATE_INTERVAL_MS);
+
+	// Another change shortly after is delayed until the min interval has passed.
+	sample.switchState = 0;
+	ticks = 0;
+	while (publisher.tick(sample) == MESH_STATE_PUBLISH_NONE) {
+		ticks++;
+	}
+	assert(ticks + 1 == MESH_SEND_STATE_MIN_INTERVAL_MS / TICK_INTERVAL_MS);
+
+	// A change that is undone before it is sent, is not sent.
+	for (uint32_t i = 0; i < 10 * TICKS_PER_SECOND; ++i) {
+		publisher.tick(sample);
+	}
+	sample.powerUsageMilliWatt = 50000;
+	assert(publisher.tick(sample) == MESH_STATE_PUBLISH_NONE);
+	sample.powerUsageMilliWatt = 0;
+	uint32_t changeSends = publisher.getNumChangeSends();
+	for (uint32_t i = 0; i < TICKS_PER_SECOND; ++i) {
+		assert(publisher.tick(sample) == MESH_STATE_PUBLISH_NONE);
+	}
+	assert(publisher.getNumChangeSends() == changeSends);
+}
+
+void testMessagesSaved() {
+	cout << "Simulate an hour of typical loads." << endl;
+	testProfile("idle", [](uint32_t) {
+		return makeSample(0, noise(200));
+	});
+	testProfile("noisy constant load", [](uint32_t) {
+		return makeSample(100, 40000 + noise(1500));
+	});
+	testProfile("fridge", [](uint32_t tick) {
+		// 15 minutes on, 30 minutes off.
+		bool on = (tick % (45 * 60 * TICKS_PER_SECOND)) < 15 * 60 * TICKS_PER_SECOND;
+		return makeSample(100, on ? 100000 + noise(3000) : noise(200));
+	});
+	testProfile("tv switched twice", [](uint32_t tick) {
+		bool on = tick > 10 * 60 * TICKS_PER_SECOND && tick < 40 * 60 * TICKS_PER_SECOND;
+		return makeSample(on ? 100 : 0, on ? 80000 + noise(8000) : 500 + noise(100));
+	});
+	testProfile("lamp switched every minute", [](uint32_t tick) {
+		bool on = (tick / (60 * TICKS_PER_SECOND)) % 2;
+		return makeSample(on ? 100 : 0, on ? 10000 + noise(300) : 0);
+	});
+}
+
+int main() {
+	cout << "Test MeshStatePublisher" << endl;
+	srand(1);
+
+	testSignificance();
+	testTiming();
+	testMessagesSaved();
+
+	cout << "MeshStatePublisher SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+#include <mesh/cs_MeshTelemetry.h>
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+
+using namespace std;
+
+uint32_t sumQueueWaitHistogram(const cs_mesh_telemetry_t& telemetry) {
+	uint32_t sum = 0;
+	for (int i = 0; i < MESH_TELEMETRY_HISTOGRAM_SIZE; ++i) {
+		sum += telemetry.queueWaitHistogram[i];
+	}
+	return sum;
+}
+
+uint32_t sumAckedLatencyHistogram(const cs_mesh_telemetry_t& telemetry) {
+	uint32_t sum = 0;
+	for (int i = 0; i < MESH_TELEMETRY_HISTOGRAM_SIZE; ++i) {
+		sum += telemetry.ackedLatencyHistogram[i];
+	}
+	return sum;
+}
+
+void testBuckets() {
+	cout << "Test histogram buckets." << endl;
+	assert(MeshTelemetry::getBucket(0) == 0);
+	assert(MeshTelemetry::getBucket(1) == 1);
+	assert(MeshTelemetry::getBucket(2) == 2);
+	assert(MeshTelemetry::getBucket(3) == 2);
+	assert(MeshTelemetry::getBucket(4) == 3);
+	assert(MeshTelemetry::getBucket(63) == 6);
+	assert(MeshTelemetry::getBucket(64) == 7);
+	assert(MeshTelemetry::getBucket(0xFFFF) == MESH_TELEMETRY_HISTOGRAM_SIZE - 1);
+}
+
+void testCounters() {
+	cout << "Test counters per model and per type." << endl;
+	MeshTelemetry telemetry;
+	telemetry.onQueued(MESH_TELEMETRY_MODEL_UNICAST, CS_MESH_MODEL_TYPE_STATE_SET);
+	telemetry.onSent(MESH_TELEMETRY_MODEL_UNICAST);
+	telemetry.onDropped(MESH_TELEMETRY_MODEL_UNICAST);
+	telemetry.onRetry(MESH_TELEMETRY_MODEL_MULTICAST_ACKED);
+	telemetry.onAckTimeout(MESH_TELEMETRY_MODEL_MULTICAST_ACKED);
+	telemetry.onReceived(MESH_TELEMETRY_MODEL_MULTICAST, CS_MESH_MODEL_TYPE_PROFILE_LOCATION, 0);
+	telemetry.onReceived(MESH_TELEMETRY_MODEL_MULTICAST, CS_MESH_MODEL_TYPE_PROFILE_LOCATION, 2);
+	telemetry.onReceived(MESH_TELEMETRY_MODEL_MULTICAST, CS_MESH_MODEL_TYPE_UNKNOWN, 0);
+
+	cs_mesh_telemetry_t& stats = telemetry.getStats();
+	assert(stats.models[MESH_TELEMETRY_MODEL_UNICAST].queued == 1);
+	assert(stats.models[MESH_TELEMETRY_MODEL_UNICAST].sent == 1);
+	assert(stats.models[MESH_TELEMETRY_MODEL_UNICAST].dropped == 1);
+	assert(stats.types[CS_MESH_MODEL_TYPE_STATE_SET].queued == 1);
+	assert(stats.models[MESH_TELEMETRY_MODEL_MULTICAST_ACKED].retries == 1);
+	assert(stats.models[MESH_TELEMETRY_MODEL_MULTICAST_ACKED].ackTimeouts == 1);
+	assert(stats.models[MESH_TELEMETRY_MODEL_MULTICAST].received == 3);
+	assert(stats.models[MESH_TELEMETRY_MODEL_MULTICAST].receivedRelayed == 1);
+	assert(stats.types[CS_MESH_MODEL_TYPE_PROFILE_LOCATION].received == 2);
+	// Unknown types are counted in the last entry.
+	assert(stats.types[MESH_TELEMETRY_NUM_TYPES - 1].received == 1);
+
+	telemetry.reset();
+	assert(stats.models[MESH_TELEMETRY_MODEL_UNICAST].queued == 0);
+	assert(stats.models[MESH_TELEMETRY_MODEL_MULTICAST].received == 0);
+}
+
+void testHistograms() {
+	cout << "Test queue wait and acked latency histograms." << endl;
+	MeshTelemetry telemetry;
+	uint32_t tickCount = 0xFFF0;
+	telemetry.tick(tickCount);
+	uint16_t queuedTick = telemetry.getTick();
+	telemetry.onFirstSent(queuedTick);
+	// Let the tick wrap around.
+	for (int i = 0; i < 40; ++i) {
+		telemetry.tick(++tickCount);
+	}
+	telemetry.onAcked(queuedTick);
+
+	cs_mesh_telemetry_t& stats = telemetry.getStats();
+	assert(stats.queueWaitHistogram[0] == 1);
+	assert(sumQueueWaitHistogram(stats) == 1);
+	assert(stats.ackedLatencyHistogram[MeshTelemetry::getBucket(40)] == 1);
+	assert(sumAckedLatencyHistogram(stats) == 1);
+}
+
+void testDuration() {
+	cout << "Test duration and result buffer." << endl;
+	MeshTelemetry telemetry;
+	for (uint32_t i = 0; i < 10 * 1000 / TICK_INTERVAL_MS; ++i) {
+		telemetry.tick(i);
+	}
+	assert(telemetry.getStats().durationSeconds == 10);
+
+	uint8_t buf[sizeof(cs_mesh_telemetry_t)];
+	cs_result_t smallResult(cs_data_t(buf, sizeof(buf) - 1));
+	telemetry.getStats(smallResult);
+	assert(smallResult.returnCode == ERR_BUFFER_TOO_SMALL);
+
+	cs_result_t result(cs_data_t(buf, sizeof(buf)));
+	telemetry.getStats(result);
+	assert(result.returnCode == ERR_SUCCESS);
+	assert(result.dataSize == sizeof(cs_mesh_telemetry_t));
+	assert(((cs_mesh_telemetry_t*)buf)->durationSeconds == 10);
+}
+
+int main() {
+	cout << "Test MeshTelemetry" << endl;
+
+	testBuckets();
+	testCounters();
+	testHistograms();
+	testDuration();
+
+	cout << "MeshTelemetry SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,192 @@
+#include <presence/cs_PresenceMatrix.h>
+
+#include <chrono>
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <list>
+
+using namespace std;
+
+const uint8_t timeoutSeconds = 10;
+const uint8_t meshThrottleSeconds = 30;
+
+void testUpdates() {
+	cout << "Test presence and occupied locations." << endl;
+	PresenceMatrix matrix;
+	assert(matrix.getOccupiedLocations() == 0);
+	assert(matrix.update(1, 2, timeoutSeconds, meshThrottleSeconds));
+	assert(matrix.update(3, 63, timeoutSeconds, meshThrottleSeconds));
+	assert(matrix.update(7, 2, timeoutSeconds, meshThrottleSeconds));
+	assert(matrix.isPresent(1, 2));
+	assert(!matrix.isPresent(1, 63));
+	assert(matrix.getNumPresent() == 3);
+	assert(matrix.getOccupiedLocations() == ((1ULL << 2) | (1ULL << 63)));
+
+	cout << "Test the mesh throttle." << endl;
+	assert(!matrix.update(1, 2, timeoutSeconds, meshThrottleSeconds));
+	for (uint8_t i = 0; i < meshThrottleSeconds; ++i) {
+		// Keep it present, so that only the throttle matters.
+		if (i % (timeoutSeconds / 2) == 0) {
+			assert(!matrix.update(1, 2, timeoutSeconds, meshThrottleSeconds));
+		}
+		matrix.tickSecond();
+	}
+	assert(matrix.update(1, 2, timeoutSeconds, meshThrottleSeconds));
+	assert(!matrix.update(1, 2, timeoutSeconds, meshThrottleSeconds));
+
+	cout << "Test timeouts." << endl;
+	for (uint8_t i = 0; i < timeoutSeconds - 1; ++i) {
+		matrix.tickSecond();
+	}
+	assert(matrix.getOccupiedLocations() == (1ULL << 2));
+	assert(matrix.isPresent(1, 2));
+	matrix.tickSecond();
+	assert(matrix.getOccupiedLocations() == 0);
+	assert(matrix.getNumPresent() == 0);
+
+	// The throttle restarts when a profile location is new again.
+	assert(matrix.update(1, 2, timeoutSeconds, meshThrottleSeconds));
+
+	cout << "Test that the location stays occupied while any profile is there." << endl;
+	matrix.clear();
+	matrix.update(0, 5, 2, meshThrottleSeconds);
+	matrix.update(4, 5, 4, meshThrottleSeconds);
+	matrix.tickSecond();
+	matrix.tickSecond();
+	assert(!matrix.isPresent(0, 5));
+	assert(matrix.getOccupiedLocations() == (1ULL << 5));
+	matrix.tickSecond();
+	matrix.tickSecond();
+	assert(matrix.getOccupiedLocations() == 0);
+}
+
+/**
+ * The list of records that the presence handler used to keep, as reference.
+ */
+struct Record {
+	uint8_t who;
+	uint8_t where;
+	uint8_t timeoutCountdownSeconds;
+	uint8_t meshSendCountdownSeconds;
+};
+
+struct ReferenceModel {
+	list<Record> records;
+
+	bool update(uint8_t profile, uint8_t location) {
+		uint8_t meshCountdown = 0;
+		for (auto iter = records.begin(); iter != records.end(); ++iter) {
+			if (iter->who == profile && iter->where == location) {
+				meshCountdown = iter->meshSendCountdownSeconds;
+				records.erase(iter);
+				break;
+			}
+		}
+		bool send = false;
+		if (meshCountdown == 0) {
+			send = true;
+			meshCountdown = meshThrottleSeconds;
+		}
+		records.push_front({profile, location, timeoutSeconds, meshCountdown});
+		return send;
+	}
+
+	uint64_t getOccupiedLocations() {
+		uint64_t mask = 0;
+		for (auto& record: records) {
+			mask |= 1ULL << record.where;
+		}
+		return mask;
+	}
+
+	void tickSecond() {
+		for (auto iter = records.begin(); iter != records.end();) {
+			if (iter->timeoutCountdownSeconds) {
+				iter->timeoutCountdownSeconds--;
+			}
+			if (iter->timeoutCountdownSeconds == 0) {
+				iter = records.erase(iter);
+			}
+			else {
+				if (iter->meshSendCountdownSeconds) {
+					iter->meshSendCountdownSeconds--;
+				}
+				++iter;
+			}
+		}
+	}
+};
+
+void testAgainstReference(uint32_t updates) {
+	cout << "Test " << updates << " random updates against the list of records." << endl;
+	PresenceMatrix matrix;
+	ReferenceModel reference;
+	srand(1);
+	for (uint32_t i = 0; i < updates; ++i) {
+		// Few profiles and locations, so that they are updated often.
+		uint8_t profile = rand() % 4;
+		uint8_t location = 30 + rand() % 6;
+		assert(matrix.update(profile, location, timeoutSeconds, meshThrottleSeconds) == reference.update(profile, location));
+		if (rand() % 3 == 0) {
+			matrix.tickSecond();
+			reference.tickSecond();
+		}
+		assert(matrix.getOccupiedLocations() == reference.getOccupiedLocations());
+		assert(matrix.getNumPresent() == reference.records.size());
+	}
+}
+
+/**
+ * Time an update with mutation detection, as the presence handler does for each background advertisement.
+ */
+void benchmark(uint32_t updates) {
+	cout << "Benchmark " << updates << " updates with 20 present profile locations." << endl;
+	uint8_t profiles[20];
+	uint8_t locations[20];
+	for (int i = 0; i < 20; ++i) {
+		profiles[i] = i % 8;
+		locations[i] = (i * 13) % 64;
+	}
+
+	ReferenceModel reference;
+	uint32_t mutations = 0;
+	auto start = chrono::steady_clock::now();
+	for (uint32_t i = 0; i < updates; ++i) {
+		uint64_t prev = reference.getOccupiedLocations();
+		reference.update(profiles[i % 20], locations[i % 20]);
+		mutations += (prev != reference.getOccupiedLocations());
+		if (i % 1000 == 0) {
+			reference.tickSecond();
+		}
+	}
+	auto listNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+
+	PresenceMatrix matrix;
+	uint32_t matrixMutations = 0;
+	start = chrono::steady_clock::now();
+	for (uint32_t i = 0; i < updates; ++i) {
+		uint64_t prev = matrix.getOccupiedLocations();
+		matrix.update(profiles[i % 20], locations[i % 20], timeoutSeconds, meshThrottleSeconds);
+		matrixMutations += (prev != matrix.getOccupiedLocations());
+		if (i % 1000 == 0) {
+			matrix.tickSecond();
+		}
+	}
+	auto matrixNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+	assert(mutations == matrixMutations);
+
+	cout << "  list:   " << updates * 1e9 / listNs << " updates per second" << endl;
+	cout << "  matrix: " << updates * 1e9 / matrixNs << " updates per second" << endl;
+}
+
+int main() {
+	cout << "Test PresenceMatrix" << endl;
+
+	testUpdates();
+	testAgainstReference(100000);
+	benchmark(1000000);
+
+	cout << "PresenceMatrix SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}
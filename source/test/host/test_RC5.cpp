@@ -0,0 +1,252 @@
+#include <processing/cs_RC5.h>
+#include <processing/cs_RC5ValidationCache.h>
+
+#include <chrono>
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+
+using namespace std;
+
+/**
+ * Test vector for RC5-16/16/8, from "Test Cases for RC5 and RC6 variants" (draft-krovetz-rc6-rc5-vectors).
+ * Words are little endian.
+ */
+void testKnownVector() {
+	cout << "Test the RC5-16/16/8 vector." << endl;
+	uint8_t key[8] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07};
+	uint16_t plain[2] = {0x0100, 0x0302};
+	uint16_t encrypted[2] = {0xA823, 0x2ED7};
+	RC5<16> rc5;
+	assert(rc5.prepareKey(key, sizeof(key)));
+	uint16_t result[2];
+	rc5.encrypt(plain, result);
+	assert(result[0] == encrypted[0] && result[1] == encrypted[1]);
+	rc5.decrypt(encrypted, result);
+	assert(result[0] == plain[0] && result[1] == plain[1]);
+}
+
+/**
+ * The key schedule and decryption that the encryption handler used to have, as reference.
+ */
+#define ROTL_16BIT(x, shift) ((x)<<(shift) | (x)>>(16-(shift)))
+#define ROTR_16BIT(x, shift) ((x)>>(shift) | (x)<<(16-(shift)))
+
+struct ReferenceRC5 {
+	uint16_t subKeys[RC5_NUM_SUBKEYS];
+
+	void prepareKey(uint8_t* key) {
+		int keyLenWords = ((RC5_KEYLEN-1)/sizeof(uint16_t))+1;
+		int loops = 3 * (RC5_NUM_SUBKEYS > keyLenWords ? RC5_NUM_SUBKEYS : keyLenWords);
+		uint16_t L[RC5_KEYLEN / 2] = {0};
+		for (int i = 0; i<keyLenWords; ++i) {
+			L[i] = (key[2*i+1] << 8) + key[2*i];
+		}
+		subKeys[0] = RC5_16BIT_P;
+		for (int i = 1; i < RC5_NUM_SUBKEYS; ++i) {
+			subKeys[i] = subKeys[i-1] + RC5_16BIT_Q;
+		}
+		uint16_t i = 0;
+		uint16_t j = 0;
+		uint16_t a = 0;
+		uint16_t b = 0;
+		uint16_t sum;
+		for (int k=0; k<loops; ++k) {
+			sum = subKeys[i] + a + b;
+			a = ROTL_16BIT(sum, 3);
+			subKeys[i] = a;
+			sum = L[j] + a + b;
+			b = ROTL_16BIT(sum, (a+b) % 16);
+			L[j] = b;
+			++i;
+			++j;
+			i %= RC5_NUM_SUBKEYS;
+			j %= keyLenWords;
+		}
+	}
+
+	void decrypt(uint16_t* encryptedData, uint16_t* target) {
+		uint16_t a = encryptedData[0];
+		uint16_t b = encryptedData[1];
+		uint16_t sum;
+		for (uint16_t i=RC5_ROUNDS; i>0; --i) {
+			sum = b - subKeys[2*i + 1];
+			b = ROTR_16BIT(sum, a % 16) ^ a;
+			sum = a - subKeys[2*i];
+			a = ROTR_16BIT(sum, b % 16) ^ b;
+		}
+		target[0] = a - subKeys[0];
+		target[1] = b - subKeys[1];
+	}
+};
+
+void testAgainstReference(uint32_t numKeys, uint32_t blocksPerKey) {
+	cout << "Test " << numKeys << " random keys against the reference." << endl;
+	srand(1);
+	RC5<> rc5;
+	ReferenceRC5 reference;
+	uint8_t key[RC5_KEYLEN];
+	for (uint32_t k = 0; k < numKeys; ++k) {
+		for (uint8_t i = 0; i < RC5_KEYLEN; ++i) {
+			key[i] = rand();
+		}
+		assert(rc5.prepareKey(key, sizeof(key)));
+		reference.prepareKey(key);
+		for (uint32_t n = 0; n < blocksPerKey; ++n) {
+			uint16_t encrypted[2] = {(uint16_t)rand(), (uint16_t)rand()};
+			uint16_t expected[2];
+			uint16_t result[2];
+			reference.decrypt(encrypted, expected);
+			rc5.decrypt(encrypted, result);
+			assert(result[0] == expected[0] && result[1] == expected[1]);
+
+			rc5.encrypt(result, result);
+			assert(result[0] == encrypted[0] && result[1] == encrypted[1]);
+		}
+	}
+}
+
+void testBatch() {
+	cout << "Test batch decrypt." << endl;
+	uint8_t key[RC5_KEYLEN] = {0x10, 0x32, 0x54, 0x76, 0x98, 0xBA, 0xDC, 0xFE, 0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+	RC5<> rc5;
+	assert(rc5.prepareKey(key, sizeof(key)));
+	assert(!rc5.prepareKey(key, 0));
+	assert(!rc5.prepareKey(key, 15));
+	assert(!rc5.prepareKey(key, 18));
+
+	const uint8_t numBlocks = 8;
+	uint16_t encrypted[numBlocks * 2];
+	uint16_t expected[numBlocks * 2];
+	for (uint8_t i = 0; i < numBlocks * 2; ++i) {
+		encrypted[i] = 0xCAFE * i + 12345;
+	}
+	for (uint8_t n = 0; n < numBlocks; ++n) {
+		rc5.decrypt(encrypted + 2 * n, expected + 2 * n);
+	}
+	uint16_t result[numBlocks * 2];
+	rc5.decrypt(encrypted, result, numBlocks);
+	for (uint8_t i = 0; i < numBlocks * 2; ++i) {
+		assert(result[i] == expected[i]);
+	}
+
+	// In place.
+	rc5.decrypt(encrypted, encrypted, numBlocks);
+	for (uint8_t i = 0; i < numBlocks * 2; ++i) {
+		assert(encrypted[i] == expected[i]);
+	}
+}
+
+void testCache() {
+	cout << "Test the validation cache." << endl;
+	RC5ValidationCache cache;
+	uint16_t encrypted[2] = {1234, 5678};
+	uint16_t decrypted[2] = {0xCAFE, 0x1234};
+	uint16_t result[2];
+	bool valid;
+	assert(!cache.get(encrypted, 100, result, valid));
+	cache.set(encrypted, 100, decrypted, true);
+	assert(cache.get(encrypted, 100, result, valid));
+	assert(valid && result[0] == decrypted[0] && result[1] == decrypted[1]);
+
+	// Another time window is a miss.
+	assert(!cache.get(encrypted, 101, result, valid));
+	cache.set(encrypted, 101, decrypted, false);
+	assert(cache.get(encrypted, 101, result, valid));
+	assert(!valid);
+	assert(!cache.get(encrypted, 100, result, valid));
+
+	// Another payload is a miss.
+	uint16_t other[2] = {1234, 5679};
+	assert(!cache.get(other, 101, result, valid));
+
+	cout << "Test that the oldest result is replaced." << endl;
+	cache.clear();
+	for (uint16_t i = 0; i <= RC5_VALIDATION_CACHE_SIZE; ++i) {
+		uint16_t payload[2] = {i, 0};
+		cache.set(payload, 101, decrypted, true);
+	}
+	uint16_t oldest[2] = {0, 0};
+	uint16_t newest[2] = {RC5_VALIDATION_CACHE_SIZE, 0};
+	assert(!cache.get(oldest, 101, result, valid));
+	assert(cache.get(newest, 101, result, valid));
+
+	cache.clear();
+	assert(!cache.get(newest, 101, result, valid));
+	assert(cache.getHits() == 0 && cache.getMisses() == 1);
+}
+
+/**
+ * Time decryption of broadcasts of a few phones, which repeat their payload many times in a time window.
+ */
+void benchmark(uint32_t numAdvertisements) {
+	cout << "Benchmark " << numAdvertisements << " advertisements of 8 phones." << endl;
+	uint8_t key[RC5_KEYLEN] = {0x10, 0x32, 0x54, 0x76, 0x98, 0xBA, 0xDC, 0xFE, 0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+	const uint8_t batchSize = 8;
+	uint16_t payloads[batchSize * 2];
+	for (uint8_t i = 0; i < batchSize * 2; ++i) {
+		payloads[i] = rand();
+	}
+	volatile uint16_t sink = 0;
+
+	// Key schedule for every advertisement.
+	ReferenceRC5 reference;
+	uint16_t result[batchSize * 2];
+	auto start = chrono::steady_clock::now();
+	for (uint32_t i = 0; i < numAdvertisements; ++i) {
+		reference.prepareKey(key);
+		reference.decrypt(payloads + 2 * (i % batchSize), result);
+		sink = sink + result[0];
+	}
+	auto prepareNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+
+	start = chrono::steady_clock::now();
+	for (uint32_t i = 0; i < numAdvertisements; ++i) {
+		reference.decrypt(payloads + 2 * (i % batchSize), result);
+		sink = sink + result[0];
+	}
+	auto referenceNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+
+	RC5<> rc5;
+	rc5.prepareKey(key, sizeof(key));
+	start = chrono::steady_clock::now();
+	for (uint32_t i = 0; i < numAdvertisements; i += batchSize) {
+		payloads[0] += 1;
+		rc5.decrypt(payloads, result, batchSize);
+		sink = sink + result[0];
+	}
+	auto batchNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+
+	RC5ValidationCache cache;
+	bool valid;
+	start = chrono::steady_clock::now();
+	for (uint32_t i = 0; i < numAdvertisements; ++i) {
+		uint16_t* payload = payloads + 2 * (i % batchSize);
+		// The time window changes every 1000 advertisements.
+		uint16_t timeWindow = i / 1000;
+		if (!cache.get(payload, timeWindow, result, valid)) {
+			rc5.decrypt(payload, result);
+			cache.set(payload, timeWindow, result, result[0] == 0xCAFE);
+		}
+		sink = sink + result[0];
+	}
+	auto cacheNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+
+	cout << "  key schedule per adv: " << (float)prepareNs / numAdvertisements << " ns per adv" << endl;
+	cout << "  single:               " << (float)referenceNs / numAdvertisements << " ns per adv" << endl;
+	cout << "  batch:                " << (float)batchNs / numAdvertisements << " ns per adv" << endl;
+	cout << "  cached:               " << (float)cacheNs / numAdvertisements << " ns per adv, hit rate " << 100.0 * cache.getHits() / numAdvertisements << "%" << endl;
+}
+
+int main() {
+	cout << "Test RC5" << endl;
+
+	testKnownVector();
+	testAgainstReference(100, 1000);
+	testBatch();
+	testCache();
+	benchmark(1000000);
+
+	cout << "RC5 SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}
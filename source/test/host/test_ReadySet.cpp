@@ -0,0 +1,162 @@
+#include <util/cs_ReadySet.h>
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <chrono>
+
+using namespace std;
+
+/**
+ * Reference implementation: the linear scans that were used by the mesh model queues.
+ */
+template<uint16_t Size>
+class LinearQueue {
+public:
+	uint8_t transmissions[Size] = {};
+	bool priority[Size] = {};
+
+	int getFree(uint16_t startIndex) {
+		for (int i = startIndex + Size; i > startIndex; --i) {
+			int index = i % Size;
+			if (transmissions[index] == 0) {
+				return index;
+			}
+		}
+		return -1;
+	}
+
+	int getNext(uint16_t startIndex, bool prio) {
+		for (int i = startIndex; i < startIndex + Size; ++i) {
+			int index = i % Size;
+			if ((!prio || priority[index]) && transmissions[index] > 0) {
+				return index;
+			}
+		}
+		return -1;
+	}
+};
+
+/**
+ * Perform random adds and sends on both implementations, and check they pick the same slots.
+ */
+template<uint16_t Size>
+void testEquivalence(int numOperations) {
+	cout << "Test equivalence with linear scan for size " << Size << endl;
+	ReadySet<Size> readySet;
+	LinearQueue<Size> reference;
+	uint16_t indexNext = 0;
+	for (int i = 0; i < numOperations; ++i) {
+		if (rand() % 2) {
+			int index = readySet.getFree(indexNext);
+			assert(index == reference.getFree(indexNext));
+			if (index < 0) {
+				continue;
+			}
+			reference.transmissions[index] = 1 + rand() % 5;
+			reference.priority[index] = (rand() % 4 == 0);
+			readySet.setReady(index, reference.priority[index]);
+			indexNext = index;
+		}
+		else {
+			int index = readySet.getNext(indexNext, true);
+			assert(index == reference.getNext(indexNext, true));
+			if (index == -1) {
+				index = readySet.getNext(indexNext, false);
+				assert(index == reference.getNext(indexNext, false));
+			}
+			if (index == -1) {
+				continue;
+			}
+			if (--reference.transmissions[index] == 0) {
+				readySet.release(index);
+			}
+			indexNext = (index + 1) % Size;
+		}
+		for (uint16_t j = 0; j < Size; ++j) {
+			assert(readySet.isReady(j) == (reference.transmissions[j] > 0));
+		}
+	}
+}
+
+template<uint16_t Size>
+void testFullAndEmpty() {
+	cout << "Test full and empty for size " << Size << endl;
+	ReadySet<Size> readySet;
+	for (uint16_t i = 0; i < Size; ++i) {
+		assert(readySet.getNext(i, false) == -1);
+		assert(readySet.getFree(i) == i);
+	}
+	for (uint16_t i = 0; i < Size; ++i) {
+		readySet.setReady(i, false);
+	}
+	for (uint16_t i = 0; i < Size; ++i) {
+		assert(readySet.getFree(i) == -1);
+		assert(readySet.getNext(i, false) == i);
+		assert(readySet.getNext(i, true) == -1);
+	}
+	readySet.release(Size - 1);
+	assert(readySet.getFree(0) == Size - 1);
+	readySet.clear();
+	assert(readySet.getNext(0, false) == -1);
+}
+
+/**
+ * Time scheduling a nearly empty queue, which is the worst case for a linear scan.
+ */
+template<uint16_t Size>
+void benchmark() {
+	const int iterations = 1000000;
+	ReadySet<Size> readySet;
+	LinearQueue<Size> reference;
+	readySet.setReady(Size / 2, false);
+	reference.transmissions[Size / 2] = 1;
+
+	volatile int sink = 0;
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < iterations; ++i) {
+		uint16_t startIndex = (Size / 2 + 1 + i) % Size;
+		int index = reference.getNext(startIndex, true);
+		if (index == -1) {
+			index = reference.getNext(startIndex, false);
+		}
+		sink += index;
+	}
+	auto linearTime = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+
+	start = chrono::steady_clock::now();
+	for (int i = 0; i < iterations; ++i) {
+		uint16_t startIndex = (Size / 2 + 1 + i) % Size;
+		int index = readySet.getNext(startIndex, true);
+		if (index == -1) {
+			index = readySet.getNext(startIndex, false);
+		}
+		sink += index;
+	}
+	auto readySetTime = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+	cout << "Size " << Size << ": linear scan " << linearTime << " us, ready set " << readySetTime << " us, for " << iterations << " lookups" << endl;
+}
+
+int main() {
+	cout << "Test ReadySet implementation" << endl;
+	srand(1);
+
+	testFullAndEmpty<1>();
+	testFullAndEmpty<20>();
+	testFullAndEmpty<32>();
+	testFullAndEmpty<64>();
+	testFullAndEmpty<100>();
+
+	testEquivalence<1>(1000);
+	testEquivalence<20>(100000);
+	testEquivalence<32>(100000);
+	testEquivalence<64>(100000);
+	testEquivalence<100>(100000);
+
+	benchmark<20>();
+	benchmark<64>();
+	benchmark<128>();
+
+	cout << "ReadySet SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,216 @@
+#include <cfg/cs_Config.h>
+#include <processing/cs_ScanAggregator.h>
+#include <util/cs_Utils.h>
+
+#include <chrono>
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+
+vector<uint8_t> backgroundAdv = {0x02, 0x01, 0x1A, 0x14, 0xFF, 0x4C, 0x00, 0x01, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x08};
+vector<uint8_t> commandAdv = {0x02, 0x01, 0x1A, 0x09, 0x03, 0x12, 0x04, 0x34, 0x48, 0x56, 0x8C, 0x78, 0xD0, 0x11, 0x07, 0x1B, 0x2C, 0x3D, 0x4E, 0x5F, 0x60, 0x71, 0x82, 0x93, 0xA4, 0xB5, 0xC6, 0xD7, 0xE8, 0xF9, 0x0A};
+
+vector<scanned_device_record_t> received;
+uint32_t numBatches = 0;
+
+void onBatch(scanned_device_batch_t& batch) {
+	numBatches++;
+	for (uint8_t i = 0; i < batch.size; ++i) {
+		received.push_back(batch.records[i]);
+		// The copy should point to its own data again.
+		received.back().device.data = received.back().data;
+	}
+}
+
+scanned_device_t makeScannedDevice(vector<uint8_t>& adv, uint8_t addressByte, int8_t rssi) {
+	scanned_device_t device = {};
+	device.address[0] = addressByte;
+	device.rssi = rssi;
+	device.data = adv.data();
+	device.dataSize = adv.size();
+	BLEutil::indexAdvData(device.data, device.dataSize, &device.advIndex);
+	return device;
+}
+
+void testBatches(ScanAggregator& aggregator) {
+	cout << "Test that a full batch is delivered." << endl;
+	aggregator.setCollapseDuplicates(false);
+	received.clear();
+	numBatches = 0;
+	vector<uint8_t> adv = backgroundAdv;
+	for (uint8_t i = 0; i < SCAN_BATCH_SIZE - 1; ++i) {
+		scanned_device_t device = makeScannedDevice(adv, i, -50 - i);
+		assert(aggregator.add(&device) == ERR_SUCCESS);
+	}
+	assert(numBatches == 0);
+
+	// The data should have been copied.
+	adv[5] = 0;
+	scanned_device_t device = makeScannedDevice(adv, SCAN_BATCH_SIZE - 1, -40);
+	assert(aggregator.add(&device) == ERR_SUCCESS);
+	assert(numBatches == 1);
+	assert(received.size() == SCAN_BATCH_SIZE);
+	for (uint8_t i = 0; i < SCAN_BATCH_SIZE; ++i) {
+		scanned_device_record_t& record = received[i];
+		assert(record.device.address[0] == i);
+		assert(record.count == 1);
+		assert(record.device.rssi == record.rssiMax);
+		assert(record.device.dataSize == backgroundAdv.size());
+		assert(record.device.advIndex.manufacturerData.offset == device.advIndex.manufacturerData.offset);
+		assert(record.data[5] == ((i == SCAN_BATCH_SIZE - 1) ? 0 : backgroundAdv[5]));
+	}
+
+	cout << "Test that a batch is delivered on timeout." << endl;
+	aggregator.tick();
+	assert(numBatches == 1);
+	device = makeScannedDevice(commandAdv, 1, -60);
+	aggregator.add(&device);
+	uint32_t timeoutTicks = (SCAN_BATCH_TIMEOUT_MS + TICK_INTERVAL_MS - 1) / TICK_INTERVAL_MS;
+	for (uint32_t i = 0; i < timeoutTicks - 1; ++i) {
+		aggregator.tick();
+		assert(numBatches == 1);
+	}
+	aggregator.tick();
+	assert(numBatches == 2);
+	assert(received.size() == SCAN_BATCH_SIZE + 1);
+	assert(memcmp(received.back().data, commandAdv.data(), commandAdv.size()) == 0);
+
+	cout << "Test that too large data is rejected." << endl;
+	vector<uint8_t> largeAdv(ADVERTISEMENT_DATA_MAX_SIZE + 1, 0);
+	device = makeScannedDevice(largeAdv, 1, -60);
+	assert(aggregator.add(&device) == ERR_WRONG_PAYLOAD_LENGTH);
+	aggregator.flush();
+	assert(numBatches == 2);
+}
+
+void testDuplicates(ScanAggregator& aggregator) {
+	cout << "Test that duplicates are collapsed." << endl;
+	aggregator.setCollapseDuplicates(true);
+	received.clear();
+	numBatches = 0;
+	int8_t rssis[] = {-70, -50, -60, -80};
+	for (int8_t rssi: rssis) {
+		scanned_device_t device = makeScannedDevice(backgroundAdv, 1, rssi);
+		aggregator.add(&device);
+	}
+	// Same address, other data: a phone broadcasts different commands from the same address.
+	scanned_device_t device = makeScannedDevice(commandAdv, 1, -55);
+	aggregator.add(&device);
+	// Other address, same data.
+	device = makeScannedDevice(backgroundAdv, 2, -65);
+	aggregator.add(&device);
+	aggregator.flush();
+
+	assert(numBatches == 1);
+	assert(received.size() == 3);
+	assert(received[0].count == 4);
+	assert(received[0].rssiMax == -50);
+	assert(received[0].device.rssi == -65);
+	assert(received[1].count == 1);
+	assert(received[1].device.rssi == -55);
+	assert(received[2].count == 1);
+	assert(received[2].device.address[0] == 2);
+	aggregator.setCollapseDuplicates(false);
+}
+
+/**
+ * Stand in for the event dispatcher: each dispatch goes by all listeners, most of which ignore scans.
+ */
+struct Listener {
+	virtual void handleEvent(int type, void* data) = 0;
+	virtual ~Listener() = default;
+};
+
+struct IgnoringListener: Listener {
+	uint32_t handled = 0;
+	void handleEvent(int type, void*) override {
+		if (type == 0) {
+			handled++;
+		}
+	}
+};
+
+struct ScanListener: Listener {
+	uint32_t rssiSum = 0;
+	void handleEvent(int type, void* data) override {
+		switch (type) {
+			case 1: {
+				scanned_device_t* device = (scanned_device_t*)data;
+				rssiSum += device->rssi;
+				break;
+			}
+			case 2: {
+				scanned_device_batch_t* batch = (scanned_device_batch_t*)data;
+				for (uint8_t i = 0; i < batch->size; ++i) {
+					rssiSum += batch->records[i].device.rssi;
+				}
+				break;
+			}
+		}
+	}
+};
+
+#define NUM_LISTENERS 24
+Listener* listeners[NUM_LISTENERS];
+
+void dispatch(int type, void* data) {
+	for (int i = 0; i < NUM_LISTENERS; ++i) {
+		listeners[i]->handleEvent(type, data);
+	}
+}
+
+void dispatchBatch(scanned_device_batch_t& batch) {
+	dispatch(2, &batch);
+}
+
+/**
+ * Time the dispatch of each advertisement, against adding it to a batch and dispatching the batch.
+ */
+void benchmark(ScanAggregator& aggregator, uint32_t iterations) {
+	ScanListener scanListeners[2];
+	IgnoringListener ignoringListeners[NUM_LISTENERS - 2];
+	for (int i = 0; i < NUM_LISTENERS; ++i) {
+		listeners[i] = (i % 12 == 0) ? (Listener*)&scanListeners[i / 12] : (Listener*)&ignoringListeners[i - i / 12 - 1];
+	}
+	cout << "Benchmark " << iterations << " advertisements, " << NUM_LISTENERS << " listeners." << endl;
+
+	scanned_device_t device = makeScannedDevice(backgroundAdv, 1, -60);
+	auto start = chrono::steady_clock::now();
+	for (uint32_t i = 0; i < iterations; ++i) {
+		device.rssi = -(i & 0x3F);
+		dispatch(1, &device);
+	}
+	auto singleNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+	uint32_t singleSum = scanListeners[0].rssiSum;
+
+	scanListeners[0].rssiSum = 0;
+	aggregator.setCallback(dispatchBatch);
+	start = chrono::steady_clock::now();
+	for (uint32_t i = 0; i < iterations; ++i) {
+		device.rssi = -(i & 0x3F);
+		aggregator.add(&device);
+	}
+	aggregator.flush();
+	auto batchNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+	assert(scanListeners[0].rssiSum == singleSum);
+	aggregator.setCallback(onBatch);
+
+	cout << "  one event per advertisement: " << (float)singleNs / iterations << " ns per advertisement" << endl;
+	cout << "  batches of " << SCAN_BATCH_SIZE << ":                 " << (float)batchNs / iterations << " ns per advertisement" << endl;
+}
+
+int main() {
+	cout << "Test ScanAggregator" << endl;
+	ScanAggregator& aggregator = ScanAggregator::getInstance();
+	aggregator.setCallback(onBatch);
+
+	testBatches(aggregator);
+	testDuplicates(aggregator);
+	benchmark(aggregator, 1000000);
+
+	cout << "ScanAggregator SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,237 @@
+#include <processing/cs_ScanDutyController.h>
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+
+using namespace std;
+
+void testBounds() {
+	cout << "Test bounds." << endl;
+	ScanDutyController controller;
+	assert(controller.getDutyPercent() == SCAN_DUTY_MIN_PERCENT);
+	assert(controller.setBounds(50, 40) == ERR_WRONG_PARAMETER);
+	assert(controller.setBounds(10, 101) == ERR_WRONG_PARAMETER);
+	assert(controller.setBounds(10, 100) == ERR_WRONG_PARAMETER);
+	assert(controller.setBounds(100, 100) == ERR_WRONG_PARAMETER);
+	assert(controller.setBounds(0, 30) == ERR_WRONG_PARAMETER);
+	assert(controller.setBounds(30, 60) == ERR_SUCCESS);
+	assert(controller.getDutyPercent() == 30);
+	for (int i = 0; i < 100; ++i) {
+		controller.addHit();
+		controller.tickSecond();
+		assert(controller.getDutyPercent() <= 60);
+	}
+	assert(controller.getDutyPercent() == 60);
+	assert(controller.setBounds(1, 30) == ERR_SUCCESS);
+	assert(controller.getDutyPercent() == 30);
+
+	cout << "Test durations." << endl;
+	assert(controller.getScanDuration(9000) == 2700);
+	assert(controller.getScanBreakDuration(9000) == 6300);
+	assert(controller.setBounds(99, 99) == ERR_SUCCESS);
+	assert(controller.getScanDuration(100000) == 0xFFFF);
+	assert(controller.getScanBreakDuration(100000) == 1000);
+
+	cout << "Test that no duration is shorter than the minimum." << endl;
+	assert(controller.getScanBreakDuration(500) == SCAN_DUTY_MIN_PHASE_MS);
+	assert(controller.setBounds(1, 1) == ERR_SUCCESS);
+	assert(controller.getScanDuration(500) == SCAN_DUTY_MIN_PHASE_MS);
+	assert(controller.getScanDuration(0) == SCAN_DUTY_MIN_PHASE_MS);
+	assert(controller.getScanBreakDuration(0) == SCAN_DUTY_MIN_PHASE_MS);
+}
+
+void testIdle() {
+	cout << "Test that an idle trace stays at the minimum." << endl;
+	ScanDutyController controller;
+	for (int i = 0; i < 3600; ++i) {
+		controller.tickSecond();
+		assert(controller.getDutyPercent() == SCAN_DUTY_MIN_PERCENT);
+	}
+	assert(controller.getHitsPerSecondCenti() == 0);
+}
+
+void testBurst() {
+	cout << "Test that a burst raises the duty to the maximum." << endl;
+	ScanDutyController controller;
+	int seconds = 0;
+	while (controller.getDutyPercent() < SCAN_DUTY_MAX_PERCENT) {
+		controller.addHit();
+		controller.tickSecond();
+		seconds++;
+	}
+	assert(seconds == (SCAN_DUTY_MAX_PERCENT - SCAN_DUTY_MIN_PERCENT + SCAN_DUTY_RISE_PERCENT - 1) / SCAN_DUTY_RISE_PERCENT);
+
+	cout << "Test that the duty is held after the last hit." << endl;
+	for (int i = 0; i < SCAN_DUTY_HOLD_SECONDS; ++i) {
+		controller.tickSecond();
+		assert(controller.getDutyPercent() == SCAN_DUTY_MAX_PERCENT);
+	}
+
+	cout << "Test that the duty decays to the minimum." << endl;
+	uint8_t prev = controller.getDutyPercent();
+	seconds = 0;
+	while (controller.getDutyPercent() > SCAN_DUTY_MIN_PERCENT) {
+		controller.tickSecond();
+		assert(controller.getDutyPercent() < prev);
+		prev = controller.getDutyPercent();
+		seconds++;
+	}
+	cout << "  decayed in " << seconds << " seconds" << endl;
+	assert(seconds < 60);
+
+	cout << "Test that a single hit restarts the hold." << endl;
+	controller.addHit();
+	controller.tickSecond();
+	assert(controller.getDutyPercent() == SCAN_DUTY_MIN_PERCENT + SCAN_DUTY_RISE_PERCENT);
+}
+
+void testCommandBoost() {
+	cout << "Test that a command advertisement boosts the duty right away." << endl;
+	ScanDutyController controller;
+	controller.addCommandHit();
+	assert(controller.getDutyPercent() == SCAN_DUTY_MAX_PERCENT);
+	assert(controller.getScanBreakDuration(9000) == 9000 - 9000 * SCAN_DUTY_MAX_PERCENT / 100);
+	for (int i = 0; i < SCAN_DUTY_COMMAND_BOOST_SECONDS - 1; ++i) {
+		controller.tickSecond();
+		assert(controller.getDutyPercent() == SCAN_DUTY_MAX_PERCENT);
+	}
+
+	cout << "Check that the duty is no longer boosted after the boost time, but still raised by the hit." << endl;
+	controller.tickSecond();
+	assert(controller.getDutyPercent() == SCAN_DUTY_MIN_PERCENT + SCAN_DUTY_RISE_PERCENT);
+}
+
+void testHitRate() {
+	cout << "Test the average hits per second." << endl;
+	ScanDutyController controller;
+	for (int i = 0; i < 200; ++i) {
+		for (int j = 0; j < 5; ++j) {
+			controller.addHit();
+		}
+		controller.tickSecond();
+	}
+	assert(controller.getHitsPerSecondCenti() >= 495 && controller.getHitsPerSecondCenti() <= 505);
+
+	uint8_t buf[sizeof(cs_scan_duty_stats_t)];
+	cs_result_t result(cs_data_t(buf, sizeof(buf) - 1));
+	controller.getStats(result);
+	assert(result.returnCode == ERR_BUFFER_TOO_SMALL);
+	result = cs_result_t(cs_data_t(buf, sizeof(buf)));
+	controller.getStats(result);
+	assert(result.returnCode == ERR_SUCCESS);
+	cs_scan_duty_stats_t* stats = (cs_scan_duty_stats_t*)buf;
+	assert(stats->dutyPercent == SCAN_DUTY_MAX_PERCENT);
+	assert(stats->totalHits == 1000);
+}
+
+/**
+ * Simulate a day with visits of phones, and compare against scanning with the default fixed duty.
+ *
+ * A visiting phone advertises relevantly a few times per second, and is only heard while scanning.
+ * Now and then, it sends a command: a command advertisement that is repeated for a few seconds.
+ * Like the scanner, the scan duration is read at the start of each scan period, and the break duration at the end of the scan.
+ */
+void testTrace() {
+	cout << "Test a trace of visits." << endl;
+	const uint32_t periodMs = SCAN_DURATION + SCAN_BREAK_DURATION;
+	const uint32_t fixedDutyPercent = 100 * SCAN_DURATION / periodMs;
+	const uint32_t advIntervalMs = 250;
+	const int commandSeconds = 3;
+	const int daySeconds = 24 * 3600;
+
+	ScanDutyController controller;
+	srand(1);
+	uint64_t scanMsSum = 0;
+	uint32_t presentSeconds = 0;
+	uint32_t heard = 0;
+	uint32_t heardFixed = 0;
+	uint32_t sent = 0;
+	uint32_t commands = 0;
+	uint32_t commandsHeard = 0;
+	uint32_t commandsHeardFixed = 0;
+	bool commandHeard = false;
+	bool commandHeardFixed = false;
+	uint32_t scanStartMs = 0;
+	uint32_t scanMs = 0;
+	uint32_t breakMs = 0;
+	bool scanning = false;
+	int visitEnd = -1;
+	int commandEnd = -1;
+	for (int t = 0; t < daySeconds; ++t) {
+		if (t > visitEnd && rand() % 3600 == 0) {
+			// On average a visit per hour, of 1 to 10 minutes.
+			visitEnd = t + 60 + rand() % 540;
+		}
+		if (t <= visitEnd && t > commandEnd && rand() % 120 == 0) {
+			// On average a command per 2 minutes of visit.
+			commandEnd = t + commandSeconds - 1;
+			commands++;
+			commandHeard = false;
+			commandHeardFixed = false;
+		}
+		for (uint32_t ms = t * 1000; ms < (uint32_t)(t + 1) * 1000; ms += advIntervalMs) {
+			if (ms == 0 || (!scanning && ms >= scanStartMs + scanMs + breakMs)) {
+				scanning = true;
+				scanStartMs = ms;
+				scanMs = controller.getScanDuration(periodMs);
+				scanMsSum += scanMs;
+			}
+			if (scanning && ms >= scanStartMs + scanMs) {
+				scanning = false;
+				breakMs = controller.getScanBreakDuration(periodMs);
+			}
+			if (t <= commandEnd) {
+				if (scanning) {
+					controller.addCommandHit();
+					commandsHeard += commandHeard ? 0 : 1;
+					commandHeard = true;
+				}
+				if (ms % periodMs < SCAN_DURATION) {
+					commandsHeardFixed += commandHeardFixed ? 0 : 1;
+					commandHeardFixed = true;
+				}
+			}
+			if (t > visitEnd) {
+				continue;
+			}
+			sent++;
+			if (scanning) {
+				controller.addHit();
+				heard++;
+			}
+			if (ms % periodMs < SCAN_DURATION) {
+				heardFixed++;
+			}
+		}
+		if (t <= visitEnd) {
+			presentSeconds++;
+		}
+		controller.tickSecond();
+	}
+	double averageDuty = 100.0 * scanMsSum / (daySeconds * 1000.0);
+	double heardPercent = 100.0 * heard / sent;
+	double heardFixedPercent = 100.0 * heardFixed / sent;
+	cout << "  present " << presentSeconds << " of " << daySeconds << " seconds, " << commands << " commands" << endl;
+	cout << "  fixed:    duty " << fixedDutyPercent << "%, heard " << heardFixedPercent << "% of advertisements, "
+			<< commandsHeardFixed << " commands" << endl;
+	cout << "  adaptive: duty " << averageDuty << "%, heard " << heardPercent << "% of advertisements, "
+			<< commandsHeard << " commands" << endl;
+	assert(averageDuty < fixedDutyPercent);
+	assert(heardPercent > 2 * heardFixedPercent);
+	assert(commandsHeard >= commandsHeardFixed);
+}
+
+int main() {
+	cout << "Test ScanDutyController" << endl;
+
+	testBounds();
+	testIdle();
+	testBurst();
+	testCommandBoost();
+	testHitRate();
+	testTrace();
+
+	cout << "ScanDutyController SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}
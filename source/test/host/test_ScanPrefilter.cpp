@@ -0,0 +1,200 @@
+#include <processing/cs_ScanPrefilter.h>
+#include <util/cs_Utils.h>
+
+#include <chrono>
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Advertisements as captured by a Crownstone, with the share of each in a busy office.
+ */
+struct recorded_adv_t {
+	uint8_t count;
+	bool interesting;
+	vector<uint8_t> data;
+};
+
+vector<recorded_adv_t> corpus = {
+	// Apple background advertisement with a services mask.
+	{2, true, {0x02, 0x01, 0x1A, 0x14, 0xFF, 0x4C, 0x00, 0x01, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x08}},
+	// Phone broadcasting a command: 4 16 bit service UUIDs and a 128 bit service UUID.
+	{1, true, {0x02, 0x01, 0x1A, 0x09, 0x03, 0x12, 0x04, 0x34, 0x48, 0x56, 0x8C, 0x78, 0xD0, 0x11, 0x07, 0x1B, 0x2C, 0x3D, 0x4E, 0x5F, 0x60, 0x71, 0x82, 0x93, 0xA4, 0xB5, 0xC6, 0xD7, 0xE8, 0xF9, 0x0A}},
+	// Crownstone service data.
+	{6, false, {0x02, 0x01, 0x06, 0x15, 0x16, 0x01, 0xC0, 0x05, 0x3A, 0x7D, 0x91, 0x0C, 0x55, 0x21, 0xE8, 0x04, 0xF1, 0x6B, 0x90, 0x12, 0x33, 0x4C, 0x0A, 0xDE, 0x77}},
+	// Foreign iBeacon: apple manufacturer data, but another type.
+	{4, false, {0x02, 0x01, 0x06, 0x1A, 0xFF, 0x4C, 0x00, 0x02, 0x15, 0xA6, 0x43, 0x42, 0x3E, 0x12, 0x4F, 0x4D, 0x9E, 0xB7, 0x31, 0x45, 0x8F, 0x67, 0x8C, 0x0B, 0x0E, 0x00, 0x01, 0x00, 0x02, 0xC4}},
+	// Apple nearby info.
+	{8, false, {0x02, 0x01, 0x1A, 0x0A, 0xFF, 0x4C, 0x00, 0x10, 0x05, 0x0B, 0x1C, 0x6F, 0x3A, 0x92}},
+	// Eddystone URL: a 16 bit service UUID list that is too short for a command.
+	{2, false, {0x02, 0x01, 0x06, 0x03, 0x03, 0xAA, 0xFE, 0x0E, 0x16, 0xAA, 0xFE, 0x10, 0xEB, 0x03, 'c', 'r', 'o', 'w', 'n', 's', 't', 0x07}},
+	// Microsoft swift pair.
+	{2, false, {0x1E, 0xFF, 0x06, 0x00, 0x03, 0x00, 0x80, 0x4D, 0x79, 0x20, 0x4D, 0x6F, 0x75, 0x73, 0x65, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+	// Named device.
+	{1, false, {0x02, 0x01, 0x06, 0x0B, 0x09, 'C', 'r', 'o', 'w', 'n', 's', 't', 'o', 'n', 'e'}},
+};
+
+uint8_t address[MAC_ADDRESS_LEN] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+
+scanned_device_t makeScannedDevice(vector<uint8_t>& adv, uint8_t addressByte = 0) {
+	scanned_device_t device = {};
+	memcpy(device.address, address, MAC_ADDRESS_LEN);
+	device.address[0] = addressByte;
+	device.data = adv.data();
+	device.dataSize = adv.size();
+	BLEutil::indexAdvData(device.data, device.dataSize, &device.advIndex);
+	return device;
+}
+
+/**
+ * Add the rules that the background and command advertisement handlers add.
+ */
+void addRules(ScanPrefilter& prefilter) {
+	scan_prefilter_rule_t backgroundRule;
+	backgroundRule.adType = BLE_GAP_AD_TYPE_MANUFACTURER_SPECIFIC_DATA;
+	backgroundRule.companyId = 0x004C;
+	backgroundRule.patternOffset = 2;
+	backgroundRule.patternLen = 1;
+	backgroundRule.pattern[0] = 0x01;
+	backgroundRule.mask[0] = 0xFF;
+	assert(prefilter.addRule(backgroundRule) == ERR_SUCCESS);
+
+	scan_prefilter_rule_t commandRule;
+	commandRule.adType = BLE_GAP_AD_TYPE_16BIT_SERVICE_UUID_COMPLETE;
+	commandRule.patternOffset = 4 * sizeof(uint16_t);
+	assert(prefilter.addRule(commandRule) == ERR_SUCCESS);
+}
+
+void testRules(ScanPrefilter& prefilter) {
+	cout << "Test that only the corpus entries of interest are accepted." << endl;
+	cs_scan_prefilter_stats_t stats = prefilter.getStats();
+	uint32_t numInteresting = 0;
+	for (auto& adv: corpus) {
+		scanned_device_t device = makeScannedDevice(adv.data);
+		assert(prefilter.accept(&device) == adv.interesting);
+		numInteresting += adv.interesting;
+	}
+	assert(prefilter.getStats().accepted == stats.accepted + numInteresting);
+	assert(prefilter.getStats().rejected == stats.rejected + corpus.size() - numInteresting);
+	assert(prefilter.getStats().acceptedByAddress == stats.acceptedByAddress);
+
+	cout << "Test a masked pattern." << endl;
+	scan_prefilter_rule_t rule;
+	rule.adType = BLE_GAP_AD_TYPE_SERVICE_DATA;
+	rule.patternLen = 3;
+	rule.pattern[0] = 0x01;
+	rule.pattern[1] = 0xC0;
+	rule.pattern[2] = 0x00;
+	rule.mask[0] = 0xFF;
+	rule.mask[1] = 0xFF;
+	rule.mask[2] = 0xF0;
+	rule.patternOffset = 0;
+	assert(prefilter.addRule(rule) == ERR_SUCCESS);
+	scanned_device_t device = makeScannedDevice(corpus[2].data);
+	assert(prefilter.accept(&device));
+
+	cout << "Test that the rule table fills up." << endl;
+	rule.patternLen = SCAN_PREFILTER_PATTERN_SIZE + 1;
+	assert(prefilter.addRule(rule) == ERR_WRONG_PARAMETER);
+	rule.patternLen = 0;
+	rule.adType = BLE_GAP_AD_TYPE_COMPLETE_LOCAL_NAME;
+	rule.patternOffset = 0xFF;
+	for (int i = 3; i < SCAN_PREFILTER_MAX_RULES; ++i) {
+		assert(prefilter.addRule(rule) == ERR_SUCCESS);
+	}
+	assert(prefilter.addRule(rule) == ERR_NO_SPACE);
+}
+
+void testAddresses(ScanPrefilter& prefilter) {
+	cout << "Test that addresses in the bloom filter are accepted." << endl;
+	vector<uint8_t>& foreign = corpus[3].data;
+	for (uint16_t i = 0; i < 256; ++i) {
+		scanned_device_t device = makeScannedDevice(foreign, i);
+		assert(!prefilter.accept(&device));
+	}
+	scanned_device_t device = makeScannedDevice(foreign, 1);
+	prefilter.addAddress(SCAN_PREFILTER_SOURCE_TAP_TO_TOGGLE, device.address);
+	device = makeScannedDevice(foreign, 2);
+	prefilter.addAddress(SCAN_PREFILTER_SOURCE_TRACKED_DEVICES, device.address);
+
+	uint32_t acceptedByAddress = prefilter.getStats().acceptedByAddress;
+	uint16_t falsePositives = 0;
+	for (uint16_t i = 0; i < 256; ++i) {
+		device = makeScannedDevice(foreign, i);
+		bool accepted = prefilter.accept(&device);
+		if (i == 1 || i == 2) {
+			assert(accepted);
+		}
+		else if (accepted) {
+			falsePositives++;
+		}
+	}
+	cout << "  false positives: " << falsePositives << " of 254" << endl;
+	assert(falsePositives < 5);
+	assert(prefilter.getStats().acceptedByAddress == acceptedByAddress + 2 + falsePositives);
+
+	prefilter.clearAddresses(SCAN_PREFILTER_SOURCE_TAP_TO_TOGGLE);
+	device = makeScannedDevice(foreign, 1);
+	assert(!prefilter.accept(&device));
+	device = makeScannedDevice(foreign, 2);
+	assert(prefilter.accept(&device));
+	prefilter.clearAddresses(SCAN_PREFILTER_SOURCE_TRACKED_DEVICES);
+	assert(!prefilter.accept(&device));
+
+	cout << "Test that everything is accepted when disabled." << endl;
+	prefilter.setEnabled(false);
+	assert(prefilter.accept(&device));
+	prefilter.setEnabled(true);
+
+	cout << "Test the result buffer." << endl;
+	uint8_t buf[sizeof(cs_scan_prefilter_stats_t)];
+	cs_result_t result(cs_data_t(buf, sizeof(buf) - 1));
+	prefilter.getStats(result);
+	assert(result.returnCode == ERR_BUFFER_TOO_SMALL);
+	result = cs_result_t(cs_data_t(buf, sizeof(buf)));
+	prefilter.getStats(result);
+	assert(result.returnCode == ERR_SUCCESS);
+	assert(result.dataSize == sizeof(cs_scan_prefilter_stats_t));
+	assert(((cs_scan_prefilter_stats_t*)buf)->rejected == prefilter.getStats().rejected);
+}
+
+/**
+ * Time the prefilter over the corpus, weighted by share.
+ */
+void benchmark(ScanPrefilter& prefilter, uint32_t iterations) {
+	vector<scanned_device_t> recording;
+	for (auto& adv: corpus) {
+		for (uint8_t i = 0; i < adv.count; ++i) {
+			recording.push_back(makeScannedDevice(adv.data, i));
+		}
+	}
+	cout << "Benchmark " << iterations << " passes over " << recording.size() << " recorded advertisements." << endl;
+	uint32_t accepted = 0;
+	auto start = chrono::steady_clock::now();
+	for (uint32_t i = 0; i < iterations; ++i) {
+		for (auto& device: recording) {
+			BLEutil::indexAdvData(device.data, device.dataSize, &device.advIndex);
+			accepted += prefilter.accept(&device);
+		}
+	}
+	auto durationNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+	uint32_t numScans = iterations * recording.size();
+	cout << "  " << (float)durationNs / numScans << " ns per advertisement, including indexing" << endl;
+	cout << "  accepted " << accepted * 100.0f / numScans << "%" << endl;
+}
+
+int main() {
+	cout << "Test ScanPrefilter" << endl;
+	ScanPrefilter& prefilter = ScanPrefilter::getInstance();
+
+	addRules(prefilter);
+	benchmark(prefilter, 100000);
+	testAddresses(prefilter);
+	testRules(prefilter);
+
+	cout << "ScanPrefilter SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}
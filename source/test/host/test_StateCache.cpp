@@ -0,0 +1,113 @@
+#include <storage/cs_StateCache.h>
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <map>
+
+using namespace std;
+
+void testEviction() {
+	cout << "Test that the least recently used value is evicted." << endl;
+	StateCache cache(100);
+	CS_TYPE type;
+	cs_state_id_t id;
+	for (cs_state_id_t i = 0; i < 5; ++i) {
+		cache.touch(CS_TYPE::STATE_BEHAVIOUR_RULE, i, 20);
+	}
+	assert(!cache.getEvictionCandidate(type, id));
+	cache.touch(CS_TYPE::STATE_BEHAVIOUR_RULE, 0, 20);
+	cache.touch(CS_TYPE::STATE_BEHAVIOUR_RULE, 5, 20);
+	assert(cache.getEvictionCandidate(type, id));
+	assert(type == CS_TYPE::STATE_BEHAVIOUR_RULE);
+	assert(id == 1);
+	cache.evicted(type, id);
+	assert(!cache.getEvictionCandidate(type, id));
+	assert(cache.getStats().size == 100);
+	assert(cache.getStats().maxSize == 120);
+	assert(cache.getStats().evictions == 1);
+}
+
+void testPinned() {
+	cout << "Test that pinned values are not evicted." << endl;
+	StateCache cache(40);
+	CS_TYPE type;
+	cs_state_id_t id;
+	cache.touch(CS_TYPE::STATE_BEHAVIOUR_RULE, 0, 20);
+	cache.setPinned(CS_TYPE::STATE_BEHAVIOUR_RULE, 0, true);
+	cache.touch(CS_TYPE::STATE_BEHAVIOUR_RULE, 1, 20);
+	cache.setPinned(CS_TYPE::STATE_BEHAVIOUR_RULE, 1, true);
+	cache.touch(CS_TYPE::STATE_BEHAVIOUR_RULE, 2, 20);
+	assert(cache.getEvictionCandidate(type, id));
+	assert(id == 2);
+	cache.setPinned(CS_TYPE::STATE_BEHAVIOUR_RULE, 2, true);
+	assert(!cache.getEvictionCandidate(type, id));
+	cache.setPinned(CS_TYPE::STATE_BEHAVIOUR_RULE, 1, false);
+	assert(cache.getEvictionCandidate(type, id));
+	assert(id == 1);
+	cache.remove(CS_TYPE::STATE_BEHAVIOUR_RULE, 1);
+	assert(!cache.getEvictionCandidate(type, id));
+}
+
+/**
+ * Models the RAM register of State: a value is either in RAM or has to be read from flash.
+ */
+struct CacheModel {
+	StateCache cache;
+	map<cs_state_id_t, size16_t> ram;
+
+	CacheModel(uint32_t maxSize): cache(maxSize) {}
+
+	void get(CS_TYPE type, cs_state_id_t id, size16_t size) {
+		if (ram.count(id)) {
+			cache.addHit();
+		}
+		else {
+			cache.addMiss();
+			ram[id] = size;
+		}
+		cache.touch(type, id, size);
+		cs_state_id_t evictId;
+		while (cache.getEvictionCandidate(type, evictId)) {
+			ram.erase(evictId);
+			cache.evicted(type, evictId);
+		}
+	}
+};
+
+void testBenchmark() {
+	cout << "Benchmark RAM use of behaviours." << endl;
+	const cs_state_id_t numBehaviours = 50;
+	const size16_t behaviourSize = 44;
+	const uint32_t fullMirrorSize = numBehaviours * behaviourSize;
+	CacheModel model(512);
+
+	// Boot: all behaviours are loaded once.
+	for (cs_state_id_t id = 0; id < numBehaviours; ++id) {
+		model.get(CS_TYPE::STATE_EXTENDED_BEHAVIOUR_RULE, id, behaviourSize);
+	}
+	// After that, most gets are of a few behaviours that are being edited.
+	srand(1);
+	for (int i = 0; i < 10000; ++i) {
+		cs_state_id_t id = (rand() % 10 < 8) ? rand() % 5 : rand() % numBehaviours;
+		model.get(CS_TYPE::STATE_EXTENDED_BEHAVIOUR_RULE, id, behaviourSize);
+	}
+	const state_cache_stats_t & stats = model.cache.getStats();
+	cout << "hitRate=" << (int)model.cache.getHitRatePercent() << "% hits=" << stats.hits << " misses=" << stats.misses
+			<< " evictions=" << stats.evictions << endl;
+	cout << "RAM full mirror=" << fullMirrorSize << " cache max=" << stats.maxSize << endl;
+	assert(stats.maxSize <= 512 + behaviourSize);
+	assert(stats.maxSize < fullMirrorSize / 3);
+	assert(model.cache.getHitRatePercent() > 70);
+}
+
+int main() {
+	cout << "Test StateCache implementation" << endl;
+
+	testEviction();
+	testPinned();
+	testBenchmark();
+
+	cout << "StateCache SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,219 @@
+#include <cfg/cs_AutoConfig.h>
+#include <cfg/cs_Config.h>
+#include <storage/cs_StateData.h>
+#include <processing/cs_StateSnapshotHandler.h>
+#include <storage/cs_StateSnapshot.h>
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+// Normally generated by the build system.
+const char g_BEACON_UUID[] = "a643423e-e175-4af0-a2e4-31e32f729a8a";
+
+struct TestValue {
+	uint16_t type;
+	uint16_t id;
+	vector<uint8_t> value;
+};
+
+vector<TestValue> getTestValues() {
+	vector<TestValue> values;
+	for (uint16_t i = 0; i < 40; ++i) {
+		TestValue testValue;
+		testValue.type = 1 + i;
+		testValue.id = (i % 5 == 0) ? i : 0;
+		// Include odd sizes and empty values.
+		for (uint16_t j = 0; j < i % 17; ++j) {
+			testValue.value.push_back(rand() % 256);
+		}
+		values.push_back(testValue);
+	}
+	return values;
+}
+
+cs_buffer_size_t writeSnapshot(const vector<TestValue> & values, uint8_t* buf, cs_buffer_size_t bufSize) {
+	StateSnapshotWriter writer(buf, bufSize);
+	for (auto & testValue: values) {
+		assert(writer.add(testValue.type, testValue.id, testValue.value.data(), testValue.value.size()) == ERR_SUCCESS);
+	}
+	assert(writer.finalize() == ERR_SUCCESS);
+	return writer.getSize();
+}
+
+void testRoundTrip() {
+	cout << "Test that a snapshot reads back the same values." << endl;
+	vector<TestValue> values = getTestValues();
+	uint8_t buf[2048];
+	cs_buffer_size_t size = writeSnapshot(values, buf, sizeof(buf));
+
+	StateSnapshotReader reader(buf, size);
+	assert(reader.validate() == ERR_SUCCESS);
+	assert(reader.getNumEntries() == values.size());
+	for (int pass = 0; pass < 2; ++pass) {
+		state_snapshot_entry_t entry;
+		for (auto & testValue: values) {
+			assert(reader.getNext(entry) == ERR_SUCCESS);
+			assert(entry.type == testValue.type);
+			assert(entry.id == testValue.id);
+			assert(entry.size == testValue.value.size());
+			assert(memcmp(entry.value, testValue.value.data(), entry.size) == 0);
+		}
+		assert(reader.getNext(entry) == ERR_NOT_FOUND);
+		reader.rewind();
+	}
+}
+
+// Number of iBeacon configs, see MeshAdvertiser.
+const uint16_t numIbeaconConfigIds = 2;
+
+/**
+ * Get the default of every type that is persisted, like StateSnapshotHandler exports them.
+ * Types with multiple ids get a value for every id, except for behaviours.
+ */
+vector<TestValue> getDefaultValues() {
+	vector<TestValue> values;
+	boards_config_t board = {};
+	for (uint16_t rawType = 1; rawType < InternalBase; ++rawType) {
+		CS_TYPE type = toCsType(rawType);
+		if (type == CS_TYPE::CONFIG_DO_NOT_USE) {
+			continue;
+		}
+		switch (DefaultLocation(type)) {
+			case PersistenceMode::FLASH:
+			case PersistenceMode::FLASH_CACHED:
+				break;
+			default:
+				continue;
+		}
+		uint16_t numIds = hasMultipleIds(type) ? numIbeaconConfigIds : 1;
+		for (uint16_t id = 0; id < numIds; ++id) {
+			TestValue testValue;
+			testValue.type = rawType;
+			testValue.id = id;
+			testValue.value.resize(TypeSize(type));
+			cs_state_data_t stateData(type, testValue.id, testValue.value.data(), testValue.value.size());
+			if (getDefault(stateData, board) != ERR_SUCCESS) {
+				// Types without default, like behaviours, are only exported when set.
+				break;
+			}
+			values.push_back(testValue);
+		}
+	}
+	return values;
+}
+
+void testFullStone() {
+	cout << "Test a snapshot of all persisted defaults." << endl;
+	vector<TestValue> values = getDefaultValues();
+	assert(values.size() > 50);
+	vector<uint8_t> buf(STATE_SNAPSHOT_MAX_SIZE);
+	cs_buffer_size_t size = writeSnapshot(values, buf.data(), buf.size());
+	cs_buffer_size_t configSize = size - sizeof(state_snapshot_header_t) - sizeof(uint32_t);
+	cout << "  " << values.size() << " values, " << configSize << " of " << STATE_SNAPSHOT_MAX_CONFIG_SIZE << " bytes" << endl;
+	assert(configSize <= STATE_SNAPSHOT_MAX_CONFIG_SIZE);
+
+	cout << "Test a snapshot of a stone with the max number of behaviours." << endl;
+	assert(TypeSize(CS_TYPE::STATE_EXTENDED_BEHAVIOUR_RULE) == STATE_SNAPSHOT_MAX_BEHAVIOUR_SIZE);
+	for (uint16_t id = 0; id < BehaviourStore::MaxBehaviours; ++id) {
+		TestValue testValue;
+		testValue.type = to_underlying_type(CS_TYPE::STATE_EXTENDED_BEHAVIOUR_RULE);
+		testValue.id = id;
+		for (size_t i = 0; i < STATE_SNAPSHOT_MAX_BEHAVIOUR_SIZE; ++i) {
+			testValue.value.push_back(rand() % 256);
+		}
+		values.push_back(testValue);
+	}
+	size = writeSnapshot(values, buf.data(), buf.size());
+	cout << "  " << values.size() << " values, " << size << " of " << STATE_SNAPSHOT_MAX_SIZE << " bytes" << endl;
+	assert(size <= STATE_SNAPSHOT_MAX_SIZE);
+
+	StateSnapshotReader reader(buf.data(), size);
+	assert(reader.validate() == ERR_SUCCESS);
+	assert(reader.getNumEntries() == values.size());
+	state_snapshot_entry_t entry;
+	for (auto & testValue: values) {
+		assert(reader.getNext(entry) == ERR_SUCCESS);
+		assert(entry.type == testValue.type);
+		assert(entry.id == testValue.id);
+		assert(entry.size == testValue.value.size());
+		assert(memcmp(entry.value, testValue.value.data(), entry.size) == 0);
+	}
+	assert(reader.getNext(entry) == ERR_NOT_FOUND);
+}
+
+void testEmpty() {
+	cout << "Test an empty snapshot." << endl;
+	uint8_t buf[16];
+	cs_buffer_size_t size = writeSnapshot(vector<TestValue>(), buf, sizeof(buf));
+	assert(size == sizeof(state_snapshot_header_t) + sizeof(uint32_t));
+	StateSnapshotReader reader(buf, size);
+	assert(reader.validate() == ERR_SUCCESS);
+	assert(reader.getNumEntries() == 0);
+	state_snapshot_entry_t entry;
+	assert(reader.getNext(entry) == ERR_NOT_FOUND);
+}
+
+void testBufferTooSmall() {
+	cout << "Test that a value that doesn't fit is rejected." << endl;
+	uint8_t buf[32];
+	uint8_t value[32] = {};
+	StateSnapshotWriter writer(buf, sizeof(buf));
+	assert(writer.add(1, 0, value, 8) == ERR_SUCCESS);
+	assert(writer.add(2, 0, value, 16) == ERR_BUFFER_TOO_SMALL);
+	assert(writer.add(3, 0, value, 4) == ERR_SUCCESS);
+	assert(writer.finalize() == ERR_SUCCESS);
+	assert(writer.add(4, 0, value, 1) == ERR_WRONG_STATE);
+
+	StateSnapshotReader reader(buf, writer.getSize());
+	assert(reader.validate() == ERR_SUCCESS);
+	assert(reader.getNumEntries() == 2);
+}
+
+void testCorruption() {
+	cout << "Test that a corrupted snapshot is rejected." << endl;
+	vector<TestValue> values = getTestValues();
+	uint8_t buf[2048];
+	cs_buffer_size_t size = writeSnapshot(values, buf, sizeof(buf));
+	state_snapshot_entry_t entry;
+
+	cout << "Check every single bit flip." << endl;
+	for (cs_buffer_size_t i = 0; i < size; ++i) {
+		for (int bit = 0; bit < 8; ++bit) {
+			buf[i] ^= (1 << bit);
+			StateSnapshotReader reader(buf, size);
+			assert(reader.validate() != ERR_SUCCESS);
+			assert(reader.getNext(entry) == ERR_WRONG_STATE);
+			buf[i] ^= (1 << bit);
+		}
+	}
+
+	cout << "Check truncated snapshots." << endl;
+	for (cs_buffer_size_t truncatedSize = 0; truncatedSize < size; ++truncatedSize) {
+		StateSnapshotReader reader(buf, truncatedSize);
+		assert(reader.validate() != ERR_SUCCESS);
+	}
+
+	cout << "Check unsupported protocol." << endl;
+	buf[0] = STATE_SNAPSHOT_PROTOCOL_VERSION + 1;
+	StateSnapshotReader reader(buf, size);
+	assert(reader.validate() == ERR_PROTOCOL_UNSUPPORTED);
+}
+
+int main() {
+	cout << "Test StateSnapshot implementation" << endl;
+	srand(1);
+
+	testRoundTrip();
+	testFullStone();
+	testEmpty();
+	testBufferTooSmall();
+	testCorruption();
+
+	cout << "StateSnapshot SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}
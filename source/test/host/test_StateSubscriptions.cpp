@@ -0,0 +1,186 @@
+#include <storage/cs_StateSubscriptions.h>
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+class TestSubscriber: public StateSubscriber {
+public:
+	uint32_t numChanges = 0;
+	vector<uint8_t> lastOld;
+	vector<uint8_t> lastNew;
+
+	void handleStateChange(const state_change_t & change) {
+		numChanges++;
+		lastOld.clear();
+		if (change.oldValue != nullptr) {
+			lastOld.assign(change.oldValue, change.oldValue + change.size);
+		}
+		lastNew.assign(change.newValue, change.newValue + change.size);
+	}
+};
+
+/**
+ * Models how State stores values in RAM: subscribers are only notified when the value differs.
+ */
+class RamModel {
+public:
+	StateSubscriptions subscriptions;
+	uint32_t numSets = 0;
+
+	void set(CS_TYPE type, const void* value, size16_t size) {
+		numSets++;
+		vector<uint8_t> & stored = _values[to_underlying_type(type)];
+		const uint8_t* newValue = (const uint8_t*)value;
+		if (stored.size() == size && memcmp(stored.data(), newValue, size) == 0) {
+			return;
+		}
+		vector<uint8_t> oldValue = stored;
+		stored.assign(newValue, newValue + size);
+		if (subscriptions.isSubscribed(type)) {
+			state_change_t change;
+			change.type = type;
+			change.id = 0;
+			change.oldValue = oldValue.empty() ? nullptr : oldValue.data();
+			change.newValue = newValue;
+			change.size = size;
+			subscriptions.notify(change);
+		}
+	}
+
+private:
+	map<uint16_t, vector<uint8_t>> _values;
+};
+
+void testSubscribe() {
+	cout << "Test subscribe and unsubscribe." << endl;
+	StateSubscriptions subscriptions;
+	TestSubscriber subscribers[STATE_MAX_SUBSCRIPTIONS + 1];
+	for (int i = 0; i < STATE_MAX_SUBSCRIPTIONS; ++i) {
+		assert(subscriptions.subscribe(CS_TYPE::STATE_TEMPERATURE, &subscribers[i]) == ERR_SUCCESS);
+	}
+	// Subscribing twice is fine.
+	assert(subscriptions.subscribe(CS_TYPE::STATE_TEMPERATURE, &subscribers[0]) == ERR_SUCCESS);
+	assert(subscriptions.subscribe(CS_TYPE::STATE_TEMPERATURE, &subscribers[STATE_MAX_SUBSCRIPTIONS]) == ERR_NO_SPACE);
+	assert(subscriptions.isSubscribed(CS_TYPE::STATE_TEMPERATURE));
+	assert(!subscriptions.isSubscribed(CS_TYPE::STATE_SWITCH_STATE));
+
+	int8_t oldTemperature = 20;
+	int8_t newTemperature = 21;
+	state_change_t change;
+	change.type = CS_TYPE::STATE_TEMPERATURE;
+	change.id = 0;
+	change.oldValue = (uint8_t*)&oldTemperature;
+	change.newValue = (uint8_t*)&newTemperature;
+	change.size = sizeof(newTemperature);
+	subscriptions.notify(change);
+	for (int i = 0; i < STATE_MAX_SUBSCRIPTIONS; ++i) {
+		assert(subscribers[i].numChanges == 1);
+		assert(subscribers[i].lastOld[0] == 20);
+		assert(subscribers[i].lastNew[0] == 21);
+	}
+
+	for (int i = 0; i < STATE_MAX_SUBSCRIPTIONS; ++i) {
+		assert(subscriptions.unsubscribe(CS_TYPE::STATE_TEMPERATURE, &subscribers[i]) == ERR_SUCCESS);
+	}
+	assert(subscriptions.unsubscribe(CS_TYPE::STATE_TEMPERATURE, &subscribers[0]) == ERR_NOT_FOUND);
+	assert(!subscriptions.isSubscribed(CS_TYPE::STATE_TEMPERATURE));
+	subscriptions.notify(change);
+	assert(subscribers[0].numChanges == 1);
+}
+
+void testOnlyChanges() {
+	cout << "Test that only actual changes are notified." << endl;
+	RamModel ram;
+	TestSubscriber subscriber;
+	assert(ram.subscriptions.subscribe(CS_TYPE::STATE_SWITCH_STATE, &subscriber) == ERR_SUCCESS);
+	uint8_t switchState = 0;
+	ram.set(CS_TYPE::STATE_SWITCH_STATE, &switchState, sizeof(switchState));
+	assert(subscriber.numChanges == 1);
+	assert(subscriber.lastOld.empty());
+	ram.set(CS_TYPE::STATE_SWITCH_STATE, &switchState, sizeof(switchState));
+	assert(subscriber.numChanges == 1);
+	switchState = 100;
+	ram.set(CS_TYPE::STATE_SWITCH_STATE, &switchState, sizeof(switchState));
+	assert(subscriber.numChanges == 2);
+	assert(subscriber.lastOld[0] == 0);
+	assert(subscriber.lastNew[0] == 100);
+
+	int8_t temperature = 30;
+	ram.set(CS_TYPE::STATE_TEMPERATURE, &temperature, sizeof(temperature));
+	assert(subscriber.numChanges == 2);
+}
+
+/**
+ * Replay the sets of a typical day, and compare the number of events with the number of state changes.
+ */
+void testReplayDay() {
+	cout << "Test a replay of a typical day." << endl;
+	RamModel ram;
+	TestSubscriber switchSubscriber;
+	TestSubscriber temperatureSubscriber;
+	TestSubscriber powerSubscriber;
+	ram.subscriptions.subscribe(CS_TYPE::STATE_SWITCH_STATE, &switchSubscriber);
+	ram.subscriptions.subscribe(CS_TYPE::STATE_TEMPERATURE, &temperatureSubscriber);
+	ram.subscriptions.subscribe(CS_TYPE::STATE_POWER_USAGE, &powerSubscriber);
+	ram.subscriptions.subscribe(CS_TYPE::STATE_ACCUMULATED_ENERGY, &powerSubscriber);
+
+	const uint32_t secondsPerDay = 24 * 3600;
+	// Device is on from 07:00 to 08:00 and from 18:00 to 23:00.
+	vector<pair<uint32_t, uint32_t>> onPeriods = {{7 * 3600, 8 * 3600}, {18 * 3600, 23 * 3600}};
+	uint8_t switchState = 0;
+	int32_t powerUsage = 0;
+	int64_t energyUsed = 0;
+	int8_t temperature = 25;
+	srand(1);
+	for (uint32_t t = 0; t < secondsPerDay; ++t) {
+		bool on = false;
+		for (auto & period: onPeriods) {
+			if (t >= period.first && t < period.second) {
+				on = true;
+			}
+		}
+		// The switch state is set by behaviour every minute, even when it doesn't change.
+		if (t % 60 == 0 || (on != (switchState != 0))) {
+			switchState = on ? 100 : 0;
+			ram.set(CS_TYPE::STATE_SWITCH_STATE, &switchState, sizeof(switchState));
+		}
+		// Power is set every second.
+		powerUsage = on ? 60000 + rand() % 1000 : 0;
+		energyUsed += powerUsage;
+		ram.set(CS_TYPE::STATE_POWER_USAGE, &powerUsage, sizeof(powerUsage));
+		ram.set(CS_TYPE::STATE_ACCUMULATED_ENERGY, &energyUsed, sizeof(energyUsed));
+		// Temperature is set every 10 seconds, and changes slowly.
+		if (t % 10 == 0) {
+			if (rand() % 100 == 0) {
+				temperature += on ? 1 : -1;
+			}
+			ram.set(CS_TYPE::STATE_TEMPERATURE, &temperature, sizeof(temperature));
+		}
+	}
+	uint32_t numChanges = switchSubscriber.numChanges + temperatureSubscriber.numChanges + powerSubscriber.numChanges;
+	cout << "sets (events)=" << ram.numSets << " changes=" << numChanges
+			<< " switch=" << switchSubscriber.numChanges
+			<< " temperature=" << temperatureSubscriber.numChanges
+			<< " power=" << powerSubscriber.numChanges << endl;
+	// The device switched on and off twice, plus the initial value.
+	assert(switchSubscriber.numChanges == 5);
+	assert(numChanges < ram.numSets / 4);
+}
+
+int main() {
+	cout << "Test StateSubscriptions implementation" << endl;
+
+	testSubscribe();
+	testOnlyChanges();
+	testReplayDay();
+
+	cout << "StateSubscriptions SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,223 @@
+#include <storage/cs_StorageGcPolicy.h>
+
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+
+using namespace std;
+
+/**
+ * Simple model of FDS: records are appended, an update makes the old record freeable,
+ * and garbage collection frees all freeable words.
+ */
+class FlashModel {
+public:
+	static const uint32_t CAPACITY_WORDS = 8 * 1024;
+	static const uint32_t NUM_KEYS = 16;
+
+	uint32_t usedWords = 0;
+	uint32_t freeableWords = 0;
+	uint32_t recordWords[NUM_KEYS] = {};
+	uint32_t failedWrites = 0;
+
+	bool write(uint32_t key, uint32_t words) {
+		if (usedWords + words > CAPACITY_WORDS) {
+			failedWrites++;
+			return false;
+		}
+		freeableWords += recordWords[key];
+		recordWords[key] = words;
+		usedWords += words;
+		return true;
+	}
+
+	void garbageCollect() {
+		usedWords -= freeableWords;
+		freeableWords = 0;
+	}
+
+	storage_gc_flash_stats_t getStats() {
+		storage_gc_flash_stats_t stats;
+		stats.usedWords = usedWords;
+		stats.freeableWords = freeableWords;
+		stats.largestContiguousWords = CAPACITY_WORDS - usedWords;
+		return stats;
+	}
+};
+
+storage_gc_config_t getConfig() {
+	storage_gc_config_t config;
+	config.dirtyRatioPercent = 25;
+	config.minFreeableWords = 256;
+	config.reserveWords = 1024;
+	config.idleTimeMs = 10000;
+	config.maxSchedulerQueueUse = 4;
+	config.maxDeferMs = 60000;
+	return config;
+}
+
+/**
+ * Let the policy decide, and perform the garbage collection instantly when it wants to.
+ */
+StorageGcReason tick(StorageGcPolicy & policy, FlashModel & flash, uint32_t nowMs, uint16_t queueUse = 0) {
+	StorageGcReason reason = policy.check(flash.getStats(), queueUse, nowMs);
+	if (reason != StorageGcReason::NONE) {
+		policy.onStarted(reason, flash.getStats(), nowMs);
+		flash.garbageCollect();
+		policy.onDone(flash.getStats(), nowMs + 100);
+	}
+	return reason;
+}
+
+void testNothingToCollect() {
+	cout << "Test that nothing is collected when there is nothing to gain." << endl;
+	StorageGcPolicy policy;
+	policy.setConfig(getConfig());
+	FlashModel flash;
+	for (uint32_t i = 0; i < FlashModel::NUM_KEYS; ++i) {
+		flash.write(i, 100);
+	}
+	for (uint32_t t = 0; t < 1000000; t += 1000) {
+		assert(tick(policy, flash, t) == StorageGcReason::NONE);
+	}
+	assert(policy.getTelemetry().runs == 0);
+}
+
+void testIdle() {
+	cout << "Test that garbage is collected when idle." << endl;
+	StorageGcPolicy policy;
+	policy.setConfig(getConfig());
+	FlashModel flash;
+	uint32_t t = 0;
+	for (int i = 0; i < 32; ++i) {
+		flash.write(i % 4, 100);
+		policy.onWrite(t);
+		t += 1000;
+	}
+	cout << "Check that nothing happens while connected." << endl;
+	policy.setConnected(true, t);
+	t += 20000;
+	assert(tick(policy, flash, t) == StorageGcReason::NONE);
+
+	cout << "Check that nothing happens while the scheduler queue is busy." << endl;
+	policy.setConnected(false, t);
+	t += 20000;
+	assert(tick(policy, flash, t, 10) == StorageGcReason::NONE);
+
+	cout << "Check that nothing happens shortly after mesh activity." << endl;
+	policy.onMeshActivity(t);
+	t += 5000;
+	assert(tick(policy, flash, t) == StorageGcReason::NONE);
+
+	t += 5000;
+	assert(tick(policy, flash, t) == StorageGcReason::IDLE);
+	assert(flash.freeableWords == 0);
+	assert(policy.getTelemetry().runs == 1);
+	assert(policy.getTelemetry().idleRuns == 1);
+	assert(policy.getTelemetry().reclaimedWords == 28 * 100);
+	assert(policy.getTelemetry().lastDurationMs == 100);
+
+	cout << "Check the stats packet." << endl;
+	uint8_t buf[sizeof(cs_storage_gc_stats_t)];
+	cs_result_t result(cs_data_t(buf, sizeof(buf) - 1));
+	policy.getStats(result);
+	assert(result.returnCode == ERR_BUFFER_TOO_SMALL);
+	result = cs_result_t(cs_data_t(buf, sizeof(buf)));
+	policy.getStats(result);
+	assert(result.returnCode == ERR_SUCCESS);
+	assert(result.dataSize == sizeof(cs_storage_gc_stats_t));
+	cs_storage_gc_stats_t* stats = (cs_storage_gc_stats_t*)buf;
+	assert(stats->runs == 1);
+	assert(stats->idleRuns == 1);
+	assert(stats->reclaimedWords == 28 * 100);
+}
+
+void testDeferred() {
+	cout << "Test that garbage collection is not deferred forever." << endl;
+	StorageGcPolicy policy;
+	policy.setConfig(getConfig());
+	FlashModel flash;
+	uint32_t t = 0;
+	for (int i = 0; i < 32; ++i) {
+		flash.write(i % 4, 100);
+	}
+	policy.setConnected(true, t);
+	StorageGcReason reason = StorageGcReason::NONE;
+	while (reason == StorageGcReason::NONE) {
+		t += 1000;
+		assert(t <= 1000 + getConfig().maxDeferMs);
+		reason = tick(policy, flash, t);
+	}
+	assert(reason == StorageGcReason::DEFERRED);
+	assert(policy.getTelemetry().deferredRuns == 1);
+}
+
+void testUrgent() {
+	cout << "Test that garbage is collected before running out of space." << endl;
+	StorageGcPolicy policy;
+	storage_gc_config_t config = getConfig();
+	// Make sure the dirty ratio is never reached.
+	config.dirtyRatioPercent = 100;
+	policy.setConfig(config);
+	FlashModel flash;
+	// Fill most of the flash with valid data.
+	for (uint32_t i = 0; i < FlashModel::NUM_KEYS; ++i) {
+		flash.write(i, 400);
+	}
+	policy.setConnected(true, 0);
+	uint32_t t = 0;
+	for (int i = 0; i < 1000; ++i) {
+		t += 1000;
+		assert(flash.write(0, 400));
+		policy.onWrite(t);
+		tick(policy, flash, t);
+	}
+	assert(flash.failedWrites == 0);
+	assert(policy.getTelemetry().urgentRuns > 0);
+	assert(policy.getTelemetry().idleRuns == 0);
+}
+
+void testWritesNeverFail() {
+	cout << "Test that writes never run out of space under a random load." << endl;
+	StorageGcPolicy policy;
+	policy.setConfig(getConfig());
+	FlashModel flash;
+	srand(1);
+	uint32_t t = 0;
+	for (int i = 0; i < 100000; ++i) {
+		t += 100;
+		int action = rand() % 1000;
+		if (action < 20) {
+			assert(flash.write(rand() % FlashModel::NUM_KEYS, 1 + rand() % 256));
+			policy.onWrite(t);
+		}
+		else if (action < 21) {
+			policy.setConnected(rand() % 2, t);
+		}
+		else if (action < 23) {
+			policy.onMeshActivity(t);
+		}
+		if (i % 10 == 0) {
+			tick(policy, flash, t, rand() % 8);
+		}
+	}
+	const cs_storage_gc_stats_t & telemetry = policy.getTelemetry();
+	cout << "runs=" << telemetry.runs << " idle=" << telemetry.idleRuns << " urgent=" << telemetry.urgentRuns
+			<< " deferred=" << telemetry.deferredRuns << " reclaimed=" << telemetry.reclaimedWords << endl;
+	assert(flash.failedWrites == 0);
+	assert(telemetry.runs == telemetry.idleRuns + telemetry.urgentRuns + telemetry.deferredRuns);
+	assert(telemetry.maxDurationMs == 100);
+}
+
+int main() {
+	cout << "Test StorageGcPolicy implementation" << endl;
+
+	testNothingToCollect();
+	testIdle();
+	testDeferred();
+	testUrgent();
+	testWritesNeverFail();
+
+	cout << "StorageGcPolicy SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}
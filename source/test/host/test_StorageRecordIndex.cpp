@@ -0,0 +1,250 @@
+#include <storage/cs_StorageRecordIndex.h>
+
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+using namespace std;
+
+struct fake_record_desc_t {
+	uint32_t record_id;
+};
+
+typedef StorageRecordIndex<fake_record_desc_t> Index;
+
+fake_record_desc_t makeDesc(uint32_t recordId) {
+	fake_record_desc_t desc;
+	desc.record_id = recordId;
+	return desc;
+}
+
+void testLookup() {
+	cout << "Test lookup." << endl;
+	Index index;
+	assert(index.find(1, 1) == NULL);
+	index.set(2, 0, makeDesc(1));
+	index.set(1, 0xFFFF, makeDesc(2));
+	index.set(1, 5, makeDesc(3));
+	index.set(0, 0, makeDesc(4));
+	assert(index.size() == 4);
+	assert(index.find(2, 0)->record_id == 1);
+	assert(index.find(1, 0xFFFF)->record_id == 2);
+	assert(index.find(1, 5)->record_id == 3);
+	assert(index.find(0, 0)->record_id == 4);
+
+	cout << "Check that file id and record key are not mixed up." << endl;
+	assert(index.find(0, 2) == NULL);
+	assert(index.find(5, 1) == NULL);
+	assert(index.find(0xFFFF, 1) == NULL);
+}
+
+void testUpdate() {
+	cout << "Test that setting a record again replaces the descriptor." << endl;
+	Index index;
+	index.set(0, 10, makeDesc(1));
+	index.set(0, 11, makeDesc(2));
+	index.set(0, 10, makeDesc(3));
+	assert(index.size() == 2);
+	assert(index.find(0, 10)->record_id == 3);
+	assert(index.find(0, 11)->record_id == 2);
+
+	cout << "Check that a descriptor can be modified via the index." << endl;
+	index.find(0, 11)->record_id = 4;
+	assert(index.find(0, 11)->record_id == 4);
+}
+
+void testRemove() {
+	cout << "Test removal by record id." << endl;
+	Index index;
+	index.set(0, 10, makeDesc(1));
+	index.set(0, 11, makeDesc(2));
+	index.set(1, 10, makeDesc(3));
+	assert(!index.remove(4));
+	assert(index.remove(2));
+	assert(!index.remove(2));
+	assert(index.size() == 2);
+	assert(index.find(0, 11) == NULL);
+	assert(index.find(0, 10)->record_id == 1);
+
+	cout << "Check that a removed record can be set again." << endl;
+	index.set(0, 11, makeDesc(5));
+	assert(index.find(0, 11)->record_id == 5);
+
+	cout << "Test removal of a file." << endl;
+	index.set(2, 10, makeDesc(6));
+	index.set(1, 0, makeDesc(7));
+	index.set(1, 0xFFFF, makeDesc(8));
+	index.removeFile(1);
+	assert(index.size() == 3);
+	assert(index.find(1, 0) == NULL);
+	assert(index.find(1, 10) == NULL);
+	assert(index.find(1, 0xFFFF) == NULL);
+	assert(index.find(0, 10)->record_id == 1);
+	assert(index.find(0, 11)->record_id == 5);
+	assert(index.find(2, 10)->record_id == 6);
+	index.removeFile(3);
+	assert(index.size() == 3);
+
+	cout << "Check clear." << endl;
+	index.clear();
+	assert(index.size() == 0);
+	assert(index.find(0, 10) == NULL);
+}
+
+void testRandom() {
+	cout << "Test random operations against a reference." << endl;
+	Index index;
+	map<pair<uint16_t, uint16_t>, uint32_t> reference;
+	uint32_t nextRecordId = 1;
+	for (int i = 0; i < 20000; ++i) {
+		uint16_t fileId = rand() % 4;
+		uint16_t recordKey = rand() % 16;
+		switch (rand() % 4) {
+			case 0:
+			case 1: {
+				index.set(fileId, recordKey, makeDesc(nextRecordId));
+				reference[make_pair(fileId, recordKey)] = nextRecordId;
+				nextRecordId++;
+				break;
+			}
+			case 2: {
+				auto it = reference.find(make_pair(fileId, recordKey));
+				if (it != reference.end()) {
+					assert(index.remove(it->second));
+					reference.erase(it);
+				}
+				break;
+			}
+			case 3: {
+				if (rand() % 50 == 0) {
+					index.removeFile(fileId);
+					for (auto it = reference.begin(); it != reference.end();) {
+						it = (it->first.first == fileId) ? reference.erase(it) : next(it);
+					}
+				}
+				break;
+			}
+		}
+		assert(index.size() == reference.size());
+		fake_record_desc_t* desc = index.find(fileId, recordKey);
+		auto it = reference.find(make_pair(fileId, recordKey));
+		if (it == reference.end()) {
+			assert(desc == NULL);
+		}
+		else {
+			assert(desc != NULL && desc->record_id == it->second);
+		}
+	}
+}
+
+/**
+ * A record in emulated flash, in order of writing.
+ */
+struct flash_record_t {
+	uint16_t fileId;
+	uint16_t recordKey;
+	uint32_t recordId;
+	//! Deleted records stay in flash until garbage collection.
+	bool deleted;
+};
+
+/**
+ * Emulate the flash reads at boot: every persisted state type is read once.
+ *
+ * Without index, each read searches all records for the last valid one, like Storage::read() does with fds_record_find().
+ * With index, the records are iterated once, and each read is a lookup in the index, followed by opening the record.
+ *
+ * @return Number of record headers read from flash.
+ */
+uint32_t emulateBoot(const vector<flash_record_t> & flash, uint16_t numTypes, bool useIndex, uint32_t & checksum) {
+	uint32_t headerReads = 0;
+	Index index;
+	if (useIndex) {
+		for (auto & record: flash) {
+			headerReads++;
+			if (!record.deleted) {
+				index.set(record.fileId, record.recordKey, makeDesc(record.recordId));
+			}
+		}
+	}
+	for (uint16_t type = 1; type <= numTypes; ++type) {
+		uint32_t foundRecordId = 0;
+		if (useIndex) {
+			fake_record_desc_t* desc = index.find(0, type);
+			if (desc != NULL) {
+				headerReads++;
+				foundRecordId = desc->record_id;
+			}
+		}
+		else {
+			for (auto & record: flash) {
+				headerReads++;
+				if (!record.deleted && record.fileId == 0 && record.recordKey == type) {
+					foundRecordId = record.recordId;
+				}
+			}
+		}
+		checksum += foundRecordId;
+	}
+	return headerReads;
+}
+
+void testBootEmulation() {
+	cout << "Emulate the flash reads at boot, without and with index." << endl;
+	// A device in use: most state types stored, behaviours in their own files, and some old versions not yet collected.
+	const uint16_t numTypes = 61;
+	vector<flash_record_t> flash;
+	uint32_t recordId = 1;
+	for (uint16_t type = 1; type <= numTypes; ++type) {
+		if (type % 8 == 0) {
+			continue;
+		}
+		flash.push_back({0, type, recordId++, false});
+	}
+	for (uint16_t behaviour = 1; behaviour <= 30; ++behaviour) {
+		flash.push_back({behaviour, 69, recordId++, false});
+	}
+	for (int i = 0; i < 40; ++i) {
+		flash[rand() % flash.size()].deleted = true;
+		flash.push_back({0, (uint16_t)(1 + rand() % numTypes), recordId++, false});
+	}
+	uint32_t checksumSearch = 0;
+	uint32_t checksumIndex = 0;
+	uint32_t readsSearch = emulateBoot(flash, numTypes, false, checksumSearch);
+	uint32_t readsIndex = emulateBoot(flash, numTypes, true, checksumIndex);
+	assert(checksumSearch == checksumIndex);
+
+	const int repeat = 10000;
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < repeat; ++i) {
+		emulateBoot(flash, numTypes, false, checksumSearch);
+	}
+	auto mid = chrono::steady_clock::now();
+	for (int i = 0; i < repeat; ++i) {
+		emulateBoot(flash, numTypes, true, checksumIndex);
+	}
+	auto end = chrono::steady_clock::now();
+	double searchUs = chrono::duration<double, micro>(mid - start).count() / repeat;
+	double indexUs = chrono::duration<double, micro>(end - mid).count() / repeat;
+	cout << "  " << flash.size() << " records in flash, " << numTypes << " types read" << endl;
+	cout << "  search: " << readsSearch << " record headers read, " << searchUs << " us" << endl;
+	cout << "  index:  " << readsIndex << " record headers read, " << indexUs << " us" << endl;
+	assert(readsIndex * 10 < readsSearch);
+}
+
+int main() {
+	cout << "Test StorageRecordIndex implementation" << endl;
+	srand(1);
+
+	testLookup();
+	testUpdate();
+	testRemove();
+	testRandom();
+	testBootEmulation();
+
+	cout << "StorageRecordIndex SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,306 @@
+#include <processing/cs_TapToToggleTable.h>
+
+#include <chrono>
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+
+// Same as in TapToToggle, with a tick interval of 100 ms.
+const uint16_t scoreIncrement = 20;
+const uint16_t scoreThreshold = 30;
+const uint16_t scoreMax = 50;
+const uint16_t timeoutTicks = 15;
+
+/**
+ * The list that TapToToggle used to keep, as reference: the scores are decreased every tick.
+ */
+template <uint8_t Count>
+struct ReferenceList {
+	t2t_entry_t list[Count] = {};
+	uint16_t timeoutCounter = 0;
+	uint32_t evictedCount = 0;
+
+	bool handle(const uint8_t* address) {
+		uint8_t index = 0;
+		bool foundAddress = false;
+		uint16_t lowestScore = 0xFFFF;
+		for (uint8_t i = 0; i < Count; ++i) {
+			if (memcmp(list[i].address, address, MAC_ADDRESS_LEN) == 0) {
+				index = i;
+				foundAddress = true;
+				break;
+			}
+			if (list[i].score < lowestScore) {
+				lowestScore = list[i].score;
+				index = i;
+			}
+		}
+		if (!foundAddress) {
+			evictedCount += (list[index].score != 0);
+			memcpy(list[index].address, address, MAC_ADDRESS_LEN);
+			list[index].score = 0;
+		}
+		if (timeoutCounter != 0) {
+			return false;
+		}
+		uint16_t prevScore = list[index].score;
+		list[index].score += scoreIncrement;
+		if (list[index].score > scoreMax) {
+			list[index].score = scoreMax;
+		}
+		if (prevScore <= scoreThreshold && list[index].score > scoreThreshold) {
+			timeoutCounter = timeoutTicks;
+			return true;
+		}
+		return false;
+	}
+
+	uint32_t getEvictedCount() {
+		return evictedCount;
+	}
+
+	void tick() {
+		for (uint8_t i = 0; i < Count; ++i) {
+			if (list[i].score) {
+				list[i].score--;
+			}
+		}
+		if (timeoutCounter) {
+			timeoutCounter--;
+		}
+	}
+};
+
+/**
+ * Same as TapToToggle does with the table.
+ */
+template <uint8_t Capacity>
+struct TableDetector {
+	TapToToggleTable<Capacity> table;
+	uint32_t tickCount = 0;
+	uint16_t timeoutCounter = 0;
+
+	bool handle(const uint8_t* address) {
+		bool added;
+		uint8_t index = table.getOrAdd(address, tickCount, added);
+		if (timeoutCounter != 0) {
+			return false;
+		}
+		uint16_t prevScore = table.increaseScore(index, scoreIncrement, scoreMax, tickCount);
+		uint16_t score = table.getScore(index, tickCount);
+		if (prevScore <= scoreThreshold && score > scoreThreshold) {
+			timeoutCounter = timeoutTicks;
+			return true;
+		}
+		return false;
+	}
+
+	uint32_t getEvictedCount() {
+		return table.getEvictedCount();
+	}
+
+	void tick() {
+		tickCount++;
+		if (timeoutCounter) {
+			timeoutCounter--;
+		}
+	}
+};
+
+void makeAddress(uint32_t phone, uint8_t* address) {
+	address[0] = 0xC0 | (phone & 0x0F);
+	for (uint8_t i = 1; i < MAC_ADDRESS_LEN; ++i) {
+		address[i] = (phone * 2654435761U) >> (i * 4);
+	}
+}
+
+void testTable() {
+	cout << "Test adding and decaying scores." << endl;
+	TapToToggleTable<4> table;
+	uint8_t address[MAC_ADDRESS_LEN];
+	bool added;
+	makeAddress(1, address);
+	uint8_t slot = table.getOrAdd(address, 100, added);
+	assert(added);
+	assert(table.isInUse(slot));
+	assert(memcmp(table.getAddress(slot), address, MAC_ADDRESS_LEN) == 0);
+	assert(table.getScore(slot, 100) == 0);
+	assert(table.increaseScore(slot, 20, 50, 100) == 0);
+	assert(table.getScore(slot, 105) == 15);
+	assert(table.increaseScore(slot, 20, 50, 105) == 15);
+	assert(table.getScore(slot, 105) == 35);
+	assert(table.increaseScore(slot, 20, 50, 105) == 35);
+	assert(table.getScore(slot, 105) == 50);
+	assert(table.getScore(slot, 150) == 5);
+	assert(table.getScore(slot, 155) == 0);
+	assert(table.getScore(slot, 100000) == 0);
+	assert(table.getOrAdd(address, 200, added) == slot);
+	assert(!added);
+
+	cout << "Test that the address with the lowest score is replaced." << endl;
+	uint8_t slots[4];
+	for (uint32_t phone = 1; phone <= 4; ++phone) {
+		makeAddress(phone, address);
+		slots[phone - 1] = table.getOrAdd(address, 200, added);
+		table.increaseScore(slots[phone - 1], 10 * phone, 50, 200);
+	}
+	for (uint8_t i = 0; i < 4; ++i) {
+		for (uint8_t j = i + 1; j < 4; ++j) {
+			assert(slots[i] != slots[j]);
+		}
+	}
+	makeAddress(5, address);
+	assert(table.getOrAdd(address, 201, added) == slots[0]);
+	assert(added);
+	assert(table.getEvictedCount() == 1);
+	makeAddress(1, address);
+	table.getOrAdd(address, 201, added);
+	assert(added);
+}
+
+/**
+ * With at most as many phones as the reference list can keep, the table should trigger at exactly the same advertisements.
+ */
+void testAgainstReference(uint32_t ticks) {
+	cout << "Test " << ticks << " random ticks with 3 phones against the list." << endl;
+	ReferenceList<3> reference;
+	TableDetector<16> detector;
+	uint8_t address[MAC_ADDRESS_LEN];
+	uint32_t triggers = 0;
+	srand(1);
+	for (uint32_t t = 0; t < ticks; ++t) {
+		for (uint32_t phone = 0; phone < 3; ++phone) {
+			if (rand() % 4 == 0) {
+				makeAddress(phone, address);
+				bool triggered = reference.handle(address);
+				assert(detector.handle(address) == triggered);
+				triggers += triggered;
+			}
+		}
+		reference.tick();
+		detector.tick();
+	}
+	assert(triggers > 0);
+	assert(detector.table.getEvictedCount() == 0);
+}
+
+struct SimResult {
+	uint32_t taps = 0;
+	uint32_t detected = 0;
+	uint32_t falseTriggers = 0;
+	uint32_t evicted = 0;
+	uint32_t advertisements = 0;
+	int64_t nanoseconds = 0;
+};
+
+/**
+ * Simulate a shared space: many phones around, of which each advertisement is sometimes received with an RSSI
+ * above threshold, and every now and then a phone that is held close to the stone.
+ *
+ * Only advertisements with an RSSI above threshold are handed to the detector, like TapToToggle does.
+ */
+template <class Detector>
+SimResult simulate(uint32_t numPhones, uint32_t aboveThresholdPerMille, uint32_t ticks) {
+	Detector detector;
+	SimResult result;
+	uint8_t address[MAC_ADDRESS_LEN];
+	srand(2);
+
+	const uint32_t tapDurationTicks = 15;
+	const uint32_t tapIntervalTicks = 50;
+	vector<uint32_t> tapPhones;
+	uint32_t tapPhone = 0;
+	uint32_t tapStart = 0;
+	bool tapDetected = false;
+
+	// Generate the received advertisements first, so that only the detector is timed.
+	vector<uint32_t> advPhones;
+	vector<uint32_t> advTicks;
+	for (uint32_t t = 0; t < ticks; ++t) {
+		if (t % tapIntervalTicks == 0) {
+			tapPhone = rand() % numPhones;
+			tapPhones.push_back(tapPhone);
+			tapStart = t;
+		}
+		for (uint32_t phone = 0; phone < numPhones; ++phone) {
+			// Each phone advertises about 3 times per second.
+			if (rand() % 10 >= 3) {
+				continue;
+			}
+			bool tapping = (phone == tapPhone && t - tapStart < tapDurationTicks);
+			if (tapping || (uint32_t)(rand() % 1000) < aboveThresholdPerMille) {
+				advPhones.push_back(phone);
+				advTicks.push_back(t);
+			}
+		}
+	}
+	result.advertisements = advPhones.size();
+
+	size_t adv = 0;
+	auto start = chrono::steady_clock::now();
+	for (uint32_t t = 0; t < ticks; ++t) {
+		if (t % tapIntervalTicks == 0) {
+			if (t) {
+				result.taps++;
+				result.detected += tapDetected;
+			}
+			tapDetected = false;
+			tapPhone = tapPhones[t / tapIntervalTicks];
+			tapStart = t;
+		}
+		for (; adv < advPhones.size() && advTicks[adv] == t; ++adv) {
+			makeAddress(advPhones[adv], address);
+			if (detector.handle(address)) {
+				if (advPhones[adv] == tapPhone && t - tapStart < tapDurationTicks && !tapDetected) {
+					tapDetected = true;
+				}
+				else {
+					result.falseTriggers++;
+				}
+			}
+		}
+		detector.tick();
+	}
+	result.evicted = detector.getEvictedCount();
+	result.nanoseconds = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+	return result;
+}
+
+void printResult(const char* name, SimResult& result) {
+	cout << "  " << name << ": detected " << result.detected << " of " << result.taps << " taps, "
+			<< result.falseTriggers << " false triggers, "
+			<< result.evicted << " scores evicted, "
+			<< (double)result.nanoseconds / result.advertisements << " ns per advertisement" << endl;
+}
+
+void testSharedSpace(uint32_t numPhones, uint32_t aboveThresholdPerMille) {
+	cout << "Test a shared space with " << numPhones << " phones, "
+			<< aboveThresholdPerMille / 10.0 << "% of the advertisements above threshold." << endl;
+	const uint32_t ticks = 10 * 3600 * 10;
+	SimResult list3 = simulate<ReferenceList<3>>(numPhones, aboveThresholdPerMille, ticks);
+	SimResult list16 = simulate<ReferenceList<16>>(numPhones, aboveThresholdPerMille, ticks);
+	SimResult table16 = simulate<TableDetector<16>>(numPhones, aboveThresholdPerMille, ticks);
+	printResult("list of 3  ", list3);
+	printResult("list of 16 ", list16);
+	printResult("table of 16", table16);
+	// The table should keep up the scores of as many phones as a list of the same size, without the per tick cost.
+	assert(table16.evicted * 10 <= list3.evicted);
+	assert(table16.detected * 100 >= list16.detected * 99);
+}
+
+int main() {
+	cout << "Test TapToToggleTable" << endl;
+
+	testTable();
+	testAgainstReference(100000);
+	testSharedSpace(5, 10);
+	testSharedSpace(20, 10);
+	testSharedSpace(50, 10);
+	testSharedSpace(200, 5);
+
+	cout << "TapToToggleTable SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,178 @@
+#include <tracking/cs_TrackedDeviceTable.h>
+
+#include <chrono>
+#include <forward_list>
+#include <iostream>
+#include <cassert>
+#include <cstdlib>
+#include <list>
+#include <map>
+
+using namespace std;
+
+void makeToken(uint32_t value, uint8_t* token) {
+	token[0] = value & 0xFF;
+	token[1] = (value >> 8) & 0xFF;
+	token[2] = (value >> 16) & 0xFF;
+}
+
+/**
+ * Compare against a simple model: a map from ID to token, and a list from most to least recently used.
+ */
+template <uint16_t Capacity>
+void testRandom(uint32_t operations) {
+	cout << "Test " << operations << " random operations with capacity " << Capacity << endl;
+	TrackedDeviceTable<Capacity>* table = new TrackedDeviceTable<Capacity>();
+	map<device_id_t, uint32_t> tokens;
+	list<device_id_t> lru;
+	// Use few IDs and tokens, so that there are many hits and collisions.
+	uint32_t numIds = Capacity * 2;
+	uint8_t token[TRACKED_DEVICE_TOKEN_SIZE];
+	srand(Capacity);
+
+	for (uint32_t i = 0; i < operations; ++i) {
+		device_id_t id = rand() % numIds;
+		uint32_t tokenValue = rand() % (numIds * 4);
+		makeToken(tokenValue, token);
+		switch (rand() % 4) {
+			case 0: {
+				// Register: find or add, then set token if it's not in use by another device.
+				TrackedDevice* device = table->find(id);
+				if (device == nullptr) {
+					if (tokens.size() == Capacity) {
+						tokens.erase(lru.back());
+						lru.pop_back();
+					}
+					device = table->add(id);
+					tokens[id] = 0xFFFFFFFF;
+					lru.push_front(id);
+				}
+				assert(device->data.data.deviceId == id);
+				TrackedDevice* other = table->findToken(token);
+				if (other == nullptr || other == device) {
+					table->setToken(device, token);
+					tokens[id] = tokenValue;
+				}
+				table->touch(device);
+				lru.remove(id);
+				lru.push_front(id);
+				break;
+			}
+			case 1: {
+				// Scan: find by token.
+				TrackedDevice* device = table->findToken(token);
+				device_id_t expectedId = 0xFFFF;
+				for (auto& entry: tokens) {
+					if (entry.second == tokenValue) {
+						expectedId = entry.first;
+					}
+				}
+				if (expectedId == 0xFFFF) {
+					assert(device == nullptr);
+				}
+				else {
+					assert(device != nullptr);
+					assert(device->data.data.deviceId == expectedId);
+				}
+				break;
+			}
+			case 2: {
+				TrackedDevice* device = table->find(id);
+				assert((device != nullptr) == (tokens.count(id) == 1));
+				if (device != nullptr && rand() % 4 == 0) {
+					table->remove(device);
+					tokens.erase(id);
+					lru.remove(id);
+				}
+				break;
+			}
+			case 3: {
+				// Remove a range of IDs.
+				if (rand() % 16 == 0) {
+					device_id_t maxId = rand() % numIds;
+					table->removeIf([&](const TrackedDevice& device) { return device.data.data.deviceId < maxId / 4; });
+					for (auto iter = tokens.begin(); iter != tokens.end();) {
+						if (iter->first < maxId / 4) {
+							lru.remove(iter->first);
+							iter = tokens.erase(iter);
+						}
+						else {
+							++iter;
+						}
+					}
+				}
+				break;
+			}
+		}
+		assert(table->size() == tokens.size());
+	}
+
+	cout << "  Test the order of the devices." << endl;
+	auto iter = lru.begin();
+	table->forEach([&](TrackedDevice& device) {
+		assert(iter != lru.end());
+		assert(device.data.data.deviceId == *iter);
+		++iter;
+	});
+	assert(iter == lru.end());
+
+	delete table;
+}
+
+/**
+ * Time the token lookup of a scanned device, for the table and for a list.
+ */
+template <uint16_t Capacity>
+void benchmark(uint32_t lookups) {
+	TrackedDeviceTable<Capacity>* table = new TrackedDeviceTable<Capacity>();
+	forward_list<TrackedDevice> devices;
+	uint8_t token[TRACKED_DEVICE_TOKEN_SIZE];
+	for (uint16_t i = 0; i < Capacity; ++i) {
+		makeToken(i * 7919, token);
+		TrackedDevice* device = table->add(i);
+		table->setToken(device, token);
+		devices.push_front(*device);
+	}
+
+	// Half of the scanned tokens are of tracked devices.
+	uint32_t found = 0;
+	auto start = chrono::steady_clock::now();
+	for (uint32_t i = 0; i < lookups; ++i) {
+		makeToken((i % (Capacity * 2)) * 7919, token);
+		for (auto& device: devices) {
+			if (memcmp(device.data.data.deviceToken, token, TRACKED_DEVICE_TOKEN_SIZE) == 0) {
+				found++;
+				break;
+			}
+		}
+	}
+	auto listNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+
+	uint32_t foundInTable = 0;
+	start = chrono::steady_clock::now();
+	for (uint32_t i = 0; i < lookups; ++i) {
+		makeToken((i % (Capacity * 2)) * 7919, token);
+		foundInTable += (table->findToken(token) != nullptr);
+	}
+	auto tableNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+	assert(found == foundInTable);
+	assert(found >= lookups / 2 - Capacity);
+
+	cout << "Benchmark token lookup with " << Capacity << " devices: list " << (float)listNs / lookups << " ns, table " << (float)tableNs / lookups << " ns" << endl;
+	delete table;
+}
+
+int main() {
+	cout << "Test TrackedDeviceTable" << endl;
+
+	testRandom<20>(100000);
+	testRandom<256>(100000);
+	testRandom<1024>(100000);
+
+	benchmark<20>(1000000);
+	benchmark<256>(100000);
+	benchmark<1024>(100000);
+
+	cout << "TrackedDeviceTable SUCCESS" << endl;
+	return EXIT_SUCCESS;
+}